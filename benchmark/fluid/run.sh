@@ -103,3 +103,28 @@ FLAGS_benchmark=true stdbuf -oL python fluid/machine_translation.py \
                --skip_batch_num=5 \
                --iterations=30 \
                2>&1 | tee -a lstm_gpu_128.log
+
+# rnn cpu inference, the recurrent weight of the lstm/gru operators is
+# packed once per batch with MKLML
+for rnn_type in lstm gru; do
+FLAGS_benchmark=true stdbuf -oL python fluid/stacked_dynamic_lstm.py \
+               --device=CPU \
+               --batch_size=32 \
+               --skip_batch_num=5 \
+               --iterations=30 \
+               --hidden_dim=512 \
+               --emb_dim=512 \
+               --crop_size=1500 \
+               --rnn_type=${rnn_type} \
+               --infer_only \
+               2>&1 | tee -a ${rnn_type}_cpu_infer_32.log
+done
+
+# seq2seq cpu inference
+FLAGS_benchmark=true stdbuf -oL python fluid/machine_translation.py \
+               --device=CPU \
+               --batch_size=32 \
+               --skip_batch_num=5 \
+               --iterations=30 \
+               --infer_only \
+               2>&1 | tee -a seq2seq_cpu_infer_32.log
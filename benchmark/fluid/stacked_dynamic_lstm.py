@@ -76,6 +76,15 @@ def parse_args():
         '--with_test',
         action='store_true',
         help='If set, test the testset during training.')
+    parser.add_argument(
+        '--rnn_type',
+        type=str,
+        default='dynamic_rnn',
+        choices=['dynamic_rnn', 'lstm', 'gru'],
+        help='Build the recurrent layer by DynamicRNN, or by the fused lstm '
+        'or gru operator. (default: %(default)s)')
+    parser.add_argument(
+        '--infer_only', action='store_true', help='If set, run forward only.')
     args = parser.parse_args()
     return args
 
@@ -94,17 +103,7 @@ def crop_sentence(reader, crop_size):
     return __impl__
 
 
-def main():
-    args = parse_args()
-    lstm_size = args.hidden_dim
-
-    data = fluid.layers.data(
-        name="words", shape=[1], lod_level=1, dtype='int64')
-    sentence = fluid.layers.embedding(
-        input=data, size=[len(word_dict), args.emb_dim])
-
-    sentence = fluid.layers.fc(input=sentence, size=lstm_size, act='tanh')
-
+def dynamic_rnn_lstm(sentence, lstm_size):
     rnn = fluid.layers.DynamicRNN()
     with rnn.block():
         word = rnn.step_input(sentence)
@@ -142,7 +141,33 @@ def main():
         rnn.update_memory(prev_hidden, hidden)
         rnn.output(hidden)
 
-    last = fluid.layers.sequence_pool(rnn(), 'last')
+    return rnn()
+
+
+def main():
+    args = parse_args()
+    lstm_size = args.hidden_dim
+
+    data = fluid.layers.data(
+        name="words", shape=[1], lod_level=1, dtype='int64')
+    sentence = fluid.layers.embedding(
+        input=data, size=[len(word_dict), args.emb_dim])
+
+    sentence = fluid.layers.fc(input=sentence, size=lstm_size, act='tanh')
+
+    if args.rnn_type == 'dynamic_rnn':
+        rnn_out = dynamic_rnn_lstm(sentence, lstm_size)
+    elif args.rnn_type == 'lstm':
+        # the input projection of all the time steps is done by one fc,
+        # only the recurrent projection is left to the lstm operator.
+        gates = fluid.layers.fc(input=sentence, size=lstm_size * 4)
+        rnn_out, _ = fluid.layers.dynamic_lstm(
+            input=gates, size=lstm_size * 4, use_peepholes=False)
+    else:
+        gates = fluid.layers.fc(input=sentence, size=lstm_size * 3)
+        rnn_out = fluid.layers.dynamic_gru(input=gates, size=lstm_size)
+
+    last = fluid.layers.sequence_pool(rnn_out, 'last')
     logit = fluid.layers.fc(input=last, size=2, act='softmax')
     loss = fluid.layers.cross_entropy(
         input=logit,
@@ -159,6 +184,7 @@ def main():
     with fluid.program_guard(inference_program):
         inference_program = fluid.io.get_inference_program(
             target_vars=[batch_acc, batch_size_tensor])
+    forward_program = fluid.default_main_program().clone(for_test=True)
 
     adam = fluid.optimizer.Adam()
     adam.minimize(loss)
@@ -188,11 +214,18 @@ def main():
             tensor_words = to_lodtensor([x[0] for x in data], place)
             label = numpy.array([x[1] for x in data]).astype("int64")
             label = label.reshape((-1, 1))
-            loss_np, acc, weight = exe.run(
-                fluid.default_main_program(),
-                feed={"words": tensor_words,
-                      "label": label},
-                fetch_list=[loss, batch_acc, batch_size_tensor])
+            if args.infer_only:
+                loss_np, acc, weight = exe.run(
+                    forward_program,
+                    feed={"words": tensor_words,
+                          "label": label},
+                    fetch_list=[loss, batch_acc, batch_size_tensor])
+            else:
+                loss_np, acc, weight = exe.run(
+                    fluid.default_main_program(),
+                    feed={"words": tensor_words,
+                          "label": label},
+                    fetch_list=[loss, batch_acc, batch_size_tensor])
             iters += 1
             for x in data:
                 num_samples += len(x[0])
@@ -10,12 +10,20 @@ if(CMAKE_COMPILER_IS_GNUCC OR CMAKE_COMPILER_IS_GNUCXX OR CMAKE_CXX_COMPILER_ID
     set(SSE3_FLAG "-msse3")
     set(AVX_FLAG "-mavx")
     set(AVX2_FLAG "-mavx2")
+    set(SSE42_FLAG "-msse4.2")
+    set(FMA_FLAG "-mfma")
+    set(AVX512F_FLAG "-mavx512f")
+    set(F16C_FLAG "-mf16c")
 elseif(MSVC)
     set(MMX_FLAG "/arch:MMX")
     set(SSE2_FLAG "/arch:SSE2")
     set(SSE3_FLAG "/arch:SSE3")
     SET(AVX_FLAG "/arch:AVX")
     SET(AVX2_FLAG "/arch:AVX2")
+    set(SSE42_FLAG "")
+    set(FMA_FLAG "")
+    set(AVX512F_FLAG "/arch:AVX512")
+    set(F16C_FLAG "")
 endif()
 
 set(CMAKE_REQUIRED_FLAGS_RETAINED ${CMAKE_REQUIRED_FLAGS})
@@ -81,5 +89,52 @@ int main()
     return 0;
 }" AVX2_FOUND)
 
+# The runtime dispatched kernels of operators/math/cpu_vec.h only need the
+# compiler to support the instruction sets, not the building machine.
+set(CMAKE_REQUIRED_FLAGS ${SSE42_FLAG})
+CHECK_CXX_SOURCE_COMPILES("
+#include <immintrin.h>
+int main()
+{
+    __m128 a = _mm_set1_ps(1.5f);
+    __m128 result = _mm_round_ps(a, _MM_FROUND_TO_NEAREST_INT);
+    return 0;
+}" SSE42_COMPILES)
+
+set(CMAKE_REQUIRED_FLAGS "${AVX2_FLAG} ${FMA_FLAG}")
+CHECK_CXX_SOURCE_COMPILES("
+#include <immintrin.h>
+int main()
+{
+    __m256 a = _mm256_set1_ps(1.5f);
+    __m256 result = _mm256_fmadd_ps(a, a, a);
+    __m256i b = _mm256_slli_epi32(_mm256_cvtps_epi32(result), 23);
+    return 0;
+}" AVX2_COMPILES)
+
+set(CMAKE_REQUIRED_FLAGS ${AVX512F_FLAG})
+CHECK_CXX_SOURCE_COMPILES("
+#include <immintrin.h>
+int main()
+{
+    __m512 a = _mm512_set1_ps(1.5f);
+    __m512 result = _mm512_fmadd_ps(a, a, a);
+    result = _mm512_roundscale_ps(result, _MM_FROUND_TO_NEAREST_INT);
+    return 0;
+}" AVX512F_COMPILES)
+
+# The FP16 conversions of operators/math/half_weight.h.
+set(CMAKE_REQUIRED_FLAGS "${AVX_FLAG} ${F16C_FLAG}")
+CHECK_CXX_SOURCE_COMPILES("
+#include <immintrin.h>
+int main()
+{
+    __m256 a = _mm256_set1_ps(1.5f);
+    __m128i h = _mm256_cvtps_ph(a, _MM_FROUND_TO_NEAREST_INT);
+    __m256 result = _mm256_cvtph_ps(h);
+    return 0;
+}" F16C_COMPILES)
+
 set(CMAKE_REQUIRED_FLAGS ${CMAKE_REQUIRED_FLAGS_RETAINED})
 mark_as_advanced(MMX_FOUND SSE2_FOUND SSE3_FOUND AVX_FOUND AVX2_FOUND)
+mark_as_advanced(SSE42_COMPILES AVX2_COMPILES AVX512F_COMPILES F16C_COMPILES)
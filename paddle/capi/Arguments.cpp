@@ -39,7 +39,9 @@ paddle_error paddle_arguments_get_size(paddle_arguments args, uint64_t* size) {
 
 paddle_error paddle_arguments_resize(paddle_arguments args, uint64_t size) {
   if (args == nullptr) return kPD_NULLPTR;
-  castArg(args)->args.resize(size);
+  auto a = castArg(args);
+  a->args.resize(size);
+  if (a->bindings.size() > size) a->bindings.resize(size);
   return kPD_NO_ERROR;
 }
 
@@ -52,6 +54,7 @@ paddle_error paddle_arguments_set_value(paddle_arguments args,
   auto a = castArg(args);
   if (ID >= a->args.size()) return kPD_OUT_OF_RANGE;
   a->args[ID].value = m->mat;
+  a->binding(ID).value = nullptr;
   return kPD_NO_ERROR;
 }
 
@@ -87,6 +90,7 @@ paddle_error paddle_arguments_set_ids(paddle_arguments args,
   auto a = castArg(args);
   if (ID >= a->args.size()) return kPD_OUT_OF_RANGE;
   a->args[ID].ids = iv->vec;
+  a->binding(ID).ids = nullptr;
   return kPD_NO_ERROR;
 }
 
@@ -110,9 +114,12 @@ paddle_error paddle_arguments_set_sequence_start_pos(paddle_arguments args,
   auto iv = paddle::capi::cast<paddle::capi::CIVector>(seqPos);
   if (iv->vec == nullptr) return kPD_NULLPTR;
   auto a = castArg(args);
-  return a->accessSeqPos(ID, nestedLevel, [&iv](paddle::ICpuGpuVectorPtr& ptr) {
-    ptr = std::make_shared<paddle::ICpuGpuVector>(iv->vec);
-  });
+  auto err =
+      a->accessSeqPos(ID, nestedLevel, [&iv](paddle::ICpuGpuVectorPtr& ptr) {
+        ptr = std::make_shared<paddle::ICpuGpuVector>(iv->vec);
+      });
+  if (err == kPD_NO_ERROR) a->binding(ID).seqPos[nestedLevel] = nullptr;
+  return err;
 }
 
 paddle_error paddle_arguments_get_sequence_start_pos(paddle_arguments args,
@@ -126,4 +133,113 @@ paddle_error paddle_arguments_get_sequence_start_pos(paddle_arguments args,
     iv->vec = ptr->getMutableVector(false);
   });
 }
+
+paddle_error paddle_arguments_bind_value(paddle_arguments args,
+                                         uint64_t ID,
+                                         paddle_real* buffer,
+                                         uint64_t capacity,
+                                         uint64_t width) {
+  if (args == nullptr || buffer == nullptr) return kPD_NULLPTR;
+  auto a = castArg(args);
+  if (ID >= a->args.size()) return kPD_OUT_OF_RANGE;
+  a->args[ID].value =
+      paddle::Matrix::create(buffer, capacity, width, false, false);
+  auto& binding = a->binding(ID);
+  binding.value = buffer;
+  binding.valueCapacity = capacity;
+  return kPD_NO_ERROR;
+}
+
+paddle_error paddle_arguments_bind_ids(paddle_arguments args,
+                                       uint64_t ID,
+                                       int* buffer,
+                                       uint64_t capacity) {
+  if (args == nullptr || buffer == nullptr) return kPD_NULLPTR;
+  auto a = castArg(args);
+  if (ID >= a->args.size()) return kPD_OUT_OF_RANGE;
+  a->args[ID].ids = paddle::IVector::create(buffer, capacity, false);
+  auto& binding = a->binding(ID);
+  binding.ids = buffer;
+  binding.idsCapacity = capacity;
+  return kPD_NO_ERROR;
+}
+
+paddle_error paddle_arguments_bind_sequence_start_pos(paddle_arguments args,
+                                                      uint64_t ID,
+                                                      uint32_t nestedLevel,
+                                                      int* buffer,
+                                                      uint64_t capacity) {
+  if (args == nullptr || buffer == nullptr) return kPD_NULLPTR;
+  auto a = castArg(args);
+  auto err = a->accessSeqPos(
+      ID, nestedLevel, [buffer, capacity](paddle::ICpuGpuVectorPtr& ptr) {
+        ptr = std::make_shared<paddle::ICpuGpuVector>(capacity, buffer, false);
+      });
+  if (err != kPD_NO_ERROR) return err;
+  auto& binding = a->binding(ID);
+  binding.seqPos[nestedLevel] = buffer;
+  binding.seqPosCapacity[nestedLevel] = capacity;
+  return kPD_NO_ERROR;
+}
+
+paddle_error paddle_arguments_set_bound_size(paddle_arguments args,
+                                             uint64_t ID,
+                                             uint64_t size) {
+  if (args == nullptr) return kPD_NULLPTR;
+  auto a = castArg(args);
+  if (ID >= a->args.size()) return kPD_OUT_OF_RANGE;
+  auto& binding = a->binding(ID);
+  if (binding.value == nullptr && binding.ids == nullptr) return kPD_NULLPTR;
+  if ((binding.value != nullptr && size > binding.valueCapacity) ||
+      (binding.ids != nullptr && size > binding.idsCapacity)) {
+    return kPD_OUT_OF_RANGE;
+  }
+  // point the bound matrix and vector at the first rows of the buffers
+  auto& arg = a->args[ID];
+  if (binding.value != nullptr) {
+    arg.value->setData(binding.value, size, arg.value->getWidth());
+  }
+  if (binding.ids != nullptr) {
+    arg.ids->subVecFrom(binding.ids, 0, size);
+  }
+  return kPD_NO_ERROR;
+}
+
+paddle_error paddle_arguments_set_bound_sequence_num(paddle_arguments args,
+                                                     uint64_t ID,
+                                                     uint32_t nestedLevel,
+                                                     uint64_t numSequences) {
+  if (args == nullptr) return kPD_NULLPTR;
+  auto a = castArg(args);
+  if (ID >= a->args.size() || nestedLevel > 1) return kPD_OUT_OF_RANGE;
+  auto& binding = a->binding(ID);
+  int* buffer = binding.seqPos[nestedLevel];
+  if (buffer == nullptr) return kPD_NULLPTR;
+  if (numSequences + 1 > binding.seqPosCapacity[nestedLevel]) {
+    return kPD_OUT_OF_RANGE;
+  }
+  return a->accessSeqPos(
+      ID, nestedLevel, [buffer, numSequences](paddle::ICpuGpuVectorPtr& ptr) {
+        // the CPU copy is marked as modified, so it is copied to the GPU
+        // again if a layer reads it there
+        ptr->getMutableVector(false)->subVecFrom(buffer, 0, numSequences + 1);
+      });
+}
+
+paddle_error paddle_arguments_borrow_value(paddle_arguments args,
+                                           uint64_t ID,
+                                           paddle_real** buffer,
+                                           uint64_t* height,
+                                           uint64_t* width) {
+  if (args == nullptr || buffer == nullptr) return kPD_NULLPTR;
+  auto a = castArg(args);
+  if (ID >= a->args.size()) return kPD_OUT_OF_RANGE;
+  auto& mat = a->args[ID].value;
+  if (mat == nullptr) return kPD_NULLPTR;
+  if (mat->isSparse() || mat->useGpu()) return kPD_NOT_SUPPORTED;
+  *buffer = mat->getData();
+  if (height != nullptr) *height = mat->getHeight();
+  if (width != nullptr) *width = mat->getWidth();
+  return kPD_NO_ERROR;
+}
 }
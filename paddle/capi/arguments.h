@@ -152,6 +152,113 @@ paddle_arguments_get_sequence_start_pos(paddle_arguments args,
                                         uint32_t nestedLevel,
                                         paddle_ivector seqPos);
 
+/**
+ * @brief paddle_arguments_bind_value Bind a dense buffer of the caller as the
+ *        value matrix of one argument in array, which index is `ID`. The
+ *        buffer is not copied, it holds at most `capacity` rows of `width`
+ *        and should be valid until it is bound again or the arguments are
+ *        destroyed. Write the next input in place and set its rows by
+ *        paddle_arguments_set_bound_size before every forward, so the
+ *        forwards do not create or copy the inputs.
+ * @param [in] args arguments array
+ * @param [in] ID array index
+ * @param [in] buffer rows of the input, on CPU
+ * @param [in] capacity maximum number of rows
+ * @param [in] width width of a row
+ * @return paddle_error
+ */
+PD_API paddle_error paddle_arguments_bind_value(paddle_arguments args,
+                                                uint64_t ID,
+                                                paddle_real* buffer,
+                                                uint64_t capacity,
+                                                uint64_t width);
+
+/**
+ * @brief paddle_arguments_bind_ids Bind an integer buffer of the caller as
+ *        the ids of one argument in array, which index is `ID`, the same as
+ *        paddle_arguments_bind_value.
+ * @param [in] args arguments array
+ * @param [in] ID array index
+ * @param [in] buffer ids of the input, on CPU
+ * @param [in] capacity maximum number of ids
+ * @return paddle_error
+ */
+PD_API paddle_error paddle_arguments_bind_ids(paddle_arguments args,
+                                              uint64_t ID,
+                                              int* buffer,
+                                              uint64_t capacity);
+
+/**
+ * @brief paddle_arguments_bind_sequence_start_pos Bind an integer buffer of
+ *        the caller as the sequence start positions of one argument in
+ *        array, which index is `ID`, the same as paddle_arguments_bind_value.
+ *        Set the number of sequences by
+ *        paddle_arguments_set_bound_sequence_num before every forward.
+ * @param [in] args arguments array
+ * @param [in] ID array index
+ * @param [in] nestedLevel 0 for sequences, 1 for sub-sequences
+ * @param [in] buffer sequence start positions, on CPU
+ * @param [in] capacity maximum number of positions, the number of
+ *        sequences plus one
+ * @return paddle_error
+ */
+PD_API paddle_error
+paddle_arguments_bind_sequence_start_pos(paddle_arguments args,
+                                         uint64_t ID,
+                                         uint32_t nestedLevel,
+                                         int* buffer,
+                                         uint64_t capacity);
+
+/**
+ * @brief paddle_arguments_set_bound_size Set the number of rows of the bound
+ *        value and the number of the bound ids of one argument in array,
+ *        which index is `ID`, for the next forward. Nothing is allocated.
+ * @param [in] args arguments array
+ * @param [in] ID array index
+ * @param [in] size rows of the value, or number of ids, at most the capacity
+ * @return paddle_error
+ */
+PD_API paddle_error paddle_arguments_set_bound_size(paddle_arguments args,
+                                                    uint64_t ID,
+                                                    uint64_t size);
+
+/**
+ * @brief paddle_arguments_set_bound_sequence_num Set the number of sequences
+ *        of the bound sequence start positions of one argument in array,
+ *        which index is `ID`, for the next forward. The buffer should hold
+ *        numSequences + 1 positions. Nothing is allocated.
+ * @param [in] args arguments array
+ * @param [in] ID array index
+ * @param [in] nestedLevel 0 for sequences, 1 for sub-sequences
+ * @param [in] numSequences number of sequences
+ * @return paddle_error
+ */
+PD_API paddle_error
+paddle_arguments_set_bound_sequence_num(paddle_arguments args,
+                                        uint64_t ID,
+                                        uint32_t nestedLevel,
+                                        uint64_t numSequences);
+
+/**
+ * @brief paddle_arguments_borrow_value Borrow the value matrix of one
+ *        argument in array, which index is `ID`, without creating a
+ *        paddle_matrix or copying it. For the output arguments of a forward
+ *        the buffer is the output of the layer, which is valid and reused
+ *        until the next forward, or until
+ *        paddle_gradient_machine_release_layer_output.
+ * @param [in] args arguments array
+ * @param [in] ID array index
+ * @param [out] buffer rows of the value, row major
+ * @param [out] height number of rows, can be NULL
+ * @param [out] width width of a row, can be NULL
+ * @return paddle_error, kPD_NOT_SUPPORTED if the value is sparse or on GPU
+ */
+PD_API paddle_error paddle_arguments_borrow_value(paddle_arguments args,
+                                                  uint64_t ID,
+                                                  paddle_real** buffer,
+                                                  uint64_t* height,
+                                                  uint64_t* width);
+
 #ifdef __cplusplus
 }
 #endif
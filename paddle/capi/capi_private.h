@@ -48,8 +48,25 @@ struct CArguments {
   STRUCT_HEADER
   std::vector<paddle::Argument> args;
 
+  // The buffers of the caller bound to an argument, which are shared by
+  // the forwards without copying.
+  struct Binding {
+    real* value = nullptr;
+    uint64_t valueCapacity = 0;
+    int* ids = nullptr;
+    uint64_t idsCapacity = 0;
+    int* seqPos[2] = {nullptr, nullptr};
+    uint64_t seqPosCapacity[2] = {0, 0};
+  };
+  std::vector<Binding> bindings;
+
   CArguments() : type(kARGUMENTS) {}
 
+  Binding& binding(uint64_t ID) {
+    if (bindings.size() < args.size()) bindings.resize(args.size());
+    return bindings[ID];
+  }
+
   template <typename T>
   paddle_error accessSeqPos(uint64_t ID, uint32_t nestedLevel, T callback) {
     if (ID >= args.size()) return kPD_OUT_OF_RANGE;
@@ -62,7 +62,11 @@ PD_API paddle_error paddle_gradient_machine_load_parameter_from_disk(
     paddle_gradient_machine machine, const char* path);
 
 /**
- * @brief Forward a gradient machine
+ * @brief Forward a gradient machine. The outputs in outArgs share the
+ *        memory of the output layers, which is reused by the next forward,
+ *        see paddle_arguments_borrow_value. Reuse inArgs and outArgs across
+ *        the forwards, with the inputs bound by paddle_arguments_bind_value,
+ *        to avoid allocating them on every forward.
  * @param machine Gradient machine
  * @param inArgs input arguments
  * @param outArgs output arguments
@@ -127,3 +127,55 @@ TEST(CAPIArguments, Sequence) {
     testSequence(i);
   }
 }
+
+TEST(CAPIArguments, bind) {
+  paddle_arguments args = paddle_arguments_create_none();
+  ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_resize(args, 1));
+
+  std::vector<paddle_real> value = randomBuffer(16 * 8);
+  int seqPos[5] = {0, 1, 3, 6, 10};
+  ASSERT_EQ(kPD_NO_ERROR,
+            paddle_arguments_bind_value(args, 0, value.data(), 16, 8));
+  ASSERT_EQ(kPD_NO_ERROR,
+            paddle_arguments_bind_sequence_start_pos(args, 0, 0, seqPos, 5));
+  ASSERT_EQ(kPD_OUT_OF_RANGE, paddle_arguments_set_bound_size(args, 0, 17));
+  ASSERT_EQ(kPD_OUT_OF_RANGE,
+            paddle_arguments_set_bound_sequence_num(args, 0, 0, 5));
+  ASSERT_EQ(kPD_NULLPTR,
+            paddle_arguments_set_bound_sequence_num(args, 0, 1, 1));
+
+  paddle_ivector pos = paddle_ivector_create_none();
+  for (uint64_t numSeqs : {4, 2}) {
+    uint64_t rows = seqPos[numSeqs];
+    ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_set_bound_size(args, 0, rows));
+    ASSERT_EQ(kPD_NO_ERROR,
+              paddle_arguments_set_bound_sequence_num(args, 0, 0, numSeqs));
+
+    // the buffers are shared, not copied
+    paddle_real* buf;
+    uint64_t height, width;
+    ASSERT_EQ(kPD_NO_ERROR,
+              paddle_arguments_borrow_value(args, 0, &buf, &height, &width));
+    ASSERT_EQ(value.data(), buf);
+    ASSERT_EQ(rows, height);
+    ASSERT_EQ(8UL, width);
+
+    ASSERT_EQ(kPD_NO_ERROR,
+              paddle_arguments_get_sequence_start_pos(args, 0, 0, pos));
+    int* rawPos;
+    uint64_t size;
+    ASSERT_EQ(kPD_NO_ERROR, paddle_ivector_get(pos, &rawPos));
+    ASSERT_EQ(kPD_NO_ERROR, paddle_ivector_get_size(pos, &size));
+    ASSERT_EQ(seqPos, rawPos);
+    ASSERT_EQ(numSeqs + 1, size);
+  }
+
+  // setting a value unbinds the buffer
+  paddle_matrix mat = paddle_matrix_create(4, 8, false);
+  ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_set_value(args, 0, mat));
+  ASSERT_EQ(kPD_NULLPTR, paddle_arguments_set_bound_size(args, 0, 2));
+
+  ASSERT_EQ(kPD_NO_ERROR, paddle_matrix_destroy(mat));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_ivector_destroy(pos));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_destroy(args));
+}
@@ -0,0 +1,287 @@
+/* Copyright (c) 2016 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+// Compare the allocations of a forward through the C API, with the
+// arguments created and the outputs copied for every request as before, and
+// with the inputs bound once and the outputs borrowed. The time of both is
+// measured by DISABLED_forwardBuffersBenchmark, run it with
+// --gtest_also_run_disabled_tests.
+//
+// The allocations of the thread are counted by operator new of this binary,
+// which covers the C API handles, the matrices, the vectors and their memory
+// handles. With the bound buffers, a request allocates exactly what
+// paddle_gradient_machine_forward does, i.e. nothing is allocated around the
+// forward, while the copying request allocates the arguments, the input
+// matrix and vector, the sequence positions and the output handle.
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include <random>
+#include <vector>
+#include "capi.h"
+#include "paddle/trainer/TrainerConfigHelper.h"
+#include "paddle/utils/Logging.h"
+#include "paddle/utils/ThreadLocal.h"
+
+static thread_local int64_t gNumAllocs = 0;
+
+void* operator new(size_t size) {
+  ++gNumAllocs;
+  void* ptr = malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+
+static const uint64_t kWidth = 100;
+static const uint64_t kCapacity = 32;
+
+// The rows of a request and its sequences.
+struct Request {
+  std::vector<paddle_real> rows;
+  std::vector<int> seqPos;
+
+  uint64_t height() const { return seqPos.back(); }
+  uint64_t numSequences() const { return seqPos.size() - 1; }
+};
+
+// Four sequences of 1 to 5 rows, which differ between the requests.
+static std::vector<Request> makeRequests(size_t num) {
+  auto& eng = paddle::ThreadLocalRandomEngine::get();
+  std::uniform_real_distribution<paddle_real> dist(-1.0, 1.0);
+  std::vector<Request> requests(num);
+  for (size_t i = 0; i < num; ++i) {
+    auto& req = requests[i];
+    req.seqPos.push_back(0);
+    for (size_t s = 0; s < 4; ++s) {
+      req.seqPos.push_back(req.seqPos.back() + 1 + (i + s) % 5);
+    }
+    for (uint64_t j = 0; j < req.height() * kWidth; ++j) {
+      req.rows.push_back(dist(eng));
+    }
+  }
+  return requests;
+}
+
+// Forward a request as the examples do, every handle is created for it and
+// the output is copied to result.
+static void forwardByCopy(paddle_gradient_machine machine,
+                          const Request& req,
+                          std::vector<paddle_real>* result) {
+  paddle_arguments inArgs = paddle_arguments_create_none();
+  ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_resize(inArgs, 1));
+  paddle_matrix mat = paddle_matrix_create(req.height(), kWidth, false);
+  for (uint64_t i = 0; i < req.height(); ++i) {
+    ASSERT_EQ(kPD_NO_ERROR,
+              paddle_matrix_set_row(mat,
+                                    i,
+                                    const_cast<paddle_real*>(
+                                        req.rows.data() + i * kWidth)));
+  }
+  ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_set_value(inArgs, 0, mat));
+  paddle_ivector seqPos =
+      paddle_ivector_create(const_cast<int*>(req.seqPos.data()),
+                            req.seqPos.size(),
+                            false,
+                            false);
+  ASSERT_EQ(kPD_NO_ERROR,
+            paddle_arguments_set_sequence_start_pos(inArgs, 0, 0, seqPos));
+
+  paddle_arguments outArgs = paddle_arguments_create_none();
+  ASSERT_EQ(kPD_NO_ERROR,
+            paddle_gradient_machine_forward(machine, inArgs, outArgs, false));
+  paddle_matrix prob = paddle_matrix_create_none();
+  ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_get_value(outArgs, 0, prob));
+  uint64_t height, width;
+  ASSERT_EQ(kPD_NO_ERROR, paddle_matrix_get_shape(prob, &height, &width));
+  result->resize(height * width);
+  ASSERT_EQ(kPD_NO_ERROR, paddle_matrix_get_value(prob, result->data()));
+
+  ASSERT_EQ(kPD_NO_ERROR, paddle_matrix_destroy(prob));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_destroy(outArgs));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_ivector_destroy(seqPos));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_matrix_destroy(mat));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_destroy(inArgs));
+}
+
+// The arguments of the requests, whose inputs are bound to the buffers.
+class BoundForward {
+public:
+  explicit BoundForward(paddle_gradient_machine machine)
+      : machine_(machine),
+        value_(kCapacity * kWidth),
+        seqPos_(kCapacity + 1),
+        inArgs_(paddle_arguments_create_none()),
+        outArgs_(paddle_arguments_create_none()) {
+    CHECK_EQ(kPD_NO_ERROR, paddle_arguments_resize(inArgs_, 1));
+    CHECK_EQ(kPD_NO_ERROR,
+             paddle_arguments_bind_value(
+                 inArgs_, 0, value_.data(), kCapacity, kWidth));
+    CHECK_EQ(kPD_NO_ERROR,
+             paddle_arguments_bind_sequence_start_pos(
+                 inArgs_, 0, 0, seqPos_.data(), seqPos_.size()));
+  }
+
+  ~BoundForward() {
+    paddle_arguments_destroy(outArgs_);
+    paddle_arguments_destroy(inArgs_);
+  }
+
+  // Forward req, the output is borrowed until the next forward.
+  void forward(const Request& req,
+               paddle_real** output,
+               uint64_t* height,
+               int64_t* forwardAllocs) {
+    // the caller writes the input in place, e.g. decoding a request
+    std::copy(req.rows.begin(), req.rows.end(), value_.begin());
+    std::copy(req.seqPos.begin(), req.seqPos.end(), seqPos_.begin());
+    ASSERT_EQ(kPD_NO_ERROR,
+              paddle_arguments_set_bound_size(inArgs_, 0, req.height()));
+    ASSERT_EQ(kPD_NO_ERROR,
+              paddle_arguments_set_bound_sequence_num(
+                  inArgs_, 0, 0, req.numSequences()));
+    int64_t begin = gNumAllocs;
+    ASSERT_EQ(kPD_NO_ERROR,
+              paddle_gradient_machine_forward(
+                  machine_, inArgs_, outArgs_, false));
+    *forwardAllocs += gNumAllocs - begin;
+    ASSERT_EQ(kPD_NO_ERROR,
+              paddle_arguments_borrow_value(
+                  outArgs_, 0, output, height, nullptr));
+  }
+
+private:
+  paddle_gradient_machine machine_;
+  std::vector<paddle_real> value_;
+  std::vector<int> seqPos_;
+  paddle_arguments inArgs_;
+  paddle_arguments outArgs_;
+};
+
+static void createMachine(paddle_gradient_machine* machine) {
+  paddle::TrainerConfigHelper config("./test_forward_network.py");
+  std::string buffer;
+  ASSERT_TRUE(config.getModelConfig().SerializeToString(&buffer));
+  ASSERT_EQ(kPD_NO_ERROR,
+            paddle_gradient_machine_create_for_inference(
+                machine, &buffer[0], (int)buffer.size()));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_gradient_machine_randomize_param(*machine));
+}
+
+// Forward the first requests both ways and check the outputs are the same,
+// which also grows the layer outputs to the largest request.
+static void warmup(paddle_gradient_machine machine,
+                   const std::vector<Request>& requests,
+                   size_t num,
+                   BoundForward* bound) {
+  std::vector<paddle_real> result;
+  paddle_real* output;
+  uint64_t height;
+  int64_t forwardAllocs = 0;
+  for (size_t i = 0; i < num; ++i) {
+    forwardByCopy(machine, requests[i], &result);
+    bound->forward(requests[i], &output, &height, &forwardAllocs);
+    ASSERT_EQ(requests[i].numSequences(), height);
+    ASSERT_EQ(result.size(), height * kWidth);
+    for (size_t j = 0; j < result.size(); ++j) {
+      ASSERT_NEAR(result[j], output[j], 1e-5);
+    }
+  }
+}
+
+TEST(GradientMachine, forwardBuffers) {
+  paddle_gradient_machine machine;
+  createMachine(&machine);
+
+  const size_t kWarmup = 10, kRepeat = 20;
+  auto requests = makeRequests(kWarmup + kRepeat);
+  BoundForward bound(machine);
+  warmup(machine, requests, kWarmup, &bound);
+
+  std::vector<paddle_real> result;
+  int64_t begin = gNumAllocs;
+  for (size_t i = kWarmup; i < requests.size(); ++i) {
+    forwardByCopy(machine, requests[i], &result);
+  }
+  int64_t copyAllocs = gNumAllocs - begin;
+
+  paddle_real* output;
+  uint64_t height;
+  int64_t forwardAllocs = 0;
+  begin = gNumAllocs;
+  for (size_t i = kWarmup; i < requests.size(); ++i) {
+    bound.forward(requests[i], &output, &height, &forwardAllocs);
+  }
+  EXPECT_EQ(gNumAllocs - begin, forwardAllocs);
+  EXPECT_LT(gNumAllocs - begin, copyAllocs);
+
+  ASSERT_EQ(kPD_NO_ERROR, paddle_gradient_machine_destroy(machine));
+}
+
+TEST(GradientMachine, DISABLED_forwardBuffersBenchmark) {
+  paddle_gradient_machine machine;
+  createMachine(&machine);
+
+  const size_t kWarmup = 10, kRepeat = 1000;
+  auto requests = makeRequests(kWarmup + kRepeat);
+  BoundForward bound(machine);
+  warmup(machine, requests, kWarmup, &bound);
+
+  std::vector<paddle_real> result;
+  int64_t begin = gNumAllocs;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = kWarmup; i < requests.size(); ++i) {
+    forwardByCopy(machine, requests[i], &result);
+  }
+  std::chrono::duration<double, std::micro> copyTime =
+      std::chrono::steady_clock::now() - start;
+  double copyAllocs = static_cast<double>(gNumAllocs - begin) / kRepeat;
+
+  paddle_real* output;
+  uint64_t height;
+  int64_t forwardAllocs = 0;
+  begin = gNumAllocs;
+  start = std::chrono::steady_clock::now();
+  for (size_t i = kWarmup; i < requests.size(); ++i) {
+    bound.forward(requests[i], &output, &height, &forwardAllocs);
+  }
+  std::chrono::duration<double, std::micro> boundTime =
+      std::chrono::steady_clock::now() - start;
+  double boundAllocs = static_cast<double>(gNumAllocs - begin) / kRepeat;
+
+  LOG(INFO) << "allocations per forward: " << copyAllocs << " copying, "
+            << boundAllocs << " bound, "
+            << static_cast<double>(forwardAllocs) / kRepeat
+            << " in paddle_gradient_machine_forward";
+  LOG(INFO) << "time per forward: " << copyTime.count() / kRepeat
+            << " us copying, " << boundTime.count() / kRepeat << " us bound";
+
+  ASSERT_EQ(kPD_NO_ERROR, paddle_gradient_machine_destroy(machine));
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  std::vector<char*> argvs;
+  argvs.push_back(strdup("--use_gpu=false"));
+  paddle_init((int)argvs.size(), argvs.data());
+  for (auto each : argvs) {
+    free(each);
+  }
+  return RUN_ALL_TESTS();
+}
@@ -97,7 +97,10 @@ class BlockDesc {
    */
   void RemoveOp(size_t s, size_t e);
 
-  void RemoveVar(const std::string &name) { vars_.erase(name); }
+  void RemoveVar(const std::string &name) {
+    need_update_ = true;
+    vars_.erase(name);
+  }
 
   std::vector<OpDesc *> AllOps() const;
 
@@ -15,6 +15,7 @@ limitations under the License. */
 #pragma once
 #include <typeindex>
 #include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/platform/bfloat16.h"
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/platform/float16.h"
 
@@ -35,6 +36,12 @@ inline proto::VarType::Type ToDataType(std::type_index type) {
     return proto::VarType::INT64;
   } else if (typeid(bool).hash_code() == type.hash_code()) {
     return proto::VarType::BOOL;
+  } else if (typeid(uint8_t).hash_code() == type.hash_code()) {
+    return proto::VarType::UINT8;
+  } else if (typeid(int8_t).hash_code() == type.hash_code()) {
+    return proto::VarType::INT8;
+  } else if (typeid(platform::bfloat16).hash_code() == type.hash_code()) {
+    return proto::VarType::BF16;
   } else {
     PADDLE_THROW("Not supported");
   }
@@ -55,6 +62,12 @@ inline std::type_index ToTypeIndex(proto::VarType::Type type) {
       return typeid(int64_t);
     case proto::VarType::BOOL:
       return typeid(bool);
+    case proto::VarType::UINT8:
+      return typeid(uint8_t);
+    case proto::VarType::INT8:
+      return typeid(int8_t);
+    case proto::VarType::BF16:
+      return typeid(platform::bfloat16);
     default:
       PADDLE_THROW("Not support type %d", type);
   }
@@ -104,6 +117,12 @@ inline std::string DataTypeToString(const proto::VarType::Type type) {
       return "int64";
     case proto::VarType::BOOL:
       return "bool";
+    case proto::VarType::UINT8:
+      return "uint8";
+    case proto::VarType::INT8:
+      return "int8";
+    case proto::VarType::BF16:
+      return "bfloat16";
     default:
       PADDLE_THROW("Not support type %d", type);
   }
@@ -41,6 +41,8 @@ class Executor {
 
   explicit Executor(const platform::Place& place);
 
+  const platform::Place& GetPlace() const { return place_; }
+
   /* @Brief
    * Runtime evaluation of the given ProgramDesc under certain Scope
    *
@@ -294,6 +294,36 @@ void DeserializeFromStream(std::istream &is, LoDTensor *tensor,
   TensorFromStream(is, static_cast<Tensor *>(tensor), dev_ctx);
 }
 
+void SkipLoDTensorInStream(std::istream &is) {
+  uint32_t version;
+  is.read(reinterpret_cast<char *>(&version), sizeof(version));
+  PADDLE_ENFORCE_EQ(version, 0U, "Only version 0 is supported");
+  uint64_t lod_level;
+  is.read(reinterpret_cast<char *>(&lod_level), sizeof(lod_level));
+  for (uint64_t i = 0; i < lod_level; ++i) {
+    uint64_t size;
+    is.read(reinterpret_cast<char *>(&size), sizeof(size));
+    is.seekg(static_cast<std::streamoff>(size), std::ios::cur);
+  }
+
+  // the Tensor written by TensorToStream
+  is.read(reinterpret_cast<char *>(&version), sizeof(version));
+  PADDLE_ENFORCE_EQ(version, 0U, "Only version 0 is supported");
+  int32_t desc_size;
+  is.read(reinterpret_cast<char *>(&desc_size), sizeof(desc_size));
+  PADDLE_ENFORCE(static_cast<bool>(is) && desc_size >= 0,
+                 "Cannot read the tensor desc");
+  std::string buf(static_cast<size_t>(desc_size), '\0');
+  is.read(&buf[0], desc_size);
+  proto::VarType::TensorDesc desc;
+  PADDLE_ENFORCE(desc.ParseFromString(buf), "Cannot parse tensor desc");
+  int64_t numel = 1;
+  for (auto dim : desc.dims()) numel *= dim;
+  is.seekg(static_cast<std::streamoff>(
+               numel * SizeOfType(ToTypeIndex(desc.data_type()))),
+           std::ios::cur);
+}
+
 void WriteToRecordIO(recordio::Writer *writer,
                      const std::vector<LoDTensor> &tensor,
                      const platform::DeviceContext &dev_ctx) {
@@ -390,7 +420,7 @@ void LoDTensor::MergeLoDTensor(
     auto &lod = t->lod();
     for (size_t j = 0; j < lod.size(); ++j) {
       auto &sub_lod = new_lod[j];
-      auto &offset = sub_lod.back();
+      auto offset = sub_lod.back();
       for (size_t k = 1; k < lod[j].size(); ++k) {
         sub_lod.push_back(lod[j][k] + offset);
       }
@@ -218,6 +218,9 @@ void SerializeToStream(std::ostream& os, const LoDTensor& tensor,
                        const platform::DeviceContext& dev_ctx);
 void DeserializeFromStream(std::istream& is, LoDTensor* tensor,
                            const platform::DeviceContext& dev_ctx);
+// Move is past a LoDTensor written by SerializeToStream without reading its
+// data, to index the LoDTensors of a file.
+void SkipLoDTensorInStream(std::istream& is);
 
 extern void WriteToRecordIO(recordio::Writer* writer,
                             const std::vector<LoDTensor>& tensor,
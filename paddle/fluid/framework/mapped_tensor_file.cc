@@ -0,0 +1,204 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/mapped_tensor_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fstream>
+#include <vector>
+
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/platform/macros.h"
+
+namespace paddle {
+namespace framework {
+
+// A file mapped copy-on-write, unmapped when the last tensor which aliases
+// it is released.
+class MappedRegion {
+ public:
+  explicit MappedRegion(const std::string& path) : data_(nullptr), size_(0) {
+    int fd = open(path.c_str(), O_RDONLY);
+    PADDLE_ENFORCE(fd >= 0, "Cannot open file %s", path);
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      close(fd);
+      PADDLE_THROW("Cannot stat file %s", path);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+      void* data =
+          mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+      close(fd);
+      PADDLE_ENFORCE(data != MAP_FAILED, "Cannot map file %s", path);
+      data_ = static_cast<char*>(data);
+    } else {
+      close(fd);
+    }
+  }
+
+  ~MappedRegion() {
+    if (data_ != nullptr) munmap(data_, size_);
+  }
+
+  char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  char* data_;
+  size_t size_;
+
+  DISABLE_COPY_AND_ASSIGN(MappedRegion);
+};
+
+template <typename T>
+static void WriteValue(std::ostream& os, T value) {
+  os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void WriteMappedTensorHeader(std::ostream& os, uint64_t count) {
+  WriteValue(os, kMappedTensorMagic);
+  WriteValue(os, static_cast<uint32_t>(0));
+  WriteValue(os, kMappedTensorAlignment);
+  WriteValue(os, count);
+}
+
+void SerializeToMappedStream(std::ostream& os, const LoDTensor& tensor,
+                             const platform::DeviceContext& dev_ctx) {
+  // the version and the LoD as SerializeToStream
+  WriteValue(os, static_cast<uint32_t>(0));
+  WriteValue(os, static_cast<uint64_t>(tensor.lod().size()));
+  for (auto& each : tensor.lod()) {
+    uint64_t size = each.size() * sizeof(LoD::value_type::value_type);
+    WriteValue(os, size);
+    os.write(reinterpret_cast<const char*>(each.data()),
+             static_cast<std::streamsize>(size));
+  }
+
+  // the version and the description of the tensor as TensorToStream
+  WriteValue(os, static_cast<uint32_t>(0));
+  proto::VarType::TensorDesc desc;
+  desc.set_data_type(ToDataType(tensor.type()));
+  for (auto dim : vectorize(tensor.dims())) desc.add_dims(dim);
+  auto desc_str = desc.SerializeAsString();
+  WriteValue(os, static_cast<int32_t>(desc_str.size()));
+  os.write(desc_str.data(), static_cast<std::streamsize>(desc_str.size()));
+
+  // the padding and the aligned data
+  std::streamoff pos = os.tellp();
+  PADDLE_ENFORCE(pos >= 0, "The stream of the mapped tensors is not seekable");
+  pos += sizeof(uint32_t);
+  uint32_t padding = static_cast<uint32_t>(
+      (kMappedTensorAlignment - pos % kMappedTensorAlignment) %
+      kMappedTensorAlignment);
+  WriteValue(os, padding);
+  std::vector<char> zeros(padding, 0);
+  os.write(zeros.data(), padding);
+
+  Tensor cpu_tensor;
+  const Tensor* data = &tensor;
+  if (!platform::is_cpu_place(tensor.place())) {
+    TensorCopy(tensor, platform::CPUPlace(), dev_ctx, &cpu_tensor);
+    dev_ctx.Wait();
+    data = &cpu_tensor;
+  }
+  os.write(static_cast<const char*>(data->data<void>()),
+           static_cast<std::streamsize>(data->numel() *
+                                        SizeOfType(data->type())));
+  PADDLE_ENFORCE(static_cast<bool>(os), "Cannot write the mapped tensors");
+}
+
+bool IsMappedTensorFile(const std::string& path) {
+  std::ifstream fin(path, std::ios::binary);
+  uint64_t magic = 0;
+  fin.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+  return static_cast<bool>(fin) && magic == kMappedTensorMagic;
+}
+
+MappedTensorReader::MappedTensorReader(const std::string& path, size_t offset)
+    : path_(path), region_(new MappedRegion(path)), offset_(offset), read_(0) {
+  PADDLE_ENFORCE_LE(offset, region_->size(), "Cannot read more from file %s",
+                    path);
+  PADDLE_ENFORCE_EQ(ConsumeValue<uint64_t>(), kMappedTensorMagic,
+                    "%s is not a file of mapped tensors", path);
+  PADDLE_ENFORCE_EQ(ConsumeValue<uint32_t>(), 0U,
+                    "Only version 0 is supported");
+  PADDLE_ENFORCE_EQ(ConsumeValue<uint32_t>(), kMappedTensorAlignment,
+                    "The alignment of %s is not supported", path);
+  size_ = ConsumeValue<uint64_t>();
+}
+
+const char* MappedTensorReader::Consume(size_t size) {
+  PADDLE_ENFORCE_LE(size, region_->size() - offset_,
+                    "Cannot read more from file %s", path_);
+  const char* begin = region_->data() + offset_;
+  offset_ += size;
+  return begin;
+}
+
+void MappedTensorReader::Next(LoDTensor* tensor, bool share,
+                              const platform::Place& place,
+                              const platform::DeviceContext& dev_ctx) {
+  PADDLE_ENFORCE_LT(read_, size_, "All the tensors of %s are read", path_);
+  ++read_;
+  PADDLE_ENFORCE_EQ(ConsumeValue<uint32_t>(), 0U,
+                    "Only version 0 is supported");
+  LoD lod(ConsumeValue<uint64_t>());
+  for (auto& each : lod) {
+    uint64_t size = ConsumeValue<uint64_t>();
+    std::vector<size_t> level(size / sizeof(size_t));
+    std::memcpy(level.data(), Consume(size), size);
+    each = level;
+  }
+
+  PADDLE_ENFORCE_EQ(ConsumeValue<uint32_t>(), 0U,
+                    "Only version 0 is supported");
+  proto::VarType::TensorDesc desc;
+  int32_t desc_size = ConsumeValue<int32_t>();
+  PADDLE_ENFORCE_GE(desc_size, 0, "Cannot parse tensor desc");
+  PADDLE_ENFORCE(desc.ParseFromArray(Consume(desc_size), desc_size),
+                 "Cannot parse tensor desc");
+  Consume(ConsumeValue<uint32_t>());
+  PADDLE_ENFORCE_EQ(offset_ % kMappedTensorAlignment, 0UL,
+                    "The data of the tensors in %s is not aligned", path_);
+
+  std::vector<int64_t> dims(desc.dims().begin(), desc.dims().end());
+  auto type = ToTypeIndex(desc.data_type());
+  LoDTensor view;
+  view.Resize(make_ddim(dims));
+  size_t bytes = static_cast<size_t>(view.numel()) * SizeOfType(type);
+  view.ShareExternalData(const_cast<char*>(Consume(bytes)), bytes, type,
+                         region_);
+  view.set_lod(lod);
+  if (share) {
+    PADDLE_ENFORCE(platform::is_cpu_place(place),
+                   "Only the CPU tensors can share the mapped file");
+    tensor->ShareDataWith(view);
+    tensor->set_lod(lod);
+  } else {
+    tensor->set_lod(lod);
+    TensorCopy(view, place, dev_ctx, tensor);
+    // the copy may be asynchronous, and the file is unmapped once the
+    // reader is released
+    dev_ctx.Wait();
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,94 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace framework {
+
+// The aligned combined format of LoDTensors, which can be loaded by mapping
+// the file instead of reading it. The file begins with
+//   uint64_t magic, kMappedTensorMagic
+//   uint32_t version, 0
+//   uint32_t alignment of the data
+//   uint64_t the number of the tensors
+// and every tensor is serialized as by SerializeToStream, except that a
+// uint32_t padding size and the zero padding bytes precede the data of the
+// tensor, so that the data begins at a multiple of alignment in the file.
+//
+// The tensors loaded with share = true alias the pages of the file, which
+// are shared by all the processes which map the same file, so loading is
+// O(1) and the memory of the parameters is paid once per host. The pages
+// are mapped copy-on-write: a process which writes a parameter, e.g. to
+// fuse it, gets a private copy of the pages it writes.
+constexpr uint64_t kMappedTensorMagic = 0x31304D4D54444150ULL;  // PADTMM01
+constexpr uint32_t kMappedTensorAlignment = 64;
+
+// Write the header of a file of count tensors.
+void WriteMappedTensorHeader(std::ostream& os, uint64_t count);
+
+// Append tensor to the file, os is positioned where the tensor begins.
+void SerializeToMappedStream(std::ostream& os, const LoDTensor& tensor,
+                             const platform::DeviceContext& dev_ctx);
+
+// Whether the file at path is in the aligned combined format.
+bool IsMappedTensorFile(const std::string& path);
+
+class MappedRegion;
+
+// Reads the tensors of a file in the aligned combined format in order.
+class MappedTensorReader {
+ public:
+  // The tensors begin at offset of the file, e.g. a section of a larger
+  // file, the alignment is of the offsets in the whole file.
+  explicit MappedTensorReader(const std::string& path, size_t offset = 0);
+
+  // The number of the tensors in the file.
+  uint64_t size() const { return size_; }
+
+  // Read the next tensor. If share is true, tensor aliases the mapped
+  // pages and place should be CPU, otherwise the data is copied to place.
+  void Next(LoDTensor* tensor, bool share, const platform::Place& place,
+            const platform::DeviceContext& dev_ctx);
+
+ private:
+  // Advance by size bytes and return where they begin.
+  const char* Consume(size_t size);
+
+  template <typename T>
+  T ConsumeValue() {
+    T value;
+    std::memcpy(&value, Consume(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  std::string path_;
+  std::shared_ptr<MappedRegion> region_;
+  size_t offset_;
+  uint64_t size_;
+  uint64_t read_;
+};
+
+}  // namespace framework
+}  // namespace paddle
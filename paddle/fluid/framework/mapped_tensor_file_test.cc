@@ -0,0 +1,84 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/mapped_tensor_file.h"
+#include <gtest/gtest.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+static const char kFile[] = "mapped_tensor_file_test.bin";
+
+static void WriteTensors(const std::vector<LoDTensor>& tensors) {
+  platform::CPUDeviceContext ctx;
+  std::ofstream fout(kFile, std::ios::binary);
+  WriteMappedTensorHeader(fout, tensors.size());
+  for (auto& tensor : tensors) SerializeToMappedStream(fout, tensor, ctx);
+}
+
+TEST(MappedTensorFile, SaveLoad) {
+  platform::CPUPlace place;
+  platform::CPUDeviceContext ctx;
+  std::vector<LoDTensor> tensors(3);
+  float* x = tensors[0].mutable_data<float>(make_ddim({3, 5}), place);
+  for (int i = 0; i < 15; ++i) x[i] = static_cast<float>(i) * 0.5f;
+  tensors[0].set_lod({{0, 1, 3}});
+  int64_t* y = tensors[1].mutable_data<int64_t>(make_ddim({7}), place);
+  for (int i = 0; i < 7; ++i) y[i] = i - 3;
+  tensors[2].mutable_data<int8_t>(make_ddim({0, 4}), place);
+  WriteTensors(tensors);
+  ASSERT_TRUE(IsMappedTensorFile(kFile));
+
+  for (bool share : {true, false}) {
+    std::vector<LoDTensor> loaded(3);
+    {
+      MappedTensorReader reader(kFile);
+      ASSERT_EQ(reader.size(), 3UL);
+      for (auto& tensor : loaded) reader.Next(&tensor, share, place, ctx);
+      EXPECT_THROW(reader.Next(&loaded[0], share, place, ctx),
+                   platform::EnforceNotMet);
+    }
+    // the tensors keep the file mapped after the reader is released
+    EXPECT_EQ(loaded[0].dims(), make_ddim({3, 5}));
+    EXPECT_EQ(loaded[0].lod(), tensors[0].lod());
+    for (int i = 0; i < 15; ++i) EXPECT_EQ(loaded[0].data<float>()[i], x[i]);
+    EXPECT_EQ(loaded[1].dims(), make_ddim({7}));
+    for (int i = 0; i < 7; ++i) EXPECT_EQ(loaded[1].data<int64_t>()[i], y[i]);
+    EXPECT_EQ(loaded[2].dims(), make_ddim({0, 4}));
+    EXPECT_EQ(loaded[2].type(), typeid(int8_t));
+    if (share) {
+      for (auto& tensor : loaded) {
+        auto addr = reinterpret_cast<uintptr_t>(tensor.data<void>());
+        EXPECT_EQ(addr % kMappedTensorAlignment, 0UL);
+      }
+      // the pages are copied on write, the file is not changed
+      loaded[0].data<float>()[0] = 100.f;
+    }
+  }
+}
+
+TEST(MappedTensorFile, NotMapped) {
+  {
+    std::ofstream fout(kFile, std::ios::binary);
+    fout << "not a file of mapped tensors";
+  }
+  EXPECT_FALSE(IsMappedTensorFile(kFile));
+  EXPECT_THROW(MappedTensorReader reader(kFile), platform::EnforceNotMet);
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -492,6 +492,36 @@ class RuntimeInferShapeContext : public InferShapeContext {
   const Scope& scope_;
 };
 
+static OpKernelBase* FindKernel(const std::string& op_type,
+                                const OpKernelType& kernel_type) {
+  // check if op[type] has kernel registered.
+  auto& all_op_kernels = OperatorWithKernel::AllOpKernels();
+  auto kernels_iter = all_op_kernels.find(op_type);
+  if (kernels_iter == all_op_kernels.end()) {
+    PADDLE_THROW(
+        "There are no kernels which are registered in the %s operator.",
+        op_type);
+  }
+  auto& kernels = kernels_iter->second;
+  auto kernel_iter = kernels.find(kernel_type);
+  if (kernel_iter == kernels.end()) {
+    PADDLE_THROW("op %s does not have kernel for %s", op_type,
+                 KernelTypeToString(kernel_type));
+  }
+  return kernel_iter->second.get();
+}
+
+OpKernelType OperatorWithKernel::ExpectedKernelType(
+    const Scope& scope, const platform::Place& place) const {
+  auto* dev_ctx = platform::DeviceContextPool::Instance().Get(place);
+  return this->GetExpectedKernelType(ExecutionContext(*this, scope, *dev_ctx));
+}
+
+void OperatorWithKernel::PinKernel(const OpKernelType& kernel_type) {
+  pinned_kernel_ = FindKernel(type_, kernel_type);
+  pinned_kernel_type_ = std::make_shared<OpKernelType>(kernel_type);
+}
+
 void OperatorWithKernel::RunImpl(const Scope& scope,
                                  const platform::Place& place) const {
   RuntimeInferShapeContext infer_shape_ctx(*this, scope);
@@ -502,18 +532,14 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
   // For profiling, don't move out of this function because that will result
   // in the failure of multi-GPU profiling.
   platform::RecordEvent record_event(Type(), dev_ctx);
-  // check if op[type] has kernel registered.
-  auto& all_op_kernels = AllOpKernels();
-  auto kernels_iter = all_op_kernels.find(type_);
-  if (kernels_iter == all_op_kernels.end()) {
-    PADDLE_THROW(
-        "There are no kernels which are registered in the %s operator.", type_);
+
+  if (pinned_kernel_ != nullptr) {
+    RunKernel(scope, *pinned_kernel_type_, pinned_kernel_);
+    return;
   }
 
   ExecutionContext ctx(*this, scope, *dev_ctx);
 
-  OpKernelMap& kernels = kernels_iter->second;
-
   // TODO(dzhwinter) : kernel fallback mechanism will be added when all the
   // transform functions are ready.
 
@@ -524,15 +550,16 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
   auto expected_kernel_key = this->GetExpectedKernelType(ctx);
   VLOG(3) << "expected_kernel_key:" << expected_kernel_key;
 
-  auto kernel_iter = kernels.find(expected_kernel_key);
-  if (kernel_iter == kernels.end()) {
-    PADDLE_THROW("op %s does not have kernel for %s", type_,
-                 KernelTypeToString(expected_kernel_key));
-  }
+  RunKernel(scope, expected_kernel_key, FindKernel(type_, expected_kernel_key));
+}
+
+void OperatorWithKernel::RunKernel(const Scope& scope,
+                                   const OpKernelType& expected_kernel_key,
+                                   OpKernelBase* kernel) const {
+  platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
 
   // do data transform
   Scope& new_scope = scope.NewScope();
-
   std::vector<std::string> inplace_vars;
   for (auto& var_name_item : this->Inputs()) {
     for (auto& var_name : var_name_item.second) {
@@ -562,8 +589,7 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
   }
 
   auto* new_dev_ctx = pool.Get(expected_kernel_key.place_);
-  kernel_iter->second->Compute(
-      ExecutionContext(*this, new_scope, *new_dev_ctx));
+  kernel->Compute(ExecutionContext(*this, new_scope, *new_dev_ctx));
 
   for (auto& var_name : inplace_vars) {
     VLOG(3) << "share inplace var " + var_name + " back to it's original scope";
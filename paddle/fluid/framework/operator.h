@@ -16,6 +16,7 @@ limitations under the License. */
 
 #include <algorithm>
 #include <atomic>
+#include <memory>
 #include <string>
 #include <tuple>
 #include <unordered_map>
@@ -389,6 +390,14 @@ class OperatorWithKernel : public OperatorBase {
     OpInfoMap::Instance().Get(Type()).infer_shape_(ctx);
   }
 
+  // The kernel type GetExpectedKernelType chooses to run in scope on place.
+  OpKernelType ExpectedKernelType(const Scope& scope,
+                                  const platform::Place& place) const;
+
+  // Run the kernel of kernel_type in the later runs without choosing it,
+  // e.g. the kernel chosen when the program was compiled ahead of time.
+  void PinKernel(const OpKernelType& kernel_type);
+
  protected:
   virtual OpKernelType GetExpectedKernelType(const ExecutionContext& ctx) const;
   virtual OpKernelType GetKernelTypeForVar(
@@ -400,6 +409,13 @@ class OperatorWithKernel : public OperatorBase {
   // same.
   proto::VarType::Type IndicateDataType(const ExecutionContext& ctx) const;
   void RunImpl(const Scope& scope, const platform::Place& place) const final;
+  // Transform the inputs for expected_kernel_key and run kernel.
+  void RunKernel(const Scope& scope, const OpKernelType& expected_kernel_key,
+                 OpKernelBase* kernel) const;
+
+  // the pinned kernel type and its kernel, or nullptr, shared by the clones
+  std::shared_ptr<const OpKernelType> pinned_kernel_type_;
+  OpKernelBase* pinned_kernel_ = nullptr;
 };
 
 extern bool OpSupportGPU(const std::string& op_type);
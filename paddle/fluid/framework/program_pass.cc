@@ -0,0 +1,122 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/program_pass.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace paddle {
+namespace framework {
+
+int ApplyProgramPasses(
+    const std::vector<std::unique_ptr<ProgramPass>>& passes, Scope* scope,
+    ProgramDesc* program) {
+  int total = 0;
+  for (auto& pass : passes) {
+    int count = pass->Apply(scope, program);
+    VLOG(3) << "Pass " << pass->Type() << " rewrote " << count << " times";
+    total += count;
+  }
+  return total;
+}
+
+bool IsFloatVar(const BlockDesc& block, const std::string& name) {
+  auto* var = block.FindVar(name);
+  return var != nullptr && var->GetDataType() == proto::VarType::FP32;
+}
+
+bool IsParameter(const BlockDesc& block, const std::string& name) {
+  return IsFloatVar(block, name) && block.FindVar(name)->Persistable();
+}
+
+LoDTensor* GetParameter(Scope* scope, const std::string& name) {
+  auto* var = scope->FindVar(name);
+  PADDLE_ENFORCE_NOT_NULL(var, "The parameter %s is not loaded", name);
+  auto* tensor = var->GetMutable<LoDTensor>();
+  PADDLE_ENFORCE(tensor->IsInitialized(), "The parameter %s is not loaded",
+                 name);
+  return tensor;
+}
+
+void RemoveOps(BlockDesc* block, std::vector<size_t> indices) {
+  std::sort(indices.begin(), indices.end(), std::greater<size_t>());
+  for (size_t idx : indices) {
+    block->RemoveOp(idx, idx + 1);
+  }
+}
+
+void RemoveVars(BlockDesc* block, const std::vector<std::string>& names) {
+  for (auto& name : names) {
+    block->RemoveVar(name);
+  }
+}
+
+VarDesc* CreateVar(BlockDesc* block, const std::string& name,
+                   proto::VarType::Type dtype,
+                   const std::vector<int64_t>& shape, bool persistable) {
+  auto* var = block->Var(name);
+  var->SetType(proto::VarType::LOD_TENSOR);
+  var->SetDataType(dtype);
+  var->SetShape(shape);
+  var->SetPersistable(persistable);
+  return var;
+}
+
+OpGraph::OpGraph(const BlockDesc& block)
+    : block_(block), ops_(block.AllOps()) {
+  for (size_t i = 0; i < ops_.size(); ++i) {
+    for (auto& name : ops_[i]->InputArgumentNames()) {
+      auto& consumers = consumers_[name];
+      // An op may read a variable by several parameters.
+      if (consumers.empty() || consumers.back() != i) {
+        consumers.push_back(i);
+      }
+    }
+  }
+}
+
+const std::vector<size_t>& OpGraph::Consumers(const std::string& var) const {
+  static const std::vector<size_t> kNoConsumers;
+  auto it = consumers_.find(var);
+  return it == consumers_.end() ? kNoConsumers : it->second;
+}
+
+int OpGraph::SoleConsumer(const std::string& var) const {
+  auto* var_desc = block_.FindVarRecursive(var);
+  if (var_desc == nullptr || var_desc->Persistable()) return -1;
+  auto& consumers = Consumers(var);
+  return consumers.size() == 1 ? static_cast<int>(consumers[0]) : -1;
+}
+
+int OpGraph::NextInChain(size_t idx, const std::string& param,
+                         const std::string& type,
+                         const std::string& in_param) const {
+  auto& outputs = ops_.at(idx)->Outputs();
+  auto output = outputs.find(param);
+  if (output == outputs.end() || output->second.size() != 1) return -1;
+  auto& var = output->second[0];
+  int next = SoleConsumer(var);
+  if (next < 0 || ops_[next]->Type() != type) return -1;
+  auto& inputs = ops_[next]->Inputs();
+  auto input = inputs.find(in_param);
+  if (input == inputs.end() || input->second.size() != 1 ||
+      input->second[0] != var) {
+    return -1;
+  }
+  return next;
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,99 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/block_desc.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/scope.h"
+
+namespace paddle {
+namespace framework {
+
+// A pass which rewrites the ops of a program, e.g. fuses several ops into
+// one or folds them into the parameters.
+class ProgramPass {
+ public:
+  virtual ~ProgramPass() {}
+
+  virtual std::string Type() const = 0;
+
+  // Rewrite the program and return the number of the rewrites. scope holds
+  // the persistable variables of the program, the passes which fold the
+  // parameters update them in scope.
+  virtual int Apply(Scope* scope, ProgramDesc* program) const = 0;
+};
+
+// Apply the passes in order, return the total number of the rewrites.
+int ApplyProgramPasses(
+    const std::vector<std::unique_ptr<ProgramPass>>& passes, Scope* scope,
+    ProgramDesc* program);
+
+// The helpers shared by the passes.
+
+// Whether name is a float variable of block.
+bool IsFloatVar(const BlockDesc& block, const std::string& name);
+
+// Whether name is a persistable float variable of block, i.e. a parameter
+// which the passes may fold or quantize.
+bool IsParameter(const BlockDesc& block, const std::string& name);
+
+// The tensor of the parameter name in scope, which must be loaded.
+LoDTensor* GetParameter(Scope* scope, const std::string& name);
+
+// Remove the ops of the indices from block.
+void RemoveOps(BlockDesc* block, std::vector<size_t> indices);
+
+void RemoveVars(BlockDesc* block, const std::vector<std::string>& names);
+
+// Create the LoDTensor variable name in block.
+VarDesc* CreateVar(BlockDesc* block, const std::string& name,
+                   proto::VarType::Type dtype,
+                   const std::vector<int64_t>& shape, bool persistable);
+
+// The readers of the variables of a block, for the passes which match the
+// patterns of the ops. The graph is not updated when the block is changed,
+// it should be built again after a rewrite.
+class OpGraph {
+ public:
+  explicit OpGraph(const BlockDesc& block);
+
+  // The indices of the ops which read var.
+  const std::vector<size_t>& Consumers(const std::string& var) const;
+
+  // The index of the only op which reads var, or -1 if var is read by
+  // several ops or none, or it is persistable. The output of an op can be
+  // fused away only if it has a sole consumer.
+  int SoleConsumer(const std::string& var) const;
+
+  // The index of the sole consumer of the output param of op idx if its
+  // type is type, and it reads the output as its input in_param; -1 if the
+  // ops do not match.
+  int NextInChain(size_t idx, const std::string& param, const std::string& type,
+                  const std::string& in_param) const;
+
+ private:
+  const BlockDesc& block_;
+  std::vector<OpDesc*> ops_;
+  std::unordered_map<std::string, std::vector<size_t>> consumers_;
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,129 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/program_pass.h"
+
+#include <gtest/gtest.h>
+#include <string>
+
+namespace f = paddle::framework;
+
+void AddOp(const std::string &type, const f::VariableNameMap &inputs,
+           const f::VariableNameMap &outputs, f::BlockDesc *block) {
+  for (auto &kv : outputs) {
+    for (auto &v : kv.second) {
+      block->Var(v)->SetDataType(f::proto::VarType::FP32);
+    }
+  }
+  auto op = block->AppendOp();
+  op->SetType(type);
+  for (auto &kv : inputs) {
+    op->SetInput(kv.first, kv.second);
+  }
+  for (auto &kv : outputs) {
+    op->SetOutput(kv.first, kv.second);
+  }
+}
+
+// Removes the ops of a chain of relu, for the test of the pass framework.
+class RemoveReluChainPass : public f::ProgramPass {
+ public:
+  std::string Type() const override { return "remove_relu_chain"; }
+
+  int Apply(f::Scope *scope, f::ProgramDesc *program) const override {
+    auto *block = program->MutableBlock(0);
+    int count = 0;
+    for (size_t i = 0; i < block->OpSize(); ++i) {
+      if (block->Op(i)->Type() != "relu") continue;
+      f::OpGraph graph(*block);
+      int next = graph.NextInChain(i, "Out", "relu", "X");
+      if (next < 0) continue;
+      block->Op(next)->SetInput("X", block->Op(i)->Input("X"));
+      block->RemoveOp(i, i + 1);
+      --i;
+      ++count;
+    }
+    return count;
+  }
+};
+
+TEST(OpGraph, consumers) {
+  f::ProgramDesc program;
+  f::BlockDesc *block = program.MutableBlock(0);
+  block->Var("w")->SetPersistable(true);
+  AddOp("mul", {{"X", {"x"}}, {"Y", {"w"}}}, {{"Out", {"a"}}}, block);
+  AddOp("relu", {{"X", {"a"}}}, {{"Out", {"b"}}}, block);
+  AddOp("elementwise_add", {{"X", {"b"}}, {"Y", {"b"}}}, {{"Out", {"c"}}},
+        block);
+  AddOp("mul", {{"X", {"c"}}, {"Y", {"w"}}}, {{"Out", {"d"}}}, block);
+
+  f::OpGraph graph(*block);
+  EXPECT_EQ(graph.Consumers("w").size(), 2UL);
+  // w is persistable, and b is read twice by a single op.
+  EXPECT_EQ(graph.SoleConsumer("w"), -1);
+  EXPECT_EQ(graph.SoleConsumer("b"), 2);
+  EXPECT_EQ(graph.SoleConsumer("d"), -1);
+
+  EXPECT_EQ(graph.NextInChain(0, "Out", "relu", "X"), 1);
+  EXPECT_EQ(graph.NextInChain(0, "Out", "sigmoid", "X"), -1);
+  EXPECT_EQ(graph.NextInChain(1, "Out", "elementwise_add", "X"), 2);
+  EXPECT_EQ(graph.NextInChain(2, "Out", "mul", "Y"), -1);
+}
+
+TEST(ProgramPass, apply) {
+  f::ProgramDesc program;
+  f::BlockDesc *block = program.MutableBlock(0);
+  AddOp("relu", {{"X", {"x"}}}, {{"Out", {"a"}}}, block);
+  AddOp("relu", {{"X", {"a"}}}, {{"Out", {"b"}}}, block);
+  AddOp("relu", {{"X", {"b"}}}, {{"Out", {"c"}}}, block);
+
+  std::vector<std::unique_ptr<f::ProgramPass>> passes;
+  passes.emplace_back(new RemoveReluChainPass());
+  f::Scope scope;
+  EXPECT_EQ(f::ApplyProgramPasses(passes, &scope, &program), 2);
+  ASSERT_EQ(block->OpSize(), 1UL);
+  EXPECT_EQ(block->Op(0)->Input("X")[0], "x");
+  EXPECT_EQ(block->Op(0)->Output("Out")[0], "c");
+  EXPECT_EQ(program.Proto()->blocks(0).ops_size(), 1);
+}
+
+TEST(ProgramPass, helpers) {
+  f::ProgramDesc program;
+  f::BlockDesc *block = program.MutableBlock(0);
+  f::CreateVar(block, "w", f::proto::VarType::FP32, {3, 4}, true);
+  f::CreateVar(block, "w.int8", f::proto::VarType::INT8, {3, 4}, true);
+  AddOp("mul", {{"X", {"x"}}, {"Y", {"w"}}}, {{"Out", {"a"}}}, block);
+  AddOp("relu", {{"X", {"a"}}}, {{"Out", {"b"}}}, block);
+  AddOp("relu", {{"X", {"b"}}}, {{"Out", {"c"}}}, block);
+
+  EXPECT_TRUE(f::IsParameter(*block, "w"));
+  EXPECT_FALSE(f::IsParameter(*block, "w.int8"));
+  EXPECT_FALSE(f::IsParameter(*block, "a"));
+  EXPECT_TRUE(f::IsFloatVar(*block, "a"));
+  EXPECT_FALSE(f::IsFloatVar(*block, "x"));
+  EXPECT_EQ(block->FindVar("w")->GetShape(), std::vector<int64_t>({3, 4}));
+
+  f::Scope scope;
+  EXPECT_THROW(f::GetParameter(&scope, "w"), paddle::platform::EnforceNotMet);
+  scope.Var("w")->GetMutable<f::LoDTensor>()->mutable_data<float>(
+      f::make_ddim({3, 4}), paddle::platform::CPUPlace());
+  EXPECT_EQ(f::GetParameter(&scope, "w")->numel(), 12);
+
+  f::RemoveOps(block, {2, 0});
+  ASSERT_EQ(block->OpSize(), 1UL);
+  EXPECT_EQ(block->Op(0)->Output("Out")[0], "b");
+  f::RemoveVars(block, {"c", "w.int8"});
+  EXPECT_EQ(block->FindVar("c"), nullptr);
+  EXPECT_EQ(block->FindVar("w.int8"), nullptr);
+}
@@ -18,10 +18,12 @@ limitations under the License. */
 #include <cstring>
 #include <memory>
 #include <typeindex>
+#include <utility>
 #include <vector>
 
 #include "paddle/fluid/framework/data_layout.h"
 #include "paddle/fluid/framework/ddim.h"
+#include "paddle/fluid/framework/tensor_arena.h"
 #include "paddle/fluid/memory/memory.h"
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/enforce.h"
@@ -98,6 +100,18 @@ class Tensor {
   /*! The internal of two tensors share the same memory block. */
   inline Tensor& ShareDataWith(const Tensor& src);
 
+  /**
+   * @brief     Alias a CPU memory block the tensor does not own, such as
+   *            the pages of a mapped file.
+   *
+   * @param[in] ptr         The memory block of at least numel() elements.
+   * @param[in] size        The size of the memory block in byte.
+   * @param[in] type        The type of the elements.
+   * @param[in] keep_alive  Released when no tensor holds the block.
+   */
+  inline void ShareExternalData(void* ptr, size_t size, std::type_index type,
+                                std::shared_ptr<void> keep_alive);
+
   /**
    * @brief  Return a sub-tensor of the given tensor.
    *
@@ -176,6 +190,31 @@ class Tensor {
     std::type_index type_;
   };
 
+  /*! A CPU memory block which is not allocated by the tensor. */
+  struct ExternalPlaceholder : public Placeholder {
+    ExternalPlaceholder(void* ptr, size_t size, std::type_index type,
+                        std::shared_ptr<void> keep_alive)
+        : ptr_(ptr),
+          size_(size),
+          type_(type),
+          keep_alive_(std::move(keep_alive)) {}
+
+    virtual size_t size() const { return size_; }
+    virtual platform::Place place() const { return platform::CPUPlace(); }
+    virtual void* ptr() const { return ptr_; }
+    virtual std::type_index type() const { return type_; }
+    virtual void set_type(std::type_index type) { type_ = type; }
+    virtual void set_place(platform::Place place) {
+      PADDLE_ENFORCE(platform::is_cpu_place(place),
+                     "External memory is only supported on CPU");
+    }
+
+    void* ptr_;
+    size_t size_;
+    std::type_index type_;
+    std::shared_ptr<void> keep_alive_;
+  };
+
   /*! holds the memory block if allocated. */
   std::shared_ptr<Placeholder> holder_;
 
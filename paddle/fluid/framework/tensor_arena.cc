@@ -0,0 +1,31 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/tensor_arena.h"
+
+namespace paddle {
+namespace framework {
+
+static thread_local TensorArena* g_tensor_arena = nullptr;
+
+TensorArena* TensorArena::Current() { return g_tensor_arena; }
+
+TensorArena::Guard::Guard(TensorArena* arena) : previous_(g_tensor_arena) {
+  g_tensor_arena = arena;
+}
+
+TensorArena::Guard::~Guard() { g_tensor_arena = previous_; }
+
+}  // namespace framework
+}  // namespace paddle
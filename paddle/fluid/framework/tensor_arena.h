@@ -0,0 +1,52 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include "paddle/fluid/platform/macros.h"
+
+namespace paddle {
+namespace framework {
+
+// TensorArena serves the CPU memory of Tensor::mutable_data in place of
+// memory::Alloc on the threads it is installed on, e.g. to reuse the
+// memory of the temporaries of an inference program across runs.
+class TensorArena {
+ public:
+  virtual ~TensorArena() {}
+
+  // Return a block of size bytes, and set keep_alive to a handle which
+  // keeps the block valid until the tensors release it. Return nullptr to
+  // allocate the block from memory::Alloc.
+  virtual void* Allocate(size_t size, std::shared_ptr<void>* keep_alive) = 0;
+
+  // The arena of the current thread, nullptr if there is none.
+  static TensorArena* Current();
+
+  // Install an arena on the current thread in a scope.
+  class Guard {
+   public:
+    explicit Guard(TensorArena* arena);
+    ~Guard();
+
+   private:
+    TensorArena* previous_;
+
+    DISABLE_COPY_AND_ASSIGN(Guard);
+  };
+};
+
+}  // namespace framework
+}  // namespace paddle
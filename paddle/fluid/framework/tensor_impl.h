@@ -15,6 +15,7 @@ limitations under the License. */
 #pragma once
 #include "paddle/fluid/memory/memcpy.h"
 #include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/bfloat16.h"
 #include "paddle/fluid/platform/float16.h"
 
 namespace paddle {
@@ -54,7 +55,7 @@ struct SizeOfTypeFunctor<HEAD, TAIL...> {
 
 static inline size_t SizeOfType(std::type_index type) {
   SizeOfTypeFunctor<int, float, double, int16_t, int64_t, bool, size_t,
-                    platform::float16>
+                    platform::float16, int8_t, uint8_t, platform::bfloat16>
       functor;
   size_t size = functor(type);
   PADDLE_ENFORCE(size != 0UL, "Cannot get size of type %s", type.name());
@@ -126,8 +127,17 @@ inline void* Tensor::mutable_data(platform::Place place, std::type_index type) {
   if (holder_ == nullptr || !(holder_->place() == place) ||
       holder_->size() < size + offset_) {
     if (platform::is_cpu_place(place)) {
-      holder_.reset(new PlaceholderImpl<platform::CPUPlace>(
-          boost::get<platform::CPUPlace>(place), size, type));
+      auto* arena = TensorArena::Current();
+      std::shared_ptr<void> keep_alive;
+      void* ptr = arena == nullptr ? nullptr
+                                   : arena->Allocate(size, &keep_alive);
+      if (ptr != nullptr) {
+        holder_.reset(
+            new ExternalPlaceholder(ptr, size, type, std::move(keep_alive)));
+      } else {
+        holder_.reset(new PlaceholderImpl<platform::CPUPlace>(
+            boost::get<platform::CPUPlace>(place), size, type));
+      }
     } else if (platform::is_gpu_place(place) ||
                platform::is_cuda_pinned_place(place)) {
 #ifndef PADDLE_WITH_CUDA
@@ -162,6 +172,17 @@ inline Tensor& Tensor::ShareDataWith(const Tensor& src) {
   return *this;
 }
 
+inline void Tensor::ShareExternalData(void* ptr, size_t size,
+                                      std::type_index type,
+                                      std::shared_ptr<void> keep_alive) {
+  PADDLE_ENFORCE_NOT_NULL(ptr, "The external memory block is null.");
+  PADDLE_ENFORCE_LE(numel() * SizeOfType(type), size,
+                    "The external memory block is smaller than the tensor.");
+  holder_.reset(
+      new ExternalPlaceholder(ptr, size, type, std::move(keep_alive)));
+  offset_ = 0;
+}
+
 inline Tensor Tensor::Slice(int begin_idx, int end_idx) const {
   check_memory_size();
   PADDLE_ENFORCE_GE(begin_idx, 0,
@@ -14,9 +14,13 @@ limitations under the License. */
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
+#include <exception>
 #include <functional>
 #include <future>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <thread>
@@ -143,5 +147,66 @@ std::future<void> Async(Callback callback) {
   return ThreadPool::GetInstance()->Run(callback);
 }
 
+// Call func(begin, end) on the ranges of [0, n) of grain elements on the
+// threads of the pool. The calling thread works on the ranges too and only
+// waits for the ranges being run by the other threads, so it does not
+// deadlock when called from a task of the same pool. If func throws, the
+// ranges not started yet are skipped, and the first exception is rethrown
+// on the calling thread once no other thread is running func.
+template <typename Func>
+void ParallelFor(int64_t n, int64_t grain, Func func) {
+  grain = std::max<int64_t>(1, grain);
+  int64_t num_chunks = (n + grain - 1) / grain;
+  if (num_chunks <= 1) {
+    if (n > 0) func(0, n);
+    return;
+  }
+
+  struct State {
+    std::atomic<int64_t> next{0};
+    // the chunks which are finished, failed or skipped.
+    int64_t done = 0;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable cv;
+  };
+  auto state = std::make_shared<State>();
+  // run the chunks until all of them are taken, the tasks which start
+  // after that return without touching func.
+  auto run = [state, num_chunks, grain, n, &func]() {
+    int64_t chunk;
+    while ((chunk = state->next.fetch_add(1)) < num_chunks) {
+      std::exception_ptr error;
+      try {
+        func(chunk * grain, std::min(n, (chunk + 1) * grain));
+      } catch (...) {
+        error = std::current_exception();
+      }
+      std::lock_guard<std::mutex> lock(state->mutex);
+      int64_t finished = 1;
+      if (error != nullptr) {
+        if (state->error == nullptr) state->error = error;
+        // no chunk is taken any more, the ones left are skipped.
+        int64_t taken = state->next.exchange(num_chunks);
+        finished += std::max<int64_t>(0, num_chunks - taken);
+      }
+      state->done += finished;
+      if (state->done == num_chunks) state->cv.notify_all();
+    }
+  };
+
+  auto* pool = ThreadPool::GetInstance();
+  int64_t num_tasks =
+      std::min<int64_t>(num_chunks - 1, static_cast<int64_t>(pool->Threads()));
+  for (int64_t t = 0; t < num_tasks; ++t) {
+    // run never throws, the errors of func are kept in state.
+    pool->RunAndGetException(run);
+  }
+  run();
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->cv.wait(lock, [&] { return state->done == num_chunks; });
+  if (state->error != nullptr) std::rethrow_exception(state->error);
+}
+
 }  // namespace framework
 }  // namespace paddle
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include <gtest/gtest.h>
 #include <atomic>
+#include <chrono>
 
 #include "threadpool.h"
 
@@ -55,3 +56,42 @@ TEST(ThreadPool, ConcurrentRun) {
   pool->Wait();
   EXPECT_EQ(sum, ((n + 1) * n) / 2);
 }
+
+TEST(ThreadPool, ParallelFor) {
+  const int64_t n = 1000;
+  std::vector<int> hits(n, 0);
+  framework::ParallelFor(n, 7, [&hits](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) ++hits[i];
+  });
+  for (int64_t i = 0; i < n; ++i) {
+    EXPECT_EQ(hits[i], 1);
+  }
+
+  // nested calls from the tasks of the pool do not deadlock
+  std::atomic<int64_t> sum(0);
+  framework::ParallelFor(16, 1, [&sum](int64_t begin, int64_t end) {
+    framework::ParallelFor(100, 10, [&sum](int64_t b, int64_t e) {
+      sum.fetch_add(e - b);
+    });
+  });
+  EXPECT_EQ(sum, 1600);
+}
+
+TEST(ThreadPool, ParallelForException) {
+  // the chunks fail on the pool threads and on the calling thread, the
+  // first error is rethrown once no thread is running the function.
+  std::atomic<int> running(0);
+  for (int64_t failing : {0, 5, 99}) {
+    EXPECT_THROW(
+        framework::ParallelFor(100, 1,
+                               [&running, failing](int64_t begin, int64_t) {
+                                 running.fetch_add(1);
+                                 std::this_thread::sleep_for(
+                                     std::chrono::milliseconds(1));
+                                 running.fetch_sub(1);
+                                 PADDLE_ENFORCE_NE(begin, failing);
+                               }),
+        paddle::platform::EnforceNotMet);
+    EXPECT_EQ(running, 0);
+  }
+}
@@ -0,0 +1,235 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/batcher.h"
+
+#include <chrono>  // NOLINT
+#include <exception>
+#include <utility>
+
+namespace paddle {
+namespace inference {
+
+int64_t BatcherHistogram::Total() const {
+  int64_t total = 0;
+  for (auto count : counts_) total += count;
+  return total;
+}
+
+size_t BatcherHistogram::Percentile(double ratio) const {
+  int64_t total = Total();
+  int64_t seen = 0;
+  for (size_t i = 0; i < counts_.size(); ++i) {
+    seen += counts_[i];
+    if (seen > 0 && seen >= ratio * total) return i;
+  }
+  return counts_.size() - 1;
+}
+
+struct Batcher::Request {
+  const std::vector<framework::LoDTensor>* feeds;
+  std::vector<framework::LoDTensor>* fetchs;
+  size_t instances;
+  std::chrono::steady_clock::time_point arrival;
+  // guarded by the mutex of the batcher
+  bool done = false;
+  std::exception_ptr error;
+  std::condition_variable done_cv;
+};
+
+// The number of the instances of a feed or a fetch.
+static size_t NumInstances(const framework::LoDTensor& tensor) {
+  if (!tensor.lod().empty()) return tensor.lod()[0].size() - 1;
+  PADDLE_ENFORCE_GT(tensor.dims().size(), 0,
+                    "A scalar can not be batched, reshape it to [1]");
+  return static_cast<size_t>(tensor.dims()[0]);
+}
+
+// Share the instances [begin, end) of batched with out.
+static void SliceInstances(const framework::LoDTensor& batched, size_t begin,
+                           size_t end, framework::LoDTensor* out) {
+  if (batched.lod().empty()) {
+    out->ShareDataWith(batched.Slice(begin, end));
+    out->set_lod(framework::LoD());
+    return;
+  }
+  auto lod_and_offset =
+      framework::GetSubLoDAndAbsoluteOffset(batched.lod(), begin, end, 0);
+  auto& offset = lod_and_offset.second;
+  out->ShareDataWith(batched.Slice(offset.first, offset.second));
+  // the sub LoD is of the lengths, convert it back to the offsets
+  framework::LoD lod;
+  for (auto& lengths : lod_and_offset.first) {
+    framework::Vector<size_t> level{0};
+    for (auto length : lengths) level.push_back(level.back() + length);
+    lod.emplace_back(level);
+  }
+  out->set_lod(lod);
+}
+
+Batcher::Batcher(const Predictor& predictor, const BatcherConfig& config)
+    : config_(config),
+      num_feeds_(predictor.FeedNames().size()),
+      queued_instances_(0),
+      stop_(false) {
+  PADDLE_ENFORCE_GT(config_.max_batch_size, 0,
+                    "max_batch_size should be positive");
+  PADDLE_ENFORCE_GE(config_.max_delay_us, 0,
+                    "max_delay_us should not be negative");
+  PADDLE_ENFORCE_GT(config_.num_workers, 0, "num_workers should be positive");
+  size_t max_batch_size = static_cast<size_t>(config_.max_batch_size);
+  stats_.queue_depth = BatcherHistogram(4 * max_batch_size + 1);
+  stats_.batch_size = BatcherHistogram(max_batch_size + 2);
+  for (int i = 0; i < config_.num_workers; ++i) {
+    predictors_.emplace_back(predictor.Clone());
+  }
+  for (auto& worker_predictor : predictors_) {
+    workers_.emplace_back(&Batcher::WorkerLoop, this, worker_predictor.get());
+  }
+}
+
+Batcher::~Batcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  queue_cv_.notify_all();
+  for (auto& worker : workers_) worker.join();
+}
+
+void Batcher::Run(const std::vector<framework::LoDTensor>& feeds,
+                  std::vector<framework::LoDTensor>* fetchs) {
+  PADDLE_ENFORCE_EQ(feeds.size(), num_feeds_,
+                    "The number of feeds should match the feed targets");
+  Request request;
+  request.feeds = &feeds;
+  request.fetchs = fetchs;
+  request.instances = NumInstances(feeds[0]);
+  PADDLE_ENFORCE_GT(request.instances, 0UL, "The request is empty");
+  for (size_t i = 1; i < feeds.size(); ++i) {
+    PADDLE_ENFORCE_EQ(NumInstances(feeds[i]), request.instances,
+                      "The feeds of a request should have the same number "
+                      "of instances to be batched");
+  }
+  request.arrival = std::chrono::steady_clock::now();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  PADDLE_ENFORCE(!stop_, "The batcher is stopped");
+  stats_.queue_depth.Add(queue_.size());
+  ++stats_.num_requests;
+  queue_.push_back(&request);
+  queued_instances_ += request.instances;
+  // wake the workers waiting for the first request, or for a full batch
+  queue_cv_.notify_all();
+  request.done_cv.wait(lock, [&request] { return request.done; });
+  lock.unlock();
+  if (request.error) std::rethrow_exception(request.error);
+}
+
+BatcherStats Batcher::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void Batcher::WorkerLoop(Predictor* predictor) {
+  size_t max_batch_size = static_cast<size_t>(config_.max_batch_size);
+  std::vector<Request*> batch;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    queue_cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+    if (queue_.empty()) return;  // stopped and drained
+
+    // wait for the batch to fill, or for the first request to time out
+    auto deadline = queue_.front()->arrival +
+                    std::chrono::microseconds(config_.max_delay_us);
+    while (!stop_ && !queue_.empty() &&
+           queued_instances_ < max_batch_size &&
+           std::chrono::steady_clock::now() < deadline) {
+      queue_cv_.wait_until(lock, deadline);
+    }
+    // another worker may have taken the requests
+    if (queue_.empty()) continue;
+
+    batch.clear();
+    size_t instances = 0;
+    do {
+      instances += queue_.front()->instances;
+      batch.push_back(queue_.front());
+      queue_.pop_front();
+    } while (!queue_.empty() &&
+             instances + queue_.front()->instances <= max_batch_size);
+    queued_instances_ -= instances;
+    stats_.batch_size.Add(instances);
+    ++stats_.num_batches;
+
+    lock.unlock();
+    RunBatch(predictor, batch);
+    lock.lock();
+    for (auto* request : batch) {
+      request->done = true;
+      request->done_cv.notify_one();
+    }
+  }
+}
+
+void Batcher::RunBatch(Predictor* predictor,
+                       const std::vector<Request*>& batch) {
+  std::exception_ptr error;
+  try {
+    if (batch.size() == 1) {
+      // nothing to concatenate or to split
+      predictor->Run(*batch[0]->feeds, batch[0]->fetchs);
+      return;
+    }
+
+    std::vector<framework::LoDTensor> feeds(num_feeds_);
+    std::vector<const framework::LoDTensor*> parts(batch.size());
+    for (size_t i = 0; i < num_feeds_; ++i) {
+      size_t lod_levels = (*batch[0]->feeds)[i].lod().size();
+      for (size_t j = 0; j < batch.size(); ++j) {
+        parts[j] = &(*batch[j]->feeds)[i];
+        PADDLE_ENFORCE_EQ(parts[j]->lod().size(), lod_levels,
+                          "The feeds batched should have the same LoD levels");
+      }
+      feeds[i].MergeLoDTensor(parts, platform::CPUPlace());
+    }
+
+    std::vector<framework::LoDTensor> fetchs;
+    predictor->Run(feeds, &fetchs);
+
+    size_t total = 0;
+    for (auto* request : batch) total += request->instances;
+    for (auto* request : batch) request->fetchs->resize(fetchs.size());
+    for (size_t i = 0; i < fetchs.size(); ++i) {
+      PADDLE_ENFORCE_EQ(NumInstances(fetchs[i]), total,
+                        "The fetch %s can not be split by the instances of "
+                        "the requests",
+                        predictor->FetchNames()[i]);
+      size_t begin = 0;
+      for (auto* request : batch) {
+        size_t end = begin + request->instances;
+        SliceInstances(fetchs[i], begin, end, &(*request->fetchs)[i]);
+        begin = end;
+      }
+    }
+  } catch (...) {
+    error = std::current_exception();
+  }
+  if (error) {
+    for (auto* request : batch) request->error = error;
+  }
+}
+
+}  // namespace inference
+}  // namespace paddle
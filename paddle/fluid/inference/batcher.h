@@ -0,0 +1,126 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/inference/predictor.h"
+#include "paddle/fluid/platform/macros.h"
+
+namespace paddle {
+namespace inference {
+
+struct BatcherConfig {
+  // The maximum number of instances of a batch. An instance is a row of a
+  // feed without LoD, or a sequence of the first LoD level. A request
+  // larger than this runs alone.
+  int max_batch_size = 32;
+  // How long the first request of a batch waits for the others.
+  int64_t max_delay_us = 1000;
+  // The number of the threads running the batches, each with its own
+  // clone of the predictor.
+  int num_workers = 1;
+};
+
+// The counts of values in [0, size - 1), the last bucket counts the larger
+// values.
+class BatcherHistogram {
+ public:
+  explicit BatcherHistogram(size_t size) : counts_(size, 0) {}
+
+  void Add(size_t value) {
+    ++counts_[std::min(value, counts_.size() - 1)];
+  }
+
+  const std::vector<int64_t>& counts() const { return counts_; }
+  int64_t Total() const;
+  // The smallest value v that at least ratio of the values are <= v.
+  size_t Percentile(double ratio) const;
+
+ private:
+  std::vector<int64_t> counts_;
+};
+
+struct BatcherStats {
+  int64_t num_requests = 0;
+  int64_t num_batches = 0;
+  // The number of the waiting requests seen by every arriving request.
+  BatcherHistogram queue_depth{1};
+  // The number of the instances of every batch.
+  BatcherHistogram batch_size{1};
+};
+
+// Runs the concurrent requests of an online service in batches.
+//
+// Every request feeds the same targets of a Predictor, the feeds of the
+// requests waiting in the queue are concatenated along the first dimension
+// (and the first LoD level for the sequences), run in one batch, and the
+// fetches are split back by the instances of every request. A batch is run
+// once it holds max_batch_size instances, or once its first request has
+// waited for max_delay_us. The fetches should have one instance for every
+// instance of the feeds, e.g. a fetch reduced over the batch can not be
+// split.
+//
+//   BatcherConfig config;
+//   config.max_batch_size = 16;
+//   Batcher batcher(predictor, config);
+//   // on every thread of the service
+//   batcher.Run(feeds, &fetchs);
+//
+// Run is thread safe and blocks until the batch of the request has run.
+class Batcher {
+ public:
+  Batcher(const Predictor& predictor, const BatcherConfig& config);
+  // Run the requests in the queue, then stop the workers.
+  ~Batcher();
+
+  // The same as Predictor::Run. The fetches of the requests of one batch
+  // share the memory of the batched fetch.
+  void Run(const std::vector<framework::LoDTensor>& feeds,
+           std::vector<framework::LoDTensor>* fetchs);
+
+  BatcherStats GetStats() const;
+
+ private:
+  struct Request;
+
+  void WorkerLoop(Predictor* predictor);
+  void RunBatch(Predictor* predictor, const std::vector<Request*>& batch);
+
+  const BatcherConfig config_;
+  const size_t num_feeds_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable queue_cv_;
+  std::deque<Request*> queue_;
+  // the number of the instances of the requests in queue_
+  size_t queued_instances_;
+  bool stop_;
+  BatcherStats stats_;
+
+  std::vector<std::unique_ptr<Predictor>> predictors_;
+  std::vector<std::thread> workers_;
+
+  DISABLE_COPY_AND_ASSIGN(Batcher);
+};
+
+}  // namespace inference
+}  // namespace paddle
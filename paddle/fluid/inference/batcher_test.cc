@@ -0,0 +1,206 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/batcher.h"
+
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "paddle/fluid/framework/op_registry.h"
+
+USE_OP(mul);
+USE_NO_KERNEL_OP(feed);
+USE_NO_KERNEL_OP(fetch);
+
+namespace f = paddle::framework;
+namespace inference = paddle::inference;
+
+static void AddVar(const std::string& name, f::proto::VarType::Type type,
+                   bool persistable, f::BlockDesc* block) {
+  auto* var = block->Var(name);
+  var->SetType(type);
+  // the feed and fetch lists have no data type
+  if (type == f::proto::VarType::LOD_TENSOR) {
+    var->SetDataType(f::proto::VarType::FP32);
+  }
+  var->SetPersistable(persistable);
+}
+
+static void AddOp(const std::string& type, const f::VariableNameMap& inputs,
+                  const f::VariableNameMap& outputs,
+                  const f::AttributeMap& attrs, f::BlockDesc* block) {
+  auto* op = block->AppendOp();
+  op->SetType(type);
+  for (auto& kv : inputs) op->SetInput(kv.first, kv.second);
+  for (auto& kv : outputs) op->SetOutput(kv.first, kv.second);
+  op->SetAttrMap(attrs);
+  op->CheckAttrs();
+}
+
+// feed -> x * w -> fetch, w is [in, out] of w[i][j] = (i - j) / in
+static inference::Predictor* MakePredictor(int in, int out) {
+  std::unique_ptr<f::ProgramDesc> program(new f::ProgramDesc);
+  auto* block = program->MutableBlock(0);
+  AddVar("feed", f::proto::VarType::FEED_MINIBATCH, true, block);
+  AddVar("fetch", f::proto::VarType::FETCH_LIST, true, block);
+  AddVar("x", f::proto::VarType::LOD_TENSOR, false, block);
+  AddVar("w", f::proto::VarType::LOD_TENSOR, true, block);
+  AddVar("out", f::proto::VarType::LOD_TENSOR, false, block);
+  AddOp("feed", {{"X", {"feed"}}}, {{"Out", {"x"}}}, {{"col", 0}}, block);
+  AddOp("mul", {{"X", {"x"}}, {"Y", {"w"}}}, {{"Out", {"out"}}}, {}, block);
+  AddOp("fetch", {{"X", {"out"}}}, {{"Out", {"fetch"}}}, {{"col", 0}}, block);
+
+  std::unique_ptr<f::Scope> scope(new f::Scope);
+  auto* w = scope->Var("w")->GetMutable<f::LoDTensor>();
+  float* w_data = w->mutable_data<float>(f::make_ddim({in, out}),
+                                         paddle::platform::CPUPlace());
+  for (int i = 0; i < in; ++i) {
+    for (int j = 0; j < out; ++j) {
+      w_data[i * out + j] = static_cast<float>(i - j) / in;
+    }
+  }
+  return new inference::Predictor(paddle::platform::CPUPlace(),
+                                  std::move(program), std::move(scope));
+}
+
+static void CheckOutput(const f::LoDTensor& x, const f::LoDTensor& out,
+                        int in, int out_width) {
+  int rows = static_cast<int>(x.dims()[0]);
+  ASSERT_EQ(out.dims(), f::make_ddim({rows, out_width}));
+  EXPECT_EQ(out.lod(), x.lod());
+  const float* x_data = x.data<float>();
+  const float* out_data = out.data<float>();
+  for (int r = 0; r < rows; ++r) {
+    for (int j = 0; j < out_width; ++j) {
+      float expected = 0.f;
+      for (int i = 0; i < in; ++i) {
+        expected += x_data[r * in + i] * static_cast<float>(i - j) / in;
+      }
+      EXPECT_NEAR(out_data[r * out_width + j], expected, 1e-4);
+    }
+  }
+}
+
+static void FillRandom(int rows, int in, std::mt19937* rng, f::LoDTensor* x) {
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  float* data = x->mutable_data<float>(f::make_ddim({rows, in}),
+                                       paddle::platform::CPUPlace());
+  for (int i = 0; i < rows * in; ++i) data[i] = dist(*rng);
+}
+
+TEST(Batcher, Dense) {
+  const int in = 8, out = 5;
+  std::unique_ptr<inference::Predictor> predictor(MakePredictor(in, out));
+  inference::BatcherConfig config;
+  config.max_batch_size = 8;
+  config.max_delay_us = 2000;
+  config.num_workers = 2;
+  inference::Batcher batcher(*predictor, config);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&batcher, t] {
+      std::mt19937 rng(t);
+      for (int r = 0; r < 20; ++r) {
+        std::vector<f::LoDTensor> feeds(1);
+        FillRandom(1 + (t + r) % 3, in, &rng, &feeds[0]);
+        std::vector<f::LoDTensor> fetchs;
+        batcher.Run(feeds, &fetchs);
+        ASSERT_EQ(fetchs.size(), 1UL);
+        CheckOutput(feeds[0], fetchs[0], in, out);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  auto stats = batcher.GetStats();
+  EXPECT_EQ(stats.num_requests, 8 * 20);
+  EXPECT_EQ(stats.queue_depth.Total(), stats.num_requests);
+  EXPECT_EQ(stats.batch_size.Total(), stats.num_batches);
+  EXPECT_LE(stats.num_batches, stats.num_requests);
+  // no batch is larger than max_batch_size, every request is at most 3
+  EXPECT_EQ(stats.batch_size.counts().back(), 0);
+}
+
+TEST(Batcher, LoD) {
+  const int in = 4, out = 3;
+  std::unique_ptr<inference::Predictor> predictor(MakePredictor(in, out));
+  inference::BatcherConfig config;
+  config.max_batch_size = 16;
+  config.max_delay_us = 20000;
+  inference::Batcher batcher(*predictor, config);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&batcher, t] {
+      std::mt19937 rng(t);
+      for (int r = 0; r < 10; ++r) {
+        // t + 1 sequences of the lengths 1, 2, ...
+        f::LoD lod(1, f::Vector<size_t>{0});
+        for (int s = 0; s <= t; ++s) lod[0].push_back(lod[0].back() + s + 1);
+        std::vector<f::LoDTensor> feeds(1);
+        FillRandom(static_cast<int>(lod[0].back()), in, &rng, &feeds[0]);
+        feeds[0].set_lod(lod);
+        std::vector<f::LoDTensor> fetchs;
+        batcher.Run(feeds, &fetchs);
+        ASSERT_EQ(fetchs.size(), 1UL);
+        CheckOutput(feeds[0], fetchs[0], in, out);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(batcher.GetStats().num_requests, 4 * 10);
+}
+
+TEST(Batcher, Histogram) {
+  inference::BatcherHistogram histogram(4);
+  for (size_t v : {0, 1, 1, 2, 7, 9}) histogram.Add(v);
+  EXPECT_EQ(histogram.counts(), std::vector<int64_t>({1, 2, 1, 2}));
+  EXPECT_EQ(histogram.Total(), 6);
+  EXPECT_EQ(histogram.Percentile(0.5), 1UL);
+  EXPECT_EQ(histogram.Percentile(0.99), 3UL);
+}
+
+// A smoke check of the closed loop load of single instance requests, the
+// throughput over a grid of configurations is measured by
+// benchmark/batcher_benchmark.
+TEST(Batcher, Load) {
+  const int in = 16, out = 16;
+  std::unique_ptr<inference::Predictor> predictor(MakePredictor(in, out));
+  inference::BatcherConfig config;
+  config.max_batch_size = 4;
+  config.max_delay_us = 200;
+  config.num_workers = 2;
+  inference::Batcher batcher(*predictor, config);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&batcher, t] {
+      std::mt19937 rng(t);
+      std::vector<f::LoDTensor> feeds(1);
+      FillRandom(1, in, &rng, &feeds[0]);
+      std::vector<f::LoDTensor> fetchs;
+      for (int r = 0; r < 20; ++r) {
+        batcher.Run(feeds, &fetchs);
+        ASSERT_EQ(fetchs.size(), 1UL);
+        CheckOutput(feeds[0], fetchs[0], in, out);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(batcher.GetStats().num_requests, 4 * 20);
+}
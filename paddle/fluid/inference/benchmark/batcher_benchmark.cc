@@ -0,0 +1,149 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+// The closed loop load of a Batcher over a grid of max_batch_size and
+// max_delay_us: num_clients threads send requests of one instance back to
+// back to a fc of [width, width], the throughput, the p50/p99 latency, the
+// mean batch and the p99 queue depth of every configuration are printed.
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/inference/batcher.h"
+
+DEFINE_int32(width, 256, "The input and output width of the fc.");
+DEFINE_int32(num_clients, 16, "The threads sending the requests.");
+DEFINE_int32(repeat, 200, "The requests of every client.");
+DEFINE_int32(num_workers, 2, "The worker threads of the batcher.");
+
+USE_OP(mul);
+USE_NO_KERNEL_OP(feed);
+USE_NO_KERNEL_OP(fetch);
+
+namespace f = paddle::framework;
+namespace inference = paddle::inference;
+
+static void AddVar(const std::string& name, f::proto::VarType::Type type,
+                   bool persistable, f::BlockDesc* block) {
+  auto* var = block->Var(name);
+  var->SetType(type);
+  if (type == f::proto::VarType::LOD_TENSOR) {
+    var->SetDataType(f::proto::VarType::FP32);
+  }
+  var->SetPersistable(persistable);
+}
+
+static void AddOp(const std::string& type, const f::VariableNameMap& inputs,
+                  const f::VariableNameMap& outputs,
+                  const f::AttributeMap& attrs, f::BlockDesc* block) {
+  auto* op = block->AppendOp();
+  op->SetType(type);
+  for (auto& kv : inputs) op->SetInput(kv.first, kv.second);
+  for (auto& kv : outputs) op->SetOutput(kv.first, kv.second);
+  op->SetAttrMap(attrs);
+  op->CheckAttrs();
+}
+
+// feed -> x * w -> fetch, w is [width, width]
+static inference::Predictor* MakePredictor(int width) {
+  std::unique_ptr<f::ProgramDesc> program(new f::ProgramDesc);
+  auto* block = program->MutableBlock(0);
+  AddVar("feed", f::proto::VarType::FEED_MINIBATCH, true, block);
+  AddVar("fetch", f::proto::VarType::FETCH_LIST, true, block);
+  AddVar("x", f::proto::VarType::LOD_TENSOR, false, block);
+  AddVar("w", f::proto::VarType::LOD_TENSOR, true, block);
+  AddVar("out", f::proto::VarType::LOD_TENSOR, false, block);
+  AddOp("feed", {{"X", {"feed"}}}, {{"Out", {"x"}}}, {{"col", 0}}, block);
+  AddOp("mul", {{"X", {"x"}}, {"Y", {"w"}}}, {{"Out", {"out"}}}, {}, block);
+  AddOp("fetch", {{"X", {"out"}}}, {{"Out", {"fetch"}}}, {{"col", 0}}, block);
+
+  std::unique_ptr<f::Scope> scope(new f::Scope);
+  auto* w = scope->Var("w")->GetMutable<f::LoDTensor>();
+  float* w_data = w->mutable_data<float>(f::make_ddim({width, width}),
+                                         paddle::platform::CPUPlace());
+  for (int i = 0; i < width * width; ++i) {
+    w_data[i] = static_cast<float>(i % 13 - 6) / width;
+  }
+  return new inference::Predictor(paddle::platform::CPUPlace(),
+                                  std::move(program), std::move(scope));
+}
+
+static void RunLoad(inference::Batcher* batcher, const std::string& name) {
+  std::vector<std::vector<double>> latencies(FLAGS_num_clients);
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (int t = 0; t < FLAGS_num_clients; ++t) {
+    threads.emplace_back([=, &latencies] {
+      std::mt19937 rng(t);
+      std::uniform_real_distribution<float> dist(-1.f, 1.f);
+      std::vector<f::LoDTensor> feeds(1);
+      float* x = feeds[0].mutable_data<float>(
+          f::make_ddim({1, FLAGS_width}), paddle::platform::CPUPlace());
+      for (int i = 0; i < FLAGS_width; ++i) x[i] = dist(rng);
+      std::vector<f::LoDTensor> fetchs;
+      for (int r = 0; r < FLAGS_repeat; ++r) {
+        auto begin = std::chrono::steady_clock::now();
+        batcher->Run(feeds, &fetchs);
+        std::chrono::duration<double, std::micro> elapsed =
+            std::chrono::steady_clock::now() - begin;
+        latencies[t].push_back(elapsed.count());
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  std::chrono::duration<double> total =
+      std::chrono::steady_clock::now() - start;
+
+  std::vector<double> all;
+  for (auto& l : latencies) all.insert(all.end(), l.begin(), l.end());
+  std::sort(all.begin(), all.end());
+  auto stats = batcher->GetStats();
+  std::cout << name << ": " << all.size() / total.count() << " qps, p50 "
+            << all[all.size() / 2] << " us, p99 "
+            << all[all.size() * 99 / 100] << " us, mean batch "
+            << static_cast<double>(stats.num_requests) / stats.num_batches
+            << ", p99 queue depth " << stats.queue_depth.Percentile(0.99)
+            << std::endl;
+}
+
+int main(int argc, char** argv) {
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  try {
+    std::unique_ptr<inference::Predictor> predictor(
+        MakePredictor(FLAGS_width));
+    for (int max_batch_size : {1, 4, 16}) {
+      for (int64_t max_delay_us : {0, 200, 1000}) {
+        inference::BatcherConfig config;
+        config.max_batch_size = max_batch_size;
+        config.max_delay_us = max_delay_us;
+        config.num_workers = FLAGS_num_workers;
+        inference::Batcher batcher(*predictor, config);
+        RunLoad(&batcher, "max_batch_size " + std::to_string(max_batch_size) +
+                              ", max_delay_us " +
+                              std::to_string(max_delay_us));
+      }
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,324 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/benchmark/benchmark.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <exception>
+#include <fstream>
+#include <list>
+#include <mutex>  // NOLINT
+#include <random>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include "paddle/fluid/memory/memory.h"
+#include "paddle/fluid/platform/profiler.h"
+
+namespace paddle {
+namespace inference {
+
+// The height of the smallest lookup_table reading name, or 0.
+static int64_t IdRange(const framework::BlockDesc& block,
+                       const std::string& name) {
+  int64_t range = 0;
+  for (auto* op : block.AllOps()) {
+    if (op->Type() != "lookup_table") continue;
+    auto& ids = op->Input("Ids");
+    if (ids.empty() || ids[0] != name) continue;
+    auto* table = block.FindVarRecursive(op->Input("W")[0]);
+    if (table == nullptr) continue;
+    auto shape = table->GetShape();
+    if (shape.empty() || shape[0] <= 0) continue;
+    range = range == 0 ? shape[0] : std::min(range, shape[0]);
+  }
+  return range;
+}
+
+template <typename T>
+static void FillReal(std::mt19937* rng, framework::LoDTensor* tensor) {
+  std::uniform_real_distribution<T> dist(-1, 1);
+  T* data = tensor->mutable_data<T>(platform::CPUPlace());
+  for (int64_t i = 0; i < tensor->numel(); ++i) data[i] = dist(*rng);
+}
+
+template <typename T>
+static void FillInteger(int64_t range, std::mt19937* rng,
+                        framework::LoDTensor* tensor) {
+  std::uniform_int_distribution<int64_t> dist(0,
+                                              std::max<int64_t>(range, 1) - 1);
+  T* data = tensor->mutable_data<T>(platform::CPUPlace());
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = static_cast<T>(dist(*rng));
+  }
+}
+
+std::vector<framework::LoDTensor> SynthesizeFeeds(
+    const framework::ProgramDesc& program,
+    const std::vector<std::string>& feed_names, const FeedConfig& config) {
+  PADDLE_ENFORCE_GT(config.batch_size, 0, "batch_size should be positive");
+  PADDLE_ENFORCE_GT(config.seq_len, 0, "seq_len should be positive");
+  auto& block = program.Block(0);
+  std::mt19937 rng(config.seed);
+  std::uniform_int_distribution<size_t> length(1, 2 * config.seq_len - 1);
+  std::vector<framework::LoDTensor> feeds(feed_names.size());
+  for (size_t i = 0; i < feed_names.size(); ++i) {
+    auto& name = feed_names[i];
+    auto* var = block.FindVar(name);
+    PADDLE_ENFORCE_NOT_NULL(var, "The feed target %s is not found", name);
+    auto shape = var->GetShape();
+    PADDLE_ENFORCE(!shape.empty(), "The shape of the feed %s is unknown",
+                   name);
+
+    // the sequences of every level have the lengths of length
+    framework::LoD lod;
+    int64_t rows = config.batch_size;
+    for (int level = 0; level < var->GetLoDLevel(); ++level) {
+      framework::Vector<size_t> offsets{0};
+      for (int64_t s = 0; s < rows; ++s) {
+        offsets.push_back(offsets.back() + length(rng));
+      }
+      rows = static_cast<int64_t>(offsets.back());
+      lod.push_back(offsets);
+    }
+    if (shape[0] < 0 || !lod.empty()) shape[0] = rows;
+    for (size_t d = 1; d < shape.size(); ++d) {
+      PADDLE_ENFORCE_GE(shape[d], 0,
+                        "The dimension %d of the feed %s is unknown, read "
+                        "the feeds from a file instead",
+                        d, name);
+    }
+
+    auto& feed = feeds[i];
+    feed.Resize(framework::make_ddim(shape));
+    feed.set_lod(lod);
+    switch (var->GetDataType()) {
+      case framework::proto::VarType::FP32:
+        FillReal<float>(&rng, &feed);
+        break;
+      case framework::proto::VarType::FP64:
+        FillReal<double>(&rng, &feed);
+        break;
+      case framework::proto::VarType::INT32:
+        FillInteger<int32_t>(IdRange(block, name), &rng, &feed);
+        break;
+      case framework::proto::VarType::INT64:
+        FillInteger<int64_t>(IdRange(block, name), &rng, &feed);
+        break;
+      default:
+        PADDLE_THROW("The data type of the feed %s is not supported", name);
+    }
+  }
+  return feeds;
+}
+
+std::vector<framework::LoDTensor> ReadFeeds(const std::string& path,
+                                            size_t num_feeds) {
+  std::ifstream fin(path, std::ios::binary);
+  PADDLE_ENFORCE(static_cast<bool>(fin), "Cannot open file %s", path);
+  auto& dev_ctx =
+      *platform::DeviceContextPool::Instance().Get(platform::CPUPlace());
+  std::vector<framework::LoDTensor> feeds(num_feeds);
+  for (auto& feed : feeds) {
+    framework::DeserializeFromStream(fin, &feed, dev_ctx);
+  }
+  return feeds;
+}
+
+// The instances of a run, as the Batcher counts them.
+static size_t NumInstances(const framework::LoDTensor& tensor) {
+  if (!tensor.lod().empty()) return tensor.lod()[0].size() - 1;
+  return tensor.dims().size() > 0 ? static_cast<size_t>(tensor.dims()[0])
+                                  : 1;
+}
+
+static double Percentile(const std::vector<double>& sorted, double ratio) {
+  size_t index = static_cast<size_t>(ratio * sorted.size());
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+
+static int64_t PeakRssBytes() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 6, "VmHWM:") == 0) {
+      return std::stoll(line.substr(6)) * 1024;
+    }
+  }
+  return -1;
+}
+
+// Sum the time of the events of every name, paired by the push and the pop
+// events as the report of DisableProfiler.
+static std::vector<OpProfile> SumEvents(
+    const std::vector<std::vector<platform::Event>>& events) {
+  std::vector<OpProfile> ops;
+  std::unordered_map<std::string, size_t> index;
+  for (auto& thread_events : events) {
+    std::list<const platform::Event*> pushed;
+    for (auto& event : thread_events) {
+      if (event.type() == platform::EventType::kPushRange) {
+        pushed.push_back(&event);
+        continue;
+      }
+      if (event.type() != platform::EventType::kPopRange) continue;
+      auto it = pushed.rbegin();
+      while (it != pushed.rend() && (*it)->name() != event.name()) ++it;
+      if (it == pushed.rend()) continue;
+      auto name = event.name();
+      if (index.count(name) == 0) {
+        index[name] = ops.size();
+        ops.push_back({name, 0, 0});
+      }
+      auto& op = ops[index[name]];
+      ++op.calls;
+      op.total_ms += (*it)->CpuElapsedMs(event);
+      pushed.erase(std::next(it).base());
+    }
+  }
+  std::sort(ops.begin(), ops.end(), [](const OpProfile& a, const OpProfile& b) {
+    return a.total_ms > b.total_ms;
+  });
+  return ops;
+}
+
+BenchmarkResult RunBenchmark(const Predictor& predictor,
+                             const std::vector<framework::LoDTensor>& feeds,
+                             const BenchmarkConfig& config) {
+  PADDLE_ENFORCE_GT(config.num_threads, 0, "num_threads should be positive");
+  PADDLE_ENFORCE_GE(config.warmup_runs, 0,
+                    "warmup_runs should not be negative");
+  PADDLE_ENFORCE_GT(config.runs, 0, "runs should be positive");
+  PADDLE_ENFORCE(!feeds.empty(), "The feeds are empty");
+  std::vector<std::unique_ptr<Predictor>> predictors;
+  for (int t = 0; t < config.num_threads; ++t) {
+    predictors.push_back(predictor.Clone());
+    if (config.freeze_memory) predictors.back()->FreezeMemory();
+  }
+
+  // the timed phase begins once all the threads are warmed up
+  std::mutex mutex;
+  std::condition_variable warmed_cv;
+  int warmed = 0;
+  std::chrono::steady_clock::time_point begin;
+  std::vector<std::vector<double>> latencies(config.num_threads);
+  std::vector<std::exception_ptr> errors(config.num_threads);
+  auto work = [&](int t) {
+    std::vector<framework::LoDTensor> fetchs;
+    try {
+      for (int r = 0; r < config.warmup_runs; ++r) {
+        predictors[t]->Run(feeds, &fetchs);
+      }
+    } catch (...) {
+      errors[t] = std::current_exception();
+    }
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (++warmed == config.num_threads) {
+        begin = std::chrono::steady_clock::now();
+        warmed_cv.notify_all();
+      } else {
+        warmed_cv.wait(lock, [&] { return warmed == config.num_threads; });
+      }
+    }
+    if (errors[t]) return;
+    try {
+      for (int r = 0; r < config.runs; ++r) {
+        auto run_begin = std::chrono::steady_clock::now();
+        predictors[t]->Run(feeds, &fetchs);
+        std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - run_begin;
+        latencies[t].push_back(elapsed.count());
+      }
+    } catch (...) {
+      errors[t] = std::current_exception();
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int t = 0; t < config.num_threads; ++t) threads.emplace_back(work, t);
+  for (auto& thread : threads) thread.join();
+  std::chrono::duration<double> total =
+      std::chrono::steady_clock::now() - begin;
+  for (auto& error : errors) {
+    if (error) std::rethrow_exception(error);
+  }
+
+  BenchmarkResult result;
+  result.num_threads = config.num_threads;
+  result.batch_size = NumInstances(feeds[0]);
+  std::vector<double> all;
+  for (auto& l : latencies) all.insert(all.end(), l.begin(), l.end());
+  std::sort(all.begin(), all.end());
+  result.runs = static_cast<int64_t>(all.size());
+  result.seconds = total.count();
+  result.runs_per_second = result.runs / result.seconds;
+  result.instances_per_second = result.runs_per_second * result.batch_size;
+  for (double l : all) result.latency_mean += l / all.size();
+  result.latency_p50 = Percentile(all, 0.5);
+  result.latency_p90 = Percentile(all, 0.9);
+  result.latency_p99 = Percentile(all, 0.99);
+  result.latency_max = all.back();
+
+  if (config.profile) {
+    std::vector<framework::LoDTensor> fetchs;
+    platform::EnableProfiler(platform::ProfilerState::kCPU);
+    try {
+      for (int r = 0; r < config.runs; ++r) {
+        predictors[0]->Run(feeds, &fetchs);
+      }
+    } catch (...) {
+      platform::StopProfiler();
+      throw;
+    }
+    result.ops = SumEvents(platform::StopProfiler());
+  }
+  result.peak_rss_bytes = PeakRssBytes();
+  result.allocator_bytes = memory::Used(platform::CPUPlace());
+  return result;
+}
+
+static std::string JsonString(const std::string& str) {
+  std::string quoted = "\"";
+  for (char c : str) {
+    if (c == '"' || c == '\\') quoted += '\\';
+    quoted += c;
+  }
+  return quoted + "\"";
+}
+
+void WriteBenchmarkJson(const BenchmarkResult& result, std::ostream& os) {
+  os << "{\"num_threads\": " << result.num_threads
+     << ", \"batch_size\": " << result.batch_size
+     << ", \"runs\": " << result.runs << ", \"seconds\": " << result.seconds
+     << ", \"runs_per_second\": " << result.runs_per_second
+     << ", \"instances_per_second\": " << result.instances_per_second
+     << ", \"latency_ms\": {\"mean\": " << result.latency_mean
+     << ", \"p50\": " << result.latency_p50
+     << ", \"p90\": " << result.latency_p90
+     << ", \"p99\": " << result.latency_p99
+     << ", \"max\": " << result.latency_max << "}"
+     << ", \"peak_rss_bytes\": " << result.peak_rss_bytes
+     << ", \"allocator_bytes\": " << result.allocator_bytes << ", \"ops\": [";
+  for (size_t i = 0; i < result.ops.size(); ++i) {
+    auto& op = result.ops[i];
+    os << (i == 0 ? "" : ", ") << "{\"type\": " << JsonString(op.type)
+       << ", \"calls\": " << op.calls << ", \"total_ms\": " << op.total_ms
+       << "}";
+  }
+  os << "]}\n";
+}
+
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,103 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/inference/predictor.h"
+
+namespace paddle {
+namespace inference {
+
+// How to synthesize the feeds of a model from the shapes, the data types
+// and the LoD levels of the feed targets.
+struct FeedConfig {
+  // The number of instances, the -1 of the first dimension of the feeds
+  // without LoD, or the number of the sequences of the first LoD level.
+  int batch_size = 1;
+  // The mean length of the sequences of every LoD level, the lengths are
+  // drawn from [1, 2 * seq_len - 1].
+  int seq_len = 16;
+  int seed = 0;
+};
+
+// Synthesize the feeds of the feed targets feed_names of program. Floats
+// are drawn from [-1, 1], and integers from [0, the height of the
+// lookup_table reading them), or are 0 if no lookup_table reads them.
+std::vector<framework::LoDTensor> SynthesizeFeeds(
+    const framework::ProgramDesc& program,
+    const std::vector<std::string>& feed_names, const FeedConfig& config);
+
+// Read num_feeds LoDTensors serialized one after another by
+// SerializeToStream in the file at path.
+std::vector<framework::LoDTensor> ReadFeeds(const std::string& path,
+                                            size_t num_feeds);
+
+struct BenchmarkConfig {
+  // The threads running the predictor, each with its own clone.
+  int num_threads = 1;
+  // The runs of every thread before and in the timed phase.
+  int warmup_runs = 10;
+  int runs = 100;
+  // Freeze the memory of the clones, see Predictor::FreezeMemory.
+  bool freeze_memory = false;
+  // Run the predictor runs times more on one thread with the profiler to
+  // break the time down by the operators.
+  bool profile = false;
+};
+
+// The time of the operators of one type in the profiled runs.
+struct OpProfile {
+  std::string type;
+  int64_t calls;
+  double total_ms;
+};
+
+struct BenchmarkResult {
+  int num_threads = 0;
+  // The instances of a run, see FeedConfig::batch_size.
+  size_t batch_size = 0;
+  // The runs of all the threads in the timed phase and its wall time.
+  int64_t runs = 0;
+  double seconds = 0;
+  double runs_per_second = 0;
+  double instances_per_second = 0;
+  // The latency of a run in milliseconds.
+  double latency_mean = 0;
+  double latency_p50 = 0;
+  double latency_p90 = 0;
+  double latency_p99 = 0;
+  double latency_max = 0;
+  // The peak resident memory of the process, or -1 if it is unknown.
+  int64_t peak_rss_bytes = -1;
+  // The memory held by the CPU allocator.
+  size_t allocator_bytes = 0;
+  // The operators by their total time, if profiled.
+  std::vector<OpProfile> ops;
+};
+
+// Run the clones of predictor on feeds as config, and measure them.
+BenchmarkResult RunBenchmark(const Predictor& predictor,
+                             const std::vector<framework::LoDTensor>& feeds,
+                             const BenchmarkConfig& config);
+
+// Write result as a JSON object, to track it across the releases.
+void WriteBenchmarkJson(const BenchmarkResult& result, std::ostream& os);
+
+}  // namespace inference
+}  // namespace paddle
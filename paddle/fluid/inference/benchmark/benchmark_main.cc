@@ -0,0 +1,106 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+// Benchmark a saved inference model on CPU, e.g.
+//
+//   fluid_inference_benchmark --dirname=word2vec.inference.model \
+//       --batch_size=32 --num_threads=4 --profile --output=result.json
+//
+// The feeds are synthesized from the feed targets unless --feeds is set.
+
+#include <fstream>
+#include <iostream>
+#include "gflags/gflags.h"
+#include "paddle/fluid/inference/benchmark/benchmark.h"
+#include "paddle/fluid/inference/io.h"
+
+DEFINE_string(dirname, "",
+              "The directory of the model saved by "
+              "fluid.io.save_inference_model.");
+DEFINE_string(prog_filename, "",
+              "The program of a model of combined parameters.");
+DEFINE_string(param_filename, "", "The combined parameters of the model.");
+DEFINE_string(compiled, "", "A model compiled by CompileModel.");
+DEFINE_string(feeds, "",
+              "The feeds serialized by SerializeToStream in the order of "
+              "the feed targets, synthesized if empty.");
+DEFINE_int32(batch_size, 1, "The instances of a synthesized feed.");
+DEFINE_int32(seq_len, 16, "The mean length of the synthesized sequences.");
+DEFINE_int32(num_threads, 1, "The threads running the model.");
+DEFINE_int32(warmup, 10, "The runs of every thread before timing.");
+DEFINE_int32(repeat, 100, "The timed runs of every thread.");
+DEFINE_bool(freeze_memory, false, "Freeze the memory of the predictors.");
+DEFINE_bool(profile, false, "Break the time down by the operators.");
+DEFINE_string(output, "", "Write the JSON result here instead of stdout.");
+
+namespace inference = paddle::inference;
+
+static std::unique_ptr<inference::Predictor> LoadPredictor() {
+  paddle::platform::CPUPlace place;
+  std::unique_ptr<inference::Predictor> predictor;
+  if (!FLAGS_compiled.empty()) {
+    predictor.reset(new inference::Predictor(
+        inference::ReadCompiledModel(FLAGS_compiled)));
+  } else if (!FLAGS_param_filename.empty()) {
+    predictor.reset(new inference::Predictor(place, FLAGS_prog_filename,
+                                             FLAGS_param_filename));
+  } else {
+    PADDLE_ENFORCE(!FLAGS_dirname.empty(),
+                   "Set --dirname, --prog_filename and --param_filename, "
+                   "or --compiled");
+    predictor.reset(new inference::Predictor(place, FLAGS_dirname));
+  }
+  return predictor;
+}
+
+int main(int argc, char** argv) {
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  try {
+    inference::Init(false);
+    auto predictor = LoadPredictor();
+
+    std::vector<paddle::framework::LoDTensor> feeds;
+    if (FLAGS_feeds.empty()) {
+      inference::FeedConfig feed_config;
+      feed_config.batch_size = FLAGS_batch_size;
+      feed_config.seq_len = FLAGS_seq_len;
+      feeds = inference::SynthesizeFeeds(predictor->Program(),
+                                         predictor->FeedNames(), feed_config);
+    } else {
+      feeds = inference::ReadFeeds(FLAGS_feeds,
+                                   predictor->FeedNames().size());
+    }
+
+    inference::BenchmarkConfig config;
+    config.num_threads = FLAGS_num_threads;
+    config.warmup_runs = FLAGS_warmup;
+    config.runs = FLAGS_repeat;
+    config.freeze_memory = FLAGS_freeze_memory;
+    config.profile = FLAGS_profile;
+    auto result = inference::RunBenchmark(*predictor, feeds, config);
+
+    if (FLAGS_output.empty()) {
+      inference::WriteBenchmarkJson(result, std::cout);
+    } else {
+      std::ofstream fout(FLAGS_output);
+      PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot open file %s",
+                     FLAGS_output);
+      inference::WriteBenchmarkJson(result, fout);
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
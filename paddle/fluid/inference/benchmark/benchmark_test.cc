@@ -0,0 +1,162 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/benchmark/benchmark.h"
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/op_registry.h"
+
+USE_OP(mul);
+USE_NO_KERNEL_OP(feed);
+USE_NO_KERNEL_OP(fetch);
+
+namespace f = paddle::framework;
+namespace inference = paddle::inference;
+
+static void AddVar(const std::string& name, f::proto::VarType::Type type,
+                   f::proto::VarType::Type data_type,
+                   const std::vector<int64_t>& shape, int lod_level,
+                   bool persistable, f::BlockDesc* block) {
+  auto* var = block->Var(name);
+  var->SetType(type);
+  if (type == f::proto::VarType::LOD_TENSOR) {
+    var->SetDataType(data_type);
+    var->SetShape(shape);
+    var->SetLoDLevel(lod_level);
+  }
+  var->SetPersistable(persistable);
+}
+
+static void AddOp(const std::string& type, const f::VariableNameMap& inputs,
+                  const f::VariableNameMap& outputs,
+                  const f::AttributeMap& attrs, f::BlockDesc* block) {
+  auto* op = block->AppendOp();
+  op->SetType(type);
+  for (auto& kv : inputs) op->SetInput(kv.first, kv.second);
+  for (auto& kv : outputs) op->SetOutput(kv.first, kv.second);
+  op->SetAttrMap(attrs);
+}
+
+TEST(Benchmark, SynthesizeFeeds) {
+  const auto kFP32 = f::proto::VarType::FP32;
+  const auto kINT64 = f::proto::VarType::INT64;
+  const auto kTensor = f::proto::VarType::LOD_TENSOR;
+  f::ProgramDesc program;
+  auto* block = program.MutableBlock(0);
+  AddVar("x", kTensor, kFP32, {-1, 8}, 0, false, block);
+  AddVar("words", kTensor, kINT64, {-1, 1}, 1, false, block);
+  AddVar("table", kTensor, kFP32, {100, 4}, 0, true, block);
+  AddVar("emb", kTensor, kFP32, {-1, 4}, 1, false, block);
+  AddOp("lookup_table", {{"Ids", {"words"}}, {"W", {"table"}}},
+        {{"Out", {"emb"}}}, {}, block);
+
+  inference::FeedConfig config;
+  config.batch_size = 6;
+  config.seq_len = 4;
+  auto feeds = inference::SynthesizeFeeds(program, {"x", "words"}, config);
+  ASSERT_EQ(feeds.size(), 2UL);
+
+  EXPECT_EQ(feeds[0].dims(), f::make_ddim({6, 8}));
+  EXPECT_TRUE(feeds[0].lod().empty());
+  const float* x = feeds[0].data<float>();
+  for (int i = 0; i < 6 * 8; ++i) {
+    EXPECT_GE(x[i], -1.f);
+    EXPECT_LE(x[i], 1.f);
+  }
+
+  auto& lod = feeds[1].lod();
+  ASSERT_EQ(lod.size(), 1UL);
+  ASSERT_EQ(lod[0].size(), 7UL);
+  for (size_t i = 1; i < lod[0].size(); ++i) {
+    EXPECT_GE(lod[0][i] - lod[0][i - 1], 1UL);
+    EXPECT_LE(lod[0][i] - lod[0][i - 1], 7UL);
+  }
+  int64_t rows = static_cast<int64_t>(lod[0].back());
+  EXPECT_EQ(feeds[1].dims(), f::make_ddim({rows, 1}));
+  const int64_t* words = feeds[1].data<int64_t>();
+  for (int64_t i = 0; i < rows; ++i) {
+    EXPECT_GE(words[i], 0);
+    EXPECT_LT(words[i], 100);
+  }
+}
+
+// feed -> x * w -> fetch
+static inference::Predictor* MakePredictor(int in, int out) {
+  const auto kFP32 = f::proto::VarType::FP32;
+  const auto kTensor = f::proto::VarType::LOD_TENSOR;
+  std::unique_ptr<f::ProgramDesc> program(new f::ProgramDesc);
+  auto* block = program->MutableBlock(0);
+  AddVar("feed", f::proto::VarType::FEED_MINIBATCH, kFP32, {}, 0, true,
+         block);
+  AddVar("fetch", f::proto::VarType::FETCH_LIST, kFP32, {}, 0, true, block);
+  AddVar("x", kTensor, kFP32, {-1, in}, 0, false, block);
+  AddVar("w", kTensor, kFP32, {in, out}, 0, true, block);
+  AddVar("out", kTensor, kFP32, {-1, out}, 0, false, block);
+  AddOp("feed", {{"X", {"feed"}}}, {{"Out", {"x"}}}, {{"col", 0}}, block);
+  AddOp("mul", {{"X", {"x"}}, {"Y", {"w"}}}, {{"Out", {"out"}}},
+        {{"x_num_col_dims", 1}, {"y_num_col_dims", 1}}, block);
+  AddOp("fetch", {{"X", {"out"}}}, {{"Out", {"fetch"}}}, {{"col", 0}}, block);
+
+  std::unique_ptr<f::Scope> scope(new f::Scope);
+  auto* w = scope->Var("w")->GetMutable<f::LoDTensor>();
+  float* w_data = w->mutable_data<float>(f::make_ddim({in, out}),
+                                         paddle::platform::CPUPlace());
+  for (int i = 0; i < in * out; ++i) w_data[i] = 0.01f * i;
+  return new inference::Predictor(paddle::platform::CPUPlace(),
+                                  std::move(program), std::move(scope));
+}
+
+TEST(Benchmark, Run) {
+  std::unique_ptr<inference::Predictor> predictor(MakePredictor(16, 8));
+  inference::FeedConfig feed_config;
+  feed_config.batch_size = 4;
+  auto feeds = inference::SynthesizeFeeds(
+      predictor->Program(), predictor->FeedNames(), feed_config);
+
+  inference::BenchmarkConfig config;
+  config.num_threads = 2;
+  config.warmup_runs = 2;
+  config.runs = 5;
+  config.freeze_memory = true;
+  config.profile = true;
+  auto result = inference::RunBenchmark(*predictor, feeds, config);
+  EXPECT_EQ(result.num_threads, 2);
+  EXPECT_EQ(result.batch_size, 4UL);
+  EXPECT_EQ(result.runs, 10);
+  EXPECT_GT(result.seconds, 0);
+  EXPECT_NEAR(result.instances_per_second, 4 * result.runs_per_second, 1e-6);
+  EXPECT_LE(result.latency_p50, result.latency_p90);
+  EXPECT_LE(result.latency_p90, result.latency_p99);
+  EXPECT_LE(result.latency_p99, result.latency_max);
+  bool profiled_mul = false;
+  for (auto& op : result.ops) {
+    if (op.type == "mul") {
+      EXPECT_EQ(op.calls, 5);
+      profiled_mul = true;
+    }
+  }
+  EXPECT_TRUE(profiled_mul);
+
+  std::ostringstream os;
+  inference::WriteBenchmarkJson(result, os);
+  auto json = os.str();
+  for (auto* key : {"\"runs_per_second\"", "\"p99\"", "\"peak_rss_bytes\"",
+                    "\"type\": \"mul\""}) {
+    EXPECT_NE(json.find(key), std::string::npos) << key;
+  }
+}
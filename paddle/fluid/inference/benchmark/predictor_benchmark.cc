@@ -0,0 +1,162 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+// The latency and the allocations per run of a predictor: a stack of fc of
+// [width, width] with the memory not frozen and frozen, and one fc with the
+// feed and the fetch not bound and bound.
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/inference/predictor.h"
+
+DEFINE_int32(width, 256, "The width of every fc.");
+DEFINE_int32(depth, 8, "The number of fc.");
+DEFINE_int32(batch, 4, "The rows of the feed of the frozen memory runs.");
+DEFINE_int32(bind_batch, 256,
+             "The rows of the feed of the bound runs, the large fetch is "
+             "copied by the fetch operator if not bound.");
+DEFINE_int32(repeat, 1000, "The timed runs of every predictor.");
+
+USE_OP(mul);
+USE_NO_KERNEL_OP(feed);
+USE_NO_KERNEL_OP(fetch);
+
+namespace f = paddle::framework;
+
+static void AddVar(const std::string& name, f::proto::VarType::Type type,
+                   bool persistable, f::BlockDesc* block) {
+  auto* var = block->Var(name);
+  var->SetType(type);
+  // the feed and fetch lists have no data type
+  if (type == f::proto::VarType::LOD_TENSOR) {
+    var->SetDataType(f::proto::VarType::FP32);
+  }
+  var->SetPersistable(persistable);
+}
+
+static void AddOp(const std::string& type, const f::VariableNameMap& inputs,
+                  const f::VariableNameMap& outputs,
+                  const f::AttributeMap& attrs, f::BlockDesc* block) {
+  auto* op = block->AppendOp();
+  op->SetType(type);
+  for (auto& kv : inputs) op->SetInput(kv.first, kv.second);
+  for (auto& kv : outputs) op->SetOutput(kv.first, kv.second);
+  op->SetAttrMap(attrs);
+  op->CheckAttrs();
+}
+
+// feed -> depth layers of x * w_i -> fetch, every w_i is [width, width]
+static paddle::inference::Predictor* MakeDeepPredictor(int width, int depth) {
+  std::unique_ptr<f::ProgramDesc> program(new f::ProgramDesc);
+  std::unique_ptr<f::Scope> scope(new f::Scope);
+  auto* block = program->MutableBlock(0);
+  AddVar("feed", f::proto::VarType::FEED_MINIBATCH, true, block);
+  AddVar("fetch", f::proto::VarType::FETCH_LIST, true, block);
+  AddVar("h0", f::proto::VarType::LOD_TENSOR, false, block);
+  AddOp("feed", {{"X", {"feed"}}}, {{"Out", {"h0"}}}, {{"col", 0}}, block);
+  for (int d = 0; d < depth; ++d) {
+    auto w = "w" + std::to_string(d);
+    auto in = "h" + std::to_string(d);
+    auto out = "h" + std::to_string(d + 1);
+    AddVar(w, f::proto::VarType::LOD_TENSOR, true, block);
+    AddVar(out, f::proto::VarType::LOD_TENSOR, false, block);
+    AddOp("mul", {{"X", {in}}, {"Y", {w}}}, {{"Out", {out}}}, {}, block);
+    float* w_data = scope->Var(w)->GetMutable<f::LoDTensor>()->mutable_data<
+        float>(f::make_ddim({width, width}), paddle::platform::CPUPlace());
+    for (int i = 0; i < width * width; ++i) {
+      w_data[i] = static_cast<float>((i * 7 + d) % 13 - 6) / width;
+    }
+  }
+  AddOp("fetch", {{"X", {"h" + std::to_string(depth)}}}, {{"Out", {"fetch"}}},
+        {{"col", 0}}, block);
+  return new paddle::inference::Predictor(
+      paddle::platform::CPUPlace(), std::move(program), std::move(scope));
+}
+
+// The allocations and the latency of the runs of a predictor.
+static void BenchmarkRuns(paddle::inference::Predictor* predictor, int width,
+                          int batch, int repeat, const std::string& name) {
+  std::vector<f::LoDTensor> feeds(1), fetchs;
+  float* x = feeds[0].mutable_data<float>(f::make_ddim({batch, width}),
+                                          paddle::platform::CPUPlace());
+  for (int i = 0; i < batch * width; ++i) x[i] = (i % 11) * 0.1f;
+  for (int r = 0; r < 3; ++r) predictor->Run(feeds, &fetchs);
+
+  int64_t allocs = predictor->MemoryStats().allocs;
+  std::vector<double> latencies;
+  for (int r = 0; r < repeat; ++r) {
+    auto begin = std::chrono::steady_clock::now();
+    predictor->Run(feeds, &fetchs);
+    std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - begin;
+    latencies.push_back(elapsed.count());
+  }
+  double mean = 0, variance = 0;
+  for (double l : latencies) mean += l / repeat;
+  for (double l : latencies) variance += (l - mean) * (l - mean) / repeat;
+  std::sort(latencies.begin(), latencies.end());
+  std::cout << name << ": "
+            << static_cast<double>(predictor->MemoryStats().allocs - allocs) /
+                   repeat
+            << " allocs/run, p50 " << latencies[repeat / 2] << " us, p99 "
+            << latencies[repeat * 99 / 100] << " us, max "
+            << latencies.back() << " us, stddev " << std::sqrt(variance)
+            << " us" << std::endl;
+}
+
+static void BenchmarkFreezeMemory() {
+  std::unique_ptr<paddle::inference::Predictor> predictor(
+      MakeDeepPredictor(FLAGS_width, FLAGS_depth));
+  BenchmarkRuns(predictor.get(), FLAGS_width, FLAGS_batch, FLAGS_repeat,
+                "not frozen");
+  auto frozen = predictor->Clone();
+  frozen->FreezeMemory();
+  BenchmarkRuns(frozen.get(), FLAGS_width, FLAGS_batch, FLAGS_repeat,
+                "frozen");
+}
+
+static void BenchmarkBindFeedFetch() {
+  std::unique_ptr<paddle::inference::Predictor> predictor(
+      MakeDeepPredictor(FLAGS_width, 1));
+  BenchmarkRuns(predictor.get(), FLAGS_width, FLAGS_bind_batch, FLAGS_repeat,
+                "not bound");
+  auto bound = predictor->Clone();
+  f::LoDTensor x;
+  x.mutable_data<float>(f::make_ddim({FLAGS_bind_batch, FLAGS_width}),
+                        paddle::platform::CPUPlace());
+  std::vector<float> buffer(FLAGS_bind_batch * FLAGS_width);
+  bound->BindFeed(0, &x);
+  bound->BindFetch(0, buffer.data(), buffer.size() * sizeof(float));
+  BenchmarkRuns(bound.get(), FLAGS_width, FLAGS_bind_batch, FLAGS_repeat,
+                "bound");
+}
+
+int main(int argc, char** argv) {
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  try {
+    BenchmarkFreezeMemory();
+    BenchmarkBindFeedFetch();
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,261 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/compiled_model.h"
+
+#include <fstream>
+#include "paddle/fluid/framework/executor.h"
+#include "paddle/fluid/framework/feed_fetch_method.h"
+#include "paddle/fluid/framework/feed_fetch_type.h"
+#include "paddle/fluid/framework/mapped_tensor_file.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/inference/fusion.h"
+#include "paddle/fluid/inference/io.h"
+#include "paddle/fluid/inference/optimize.h"
+
+namespace paddle {
+namespace inference {
+
+template <typename T>
+static void WriteValue(std::ostream& os, T value) {
+  os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void WriteString(std::ostream& os, const std::string& str) {
+  WriteValue(os, static_cast<uint64_t>(str.size()));
+  os.write(str.data(), static_cast<std::streamsize>(str.size()));
+}
+
+template <typename T>
+static T ReadValue(std::istream& is) {
+  T value;
+  is.read(reinterpret_cast<char*>(&value), sizeof(value));
+  PADDLE_ENFORCE(static_cast<bool>(is), "The compiled model is truncated");
+  return value;
+}
+
+static std::string ReadString(std::istream& is) {
+  std::string str(ReadValue<uint64_t>(is), '\0');
+  is.read(&str[0], static_cast<std::streamsize>(str.size()));
+  PADDLE_ENFORCE(static_cast<bool>(is), "The compiled model is truncated");
+  return str;
+}
+
+static bool IsParameter(const framework::VarDesc& var) {
+  auto type = var.GetType();
+  return var.Persistable() &&
+         type != framework::proto::VarType::FEED_MINIBATCH &&
+         type != framework::proto::VarType::FETCH_LIST;
+}
+
+// Run block 0 of program on sample_feeds, record the kernel chosen by every
+// operator and the plan of the arena.
+static void Calibrate(const framework::ProgramDesc& program,
+                      framework::Scope* scope,
+                      const std::vector<framework::LoDTensor>& sample_feeds,
+                      CompiledModel* model) {
+  PADDLE_ENFORCE(!sample_feeds.empty(), "The sample feeds are empty");
+  platform::CPUPlace place;
+  auto& block = program.Block(0);
+  std::string feed_holder;
+  for (auto* op : block.AllOps()) {
+    if (op->Type() == framework::kFeedOpType) {
+      feed_holder = op->Input("X")[0];
+    }
+  }
+  PADDLE_ENFORCE(!feed_holder.empty(), "The program has no feed operators");
+
+  auto& local = scope->NewScope();
+  std::vector<std::string> temporaries;
+  for (auto* var : block.AllVars()) {
+    if (var->Name() == framework::kEmptyVarName || IsParameter(*var)) {
+      continue;
+    }
+    framework::InitializeVariable(local.Var(var->Name()), var->GetType());
+    if (var->GetType() == framework::proto::VarType::LOD_TENSOR) {
+      temporaries.push_back(var->Name());
+    }
+  }
+  auto ctx = framework::Executor::Prepare(program, 0);
+  auto& ops = ctx->ops_;
+  FrozenArena arena(program, ops, &local, temporaries);
+  arena.Freeze();
+  model->kernel_types.clear();
+  model->kernel_types.resize(ops.size());
+  // the arena is recorded in the first two runs and served in the third
+  for (int run = 0; run < 3; ++run) {
+    framework::TensorArena::Guard guard(&arena);
+    arena.BeginRun();
+    for (size_t i = 0; i < sample_feeds.size(); ++i) {
+      framework::SetFeedVariable(&local, sample_feeds[i], feed_holder, i);
+    }
+    for (size_t i = 0; i < ops.size(); ++i) {
+      auto* op = dynamic_cast<framework::OperatorWithKernel*>(ops[i].get());
+      if (run == 0 && op != nullptr) {
+        model->kernel_types[i].reset(
+            new framework::OpKernelType(op->ExpectedKernelType(local, place)));
+      }
+      arena.BeginOp(i);
+      ops[i]->Run(local, place);
+      arena.EndOp();
+    }
+    arena.EndRun();
+  }
+  PADDLE_ENFORCE(arena.planned(),
+                 "The runs of the sample feeds do not allocate the same "
+                 "memory");
+  model->arena_plan = arena.plan();
+  ctx.reset();
+  scope->DeleteScope(&local);
+}
+
+static void WriteArenaPlan(std::ostream& os, const ArenaPlan& plan) {
+  WriteValue(os, static_cast<uint64_t>(plan.temporary_bytes));
+  WriteValue(os, static_cast<uint64_t>(plan.temporaries.size()));
+  for (auto& tmp : plan.temporaries) {
+    WriteString(os, tmp.name);
+    WriteValue(os, static_cast<uint64_t>(tmp.offset));
+    WriteValue(os, static_cast<uint64_t>(tmp.size));
+  }
+  WriteValue(os, static_cast<uint64_t>(plan.scratch_bytes));
+  WriteValue(os, static_cast<uint64_t>(plan.peak_live_bytes));
+  WriteValue(os, static_cast<uint64_t>(plan.scratch.size()));
+  for (auto& op_scratch : plan.scratch) {
+    WriteValue(os, static_cast<uint64_t>(op_scratch.size()));
+    for (auto& scratch : op_scratch) {
+      WriteValue(os, static_cast<uint64_t>(scratch.size));
+      WriteValue(os, static_cast<uint64_t>(scratch.offset));
+    }
+  }
+}
+
+static void ReadArenaPlan(std::istream& is, ArenaPlan* plan) {
+  plan->temporary_bytes = ReadValue<uint64_t>(is);
+  plan->temporaries.resize(ReadValue<uint64_t>(is));
+  for (auto& tmp : plan->temporaries) {
+    tmp.name = ReadString(is);
+    tmp.offset = ReadValue<uint64_t>(is);
+    tmp.size = ReadValue<uint64_t>(is);
+  }
+  plan->scratch_bytes = ReadValue<uint64_t>(is);
+  plan->peak_live_bytes = ReadValue<uint64_t>(is);
+  plan->scratch.resize(ReadValue<uint64_t>(is));
+  for (auto& op_scratch : plan->scratch) {
+    op_scratch.resize(ReadValue<uint64_t>(is));
+    for (auto& scratch : op_scratch) {
+      scratch.size = ReadValue<uint64_t>(is);
+      scratch.offset = ReadValue<uint64_t>(is);
+    }
+  }
+}
+
+void CompileModel(framework::ProgramDesc* program, framework::Scope* scope,
+                  const std::vector<framework::LoDTensor>& sample_feeds,
+                  const std::string& path) {
+  OptimizeProgram(scope, program);
+  FuseProgram(scope, program);
+  CompiledModel model;
+  Calibrate(*program, scope, sample_feeds, &model);
+
+  std::vector<std::string> params;
+  for (auto* var : program->Block(0).AllVars()) {
+    if (!IsParameter(*var)) continue;
+    PADDLE_ENFORCE(scope->FindVar(var->Name()) != nullptr,
+                   "The parameter %s is not loaded", var->Name());
+    params.push_back(var->Name());
+  }
+
+  std::ofstream fout(path, std::ios::binary);
+  PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot open %s to write", path);
+  WriteValue(fout, kCompiledModelMagic);
+  WriteValue(fout, static_cast<uint32_t>(0));
+  WriteString(fout, program->Proto()->SerializeAsString());
+  WriteValue(fout, static_cast<uint64_t>(model.kernel_types.size()));
+  for (auto& kernel_type : model.kernel_types) {
+    if (kernel_type == nullptr) {
+      WriteValue(fout, static_cast<int32_t>(-1));
+      continue;
+    }
+    WriteValue(fout, static_cast<int32_t>(kernel_type->data_type_));
+    WriteValue(fout, static_cast<int32_t>(kernel_type->data_layout_));
+    WriteValue(fout, static_cast<int32_t>(kernel_type->library_type_));
+  }
+  WriteArenaPlan(fout, model.arena_plan);
+  WriteValue(fout, static_cast<uint64_t>(params.size()));
+  for (auto& name : params) WriteString(fout, name);
+
+  platform::CPUPlace place;
+  auto& dev_ctx = *platform::DeviceContextPool::Instance().Get(place);
+  framework::WriteMappedTensorHeader(fout, params.size());
+  for (auto& name : params) {
+    framework::SerializeToMappedStream(
+        fout, scope->FindVar(name)->Get<framework::LoDTensor>(), dev_ctx);
+  }
+  PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot write the compiled model %s",
+                 path);
+}
+
+void CompileModel(const std::string& dirname,
+                  const std::vector<framework::LoDTensor>& sample_feeds,
+                  const std::string& path) {
+  platform::CPUPlace place;
+  framework::Executor executor(place);
+  framework::Scope scope;
+  auto program = Load(executor, scope, dirname);
+  CompileModel(program.get(), &scope, sample_feeds, path);
+}
+
+CompiledModel ReadCompiledModel(const std::string& path) {
+  std::ifstream fin(path, std::ios::binary);
+  PADDLE_ENFORCE(static_cast<bool>(fin), "Cannot open file %s", path);
+  PADDLE_ENFORCE_EQ(ReadValue<uint64_t>(fin), kCompiledModelMagic,
+                    "%s is not a compiled model", path);
+  PADDLE_ENFORCE_EQ(ReadValue<uint32_t>(fin), 0U,
+                    "Only version 0 is supported");
+  CompiledModel model;
+  model.program.reset(new framework::ProgramDesc(ReadString(fin)));
+
+  platform::CPUPlace place;
+  model.kernel_types.resize(ReadValue<uint64_t>(fin));
+  for (auto& kernel_type : model.kernel_types) {
+    int32_t data_type = ReadValue<int32_t>(fin);
+    if (data_type < 0) continue;
+    auto layout = static_cast<framework::DataLayout>(ReadValue<int32_t>(fin));
+    auto library =
+        static_cast<framework::LibraryType>(ReadValue<int32_t>(fin));
+    kernel_type.reset(new framework::OpKernelType(
+        static_cast<framework::proto::VarType::Type>(data_type), place, layout,
+        library));
+  }
+  ReadArenaPlan(fin, &model.arena_plan);
+  std::vector<std::string> params(ReadValue<uint64_t>(fin));
+  for (auto& name : params) name = ReadString(fin);
+  size_t offset = static_cast<size_t>(fin.tellg());
+  fin.close();
+
+  framework::MappedTensorReader reader(path, offset);
+  PADDLE_ENFORCE_EQ(reader.size(), params.size(),
+                    "The number of the parameters of %s does not match",
+                    path);
+  model.scope.reset(new framework::Scope);
+  auto& dev_ctx = *platform::DeviceContextPool::Instance().Get(place);
+  for (auto& name : params) {
+    auto* tensor = model.scope->Var(name)->GetMutable<framework::LoDTensor>();
+    reader.Next(tensor, true, place, dev_ctx);
+  }
+  return model;
+}
+
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,76 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_kernel_type.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/inference/frozen_arena.h"
+
+namespace paddle {
+namespace inference {
+
+// A model compiled ahead of time into one file, which a Predictor serves
+// without running the load operators or the optimization passes, and
+// without choosing the kernels or planning the memory in the first runs.
+// The file is
+//   uint64_t magic, kCompiledModelMagic
+//   uint32_t version, 0
+//   uint64_t size and the bytes of the ProgramDesc, optimized and fused,
+//            with the feed and fetch operators
+//   uint64_t the number of the operators of block 0, and for every one
+//            int32_t the data type of its kernel, or -1 without a kernel,
+//            int32_t the layout and int32_t the library of the kernel
+//   the ArenaPlan recorded by running the sample feeds
+//   uint64_t the number of the parameters and their names
+//   the parameters in the aligned format of mapped_tensor_file.h
+// The parameters are loaded by mapping the file, so they are shared by all
+// the processes serving it. The program is still parsed once to create the
+// operators. Only CPUPlace is supported.
+constexpr uint64_t kCompiledModelMagic = 0x3130504D43444150ULL;  // PADCMP01
+
+struct CompiledModel {
+  std::unique_ptr<framework::ProgramDesc> program;
+  // the parameters
+  std::unique_ptr<framework::Scope> scope;
+  // the kernel of every operator of block 0, nullptr for the operators
+  // without kernels
+  std::vector<std::unique_ptr<framework::OpKernelType>> kernel_types;
+  ArenaPlan arena_plan;
+};
+
+// Optimize and fuse program, whose parameters are loaded in scope, run it
+// on sample_feeds to choose the kernels and plan the memory, and write it
+// to the file at path. The program should have the feed and fetch
+// operators, and the feeds to serve should have the data types of
+// sample_feeds. The feeds of other shapes run, but plan the memory again.
+void CompileModel(framework::ProgramDesc* program, framework::Scope* scope,
+                  const std::vector<framework::LoDTensor>& sample_feeds,
+                  const std::string& path);
+
+// Compile the model saved by fluid.io.save_inference_model in dirname.
+void CompileModel(const std::string& dirname,
+                  const std::vector<framework::LoDTensor>& sample_feeds,
+                  const std::string& path);
+
+// Read the model compiled at path, to be served by Predictor.
+CompiledModel ReadCompiledModel(const std::string& path);
+
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,226 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/compiled_model.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/executor.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/inference/predictor.h"
+
+USE_OP(mul);
+USE_OP(elementwise_add);
+USE_OP(relu);
+USE_CPU_ONLY_OP(fused_fc);
+USE_NO_KERNEL_OP(feed);
+USE_NO_KERNEL_OP(fetch);
+USE_NO_KERNEL_OP(save);
+USE_NO_KERNEL_OP(load);
+
+namespace f = paddle::framework;
+namespace inference = paddle::inference;
+
+static const char kDirname[] = "compiled_model_test";
+static const char kCompiled[] = "compiled_model_test.bin";
+
+static void AddVar(const std::string& name, f::proto::VarType::Type type,
+                   bool persistable, f::BlockDesc* block) {
+  auto* var = block->Var(name);
+  var->SetType(type);
+  // the feed and fetch lists have no data type
+  if (type == f::proto::VarType::LOD_TENSOR) {
+    var->SetDataType(f::proto::VarType::FP32);
+  }
+  var->SetPersistable(persistable);
+}
+
+static void AddOp(const std::string& type, const f::VariableNameMap& inputs,
+                  const f::VariableNameMap& outputs,
+                  const f::AttributeMap& attrs, f::BlockDesc* block) {
+  auto* op = block->AppendOp();
+  op->SetType(type);
+  for (auto& kv : inputs) op->SetInput(kv.first, kv.second);
+  for (auto& kv : outputs) op->SetOutput(kv.first, kv.second);
+  op->SetAttrMap(attrs);
+  op->CheckAttrs();
+}
+
+static void FillParam(const std::string& name, const f::DDim& dims, int seed,
+                      f::Scope* scope) {
+  auto* tensor = scope->Var(name)->GetMutable<f::LoDTensor>();
+  float* data = tensor->mutable_data<float>(dims, paddle::platform::CPUPlace());
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = static_cast<float>((i * 7 + seed) % 13 - 6) / dims[0];
+  }
+}
+
+// Save the model of depth layers of relu(x * w_i + b_i) in kDirname as
+// fluid.io.save_inference_model, every w_i is [width, width].
+static void SaveModel(int width, int depth) {
+  f::ProgramDesc program;
+  f::ProgramDesc save_program;
+  f::Scope scope;
+  auto* block = program.MutableBlock(0);
+  auto* save_block = save_program.MutableBlock(0);
+  AddVar("feed", f::proto::VarType::FEED_MINIBATCH, true, block);
+  AddVar("fetch", f::proto::VarType::FETCH_LIST, true, block);
+  AddVar("h0", f::proto::VarType::LOD_TENSOR, false, block);
+  AddOp("feed", {{"X", {"feed"}}}, {{"Out", {"h0"}}}, {{"col", 0}}, block);
+  for (int d = 0; d < depth; ++d) {
+    auto i = std::to_string(d);
+    auto in = "h" + i, out = "h" + std::to_string(d + 1);
+    for (auto& name : {"mul" + i, "add" + i, out}) {
+      AddVar(name, f::proto::VarType::LOD_TENSOR, false, block);
+    }
+    for (auto& name : {"w" + i, "b" + i}) {
+      AddVar(name, f::proto::VarType::LOD_TENSOR, true, block);
+      AddVar(name, f::proto::VarType::LOD_TENSOR, true, save_block);
+      AddOp("save", {{"X", {name}}}, {},
+            {{"file_path", std::string(kDirname) + "/" + name}}, save_block);
+    }
+    AddOp("mul", {{"X", {in}}, {"Y", {"w" + i}}}, {{"Out", {"mul" + i}}}, {},
+          block);
+    AddOp("elementwise_add", {{"X", {"mul" + i}}, {"Y", {"b" + i}}},
+          {{"Out", {"add" + i}}}, {{"axis", 1}}, block);
+    AddOp("relu", {{"X", {"add" + i}}}, {{"Out", {out}}}, {}, block);
+    FillParam("w" + i, f::make_ddim({width, width}), d, &scope);
+    FillParam("b" + i, f::make_ddim({width}), d + 1, &scope);
+  }
+  AddOp("fetch", {{"X", {"h" + std::to_string(depth)}}}, {{"Out", {"fetch"}}},
+        {{"col", 0}}, block);
+
+  paddle::platform::CPUPlace place;
+  f::Executor executor(place);
+  executor.Run(save_program, &scope, 0, false, false);
+  std::ofstream fout(std::string(kDirname) + "/__model__", std::ios::binary);
+  fout << program.Proto()->SerializeAsString();
+}
+
+static std::vector<f::LoDTensor> MakeFeeds(int rows, int width, int seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  std::vector<f::LoDTensor> feeds(1);
+  float* x = feeds[0].mutable_data<float>(f::make_ddim({rows, width}),
+                                          paddle::platform::CPUPlace());
+  for (int i = 0; i < rows * width; ++i) x[i] = dist(rng);
+  return feeds;
+}
+
+static void ExpectNear(const f::LoDTensor& expected,
+                       const f::LoDTensor& actual) {
+  ASSERT_EQ(actual.dims(), expected.dims());
+  for (int64_t i = 0; i < expected.numel(); ++i) {
+    EXPECT_NEAR(actual.data<float>()[i], expected.data<float>()[i], 1e-4);
+  }
+}
+
+TEST(CompiledModel, Run) {
+  const int width = 16, depth = 4, batch = 3;
+  SaveModel(width, depth);
+  paddle::platform::CPUPlace place;
+  inference::Predictor predictor(place, kDirname);
+  inference::CompileModel(kDirname, MakeFeeds(batch, width, 0), kCompiled);
+
+  auto compiled_model = inference::ReadCompiledModel(kCompiled);
+  // mul and elementwise_add are fused
+  EXPECT_EQ(compiled_model.kernel_types.size(),
+            static_cast<size_t>(2 * depth + 2));
+  inference::Predictor compiled(std::move(compiled_model));
+  auto clone = compiled.Clone();
+  EXPECT_EQ(compiled.MemoryStats().plans, 1);
+  for (int r = 0; r < 6; ++r) {
+    // the shapes change once, the arena is planned again
+    auto feeds = MakeFeeds(r < 3 ? batch : 2 * batch, width, r);
+    std::vector<f::LoDTensor> expected, fetchs, clone_fetchs;
+    predictor.Run(feeds, &expected);
+    int64_t allocs = compiled.MemoryStats().allocs;
+    compiled.Run(feeds, &fetchs);
+    ExpectNear(expected[0], fetchs[0]);
+    clone->Run(feeds, &clone_fetchs);
+    ExpectNear(expected[0], clone_fetchs[0]);
+    // the arena is served from the first run, which only allocates the
+    // fetch
+    if (r == 0) EXPECT_LE(compiled.MemoryStats().allocs, allocs + 1);
+    if (r == 1 || r == 2) EXPECT_EQ(compiled.MemoryStats().allocs, allocs);
+  }
+  EXPECT_EQ(compiled.MemoryStats().plans, 2);
+}
+
+TEST(CompiledModel, NotCompiled) {
+  std::ofstream(kCompiled, std::ios::binary) << "not a compiled model";
+  EXPECT_THROW(inference::ReadCompiledModel(kCompiled),
+               paddle::platform::EnforceNotMet);
+}
+
+// The first run of a predictor loaded from the compiled model, which is
+// served from the recorded arena, fetches what the first run of the
+// predictor loaded from the model directory does.
+TEST(CompiledModel, FirstInference) {
+  const int width = 32, depth = 3;
+  SaveModel(width, depth);
+  inference::CompileModel(kDirname, MakeFeeds(1, width, 0), kCompiled);
+  paddle::platform::CPUPlace place;
+  auto feeds = MakeFeeds(1, width, 1);
+  std::vector<f::LoDTensor> expected, fetchs;
+  inference::Predictor(place, kDirname).Run(feeds, &expected);
+  inference::Predictor(inference::ReadCompiledModel(kCompiled))
+      .Run(feeds, &fetchs);
+  ASSERT_EQ(fetchs.size(), 1UL);
+  ExpectNear(expected[0], fetchs[0]);
+}
+
+// The time to load a model and run the first feed, the best of repeat.
+template <typename Load>
+static double TimeToFirstInference(Load load, int width, int repeat) {
+  auto feeds = MakeFeeds(1, width, 0);
+  double best = 0;
+  for (int r = 0; r < repeat; ++r) {
+    auto begin = std::chrono::steady_clock::now();
+    std::unique_ptr<inference::Predictor> predictor(load());
+    std::vector<f::LoDTensor> fetchs;
+    predictor->Run(feeds, &fetchs);
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - begin;
+    if (r == 0 || elapsed.count() < best) best = elapsed.count();
+  }
+  return best;
+}
+
+// Logs the time to the first inference of a model of 16 fc of 512 loaded
+// from the directory and from the compiled model. It checks nothing, run it
+// with --gtest_also_run_disabled_tests.
+TEST(CompiledModel, DISABLED_TimeToFirstInference) {
+  const int width = 512, depth = 16, repeat = 5;
+  SaveModel(width, depth);
+  inference::CompileModel(kDirname, MakeFeeds(1, width, 0), kCompiled);
+  paddle::platform::CPUPlace place;
+  double loaded = TimeToFirstInference(
+      [&place] { return new inference::Predictor(place, kDirname); }, width,
+      repeat);
+  double compiled = TimeToFirstInference(
+      [] {
+        return new inference::Predictor(
+            inference::ReadCompiledModel(kCompiled));
+      },
+      width, repeat);
+  LOG(INFO) << "time to first inference: " << loaded << " ms loaded, "
+            << compiled << " ms compiled";
+}
@@ -0,0 +1,443 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/frozen_arena.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/memory/memory.h"
+
+namespace paddle {
+namespace inference {
+
+static const size_t kNoOp = std::numeric_limits<size_t>::max();
+static const size_t kArenaAlignment = 64;
+
+static size_t AlignArena(size_t size) {
+  return (size + kArenaAlignment - 1) / kArenaAlignment * kArenaAlignment;
+}
+
+static std::shared_ptr<uint8_t> AllocArena(size_t size) {
+  platform::CPUPlace cpu;
+  auto* ptr = static_cast<uint8_t*>(memory::Alloc(cpu, size));
+  PADDLE_ENFORCE_NOT_NULL(ptr, "Insufficient CPU memory for the arena.");
+  return std::shared_ptr<uint8_t>(
+      ptr, memory::PODDeleter<uint8_t, platform::CPUPlace>(cpu));
+}
+
+FrozenArena::FrozenArena(
+    const framework::ProgramDesc& program,
+    const std::vector<std::unique_ptr<framework::OperatorBase>>& ops,
+    framework::Scope* scope, const std::vector<std::string>& temporaries)
+    : ops_(ops),
+      scope_(scope),
+      mode_(kCount),
+      in_run_(false),
+      op_idx_(kNoOp),
+      alloc_idx_(0),
+      diverged_(false),
+      escaped_(false),
+      temporary_bytes_(0) {
+  std::unordered_map<std::string, size_t> index;
+  for (auto& name : temporaries) {
+    index[name] = temporaries_.size();
+    temporaries_.push_back({name, kNoOp, 0, false});
+  }
+  auto touch = [&](const std::string& name, size_t op_idx, bool read) {
+    auto it = index.find(name);
+    if (it == index.end()) return;
+    auto& tmp = temporaries_[it->second];
+    if (tmp.first == kNoOp) {
+      tmp.first = op_idx;
+      tmp.carried = read;
+    }
+    tmp.last = op_idx;
+  };
+  for (size_t i = 0; i < ops_.size(); ++i) {
+    for (auto& input : ops_[i]->Inputs()) {
+      for (auto& name : input.second) touch(name, i, true);
+    }
+    for (auto& output : ops_[i]->Outputs()) {
+      for (auto& name : output.second) touch(name, i, false);
+    }
+  }
+  // the variables used by the sub-blocks live in the whole run
+  std::unordered_set<std::string> used_by_blocks;
+  for (size_t b = 1; b < program.Size(); ++b) {
+    for (auto* op : program.Block(b).AllOps()) {
+      for (auto& name : op->InputArgumentNames()) used_by_blocks.insert(name);
+      for (auto& name : op->OutputArgumentNames()) used_by_blocks.insert(name);
+    }
+  }
+  for (auto& tmp : temporaries_) {
+    if (tmp.first == kNoOp) continue;
+    if (tmp.carried || used_by_blocks.count(tmp.name)) {
+      tmp.carried = true;
+      tmp.first = 0;
+      tmp.last = ops_.size() - 1;
+    }
+  }
+}
+
+void FrozenArena::Freeze() {
+  if (mode_ == kCount) mode_ = kRecordTemporaries;
+}
+
+void FrozenArena::BeginRun() {
+  // plan again if the last run failed
+  if (in_run_ && mode_ != kCount) mode_ = kRecordTemporaries;
+  in_run_ = true;
+  op_idx_ = kNoOp;
+  diverged_ = false;
+  extras_.clear();
+  if (mode_ == kRecordTemporaries) {
+    // release the temporaries, so they allocate their memory in this run
+    for (auto& tmp : temporaries_) {
+      if (tmp.first == kNoOp || tmp.carried) continue;
+      auto* var = scope_->FindVar(tmp.name);
+      if (var != nullptr && var->IsType<framework::LoDTensor>()) {
+        *var->GetMutable<framework::LoDTensor>() = framework::LoDTensor();
+      }
+    }
+  }
+  if (mode_ == kRecordTemporaries || mode_ == kRecordScratch) {
+    records_.assign(ops_.size(), std::vector<Record>());
+  }
+}
+
+void FrozenArena::BeginOp(size_t op_idx) {
+  op_idx_ = op_idx;
+  alloc_idx_ = 0;
+}
+
+void FrozenArena::EndOp() {
+  if (mode_ == kRecordTemporaries || mode_ == kRecordScratch) {
+    for (auto& record : records_[op_idx_]) {
+      record.escaped = !record.alive.expired();
+    }
+  } else if (mode_ == kReplay) {
+    auto& slots = slots_[op_idx_];
+    if (alloc_idx_ < slots.size()) diverged_ = true;
+    if (!extras_.empty() && !diverged_) CheckExtras();
+    extras_.clear();
+    for (auto& slot : slots) {
+      if (slot.ptr != nullptr && slot.keep_alive.use_count() > 1) {
+        // the block may be overwritten by the next operators, serve no
+        // more scratch blocks until the arena is planned again
+        escaped_ = true;
+      }
+    }
+  }
+  op_idx_ = kNoOp;
+}
+
+void FrozenArena::EndRun() {
+  in_run_ = false;
+  ++stats_.runs;
+  switch (mode_) {
+    case kRecordTemporaries:
+      PlanTemporaries();
+      records_.clear();
+      mode_ = kRecordScratch;
+      break;
+    case kRecordScratch:
+      PlanScratch();
+      records_.clear();
+      mode_ = kReplay;
+      break;
+    case kReplay:
+      if (diverged_ || escaped_) {
+        VLOG(3) << "The runs allocate other than recorded, plan the arena "
+                   "again";
+        mode_ = kRecordTemporaries;
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void* FrozenArena::Allocate(size_t size, std::shared_ptr<void>* keep_alive) {
+  if (mode_ == kCount || op_idx_ == kNoOp) {
+    ++stats_.allocs;
+    return nullptr;
+  }
+  if (mode_ == kRecordTemporaries || mode_ == kRecordScratch) {
+    platform::CPUPlace cpu;
+    auto* ptr = static_cast<uint8_t*>(memory::Alloc(cpu, size));
+    PADDLE_ENFORCE_NOT_NULL(ptr, "Insufficient CPU memory to allocation.");
+    keep_alive->reset(ptr,
+                      memory::PODDeleter<uint8_t, platform::CPUPlace>(cpu));
+    records_[op_idx_].push_back({ptr, size, *keep_alive, false});
+    ++stats_.allocs;
+    return ptr;
+  }
+  auto& slots = slots_[op_idx_];
+  if (!diverged_ && alloc_idx_ >= slots.size()) {
+    // allocated after the recorded blocks, e.g. the first fetch of a
+    // restored plan, the plan holds if the block outlives the operator
+    platform::CPUPlace cpu;
+    auto* ptr = static_cast<uint8_t*>(memory::Alloc(cpu, size));
+    PADDLE_ENFORCE_NOT_NULL(ptr, "Insufficient CPU memory to allocation.");
+    keep_alive->reset(ptr,
+                      memory::PODDeleter<uint8_t, platform::CPUPlace>(cpu));
+    extras_.push_back({ptr, size, *keep_alive, true});
+    ++alloc_idx_;
+    ++stats_.allocs;
+    return ptr;
+  }
+  if (diverged_ || slots[alloc_idx_].size != size) {
+    diverged_ = true;
+    ++stats_.allocs;
+    return nullptr;
+  }
+  auto& slot = slots[alloc_idx_++];
+  if (slot.ptr == nullptr || escaped_) {
+    ++stats_.allocs;
+    return nullptr;
+  }
+  *keep_alive = slot.keep_alive;
+  ++stats_.arena_allocs;
+  return slot.ptr;
+}
+
+void FrozenArena::CheckExtras() {
+  for (auto& extra : extras_) {
+    // a new scratch block
+    if (extra.alive.expired()) diverged_ = true;
+  }
+  auto& op = *ops_[op_idx_];
+  for (auto& output : op.Outputs()) {
+    for (auto& name : output.second) {
+      auto* var = scope_->FindVar(name);
+      if (var == nullptr || !var->IsType<framework::LoDTensor>()) continue;
+      auto& tensor = var->Get<framework::LoDTensor>();
+      if (!tensor.IsInitialized()) continue;
+      // an output outgrows its memory in the arena
+      auto* ptr = tensor.data<void>();
+      for (auto& extra : extras_) {
+        if (ptr == extra.ptr) diverged_ = true;
+      }
+    }
+  }
+}
+
+// A block of the arena, which lives in the operators [first, last].
+struct ArenaItem {
+  size_t size;
+  size_t first;
+  size_t last;
+  size_t offset;
+};
+
+// Assign every item the lowest offset which does not overlap the items
+// placed before whose lives overlap, the larger items are placed first.
+// Return the size of the region.
+static size_t PackArenaItems(std::vector<ArenaItem>* items) {
+  std::vector<ArenaItem*> order;
+  for (auto& item : *items) order.push_back(&item);
+  std::stable_sort(order.begin(), order.end(),
+                   [](const ArenaItem* a, const ArenaItem* b) {
+                     return a->size > b->size;
+                   });
+  size_t total = 0;
+  std::vector<ArenaItem*> placed;
+  std::vector<ArenaItem*> conflicts;
+  for (auto* item : order) {
+    conflicts.clear();
+    for (auto* other : placed) {
+      if (other->first <= item->last && item->first <= other->last) {
+        conflicts.push_back(other);
+      }
+    }
+    std::sort(conflicts.begin(), conflicts.end(),
+              [](const ArenaItem* a, const ArenaItem* b) {
+                return a->offset < b->offset;
+              });
+    size_t offset = 0;
+    for (auto* other : conflicts) {
+      if (offset + item->size <= other->offset) break;
+      offset = std::max(offset, other->offset + other->size);
+    }
+    item->offset = offset;
+    total = std::max(total, offset + item->size);
+    placed.push_back(item);
+  }
+  return total;
+}
+
+void FrozenArena::PlanTemporaries() {
+  // the blocks still held after the run
+  std::vector<const Record*> blocks;
+  for (auto& op_records : records_) {
+    for (auto& record : op_records) {
+      if (!record.alive.expired()) blocks.push_back(&record);
+    }
+  }
+  std::sort(blocks.begin(), blocks.end(),
+            [](const Record* a, const Record* b) { return a->ptr < b->ptr; });
+
+  // the temporaries in every block
+  struct Member {
+    const std::string* name;
+    framework::LoDTensor* tensor;
+    size_t offset;
+    size_t size;
+  };
+  std::vector<std::vector<Member>> members(blocks.size());
+  std::vector<ArenaItem> items(blocks.size(), {0, kNoOp, 0, 0});
+  for (auto& tmp : temporaries_) {
+    if (tmp.first == kNoOp) continue;
+    auto* var = scope_->FindVar(tmp.name);
+    if (var == nullptr || !var->IsType<framework::LoDTensor>()) continue;
+    auto* tensor = var->GetMutable<framework::LoDTensor>();
+    if (!tensor->IsInitialized() || tensor->memory_size() == 0) continue;
+    auto* ptr = static_cast<uint8_t*>(tensor->data<void>());
+    auto it = std::upper_bound(
+        blocks.begin(), blocks.end(), ptr,
+        [](uint8_t* p, const Record* r) { return p < r->ptr; });
+    if (it == blocks.begin()) continue;
+    size_t b = static_cast<size_t>(it - blocks.begin()) - 1;
+    auto* begin = static_cast<uint8_t*>(blocks[b]->ptr);
+    if (ptr + tensor->memory_size() > begin + blocks[b]->size) continue;
+    members[b].push_back({&tmp.name, tensor,
+                          static_cast<size_t>(ptr - begin),
+                          tensor->memory_size()});
+    auto& item = items[b];
+    item.size = AlignArena(blocks[b]->size);
+    item.first = std::min(item.first, tmp.first);
+    item.last = std::max(item.last, tmp.last);
+  }
+
+  std::vector<ArenaItem> planned;
+  std::vector<size_t> planned_blocks;
+  for (size_t b = 0; b < blocks.size(); ++b) {
+    if (members[b].empty()) continue;
+    planned.push_back(items[b]);
+    planned_blocks.push_back(b);
+  }
+  temporary_bytes_ = PackArenaItems(&planned);
+  temporary_buffer_.reset();
+  if (temporary_bytes_ > 0) temporary_buffer_ = AllocArena(temporary_bytes_);
+
+  plan_.temporary_bytes = temporary_bytes_;
+  plan_.temporaries.clear();
+  live_bytes_.assign(ops_.size(), 0);
+  for (size_t i = 0; i < planned.size(); ++i) {
+    auto& item = planned[i];
+    for (size_t op = item.first; op <= item.last; ++op) {
+      live_bytes_[op] += item.size;
+    }
+    auto* block = blocks[planned_blocks[i]];
+    uint8_t* base = temporary_buffer_.get() + item.offset;
+    std::memcpy(base, block->ptr, block->size);
+    for (auto& member : members[planned_blocks[i]]) {
+      plan_.temporaries.push_back(
+          {*member.name, item.offset + member.offset, member.size});
+      uint8_t* ptr = base + member.offset;
+      member.tensor->ShareExternalData(
+          ptr, member.size, member.tensor->type(),
+          std::shared_ptr<void>(temporary_buffer_, ptr));
+    }
+  }
+  VLOG(3) << "Planned " << planned.size() << " blocks of temporaries in "
+          << temporary_bytes_ << " bytes";
+}
+
+void FrozenArena::PlanScratch() {
+  plan_.scratch.assign(ops_.size(), std::vector<ArenaPlan::Scratch>());
+  plan_.scratch_bytes = 0;
+  plan_.peak_live_bytes = 0;
+  for (size_t op = 0; op < ops_.size(); ++op) {
+    size_t offset = 0;
+    for (auto& record : records_[op]) {
+      // the blocks held after the operator return fall back
+      plan_.scratch[op].push_back(
+          {record.size, record.escaped ? kNoArenaOffset : offset});
+      if (!record.escaped) offset += AlignArena(record.size);
+    }
+    plan_.scratch_bytes = std::max(plan_.scratch_bytes, offset);
+    plan_.peak_live_bytes =
+        std::max(plan_.peak_live_bytes, live_bytes_[op] + offset);
+  }
+  ServeScratch();
+  VLOG(3) << "Planned the scratch blocks in " << plan_.scratch_bytes
+          << " bytes";
+}
+
+void FrozenArena::ServeScratch() {
+  slots_.assign(ops_.size(), std::vector<Slot>());
+  scratch_buffer_.reset();
+  if (plan_.scratch_bytes > 0) {
+    scratch_buffer_ = AllocArena(plan_.scratch_bytes);
+  }
+  for (size_t op = 0; op < ops_.size(); ++op) {
+    for (auto& scratch : plan_.scratch[op]) {
+      slots_[op].push_back({scratch.size, nullptr, std::shared_ptr<void>()});
+      if (scratch.offset == kNoArenaOffset) continue;
+      auto& slot = slots_[op].back();
+      slot.ptr = scratch_buffer_.get() + scratch.offset;
+      // a control block for every slot, to count the tensors holding it
+      auto buffer = scratch_buffer_;
+      slot.keep_alive = std::shared_ptr<void>(slot.ptr, [buffer](void*) {});
+    }
+  }
+  escaped_ = false;
+  ++stats_.plans;
+  stats_.peak_live_bytes = plan_.peak_live_bytes;
+  stats_.arena_bytes = temporary_bytes_ + plan_.scratch_bytes;
+}
+
+void FrozenArena::Restore(const ArenaPlan& plan) {
+  PADDLE_ENFORCE_EQ(plan.scratch.size(), ops_.size(),
+                    "The arena plan is of another program");
+  for (auto& op_scratch : plan.scratch) {
+    for (auto& scratch : op_scratch) {
+      PADDLE_ENFORCE(scratch.offset == kNoArenaOffset ||
+                         (scratch.offset <= plan.scratch_bytes &&
+                          scratch.size <= plan.scratch_bytes - scratch.offset),
+                     "The scratch block is out of the arena");
+    }
+  }
+  plan_ = plan;
+
+  temporary_bytes_ = plan_.temporary_bytes;
+  temporary_buffer_.reset();
+  if (temporary_bytes_ > 0) temporary_buffer_ = AllocArena(temporary_bytes_);
+  for (auto& tmp : plan_.temporaries) {
+    PADDLE_ENFORCE(tmp.offset <= temporary_bytes_ &&
+                       tmp.size <= temporary_bytes_ - tmp.offset,
+                   "The temporary %s is out of the arena", tmp.name);
+    auto* var = scope_->FindVar(tmp.name);
+    PADDLE_ENFORCE(var != nullptr && var->IsType<framework::LoDTensor>(),
+                   "The temporary %s of the arena plan is not found",
+                   tmp.name);
+    // the kernels writing the temporary keep the memory, which fits
+    auto* tensor = var->GetMutable<framework::LoDTensor>();
+    uint8_t* ptr = temporary_buffer_.get() + tmp.offset;
+    tensor->Resize(framework::make_ddim({static_cast<int64_t>(tmp.size)}));
+    tensor->ShareExternalData(ptr, tmp.size, typeid(uint8_t),
+                              std::shared_ptr<void>(temporary_buffer_, ptr));
+  }
+  ServeScratch();
+  records_.clear();
+  mode_ = kReplay;
+}
+
+}  // namespace inference
+}  // namespace paddle
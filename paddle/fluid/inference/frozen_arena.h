@@ -0,0 +1,184 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/tensor_arena.h"
+#include "paddle/fluid/platform/macros.h"
+
+namespace paddle {
+namespace inference {
+
+struct ArenaStats {
+  int64_t runs = 0;
+  // The tensors allocated by memory::Alloc in the runs.
+  int64_t allocs = 0;
+  // The tensors served by the arena.
+  int64_t arena_allocs = 0;
+  // How many times the arena was planned.
+  int64_t plans = 0;
+  size_t arena_bytes = 0;
+  // The most bytes of the arena used by one operator.
+  size_t peak_live_bytes = 0;
+};
+
+// The layout of a frozen arena, which can be saved with the model so that
+// the arena of another predictor of the program replays it from the first
+// run.
+struct ArenaPlan {
+  // The memory of a temporary at offset of the temporary region.
+  struct Temporary {
+    std::string name;
+    size_t offset;
+    size_t size;
+  };
+  // A scratch block at offset of the scratch region, or kNoArenaOffset if it
+  // falls back to memory::Alloc.
+  struct Scratch {
+    size_t size;
+    size_t offset;
+  };
+
+  size_t temporary_bytes = 0;
+  std::vector<Temporary> temporaries;
+  size_t scratch_bytes = 0;
+  // the scratch blocks of every operator in the order of allocation
+  std::vector<std::vector<Scratch>> scratch;
+  size_t peak_live_bytes = 0;
+};
+
+constexpr size_t kNoArenaOffset = static_cast<size_t>(-1);
+
+// The memory of the runs of a predictor, which is recorded and frozen in
+// one arena once the predictor is frozen.
+//
+// Until frozen, the arena only counts the allocations. Then it records two
+// runs. In the first one the temporaries of the program allocate their
+// memory again, the blocks which hold them after the run are packed in
+// the arena by the operators they live in, so the temporaries whose
+// lives do not overlap share memory, and the temporaries are moved there.
+// In the second one the scratch memory of the kernels, which is released
+// before the operator returns, is recorded by the operator and the order
+// of allocation, and the scratch blocks of every operator are placed one
+// after another at the start of the scratch region. The later runs are
+// served by the arena if they allocate the same sizes in the same order,
+// otherwise the runs fall back to memory::Alloc and the arena is planned
+// again. The blocks an operator allocates after the recorded ones, e.g. the
+// fetches of the first run of a restored plan, fall back without planning
+// again unless the LoDTensor outputs of the operator hold them.
+class FrozenArena : public framework::TensorArena {
+ public:
+  // ops are the prepared operators of block 0 of program, temporaries are
+  // the names of the LoDTensor variables of scope which may be moved to the
+  // arena.
+  FrozenArena(const framework::ProgramDesc& program,
+              const std::vector<std::unique_ptr<framework::OperatorBase>>& ops,
+              framework::Scope* scope,
+              const std::vector<std::string>& temporaries);
+
+  bool frozen() const { return mode_ != kCount; }
+  // Plan the arena on the next runs.
+  void Freeze();
+
+  void BeginRun();
+  void BeginOp(size_t op_idx);
+  void EndOp();
+  void EndRun();
+
+  void* Allocate(size_t size, std::shared_ptr<void>* keep_alive) override;
+
+  const ArenaStats& stats() const { return stats_; }
+
+  // Whether the runs are served by the arena, then plan() is valid.
+  bool planned() const { return mode_ == kReplay; }
+  const ArenaPlan& plan() const { return plan_; }
+  // Replay plan from the next run without recording it, the arena is
+  // planned again if the runs allocate other than the plan.
+  void Restore(const ArenaPlan& plan);
+
+ private:
+  enum Mode { kCount, kRecordTemporaries, kRecordScratch, kReplay };
+
+  // A temporary variable, which lives in the operators [first, last].
+  struct Temporary {
+    std::string name;
+    size_t first;
+    size_t last;
+    // read before it is written, so it holds a value between the runs
+    bool carried;
+  };
+
+  // An allocation of a recorded run.
+  struct Record {
+    void* ptr;
+    size_t size;
+    std::weak_ptr<void> alive;
+    // still held by a tensor when the operator returns
+    bool escaped;
+  };
+
+  // A scratch block of the arena, or an allocation which falls back to
+  // memory::Alloc if ptr is nullptr.
+  struct Slot {
+    size_t size;
+    void* ptr;
+    // held by the tensors of the block, to find the blocks which escape
+    std::shared_ptr<void> keep_alive;
+  };
+
+  void PlanTemporaries();
+  void PlanScratch();
+  // Allocate the scratch region and the slots of plan_.
+  void ServeScratch();
+  // Plan again if a block of extras_ is released in the operator, or held
+  // by a LoDTensor output of the operator.
+  void CheckExtras();
+
+  const std::vector<std::unique_ptr<framework::OperatorBase>>& ops_;
+  framework::Scope* scope_;
+  std::vector<Temporary> temporaries_;
+
+  Mode mode_;
+  bool in_run_;
+  size_t op_idx_;
+  size_t alloc_idx_;
+  // the run does not allocate as recorded
+  bool diverged_;
+  // a scratch block is held after its operator returns
+  bool escaped_;
+
+  std::vector<std::vector<Record>> records_;
+  ArenaPlan plan_;
+  std::vector<std::vector<Slot>> slots_;
+  // the blocks the operator allocates after its slots in a replay
+  std::vector<Record> extras_;
+  std::shared_ptr<uint8_t> temporary_buffer_;
+  std::shared_ptr<uint8_t> scratch_buffer_;
+  // the bytes of the temporaries live in every operator
+  std::vector<size_t> live_bytes_;
+  size_t temporary_bytes_;
+
+  ArenaStats stats_;
+
+  DISABLE_COPY_AND_ASSIGN(FrozenArena);
+};
+
+}  // namespace inference
+}  // namespace paddle
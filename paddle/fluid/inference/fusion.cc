@@ -0,0 +1,290 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/fusion.h"
+
+#include <algorithm>
+#include <cmath>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/operators/math/fused_functors.h"
+
+namespace paddle {
+namespace inference {
+
+namespace {
+
+const char* kActivationTypes[] = {"relu", "sigmoid", "tanh"};
+
+const char* kChainOpTypes[] = {"elementwise_add", "elementwise_sub",
+                               "elementwise_mul", "elementwise_div",
+                               "relu",            "sigmoid",
+                               "tanh"};
+
+}  // namespace
+
+int FCFusePass::Apply(framework::Scope* scope,
+                      framework::ProgramDesc* program) const {
+  auto* block = program->MutableBlock(0);
+  std::unique_ptr<framework::OpGraph> graph(new framework::OpGraph(*block));
+  int count = 0;
+  for (size_t i = 0; i < block->OpSize(); ++i) {
+    auto* mul = block->Op(i);
+    if (mul->Type() != "mul") continue;
+    std::string w = mul->Input("Y")[0];
+    if (!framework::IsParameter(*block, w) ||
+        block->FindVar(w)->GetShape().size() != 2 ||
+        boost::get<int>(mul->GetAttr("y_num_col_dims")) != 1) {
+      continue;
+    }
+    int in_num_col_dims = boost::get<int>(mul->GetAttr("x_num_col_dims"));
+
+    int add_idx = graph->NextInChain(i, "Out", "elementwise_add", "X");
+    if (add_idx < 0) continue;
+    auto* add = block->Op(add_idx);
+    std::string bias = add->Input("Y")[0];
+    int axis = boost::get<int>(add->GetAttr("axis"));
+    if (!framework::IsParameter(*block, bias) ||
+        block->FindVar(bias)->GetShape().size() != 1 ||
+        (axis != -1 && axis != in_num_col_dims)) {
+      continue;
+    }
+
+    std::string activation_type = "identity";
+    int act_idx = -1;
+    for (auto* type : kActivationTypes) {
+      act_idx = graph->NextInChain(add_idx, "Out", type, "X");
+      if (act_idx >= 0) {
+        activation_type = type;
+        break;
+      }
+    }
+
+    std::string input = mul->Input("X")[0];
+    std::vector<size_t> ops = {i, static_cast<size_t>(add_idx)};
+    std::vector<std::string> intermediates = {mul->Output("Out")[0]};
+    std::string out = add->Output("Out")[0];
+    if (act_idx >= 0) {
+      ops.push_back(act_idx);
+      intermediates.push_back(out);
+      out = block->Op(act_idx)->Output("Out")[0];
+    }
+
+    framework::RemoveOps(block, ops);
+    auto* fc = block->InsertOp(i);
+    fc->SetType("fused_fc");
+    fc->SetInput("Input", {input});
+    fc->SetInput("W", {w});
+    fc->SetInput("Bias", {bias});
+    fc->SetOutput("Out", {out});
+    fc->SetAttr("in_num_col_dims", in_num_col_dims);
+    fc->SetAttr("activation_type", activation_type);
+    fc->CheckAttrs();
+    framework::RemoveVars(block, intermediates);
+
+    graph.reset(new framework::OpGraph(*block));
+    ++count;
+  }
+  return count;
+}
+
+int ConvBNFusePass::Apply(framework::Scope* scope,
+                          framework::ProgramDesc* program) const {
+  auto* block = program->MutableBlock(0);
+  std::unique_ptr<framework::OpGraph> graph(new framework::OpGraph(*block));
+  int count = 0;
+  for (size_t i = 0; i < block->OpSize(); ++i) {
+    auto* conv = block->Op(i);
+    if (conv->Type() != "conv2d") continue;
+    // The filter is updated in place, so it should not be shared.
+    std::string filter = conv->Input("Filter")[0];
+    if (!framework::IsParameter(*block, filter) ||
+        graph->Consumers(filter).size() != 1) {
+      continue;
+    }
+    int bn_idx = graph->NextInChain(i, "Output", "batch_norm", "X");
+    if (bn_idx < 0) continue;
+    auto* bn = block->Op(bn_idx);
+    if (!boost::get<bool>(bn->GetAttr("is_test")) ||
+        boost::get<std::string>(bn->GetAttr("data_layout")) != "NCHW") {
+      continue;
+    }
+    bool params_ready = true;
+    for (auto* param : {"Scale", "Bias", "Mean", "Variance"}) {
+      params_ready &= framework::IsParameter(*block, bn->Input(param)[0]);
+    }
+    if (!params_ready) continue;
+
+    // The batch_norm of the inference is
+    //   y = (x - mean) * scale / sqrt(variance + epsilon) + bias
+    // per channel, so it is folded into the filter and a bias.
+    auto* filter_tensor = framework::GetParameter(scope, filter);
+    auto* scale = framework::GetParameter(scope, bn->Input("Scale")[0]);
+    auto* bn_bias = framework::GetParameter(scope, bn->Input("Bias")[0]);
+    auto* mean = framework::GetParameter(scope, bn->Input("Mean")[0]);
+    auto* variance = framework::GetParameter(scope, bn->Input("Variance")[0]);
+    float epsilon = boost::get<float>(bn->GetAttr("epsilon"));
+    int64_t channels = filter_tensor->dims()[0];
+    int64_t channel_numel = filter_tensor->numel() / channels;
+    PADDLE_ENFORCE_EQ(scale->numel(), channels,
+                      "The batch_norm after conv2d should normalize its "
+                      "output channels");
+
+    std::string bias = filter + ".bn_bias";
+    auto* bias_tensor = scope->Var(bias)->GetMutable<framework::LoDTensor>();
+    bias_tensor->Resize(framework::make_ddim({channels}));
+    float* bias_data = bias_tensor->mutable_data<float>(platform::CPUPlace());
+    float* filter_data = filter_tensor->data<float>();
+    const float* scale_data = scale->data<float>();
+    const float* bn_bias_data = bn_bias->data<float>();
+    const float* mean_data = mean->data<float>();
+    const float* variance_data = variance->data<float>();
+    for (int64_t c = 0; c < channels; ++c) {
+      float alpha = scale_data[c] / std::sqrt(variance_data[c] + epsilon);
+      for (int64_t j = 0; j < channel_numel; ++j) {
+        filter_data[c * channel_numel + j] *= alpha;
+      }
+      bias_data[c] = bn_bias_data[c] - mean_data[c] * alpha;
+    }
+    auto* bias_var = block->Var(bias);
+    bias_var->SetType(framework::proto::VarType::LOD_TENSOR);
+    bias_var->SetDataType(framework::proto::VarType::FP32);
+    bias_var->SetShape({channels});
+    bias_var->SetPersistable(true);
+
+    std::string conv_out = conv->Output("Output")[0];
+    std::string y = bn->Output("Y")[0];
+    framework::RemoveOps(block, {static_cast<size_t>(bn_idx)});
+    auto* add = block->InsertOp(bn_idx);
+    add->SetType("elementwise_add");
+    add->SetInput("X", {conv_out});
+    add->SetInput("Y", {bias});
+    add->SetOutput("Out", {y});
+    add->SetAttr("axis", 1);
+    add->CheckAttrs();
+
+    graph.reset(new framework::OpGraph(*block));
+    ++count;
+  }
+  return count;
+}
+
+int ElementwiseChainFusePass::Apply(framework::Scope* scope,
+                                    framework::ProgramDesc* program) const {
+  auto* block = program->MutableBlock(0);
+  std::unique_ptr<framework::OpGraph> graph(new framework::OpGraph(*block));
+  auto is_chain_op = [](const std::string& type) {
+    return operators::math::IsFusableElementwise(type) ||
+           operators::math::IsFusableActivation(type);
+  };
+
+  int count = 0;
+  for (size_t i = 0; i < block->OpSize(); ++i) {
+    auto* first = block->Op(i);
+    if (!is_chain_op(first->Type()) ||
+        !framework::IsFloatVar(*block, first->Output("Out")[0])) {
+      continue;
+    }
+
+    std::vector<size_t> chain = {i};
+    while (true) {
+      int next = -1;
+      for (auto* type : kChainOpTypes) {
+        next = graph->NextInChain(chain.back(), "Out", type, "X");
+        if (next >= 0) break;
+      }
+      if (next < 0) break;
+      // The second input of a binary op should not be the chained tensor.
+      auto* op = block->Op(next);
+      if (operators::math::IsFusableElementwise(op->Type()) &&
+          op->Input("Y")[0] == op->Input("X")[0]) {
+        break;
+      }
+      chain.push_back(next);
+    }
+    if (chain.size() < 2) continue;
+
+    // The fused op runs at the place of the last op of the chain, so the
+    // inputs of the chain should not be written by the ops in between.
+    std::vector<std::pair<size_t, std::string>> reads;
+    reads.emplace_back(i, first->Input("X")[0]);
+    for (size_t idx : chain) {
+      auto* op = block->Op(idx);
+      if (operators::math::IsFusableElementwise(op->Type())) {
+        reads.emplace_back(idx, op->Input("Y")[0]);
+      }
+    }
+    bool overwritten = false;
+    for (size_t k = i + 1; k < chain.back() && !overwritten; ++k) {
+      if (std::find(chain.begin(), chain.end(), k) != chain.end()) continue;
+      for (auto& name : block->Op(k)->OutputArgumentNames()) {
+        for (auto& read : reads) {
+          overwritten |= read.first < k && read.second == name;
+        }
+      }
+    }
+    if (overwritten) continue;
+
+    std::vector<std::string> ys;
+    std::vector<std::string> functors;
+    std::vector<int> axes;
+    std::vector<std::string> intermediates;
+    for (size_t idx : chain) {
+      auto* op = block->Op(idx);
+      functors.push_back(op->Type());
+      if (operators::math::IsFusableElementwise(op->Type())) {
+        ys.push_back(op->Input("Y")[0]);
+        axes.push_back(boost::get<int>(op->GetAttr("axis")));
+      }
+      intermediates.push_back(op->Output("Out")[0]);
+    }
+    std::string x = first->Input("X")[0];
+    std::string out = intermediates.back();
+    intermediates.pop_back();
+
+    size_t fused_idx = chain.back() - (chain.size() - 1);
+    framework::RemoveOps(block, chain);
+    auto* fused = block->InsertOp(fused_idx);
+    fused->SetType("fused_elementwise_chain");
+    fused->SetInput("X", {x});
+    fused->SetInput("Y", ys);
+    fused->SetOutput("Out", {out});
+    fused->SetAttr("functor_list", functors);
+    fused->SetAttr("axis_list", axes);
+    fused->CheckAttrs();
+    framework::RemoveVars(block, intermediates);
+
+    graph.reset(new framework::OpGraph(*block));
+    ++count;
+    // The op after the first one of the chain is moved to i.
+    --i;
+  }
+  return count;
+}
+
+std::vector<std::unique_ptr<framework::ProgramPass>> FusionPasses() {
+  std::vector<std::unique_ptr<framework::ProgramPass>> passes;
+  // conv_bn_fuse creates the elementwise_add which may be chained with the
+  // activation after it.
+  passes.emplace_back(new ConvBNFusePass());
+  passes.emplace_back(new FCFusePass());
+  passes.emplace_back(new ElementwiseChainFusePass());
+  return passes;
+}
+
+int FuseProgram(framework::Scope* scope, framework::ProgramDesc* program) {
+  return framework::ApplyProgramPasses(FusionPasses(), scope, program);
+}
+
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,61 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/program_pass.h"
+
+namespace paddle {
+namespace inference {
+
+// Fuse mul + elementwise_add (+ relu, sigmoid or tanh) into fused_fc when
+// the weight and the bias are parameters.
+class FCFusePass : public framework::ProgramPass {
+ public:
+  std::string Type() const override { return "fc_fuse"; }
+  int Apply(framework::Scope* scope,
+            framework::ProgramDesc* program) const override;
+};
+
+// Fold an inference batch_norm into the filter of the conv2d before it,
+// the batch_norm is replaced by an elementwise_add of the folded bias.
+class ConvBNFusePass : public framework::ProgramPass {
+ public:
+  std::string Type() const override { return "conv_bn_fuse"; }
+  int Apply(framework::Scope* scope,
+            framework::ProgramDesc* program) const override;
+};
+
+// Fuse a chain of the elementwise ops and activations, where each op reads
+// the output of the previous one as its X, into fused_elementwise_chain.
+class ElementwiseChainFusePass : public framework::ProgramPass {
+ public:
+  std::string Type() const override { return "elementwise_chain_fuse"; }
+  int Apply(framework::Scope* scope,
+            framework::ProgramDesc* program) const override;
+};
+
+// The fusion passes in the order they should be applied.
+std::vector<std::unique_ptr<framework::ProgramPass>> FusionPasses();
+
+// Apply the fusion passes to the block 0 of a loaded inference program,
+// scope holds its parameters. Returns the number of the fusions. The fused
+// ops have CPU kernels only.
+int FuseProgram(framework::Scope* scope, framework::ProgramDesc* program);
+
+}  // namespace inference
+}  // namespace paddle
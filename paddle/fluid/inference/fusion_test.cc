@@ -0,0 +1,174 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/fusion.h"
+
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/executor.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+USE_OP(mul);
+USE_OP(elementwise_add);
+USE_OP(elementwise_mul);
+USE_OP(relu);
+USE_OP(sigmoid);
+USE_CPU_ONLY_OP(conv2d);
+USE_OP(batch_norm);
+USE_CPU_ONLY_OP(fused_fc);
+USE_CPU_ONLY_OP(fused_elementwise_chain);
+
+namespace f = paddle::framework;
+
+void AddVar(const std::string& name, const std::vector<int64_t>& shape,
+            bool persistable, f::BlockDesc* block) {
+  auto* var = block->Var(name);
+  var->SetType(f::proto::VarType::LOD_TENSOR);
+  var->SetDataType(f::proto::VarType::FP32);
+  var->SetShape(shape);
+  var->SetPersistable(persistable);
+}
+
+void AddOp(const std::string& type, const f::VariableNameMap& inputs,
+           const f::VariableNameMap& outputs, const f::AttributeMap& attrs,
+           f::BlockDesc* block) {
+  auto* op = block->AppendOp();
+  op->SetType(type);
+  for (auto& kv : inputs) {
+    op->SetInput(kv.first, kv.second);
+  }
+  for (auto& kv : outputs) {
+    op->SetOutput(kv.first, kv.second);
+  }
+  op->SetAttrMap(attrs);
+  op->CheckAttrs();
+}
+
+// Set the variable to random values in [low, high] in both scopes.
+void SetRandom(const std::string& name, const std::vector<int64_t>& shape,
+               float low, float high, f::Scope* scope1, f::Scope* scope2) {
+  static std::mt19937 engine(0);
+  std::uniform_real_distribution<float> dist(low, high);
+  auto* t1 = scope1->Var(name)->GetMutable<f::LoDTensor>();
+  auto* t2 = scope2->Var(name)->GetMutable<f::LoDTensor>();
+  t1->Resize(f::make_ddim(shape));
+  t2->Resize(f::make_ddim(shape));
+  float* d1 = t1->mutable_data<float>(paddle::platform::CPUPlace());
+  float* d2 = t2->mutable_data<float>(paddle::platform::CPUPlace());
+  for (int64_t i = 0; i < t1->numel(); ++i) {
+    d1[i] = d2[i] = dist(engine);
+  }
+}
+
+std::vector<std::string> OpTypes(const f::ProgramDesc& program) {
+  std::vector<std::string> types;
+  for (auto* op : program.Block(0).AllOps()) {
+    types.push_back(op->Type());
+  }
+  return types;
+}
+
+// Run the program and its fused copy, and compare the outputs.
+void CheckFusion(const f::ProgramDesc& program, f::Scope* scope,
+                 f::Scope* fused_scope, const std::string& out,
+                 const std::vector<std::string>& fused_types) {
+  f::ProgramDesc fused(program);
+  EXPECT_GT(paddle::inference::FuseProgram(fused_scope, &fused), 0);
+  EXPECT_EQ(OpTypes(fused), fused_types);
+
+  paddle::platform::CPUPlace place;
+  f::Executor executor(place);
+  executor.Run(program, scope, 0, false, true);
+  executor.Run(fused, fused_scope, 0, false, true);
+
+  auto& expected = scope->FindVar(out)->Get<f::LoDTensor>();
+  auto& actual = fused_scope->FindVar(out)->Get<f::LoDTensor>();
+  ASSERT_EQ(expected.dims(), actual.dims());
+  for (int64_t i = 0; i < expected.numel(); ++i) {
+    EXPECT_NEAR(expected.data<float>()[i], actual.data<float>()[i], 1e-5);
+  }
+}
+
+TEST(Fusion, fc_and_elementwise_chain) {
+  f::ProgramDesc program;
+  auto* block = program.MutableBlock(0);
+  AddVar("x", {2, 4}, false, block);
+  AddVar("w", {4, 3}, true, block);
+  AddVar("b", {3}, true, block);
+  AddVar("s", {3}, true, block);
+  for (auto name : {"mul_out", "add_out", "fc_out", "mul2_out", "out"}) {
+    AddVar(name, {2, 3}, false, block);
+  }
+  AddOp("mul", {{"X", {"x"}}, {"Y", {"w"}}}, {{"Out", {"mul_out"}}},
+        {{"x_num_col_dims", 1}, {"y_num_col_dims", 1}}, block);
+  AddOp("elementwise_add", {{"X", {"mul_out"}}, {"Y", {"b"}}},
+        {{"Out", {"add_out"}}}, {{"axis", 1}}, block);
+  AddOp("relu", {{"X", {"add_out"}}}, {{"Out", {"fc_out"}}}, {}, block);
+  AddOp("elementwise_mul", {{"X", {"fc_out"}}, {"Y", {"s"}}},
+        {{"Out", {"mul2_out"}}}, {{"axis", -1}}, block);
+  AddOp("sigmoid", {{"X", {"mul2_out"}}}, {{"Out", {"out"}}}, {}, block);
+
+  f::Scope scope;
+  f::Scope fused_scope;
+  SetRandom("x", {2, 4}, -1, 1, &scope, &fused_scope);
+  SetRandom("w", {4, 3}, -1, 1, &scope, &fused_scope);
+  SetRandom("b", {3}, -1, 1, &scope, &fused_scope);
+  SetRandom("s", {3}, -1, 1, &scope, &fused_scope);
+  CheckFusion(program, &scope, &fused_scope, "out",
+              {"fused_fc", "fused_elementwise_chain"});
+}
+
+TEST(Fusion, conv_bn_relu) {
+  f::ProgramDesc program;
+  auto* block = program.MutableBlock(0);
+  AddVar("x", {1, 2, 5, 5}, false, block);
+  AddVar("filter", {3, 2, 3, 3}, true, block);
+  for (auto name : {"scale", "bias", "mean", "variance"}) {
+    AddVar(name, {3}, true, block);
+  }
+  for (auto name : {"conv_out", "bn_out", "out"}) {
+    AddVar(name, {1, 3, 3, 3}, false, block);
+  }
+  AddVar("saved_mean", {3}, false, block);
+  AddVar("saved_variance", {3}, false, block);
+  AddOp("conv2d", {{"Input", {"x"}}, {"Filter", {"filter"}}},
+        {{"Output", {"conv_out"}}}, {}, block);
+  AddOp("batch_norm",
+        {{"X", {"conv_out"}},
+         {"Scale", {"scale"}},
+         {"Bias", {"bias"}},
+         {"Mean", {"mean"}},
+         {"Variance", {"variance"}}},
+        {{"Y", {"bn_out"}},
+         {"MeanOut", {"mean"}},
+         {"VarianceOut", {"variance"}},
+         {"SavedMean", {"saved_mean"}},
+         {"SavedVariance", {"saved_variance"}}},
+        {{"is_test", true}}, block);
+  AddOp("relu", {{"X", {"bn_out"}}}, {{"Out", {"out"}}}, {}, block);
+
+  f::Scope scope;
+  f::Scope fused_scope;
+  SetRandom("x", {1, 2, 5, 5}, -1, 1, &scope, &fused_scope);
+  SetRandom("filter", {3, 2, 3, 3}, -1, 1, &scope, &fused_scope);
+  SetRandom("scale", {3}, 0.5, 2, &scope, &fused_scope);
+  SetRandom("bias", {3}, -1, 1, &scope, &fused_scope);
+  SetRandom("mean", {3}, -1, 1, &scope, &fused_scope);
+  SetRandom("variance", {3}, 0.5, 2, &scope, &fused_scope);
+  CheckFusion(program, &scope, &fused_scope, "out",
+              {"conv2d", "fused_elementwise_chain"});
+}
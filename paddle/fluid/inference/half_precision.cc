@@ -0,0 +1,127 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/half_precision.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/block_desc.h"
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/inference/io.h"
+#include "paddle/fluid/operators/math/half_weight.h"
+
+namespace paddle {
+namespace inference {
+
+namespace {
+
+// The weight parameters of the ops whose float kernels take half weights.
+const std::unordered_map<std::string, std::string>& HalfWeightOps() {
+  static const std::unordered_map<std::string, std::string> ops = {
+      {"mul", "Y"},
+      {"fused_fc", "W"},
+      {"conv2d", "Filter"},
+      {"lookup_table", "W"}};
+  return ops;
+}
+
+template <typename W>
+void ConvertTensor(framework::LoDTensor* tensor) {
+  framework::LoDTensor half;
+  half.Resize(tensor->dims());
+  half.set_lod(tensor->lod());
+  operators::math::FloatToHalf(
+      tensor->data<float>(), half.mutable_data<W>(platform::CPUPlace()),
+      tensor->numel());
+  // The float buffer is freed with its last reference.
+  *tensor = half;
+}
+
+}  // namespace
+
+int ConvertWeightsToHalf(framework::proto::VarType::Type dtype,
+                         int64_t min_numel, framework::Scope* scope,
+                         framework::ProgramDesc* program) {
+  PADDLE_ENFORCE(dtype == framework::proto::VarType::FP16 ||
+                     dtype == framework::proto::VarType::BF16,
+                 "The weights can only be converted to FP16 or BF16");
+  auto* block = program->MutableBlock(0);
+
+  // The weights which are only read as the weights of the half ops.
+  std::unordered_set<std::string> weights;
+  std::unordered_set<std::string> float_inputs;
+  for (auto* op : block->AllOps()) {
+    auto it = HalfWeightOps().find(op->Type());
+    std::string weight_param;
+    if (it != HalfWeightOps().end() && op->Input(it->second).size() == 1) {
+      weight_param = it->second;
+      weights.insert(op->Input(weight_param)[0]);
+    }
+    for (auto& param : op->InputNames()) {
+      if (param == weight_param) continue;
+      for (auto& name : op->Input(param)) float_inputs.insert(name);
+    }
+  }
+
+  int converted = 0;
+  for (auto& name : weights) {
+    if (float_inputs.count(name) != 0) continue;
+    auto* var_desc = block->FindVar(name);
+    if (var_desc == nullptr || !var_desc->Persistable() ||
+        var_desc->GetDataType() != framework::proto::VarType::FP32) {
+      continue;
+    }
+    auto* var = scope->FindVar(name);
+    if (var == nullptr || !var->IsType<framework::LoDTensor>()) continue;
+    auto* tensor = var->GetMutable<framework::LoDTensor>();
+    if (tensor->numel() < min_numel) continue;
+
+    if (dtype == framework::proto::VarType::FP16) {
+      ConvertTensor<platform::float16>(tensor);
+    } else {
+      ConvertTensor<platform::bfloat16>(tensor);
+    }
+    var_desc->SetDataType(dtype);
+    converted++;
+  }
+
+  // The half filters are only supported by the plain CPU kernel.
+  for (auto* op : block->AllOps()) {
+    if (op->Type() != "conv2d") continue;
+    auto* filter = block->FindVar(op->Input("Filter")[0]);
+    if (filter != nullptr && filter->GetDataType() == dtype) {
+      op->SetAttr("use_cudnn", false);
+      op->SetAttr("use_mkldnn", false);
+    }
+  }
+  block->Flush();
+  return converted;
+}
+
+std::unique_ptr<framework::ProgramDesc> LoadHalf(
+    framework::Executor& executor, framework::Scope& scope,
+    const std::string& dirname, framework::proto::VarType::Type dtype,
+    int64_t min_numel) {
+  std::unique_ptr<framework::ProgramDesc> program =
+      Load(executor, scope, dirname);
+  int converted = ConvertWeightsToHalf(dtype, min_numel, &scope, program.get());
+  VLOG(3) << "Converted " << converted << " weights to "
+          << framework::DataTypeToString(dtype);
+  return program;
+}
+
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,46 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "paddle/fluid/framework/executor.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/scope.h"
+
+namespace paddle {
+namespace inference {
+
+// The half precision weights of the CPU inference.
+//
+// ConvertWeightsToHalf stores the persistable float weights of the mul,
+// fused_fc, conv2d and lookup_table ops of at least min_numel elements in
+// dtype, FP16 or BF16, in the scope, and updates their variables in the
+// program. The kernels widen the weights to float in blocks while they
+// run, see operators/math/half_weight.h, so the inputs, the outputs and
+// the arithmetic stay in float. A weight which is read by any other op is
+// kept in float. Returns the number of the converted weights.
+int ConvertWeightsToHalf(framework::proto::VarType::Type dtype,
+                         int64_t min_numel, framework::Scope* scope,
+                         framework::ProgramDesc* program);
+
+// Load the inference model in dirname and convert its weights to dtype.
+std::unique_ptr<framework::ProgramDesc> LoadHalf(
+    framework::Executor& executor, framework::Scope& scope,
+    const std::string& dirname, framework::proto::VarType::Type dtype,
+    int64_t min_numel = 1024);
+
+}  // namespace inference
+}  // namespace paddle
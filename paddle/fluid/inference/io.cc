@@ -14,9 +14,14 @@ limitations under the License. */
 
 #include "paddle/fluid/inference/io.h"
 
+#include <atomic>
+#include <exception>
 #include <fstream>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 #include "paddle/fluid/framework/block_desc.h"
 #include "paddle/fluid/framework/feed_fetch_type.h"
+#include "paddle/fluid/framework/mapped_tensor_file.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/pybind/pybind.h"
 
@@ -47,10 +52,58 @@ bool IsPersistable(const framework::VarDesc* var) {
   return false;
 }
 
+// The offsets of the first count LoDTensors of a file saved by
+// save_combine.
+std::vector<int64_t> IndexCombinedFile(const std::string& filename,
+                                       size_t count) {
+  std::ifstream fin(filename, std::ios::in | std::ios::binary);
+  PADDLE_ENFORCE(static_cast<bool>(fin), "Cannot open file %s", filename);
+  std::vector<int64_t> offsets;
+  for (size_t i = 0; i < count; ++i) {
+    offsets.push_back(static_cast<int64_t>(fin.tellg()));
+    framework::SkipLoDTensorInStream(fin);
+    PADDLE_ENFORCE(static_cast<bool>(fin), "Cannot read more from file %s",
+                   filename);
+  }
+  return offsets;
+}
+
+// Run the load ops of block 0 of load_program on num_threads threads. Every
+// op loads its own variable, which is created before.
+void RunLoadOps(const platform::Place& place, framework::Scope* scope,
+                const framework::ProgramDesc& load_program, int num_threads) {
+  auto ctx = framework::Executor::Prepare(load_program, 0);
+  auto& ops = ctx->ops_;
+  std::atomic<size_t> next(0);
+  std::mutex error_mutex;
+  std::exception_ptr error;
+  auto worker = [&] {
+    for (size_t i = next++; i < ops.size(); i = next++) {
+      try {
+        ops[i]->Run(*scope, place);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) error = std::current_exception();
+        next = ops.size();
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < static_cast<size_t>(num_threads) && t < ops.size();
+       ++t) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) thread.join();
+  if (error) std::rethrow_exception(error);
+}
+
 void LoadPersistables(framework::Executor& executor, framework::Scope& scope,
                       const framework::ProgramDesc& main_program,
                       const std::string& dirname,
-                      const std::string& param_filename) {
+                      const std::string& param_filename, bool use_mmap,
+                      int num_threads) {
+  PADDLE_ENFORCE_GT(num_threads, 0, "num_threads should be positive");
   const framework::BlockDesc& global_block = main_program.Block(0);
 
   framework::ProgramDesc* load_program = new framework::ProgramDesc();
@@ -84,22 +137,42 @@ void LoadPersistables(framework::Executor& executor, framework::Scope& scope,
   if (!param_filename.empty()) {
     // sort paramlist to have consistent ordering
     std::sort(paramlist.begin(), paramlist.end());
-    // append just the load_combine op
-    framework::OpDesc* op = load_block->AppendOp();
-    op->SetType("load_combine");
-    op->SetOutput("Out", paramlist);
-    op->SetAttr("file_path", {param_filename});
-    op->CheckAttrs();
+    if (num_threads > 1 && !framework::IsMappedTensorFile(param_filename)) {
+      // append a load op for the offset of every tensor
+      auto offsets = IndexCombinedFile(param_filename, paramlist.size());
+      for (size_t i = 0; i < paramlist.size(); ++i) {
+        framework::OpDesc* op = load_block->AppendOp();
+        op->SetType("load");
+        op->SetOutput("Out", {paramlist[i]});
+        op->SetAttr("file_path", {param_filename});
+        op->SetAttr("offset", offsets[i]);
+        op->CheckAttrs();
+      }
+    } else {
+      // append just the load_combine op
+      framework::OpDesc* op = load_block->AppendOp();
+      op->SetType("load_combine");
+      op->SetOutput("Out", paramlist);
+      op->SetAttr("file_path", {param_filename});
+      op->SetAttr("use_mmap", use_mmap);
+      op->CheckAttrs();
+    }
   }
 
-  executor.Run(*load_program, &scope, 0, true, true);
+  if (num_threads > 1) {
+    executor.CreateVariables(*load_program, &scope, 0);
+    RunLoadOps(executor.GetPlace(), &scope, *load_program, num_threads);
+  } else {
+    executor.Run(*load_program, &scope, 0, true, true);
+  }
 
   delete load_program;
 }
 
 std::unique_ptr<framework::ProgramDesc> Load(framework::Executor& executor,
                                              framework::Scope& scope,
-                                             const std::string& dirname) {
+                                             const std::string& dirname,
+                                             int num_threads) {
   std::string model_filename = dirname + "/__model__";
   std::string program_desc_str;
   VLOG(3) << "loading model from " << model_filename;
@@ -108,13 +181,15 @@ std::unique_ptr<framework::ProgramDesc> Load(framework::Executor& executor,
   std::unique_ptr<framework::ProgramDesc> main_program(
       new framework::ProgramDesc(program_desc_str));
 
-  LoadPersistables(executor, scope, *main_program, dirname, "");
+  LoadPersistables(executor, scope, *main_program, dirname, "", false,
+                   num_threads);
   return main_program;
 }
 
 std::unique_ptr<framework::ProgramDesc> Load(
     framework::Executor& executor, framework::Scope& scope,
-    const std::string& prog_filename, const std::string& param_filename) {
+    const std::string& prog_filename, const std::string& param_filename,
+    bool use_mmap, int num_threads) {
   std::string model_filename = prog_filename;
   std::string program_desc_str;
   ReadBinaryFile(model_filename, program_desc_str);
@@ -122,7 +197,8 @@ std::unique_ptr<framework::ProgramDesc> Load(
   std::unique_ptr<framework::ProgramDesc> main_program(
       new framework::ProgramDesc(program_desc_str));
 
-  LoadPersistables(executor, scope, *main_program, "", param_filename);
+  LoadPersistables(executor, scope, *main_program, "", param_filename,
+                   use_mmap, num_threads);
   return main_program;
 }
 
@@ -27,19 +27,31 @@ namespace inference {
 
 void Init(bool init_p2p);
 
+// If use_mmap is true and param_filename is saved in the aligned format,
+// the parameters on CPU share the pages of the mapped file, see
+// load_combine.
+//
+// With num_threads > 1 the parameters are loaded on num_threads threads:
+// the separate files are read concurrently, and the tensors of
+// param_filename are indexed first and then read from their offsets
+// concurrently. The aligned param_filename is mapped on one thread.
 void LoadPersistables(framework::Executor& executor, framework::Scope& scope,
                       const framework::ProgramDesc& main_program,
                       const std::string& dirname,
-                      const std::string& param_filename);
+                      const std::string& param_filename,
+                      bool use_mmap = false, int num_threads = 1);
 
 std::unique_ptr<framework::ProgramDesc> Load(framework::Executor& executor,
                                              framework::Scope& scope,
-                                             const std::string& dirname);
+                                             const std::string& dirname,
+                                             int num_threads = 1);
 
 std::unique_ptr<framework::ProgramDesc> Load(framework::Executor& executor,
                                              framework::Scope& scope,
                                              const std::string& prog_filename,
-                                             const std::string& param_filename);
+                                             const std::string& param_filename,
+                                             bool use_mmap = false,
+                                             int num_threads = 1);
 
 }  // namespace inference
 }  // namespace paddle
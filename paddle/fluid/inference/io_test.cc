@@ -0,0 +1,155 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/io.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/op_registry.h"
+
+USE_NO_KERNEL_OP(save);
+USE_NO_KERNEL_OP(save_combine);
+USE_NO_KERNEL_OP(load);
+USE_NO_KERNEL_OP(load_combine);
+
+namespace f = paddle::framework;
+
+static const char kDirname[] = "io_test_params";
+static const char kCombined[] = "io_test_params/__params__";
+
+static std::string ParamName(int i) {
+  return "param_" + std::to_string(100 + i);
+}
+
+// A program of num_params parameters of different sizes, saved both in
+// separate files and combined, returns the total bytes of the parameters.
+static int64_t SaveParams(int num_params, f::ProgramDesc* program,
+                          f::Scope* scope) {
+  auto* block = program->MutableBlock(0);
+  f::ProgramDesc save_program;
+  auto* save_block = save_program.MutableBlock(0);
+  std::vector<std::string> names;
+  int64_t bytes = 0;
+  for (int i = 0; i < num_params; ++i) {
+    auto name = ParamName(i);
+    for (auto* b : {block, save_block}) {
+      auto* var = b->Var(name);
+      var->SetType(f::proto::VarType::LOD_TENSOR);
+      var->SetDataType(f::proto::VarType::FP32);
+      var->SetPersistable(true);
+    }
+    auto* tensor = scope->Var(name)->GetMutable<f::LoDTensor>();
+    int rows = 64 * (1 + i % 8);
+    float* data = tensor->mutable_data<float>(f::make_ddim({rows, 256}),
+                                              paddle::platform::CPUPlace());
+    for (int64_t k = 0; k < tensor->numel(); ++k) data[k] = i + k * 0.001f;
+    if (i % 3 == 0) tensor->set_lod({{0, 1, static_cast<size_t>(rows)}});
+    bytes += tensor->memory_size();
+
+    auto* op = save_block->AppendOp();
+    op->SetType("save");
+    op->SetInput("X", {name});
+    op->SetAttr("file_path", std::string(kDirname) + "/" + name);
+    op->CheckAttrs();
+    names.push_back(name);
+  }
+  auto* op = save_block->AppendOp();
+  op->SetType("save_combine");
+  op->SetInput("X", names);
+  op->SetAttr("file_path", std::string(kCombined));
+  op->CheckAttrs();
+
+  paddle::platform::CPUPlace place;
+  f::Executor executor(place);
+  executor.Run(save_program, scope, 0, false, false);
+  return bytes;
+}
+
+static void CheckParams(int num_params, const f::Scope& expected,
+                        const f::Scope& actual) {
+  for (int i = 0; i < num_params; ++i) {
+    auto name = ParamName(i);
+    auto& e = expected.FindVar(name)->Get<f::LoDTensor>();
+    auto* var = actual.FindVar(name);
+    ASSERT_NE(var, nullptr) << name;
+    auto& a = var->Get<f::LoDTensor>();
+    ASSERT_EQ(a.dims(), e.dims()) << name;
+    EXPECT_EQ(a.lod(), e.lod()) << name;
+    EXPECT_TRUE(std::equal(e.data<float>(), e.data<float>() + e.numel(),
+                           a.data<float>()))
+        << name;
+  }
+}
+
+TEST(LoadPersistables, num_threads) {
+  const int num_params = 16;
+  f::ProgramDesc program;
+  f::Scope scope;
+  SaveParams(num_params, &program, &scope);
+
+  paddle::platform::CPUPlace place;
+  f::Executor executor(place);
+  for (bool combined : {false, true}) {
+    for (int num_threads : {1, 2, 4, 8}) {
+      f::Scope loaded;
+      paddle::inference::LoadPersistables(
+          executor, loaded, program, combined ? "" : kDirname,
+          combined ? kCombined : "", false, num_threads);
+      CheckParams(num_params, scope, loaded);
+    }
+  }
+}
+
+// Logs the load throughput of the separate and the combined files on 1 to
+// 8 threads. Run it with --gtest_also_run_disabled_tests.
+TEST(LoadPersistables, DISABLED_Benchmark) {
+  const int num_params = 64;
+  f::ProgramDesc program;
+  f::Scope scope;
+  int64_t bytes = SaveParams(num_params, &program, &scope);
+
+  paddle::platform::CPUPlace place;
+  f::Executor executor(place);
+  for (bool combined : {false, true}) {
+    for (int num_threads : {1, 2, 4, 8}) {
+      f::Scope loaded;
+      auto begin = std::chrono::steady_clock::now();
+      paddle::inference::LoadPersistables(
+          executor, loaded, program, combined ? "" : kDirname,
+          combined ? kCombined : "", false, num_threads);
+      std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - begin;
+      LOG(INFO) << (combined ? "combined" : "separate") << " files, "
+                << num_threads << " threads: " << elapsed.count() * 1000
+                << " ms, " << bytes / elapsed.count() / (1 << 20) << " MB/s";
+    }
+  }
+}
+
+TEST(LoadPersistables, missing_file) {
+  f::ProgramDesc program;
+  auto* var = program.MutableBlock(0)->Var("io_test_missing");
+  var->SetType(f::proto::VarType::LOD_TENSOR);
+  var->SetPersistable(true);
+  paddle::platform::CPUPlace place;
+  f::Executor executor(place);
+  f::Scope scope;
+  EXPECT_THROW(paddle::inference::LoadPersistables(executor, scope, program,
+                                                   kDirname, "", false, 4),
+               paddle::platform::EnforceNotMet);
+}
@@ -0,0 +1,263 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/optimize.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace inference {
+
+namespace {
+
+// Whether an op in (begin, end) of block writes var.
+bool WrittenBetween(framework::BlockDesc* block, size_t begin, size_t end,
+                    const std::string& var) {
+  for (size_t k = begin + 1; k < end; ++k) {
+    auto names = block->Op(k)->OutputArgumentNames();
+    if (std::find(names.begin(), names.end(), var) != names.end()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// The ops linear in one input, which can absorb a factor of the input into
+// their weight.
+struct LinearOp {
+  const char* type;
+  const char* input;
+  const char* weight;
+};
+
+const LinearOp kLinearOps[] = {{"mul", "X", "Y"},
+                               {"conv2d", "Input", "Filter"}};
+
+// The ops which are not folded even if their inputs are parameters.
+const char* kSideEffectOpTypes[] = {"feed", "fetch",        "load",
+                                    "save", "load_combine", "save_combine",
+                                    "print"};
+
+bool HasSubBlockOrSeed(const framework::OpDesc& op) {
+  if (op.HasAttr("seed")) return true;
+  for (auto& name : op.AttrNames()) {
+    if (op.GetAttrType(name) == framework::proto::AttrType::BLOCK) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+int DropoutStripPass::Apply(framework::Scope* scope,
+                            framework::ProgramDesc* program) const {
+  auto* block = program->MutableBlock(0);
+  std::unique_ptr<framework::OpGraph> graph(new framework::OpGraph(*block));
+  int count = 0;
+  for (size_t i = 0; i < block->OpSize(); ++i) {
+    auto* dropout = block->Op(i);
+    if (dropout->Type() != "dropout" ||
+        !boost::get<bool>(dropout->GetAttr("is_test"))) {
+      continue;
+    }
+    // The dropout of the inference is y = x * (1 - dropout_prob).
+    float factor = 1.f - boost::get<float>(dropout->GetAttr("dropout_prob"));
+    std::string x = dropout->Input("X")[0];
+    std::string out = dropout->Output("Out")[0];
+    std::vector<std::string> removed;
+    for (auto& name : dropout->OutputArgumentNames()) {
+      if (name != out) removed.push_back(name);
+    }
+
+    int next = -1;
+    std::string weight;
+    for (auto& linear : kLinearOps) {
+      next = graph->NextInChain(i, "Out", linear.type, linear.input);
+      if (next >= 0) {
+        weight = block->Op(next)->Input(linear.weight)[0];
+        break;
+      }
+    }
+    // The weight is updated in place on CPU, so it should not be shared or
+    // on a device, and x is read later by the next op, so it should not be
+    // written in between.
+    if (next >= 0 && framework::IsParameter(*block, weight) &&
+        graph->Consumers(weight).size() == 1 &&
+        !WrittenBetween(block, i, next, x) &&
+        platform::is_cpu_place(
+            framework::GetParameter(scope, weight)->place())) {
+      auto* tensor = framework::GetParameter(scope, weight);
+      float* data = tensor->data<float>();
+      for (int64_t k = 0; k < tensor->numel(); ++k) {
+        data[k] *= factor;
+      }
+      block->Op(next)->RenameInput(out, x);
+      removed.push_back(out);
+      framework::RemoveOps(block, {i});
+      // The op after the dropout is moved to i.
+      --i;
+    } else {
+      framework::RemoveOps(block, {i});
+      auto* scale = block->InsertOp(i);
+      scale->SetType("scale");
+      scale->SetInput("X", {x});
+      scale->SetOutput("Out", {out});
+      scale->SetAttr("scale", factor);
+      scale->CheckAttrs();
+    }
+    framework::RemoveVars(block, removed);
+
+    graph.reset(new framework::OpGraph(*block));
+    ++count;
+  }
+  return count;
+}
+
+int ConstantFoldPass::Apply(framework::Scope* scope,
+                            framework::ProgramDesc* program) const {
+  // The number of the ops writing every variable, in all the blocks. A
+  // parameter written by an op is not a constant.
+  std::unordered_map<std::string, int> writers;
+  for (size_t b = 0; b < program->Size(); ++b) {
+    for (auto* op : program->Block(b).AllOps()) {
+      for (auto& name : op->OutputArgumentNames()) {
+        ++writers[name];
+      }
+    }
+  }
+
+  auto* block = program->MutableBlock(0);
+  auto is_constant = [&](const std::string& name) {
+    auto* var = block->FindVar(name);
+    if (var == nullptr || !var->Persistable() ||
+        var->GetType() != framework::proto::VarType::LOD_TENSOR ||
+        writers[name] != 0) {
+      return false;
+    }
+    auto* scope_var = scope->FindVar(name);
+    return scope_var != nullptr &&
+           scope_var->IsType<framework::LoDTensor>() &&
+           scope_var->Get<framework::LoDTensor>().IsInitialized();
+  };
+
+  // The variables read by the ops which are not folded, the outputs of a
+  // later op are not constants if they are read before it.
+  std::unordered_set<std::string> read;
+  auto can_fold = [&](const framework::OpDesc& op) {
+    for (auto* type : kSideEffectOpTypes) {
+      if (op.Type() == type) return false;
+    }
+    if (HasSubBlockOrSeed(op)) return false;
+    for (auto& name : op.InputArgumentNames()) {
+      if (!is_constant(name)) return false;
+    }
+    auto outputs = op.OutputArgumentNames();
+    if (outputs.empty()) return false;
+    for (auto& name : outputs) {
+      auto* var = block->FindVar(name);
+      if (var == nullptr || var->Persistable() ||
+          var->GetType() != framework::proto::VarType::LOD_TENSOR ||
+          writers[name] != 1 || read.count(name) != 0) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  int count = 0;
+  for (size_t i = 0; i < block->OpSize();) {
+    auto* op = block->Op(i);
+    if (!can_fold(*op)) {
+      for (auto& name : op->InputArgumentNames()) {
+        read.insert(name);
+      }
+      ++i;
+      continue;
+    }
+
+    VLOG(3) << "Fold the constant op " << op->Type();
+    auto op_base = framework::OpRegistry::CreateOp(*op);
+    auto outputs = op->OutputArgumentNames();
+    for (auto& name : outputs) {
+      scope->Var(name)->GetMutable<framework::LoDTensor>();
+    }
+    op_base->Run(*scope, place_);
+    for (auto& name : outputs) {
+      auto& tensor = scope->FindVar(name)->Get<framework::LoDTensor>();
+      auto* var = block->FindVar(name);
+      var->SetPersistable(true);
+      var->SetShape(framework::vectorize(tensor.dims()));
+      writers[name] = 0;
+    }
+    framework::RemoveOps(block, {i});
+    ++count;
+  }
+  if (count > 0) {
+    // The folded parameters are ready before the program reads them.
+    platform::DeviceContextPool::Instance().Get(place_)->Wait();
+  }
+  return count;
+}
+
+int RemoveUnusedVarsPass::Apply(framework::Scope* scope,
+                                framework::ProgramDesc* program) const {
+  std::unordered_set<std::string> used;
+  for (size_t b = 0; b < program->Size(); ++b) {
+    for (auto* op : program->Block(b).AllOps()) {
+      for (auto& name : op->InputArgumentNames()) used.insert(name);
+      for (auto& name : op->OutputArgumentNames()) used.insert(name);
+    }
+  }
+
+  int count = 0;
+  std::vector<std::string> erased;
+  for (size_t b = 0; b < program->Size(); ++b) {
+    auto* block = program->MutableBlock(b);
+    for (auto* var : block->AllVars()) {
+      std::string name = var->Name();
+      if (used.count(name) != 0) continue;
+      // All the parameters are in the root scope.
+      if (var->Persistable()) erased.push_back(name);
+      block->RemoveVar(name);
+      ++count;
+    }
+  }
+  scope->EraseVars(erased);
+  return count;
+}
+
+std::vector<std::unique_ptr<framework::ProgramPass>> OptimizePasses(
+    const platform::Place& place) {
+  std::vector<std::unique_ptr<framework::ProgramPass>> passes;
+  // dropout_strip may leave a scale of a parameter for constant_fold, and
+  // both leave the variables they replaced for remove_unused_vars.
+  passes.emplace_back(new DropoutStripPass());
+  passes.emplace_back(new ConstantFoldPass(place));
+  passes.emplace_back(new RemoveUnusedVarsPass());
+  return passes;
+}
+
+int OptimizeProgram(framework::Scope* scope, framework::ProgramDesc* program,
+                    const platform::Place& place) {
+  return framework::ApplyProgramPasses(OptimizePasses(place), scope, program);
+}
+
+}  // namespace inference
+}  // namespace paddle
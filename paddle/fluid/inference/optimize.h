@@ -0,0 +1,77 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/program_pass.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace inference {
+
+// Rewrite the dropout of the inference, which only scales its input by
+// 1 - dropout_prob. The factor is folded into the weight of the mul or the
+// conv2d reading the output of the dropout if the weight is on CPU and not
+// shared, otherwise the dropout is replaced by a scale.
+class DropoutStripPass : public framework::ProgramPass {
+ public:
+  std::string Type() const override { return "dropout_strip"; }
+  int Apply(framework::Scope* scope,
+            framework::ProgramDesc* program) const override;
+};
+
+// Run the ops whose inputs are all parameters once, e.g. the reshapes and
+// the transposes of the weights, and make their outputs parameters in
+// scope. The ops run on place, where the parameters in scope are. The ops
+// with a sub-block or a random seed are not folded.
+class ConstantFoldPass : public framework::ProgramPass {
+ public:
+  explicit ConstantFoldPass(
+      const platform::Place& place = platform::CPUPlace())
+      : place_(place) {}
+
+  std::string Type() const override { return "constant_fold"; }
+  int Apply(framework::Scope* scope,
+            framework::ProgramDesc* program) const override;
+
+ private:
+  platform::Place place_;
+};
+
+// Remove the variables which no op reads or writes, and erase the removed
+// parameters from scope.
+class RemoveUnusedVarsPass : public framework::ProgramPass {
+ public:
+  std::string Type() const override { return "remove_unused_vars"; }
+  int Apply(framework::Scope* scope,
+            framework::ProgramDesc* program) const override;
+};
+
+// The optimization passes in the order they should be applied, the
+// constants are folded on place.
+std::vector<std::unique_ptr<framework::ProgramPass>> OptimizePasses(
+    const platform::Place& place = platform::CPUPlace());
+
+// Apply the optimization passes to a loaded inference program, scope holds
+// its parameters on place, the place of the executor which loaded them.
+// Returns the number of the rewrites. It should be applied before
+// FuseProgram, so the folded weights can be fused.
+int OptimizeProgram(framework::Scope* scope, framework::ProgramDesc* program,
+                    const platform::Place& place = platform::CPUPlace());
+
+}  // namespace inference
+}  // namespace paddle
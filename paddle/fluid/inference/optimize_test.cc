@@ -0,0 +1,160 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/optimize.h"
+
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/executor.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+USE_OP(mul);
+USE_OP(elementwise_add);
+USE_OP(relu);
+USE_OP(scale);
+USE_OP(transpose);
+USE_OP(dropout);
+
+namespace f = paddle::framework;
+
+void AddVar(const std::string& name, const std::vector<int64_t>& shape,
+            bool persistable, f::BlockDesc* block) {
+  auto* var = block->Var(name);
+  var->SetType(f::proto::VarType::LOD_TENSOR);
+  var->SetDataType(f::proto::VarType::FP32);
+  var->SetShape(shape);
+  var->SetPersistable(persistable);
+}
+
+void AddOp(const std::string& type, const f::VariableNameMap& inputs,
+           const f::VariableNameMap& outputs, const f::AttributeMap& attrs,
+           f::BlockDesc* block) {
+  auto* op = block->AppendOp();
+  op->SetType(type);
+  for (auto& kv : inputs) {
+    op->SetInput(kv.first, kv.second);
+  }
+  for (auto& kv : outputs) {
+    op->SetOutput(kv.first, kv.second);
+  }
+  op->SetAttrMap(attrs);
+  op->CheckAttrs();
+}
+
+// Set the variable to random values in [-1, 1] in both scopes.
+void SetRandom(const std::string& name, const std::vector<int64_t>& shape,
+               f::Scope* scope1, f::Scope* scope2) {
+  static std::mt19937 engine(0);
+  std::uniform_real_distribution<float> dist(-1, 1);
+  auto* t1 = scope1->Var(name)->GetMutable<f::LoDTensor>();
+  auto* t2 = scope2->Var(name)->GetMutable<f::LoDTensor>();
+  t1->Resize(f::make_ddim(shape));
+  t2->Resize(f::make_ddim(shape));
+  float* d1 = t1->mutable_data<float>(paddle::platform::CPUPlace());
+  float* d2 = t2->mutable_data<float>(paddle::platform::CPUPlace());
+  for (int64_t i = 0; i < t1->numel(); ++i) {
+    d1[i] = d2[i] = dist(engine);
+  }
+}
+
+std::vector<std::string> OpTypes(const f::ProgramDesc& program) {
+  std::vector<std::string> types;
+  for (auto* op : program.Block(0).AllOps()) {
+    types.push_back(op->Type());
+  }
+  return types;
+}
+
+TEST(Optimize, dropout_and_constant_fold) {
+  f::ProgramDesc program;
+  auto* block = program.MutableBlock(0);
+  AddVar("x", {2, 4}, false, block);
+  AddVar("w", {3, 4}, true, block);
+  AddVar("w2", {4, 3}, true, block);
+  for (auto name : {"wt", "ws"}) AddVar(name, {4, 3}, false, block);
+  for (auto name : {"dx", "mask1"}) AddVar(name, {2, 4}, false, block);
+  for (auto name : {"h1", "h2", "s", "d", "mask2", "out"}) {
+    AddVar(name, {2, 3}, false, block);
+  }
+  // ws = transpose(w) * 0.5 is folded
+  AddOp("transpose", {{"X", {"w"}}}, {{"Out", {"wt"}}},
+        {{"axis", std::vector<int>({1, 0})}}, block);
+  AddOp("scale", {{"X", {"wt"}}}, {{"Out", {"ws"}}}, {{"scale", 0.5f}},
+        block);
+  // the dropout before a mul is folded into w2
+  AddOp("dropout", {{"X", {"x"}}}, {{"Out", {"dx"}}, {"Mask", {"mask1"}}},
+        {{"dropout_prob", 0.5f}, {"is_test", true}}, block);
+  AddOp("mul", {{"X", {"dx"}}, {"Y", {"w2"}}}, {{"Out", {"h1"}}}, {}, block);
+  AddOp("mul", {{"X", {"x"}}, {"Y", {"ws"}}}, {{"Out", {"h2"}}}, {}, block);
+  AddOp("elementwise_add", {{"X", {"h1"}}, {"Y", {"h2"}}}, {{"Out", {"s"}}},
+        {}, block);
+  // the dropout before a relu is replaced by a scale
+  AddOp("dropout", {{"X", {"s"}}}, {{"Out", {"d"}}, {"Mask", {"mask2"}}},
+        {{"dropout_prob", 0.25f}, {"is_test", true}}, block);
+  AddOp("relu", {{"X", {"d"}}}, {{"Out", {"out"}}}, {}, block);
+
+  f::Scope scope;
+  f::Scope optimized_scope;
+  SetRandom("x", {2, 4}, &scope, &optimized_scope);
+  SetRandom("w", {3, 4}, &scope, &optimized_scope);
+  SetRandom("w2", {4, 3}, &scope, &optimized_scope);
+
+  f::ProgramDesc optimized(program);
+  EXPECT_GT(paddle::inference::OptimizeProgram(&optimized_scope, &optimized),
+            0);
+  EXPECT_EQ(OpTypes(optimized),
+            std::vector<std::string>(
+                {"mul", "mul", "elementwise_add", "scale", "relu"}));
+  auto& optimized_block = optimized.Block(0);
+  EXPECT_TRUE(optimized_block.FindVar("ws")->Persistable());
+  EXPECT_EQ(optimized_block.FindVar("ws")->GetShape(),
+            std::vector<int64_t>({4, 3}));
+  for (auto name : {"w", "wt", "dx", "mask1", "mask2"}) {
+    EXPECT_EQ(optimized_block.FindVar(name), nullptr) << name;
+  }
+  // the replaced parameter is freed
+  EXPECT_EQ(optimized_scope.FindVar("w"), nullptr);
+
+  paddle::platform::CPUPlace place;
+  f::Executor executor(place);
+  executor.Run(program, &scope, 0, false, true);
+  executor.Run(optimized, &optimized_scope, 0, false, true);
+  auto& expected = scope.FindVar("out")->Get<f::LoDTensor>();
+  auto& actual = optimized_scope.FindVar("out")->Get<f::LoDTensor>();
+  ASSERT_EQ(expected.dims(), actual.dims());
+  for (int64_t i = 0; i < expected.numel(); ++i) {
+    EXPECT_NEAR(expected.data<float>()[i], actual.data<float>()[i], 1e-5);
+  }
+}
+
+TEST(Optimize, written_parameter_is_not_folded) {
+  f::ProgramDesc program;
+  auto* block = program.MutableBlock(0);
+  AddVar("w", {2, 2}, true, block);
+  AddVar("x", {2, 2}, false, block);
+  AddVar("y", {2, 2}, false, block);
+  // y = w * 2 reads w before the op which overwrites it
+  AddOp("scale", {{"X", {"w"}}}, {{"Out", {"y"}}}, {{"scale", 2.f}}, block);
+  AddOp("relu", {{"X", {"x"}}}, {{"Out", {"w"}}}, {}, block);
+
+  f::Scope scope;
+  f::Scope unused;
+  SetRandom("w", {2, 2}, &scope, &unused);
+  paddle::inference::ConstantFoldPass pass;
+  EXPECT_EQ(pass.Apply(&scope, &program), 0);
+  EXPECT_EQ(OpTypes(program), std::vector<std::string>({"scale", "relu"}));
+}
@@ -0,0 +1,348 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/predictor.h"
+
+#include <utility>
+#include "paddle/fluid/framework/feed_fetch_method.h"
+#include "paddle/fluid/framework/feed_fetch_type.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/inference/io.h"
+
+namespace paddle {
+namespace inference {
+
+struct Predictor::Model {
+  platform::Place place;
+  std::unique_ptr<framework::ProgramDesc> program;
+  // the parameters, which outlive the child scopes of the predictors
+  std::unique_ptr<framework::Scope> scope;
+  std::string feed_holder;
+  std::string fetch_holder;
+  std::vector<std::string> feed_names;
+  std::vector<std::string> fetch_names;
+  // the indices of the feed and fetch operators of every column
+  std::vector<size_t> feed_ops;
+  std::vector<size_t> fetch_ops;
+  // the variables every predictor creates in its own scope
+  std::vector<std::pair<std::string, framework::proto::VarType::Type>>
+      local_vars;
+  // the LoDTensors of local_vars
+  std::vector<std::string> temporaries;
+  // the kernels pinned to the operators of block 0, empty if not compiled
+  std::vector<std::unique_ptr<framework::OpKernelType>> kernel_types;
+};
+
+// Collect the targets of the feed or fetch operators of block and the
+// indices of the operators by their columns, and the name of their holder.
+static void CollectTargets(const framework::BlockDesc& block,
+                           const std::string& op_type,
+                           std::vector<std::string>* names,
+                           std::vector<size_t>* op_indices,
+                           std::string* holder) {
+  bool is_feed = op_type == framework::kFeedOpType;
+  auto ops = block.AllOps();
+  for (size_t i = 0; i < ops.size(); ++i) {
+    auto* op = ops[i];
+    if (op->Type() != op_type) continue;
+    auto name = is_feed ? op->Output("Out")[0] : op->Input("X")[0];
+    auto op_holder = is_feed ? op->Input("X")[0] : op->Output("Out")[0];
+    PADDLE_ENFORCE(holder->empty() || *holder == op_holder,
+                   "The %s operators should share one holder", op_type);
+    *holder = op_holder;
+    size_t col = static_cast<size_t>(boost::get<int>(op->GetAttr("col")));
+    if (col >= names->size()) {
+      names->resize(col + 1);
+      op_indices->resize(col + 1);
+    }
+    PADDLE_ENFORCE((*names)[col].empty(), "Duplicated column %d of %s", col,
+                   op_type);
+    (*names)[col] = name;
+    (*op_indices)[col] = i;
+  }
+  PADDLE_ENFORCE(!names->empty(), "The program has no %s operators", op_type);
+  for (auto& name : *names) {
+    PADDLE_ENFORCE(!name.empty(), "The columns of %s are not contiguous",
+                   op_type);
+  }
+}
+
+// The LoDTensor of a bound feed or fetch target in scope. The target should
+// be a temporary of the predictor, binding a parameter shared by the
+// predictors would let the caller write into it.
+static framework::LoDTensor* BoundTarget(const framework::ProgramDesc& program,
+                                         const framework::Scope& scope,
+                                         const std::string& name) {
+  auto* desc = program.Block(0).FindVar(name);
+  PADDLE_ENFORCE_NOT_NULL(desc, "The bound variable %s is not in the program",
+                          name);
+  PADDLE_ENFORCE(!desc->Persistable(), "The bound variable %s is persistable",
+                 name);
+  auto* var = scope.FindVar(name);
+  PADDLE_ENFORCE_NOT_NULL(var, "The bound variable %s is not created", name);
+  return var->GetMutable<framework::LoDTensor>();
+}
+
+std::shared_ptr<Predictor::Model> Predictor::MakeModel(
+    const platform::Place& place,
+    std::unique_ptr<framework::ProgramDesc> program,
+    std::unique_ptr<framework::Scope> scope) {
+  std::shared_ptr<Model> model(new Model);
+  model->place = place;
+  auto& block = program->Block(0);
+  CollectTargets(block, framework::kFeedOpType, &model->feed_names,
+                 &model->feed_ops, &model->feed_holder);
+  CollectTargets(block, framework::kFetchOpType, &model->fetch_names,
+                 &model->fetch_ops, &model->fetch_holder);
+  for (auto* var : block.AllVars()) {
+    if (var->Name() == framework::kEmptyVarName) continue;
+    auto type = var->GetType();
+    if (var->Persistable() &&
+        type != framework::proto::VarType::FEED_MINIBATCH &&
+        type != framework::proto::VarType::FETCH_LIST) {
+      PADDLE_ENFORCE(scope->FindVar(var->Name()) != nullptr,
+                     "The parameter %s is not loaded", var->Name());
+    } else {
+      model->local_vars.emplace_back(var->Name(), type);
+      if (type == framework::proto::VarType::LOD_TENSOR) {
+        model->temporaries.push_back(var->Name());
+      }
+    }
+  }
+  model->program = std::move(program);
+  model->scope = std::move(scope);
+  return model;
+}
+
+std::shared_ptr<const Predictor::Model> Predictor::LoadModel(
+    const platform::Place& place, const std::string& dirname,
+    const std::string& prog_filename, const std::string& param_filename,
+    bool use_mmap) {
+  framework::Executor executor(place);
+  std::unique_ptr<framework::Scope> scope(new framework::Scope);
+  std::unique_ptr<framework::ProgramDesc> program;
+  if (param_filename.empty()) {
+    program = Load(executor, *scope, dirname);
+  } else {
+    program = Load(executor, *scope, prog_filename, param_filename, use_mmap);
+  }
+  return MakeModel(place, std::move(program), std::move(scope));
+}
+
+std::shared_ptr<const Predictor::Model> Predictor::MakeModel(
+    CompiledModel* compiled) {
+  auto model = MakeModel(platform::CPUPlace(), std::move(compiled->program),
+                         std::move(compiled->scope));
+  PADDLE_ENFORCE_EQ(compiled->kernel_types.size(),
+                    model->program->Block(0).OpSize(),
+                    "The kernels do not match the operators of the program");
+  model->kernel_types = std::move(compiled->kernel_types);
+  return model;
+}
+
+Predictor::Predictor(const platform::Place& place, const std::string& dirname)
+    : Predictor(LoadModel(place, dirname, "", "", false)) {}
+
+Predictor::Predictor(const platform::Place& place,
+                     const std::string& prog_filename,
+                     const std::string& param_filename, bool use_mmap)
+    : Predictor(LoadModel(place, "", prog_filename, param_filename,
+                          use_mmap)) {}
+
+Predictor::Predictor(const platform::Place& place,
+                     std::unique_ptr<framework::ProgramDesc> program,
+                     std::unique_ptr<framework::Scope> scope)
+    : Predictor(MakeModel(place, std::move(program), std::move(scope))) {}
+
+Predictor::Predictor(CompiledModel model) : Predictor(MakeModel(&model)) {
+  arena_->Restore(model.arena_plan);
+}
+
+Predictor::Predictor(std::shared_ptr<const Model> model)
+    : model_(std::move(model)),
+      executor_(model_->place),
+      scope_(nullptr),
+      num_bindings_(0) {
+  Prepare();
+}
+
+Predictor::~Predictor() {
+  arena_.reset();
+  ctx_.reset();
+  model_->scope->DeleteScope(scope_);
+}
+
+void Predictor::Prepare() {
+  scope_ = &model_->scope->NewScope();
+  for (auto& var : model_->local_vars) {
+    framework::InitializeVariable(scope_->Var(var.first), var.second);
+  }
+  ctx_ = framework::Executor::Prepare(*model_->program, 0);
+  for (size_t i = 0; i < model_->kernel_types.size(); ++i) {
+    if (model_->kernel_types[i] == nullptr) continue;
+    auto* op =
+        dynamic_cast<framework::OperatorWithKernel*>(ctx_->ops_[i].get());
+    PADDLE_ENFORCE_NOT_NULL(op, "The operator %s has no kernels",
+                            ctx_->ops_[i]->Type());
+    op->PinKernel(*model_->kernel_types[i]);
+  }
+  arena_.reset(new FrozenArena(*model_->program, ctx_->ops_, scope_,
+                               model_->temporaries));
+  Unbind();
+}
+
+std::unique_ptr<Predictor> Predictor::Clone() const {
+  return std::unique_ptr<Predictor>(new Predictor(model_));
+}
+
+const std::vector<std::string>& Predictor::FeedNames() const {
+  return model_->feed_names;
+}
+
+const std::vector<std::string>& Predictor::FetchNames() const {
+  return model_->fetch_names;
+}
+
+const framework::ProgramDesc& Predictor::Program() const {
+  return *model_->program;
+}
+
+void Predictor::Run(const std::vector<framework::LoDTensor>& feeds,
+                    std::vector<framework::LoDTensor>* fetchs) {
+  PADDLE_ENFORCE_EQ(feeds.size(), model_->feed_names.size(),
+                    "The number of feeds should match the feed targets");
+  {
+    framework::TensorArena::Guard guard(arena_.get());
+    arena_->BeginRun();
+    for (size_t i = 0; i < feeds.size(); ++i) {
+      if (bound_feeds_[i] != nullptr) {
+        SetBoundFeed(i);
+      } else {
+        framework::SetFeedVariable(scope_, feeds[i], model_->feed_holder, i);
+      }
+    }
+    for (size_t i = 0; i < bound_fetchs_.size(); ++i) {
+      if (bound_fetchs_[i].data != nullptr) PrepareBoundFetch(i);
+    }
+    if (arena_->frozen() || num_bindings_ > 0) {
+      for (size_t i = 0; i < ctx_->ops_.size(); ++i) {
+        if (skip_ops_[i]) continue;
+        arena_->BeginOp(i);
+        ctx_->ops_[i]->Run(*scope_, model_->place);
+        arena_->EndOp();
+      }
+    } else {
+      executor_.RunPreparedContext(ctx_.get(), scope_, false, false);
+    }
+    arena_->EndRun();
+  }
+  fetchs->resize(model_->fetch_names.size());
+  for (size_t i = 0; i < fetchs->size(); ++i) {
+    if (bound_fetchs_[i].data != nullptr) {
+      GetBoundFetch(i, &(*fetchs)[i]);
+      continue;
+    }
+    auto& fetched =
+        framework::GetFetchVariable(*scope_, model_->fetch_holder, i);
+    (*fetchs)[i] = fetched;
+    // hand the fetched tensor over, so the next run does not overwrite it
+    if (!arena_->frozen()) fetched = framework::LoDTensor();
+  }
+}
+
+void Predictor::BindFeed(size_t col, const framework::LoDTensor* tensor) {
+  PADDLE_ENFORCE_LT(col, bound_feeds_.size(), "Invalid feed column %d", col);
+  PADDLE_ENFORCE_NOT_NULL(tensor, "The bound feed is null");
+  BoundTarget(*model_->program, *scope_, model_->feed_names[col]);
+  if (bound_feeds_[col] == nullptr) ++num_bindings_;
+  bound_feeds_[col] = tensor;
+  skip_ops_[model_->feed_ops[col]] = true;
+}
+
+void Predictor::BindFetch(size_t col, void* buffer, size_t size) {
+  PADDLE_ENFORCE_LT(col, bound_fetchs_.size(), "Invalid fetch column %d",
+                    col);
+  PADDLE_ENFORCE_NOT_NULL(buffer, "The bound fetch buffer is null");
+  PADDLE_ENFORCE_GT(size, 0UL, "The bound fetch buffer is empty");
+  BoundTarget(*model_->program, *scope_, model_->fetch_names[col]);
+  if (bound_fetchs_[col].data == nullptr) ++num_bindings_;
+  bound_fetchs_[col] = {buffer, size};
+  skip_ops_[model_->fetch_ops[col]] = true;
+}
+
+void Predictor::Unbind() {
+  bound_feeds_.assign(model_->feed_names.size(), nullptr);
+  bound_fetchs_.assign(model_->fetch_names.size(), {nullptr, 0});
+  skip_ops_.assign(ctx_->ops_.size(), false);
+  num_bindings_ = 0;
+}
+
+void Predictor::SetBoundFeed(size_t col) {
+  auto& tensor = *bound_feeds_[col];
+  auto* target =
+      BoundTarget(*model_->program, *scope_, model_->feed_names[col]);
+  if (platform::is_same_place(tensor.place(), model_->place)) {
+    target->ShareDataWith(tensor);
+  } else {
+    framework::TensorCopy(tensor, model_->place, target);
+  }
+  target->set_lod(tensor.lod());
+}
+
+void Predictor::PrepareBoundFetch(size_t col) {
+  if (!platform::is_cpu_place(model_->place)) return;
+  auto& buffer = bound_fetchs_[col];
+  auto* target =
+      BoundTarget(*model_->program, *scope_, model_->fetch_names[col]);
+  if (target->IsInitialized() && target->data<void>() == buffer.data) return;
+  // let the operator producing the target write into the buffer, its
+  // mutable_data keeps the memory if it fits
+  target->Resize(framework::make_ddim({static_cast<int64_t>(buffer.size)}));
+  target->ShareExternalData(buffer.data, buffer.size, typeid(uint8_t),
+                            std::shared_ptr<void>());
+}
+
+void Predictor::GetBoundFetch(size_t col, framework::LoDTensor* fetch) {
+  auto& buffer = bound_fetchs_[col];
+  auto& target =
+      *BoundTarget(*model_->program, *scope_, model_->fetch_names[col]);
+  PADDLE_ENFORCE_LE(target.numel() * framework::SizeOfType(target.type()),
+                    buffer.size,
+                    "The buffer bound to the fetch %s is too small",
+                    model_->fetch_names[col]);
+  if (platform::is_cpu_place(target.place()) &&
+      target.data<void>() == buffer.data) {
+    *fetch = target;
+    return;
+  }
+  // written elsewhere, e.g. shared with another tensor or on the GPU
+  fetch->Resize(target.dims());
+  fetch->ShareExternalData(buffer.data, buffer.size, target.type(),
+                           std::shared_ptr<void>());
+  framework::TensorCopy(target, platform::CPUPlace(), fetch);
+  platform::DeviceContextPool::Instance().Get(target.place())->Wait();
+  fetch->set_lod(target.lod());
+}
+
+void Predictor::FreezeMemory() {
+  PADDLE_ENFORCE(platform::is_cpu_place(model_->place),
+                 "FreezeMemory only supports CPUPlace");
+  arena_->Freeze();
+}
+
+const ArenaStats& Predictor::MemoryStats() const { return arena_->stats(); }
+
+}  // namespace inference
+}  // namespace paddle
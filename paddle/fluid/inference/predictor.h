@@ -0,0 +1,160 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/executor.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/inference/compiled_model.h"
+#include "paddle/fluid/inference/frozen_arena.h"
+#include "paddle/fluid/platform/macros.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace inference {
+
+// A loaded inference model which serves many threads.
+//
+// The program and the parameters are loaded once and shared by the
+// predictor and all its clones, the parameter scope is never written after
+// loading. Every clone has a child scope of the parameter scope for the
+// temporary variables and the feed and fetch holders, the prepared
+// operators, and the columns of the feed and fetch targets, so it runs
+// without allocating them again. A predictor must be used by one thread at
+// a time, call Clone for every other thread:
+//
+//   Predictor predictor(place, dirname);
+//   for (int i = 0; i < num_threads; ++i) {
+//     threads.emplace_back([&predictor] {
+//       auto local = predictor.Clone();
+//       local->Run(feeds, &fetchs);
+//     });
+//   }
+//
+// Clone is thread safe.
+class Predictor {
+ public:
+  // Load the model saved by fluid.io.save_inference_model in dirname.
+  Predictor(const platform::Place& place, const std::string& dirname);
+
+  // Load the program and the combined parameters, see inference::Load.
+  Predictor(const platform::Place& place, const std::string& prog_filename,
+            const std::string& param_filename, bool use_mmap = false);
+
+  // Serve a program whose parameters are loaded in scope, e.g. after
+  // FuseProgram or QuantizeProgram. The program should have the feed and
+  // fetch operators.
+  Predictor(const platform::Place& place,
+            std::unique_ptr<framework::ProgramDesc> program,
+            std::unique_ptr<framework::Scope> scope);
+
+  // Serve a compiled model on CPUPlace, see ReadCompiledModel. The kernels
+  // chosen by the compilation are run, and this predictor is frozen on the
+  // arena plan of the model from the first run, as FreezeMemory. The clones
+  // run the same kernels but are not frozen.
+  explicit Predictor(CompiledModel model);
+
+  ~Predictor();
+
+  // A predictor sharing the program and the parameters with this one.
+  std::unique_ptr<Predictor> Clone() const;
+
+  // The feed targets in the order of the feeds of Run.
+  const std::vector<std::string>& FeedNames() const;
+  // The fetch targets in the order of the fetchs of Run.
+  const std::vector<std::string>& FetchNames() const;
+  // The program run by the predictor, to inspect the feed targets.
+  const framework::ProgramDesc& Program() const;
+
+  // Run the program. feeds are shared with the program, not copied, and
+  // fetchs are resized to the number of the fetch targets.
+  void Run(const std::vector<framework::LoDTensor>& feeds,
+           std::vector<framework::LoDTensor>* fetchs);
+
+  // Bind the feed of column col to tensor, which is read by the operators
+  // in every run without the feed operator, so the caller can write the
+  // next feed in place. tensor is copied if it is not on the place of the
+  // predictor. It should outlive the binding, and the feeds of Run of the
+  // bound columns are ignored. The targets of the bound feeds and fetches
+  // should not be persistable.
+  void BindFeed(size_t col, const framework::LoDTensor* tensor);
+
+  // Bind the fetch of column col to a CPU buffer of size bytes owned by the
+  // caller. The operator producing the fetch writes it into buffer if it
+  // can, otherwise the fetch is copied there without the fetch operator.
+  // Run returns the fetch sharing buffer, the buffer should be large
+  // enough for the fetch.
+  void BindFetch(size_t col, void* buffer, size_t size);
+
+  // Remove the bindings of all the columns.
+  void Unbind();
+
+  // Serve the memory of the later runs from an arena, for the models whose
+  // feeds have the same shapes in every run, see FrozenArena. The fetches
+  // are then shared with the predictor and valid until the next run. Only
+  // CPUPlace is supported, the clones are not frozen.
+  void FreezeMemory();
+
+  // The allocations of the runs of this predictor.
+  const ArenaStats& MemoryStats() const;
+
+ private:
+  struct Model;
+
+  explicit Predictor(std::shared_ptr<const Model> model);
+
+  static std::shared_ptr<Model> MakeModel(
+      const platform::Place& place,
+      std::unique_ptr<framework::ProgramDesc> program,
+      std::unique_ptr<framework::Scope> scope);
+  // Take the program, the parameters and the kernels of compiled.
+  static std::shared_ptr<const Model> MakeModel(CompiledModel* compiled);
+  // Load the model of dirname, or of prog_filename and param_filename if
+  // param_filename is not empty.
+  static std::shared_ptr<const Model> LoadModel(
+      const platform::Place& place, const std::string& dirname,
+      const std::string& prog_filename, const std::string& param_filename,
+      bool use_mmap);
+
+  void Prepare();
+  void SetBoundFeed(size_t col);
+  void PrepareBoundFetch(size_t col);
+  void GetBoundFetch(size_t col, framework::LoDTensor* fetch);
+
+  std::shared_ptr<const Model> model_;
+  framework::Executor executor_;
+  framework::Scope* scope_;
+  std::unique_ptr<framework::ExecutorPrepareContext> ctx_;
+  std::unique_ptr<FrozenArena> arena_;
+
+  struct FetchBuffer {
+    void* data;
+    size_t size;
+  };
+  std::vector<const framework::LoDTensor*> bound_feeds_;
+  std::vector<FetchBuffer> bound_fetchs_;
+  // the feed and fetch operators of the bound columns
+  std::vector<bool> skip_ops_;
+  size_t num_bindings_;
+
+  DISABLE_COPY_AND_ASSIGN(Predictor);
+};
+
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,275 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/predictor.h"
+
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "paddle/fluid/framework/op_registry.h"
+
+USE_OP(mul);
+USE_NO_KERNEL_OP(feed);
+USE_NO_KERNEL_OP(fetch);
+
+namespace f = paddle::framework;
+
+static const int kIn = 4;
+static const int kOut = 3;
+
+static void AddVar(const std::string& name, f::proto::VarType::Type type,
+                   bool persistable, f::BlockDesc* block) {
+  auto* var = block->Var(name);
+  var->SetType(type);
+  // the feed and fetch lists have no data type
+  if (type == f::proto::VarType::LOD_TENSOR) {
+    var->SetDataType(f::proto::VarType::FP32);
+  }
+  var->SetPersistable(persistable);
+}
+
+static void AddOp(const std::string& type, const f::VariableNameMap& inputs,
+                  const f::VariableNameMap& outputs,
+                  const f::AttributeMap& attrs, f::BlockDesc* block) {
+  auto* op = block->AppendOp();
+  op->SetType(type);
+  for (auto& kv : inputs) op->SetInput(kv.first, kv.second);
+  for (auto& kv : outputs) op->SetOutput(kv.first, kv.second);
+  op->SetAttrMap(attrs);
+  op->CheckAttrs();
+}
+
+// feed -> x * w -> fetch, w is [kIn, kOut] of w[i][j] = i - j
+static paddle::inference::Predictor* MakePredictor() {
+  std::unique_ptr<f::ProgramDesc> program(new f::ProgramDesc);
+  auto* block = program->MutableBlock(0);
+  AddVar("feed", f::proto::VarType::FEED_MINIBATCH, true, block);
+  AddVar("fetch", f::proto::VarType::FETCH_LIST, true, block);
+  AddVar("x", f::proto::VarType::LOD_TENSOR, false, block);
+  AddVar("w", f::proto::VarType::LOD_TENSOR, true, block);
+  AddVar("out", f::proto::VarType::LOD_TENSOR, false, block);
+  AddOp("feed", {{"X", {"feed"}}}, {{"Out", {"x"}}}, {{"col", 0}}, block);
+  AddOp("mul", {{"X", {"x"}}, {"Y", {"w"}}}, {{"Out", {"out"}}}, {}, block);
+  AddOp("fetch", {{"X", {"out"}}}, {{"Out", {"fetch"}}}, {{"col", 0}}, block);
+
+  std::unique_ptr<f::Scope> scope(new f::Scope);
+  auto* w = scope->Var("w")->GetMutable<f::LoDTensor>();
+  float* w_data = w->mutable_data<float>(f::make_ddim({kIn, kOut}),
+                                         paddle::platform::CPUPlace());
+  for (int i = 0; i < kIn; ++i) {
+    for (int j = 0; j < kOut; ++j) w_data[i * kOut + j] = i - j;
+  }
+  return new paddle::inference::Predictor(
+      paddle::platform::CPUPlace(), std::move(program), std::move(scope));
+}
+
+static void RunAndCheck(paddle::inference::Predictor* predictor, int seed,
+                        int repeat) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  std::vector<f::LoDTensor> previous;
+  float previous_first = 0.f;
+  for (int r = 0; r < repeat; ++r) {
+    int batch = 1 + r % 5;
+    std::vector<f::LoDTensor> feeds(1);
+    float* x = feeds[0].mutable_data<float>(f::make_ddim({batch, kIn}),
+                                            paddle::platform::CPUPlace());
+    for (int i = 0; i < batch * kIn; ++i) x[i] = dist(rng);
+    std::vector<f::LoDTensor> fetchs;
+    predictor->Run(feeds, &fetchs);
+    ASSERT_EQ(fetchs.size(), 1UL);
+    ASSERT_EQ(fetchs[0].dims(), f::make_ddim({batch, kOut}));
+    const float* out = fetchs[0].data<float>();
+    for (int b = 0; b < batch; ++b) {
+      for (int j = 0; j < kOut; ++j) {
+        float expected = 0.f;
+        for (int i = 0; i < kIn; ++i) expected += x[b * kIn + i] * (i - j);
+        EXPECT_NEAR(out[b * kOut + j], expected, 1e-5);
+      }
+    }
+    if (!previous.empty()) {
+      // the outputs of a run are not overwritten by the next one
+      EXPECT_EQ(previous[0].data<float>()[0], previous_first);
+    }
+    previous = fetchs;
+    previous_first = out[0];
+  }
+}
+
+TEST(Predictor, Run) {
+  std::unique_ptr<paddle::inference::Predictor> predictor(MakePredictor());
+  EXPECT_EQ(predictor->FeedNames(), std::vector<std::string>({"x"}));
+  EXPECT_EQ(predictor->FetchNames(), std::vector<std::string>({"out"}));
+  RunAndCheck(predictor.get(), 0, 10);
+}
+
+TEST(Predictor, MultiThread) {
+  std::unique_ptr<paddle::inference::Predictor> predictor(MakePredictor());
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&predictor, t] {
+      auto local = predictor->Clone();
+      RunAndCheck(local.get(), t, 50);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+}
+
+// feed -> depth layers of x * w_i -> fetch, every w_i is [width, width]
+static paddle::inference::Predictor* MakeDeepPredictor(int width, int depth) {
+  std::unique_ptr<f::ProgramDesc> program(new f::ProgramDesc);
+  std::unique_ptr<f::Scope> scope(new f::Scope);
+  auto* block = program->MutableBlock(0);
+  AddVar("feed", f::proto::VarType::FEED_MINIBATCH, true, block);
+  AddVar("fetch", f::proto::VarType::FETCH_LIST, true, block);
+  AddVar("h0", f::proto::VarType::LOD_TENSOR, false, block);
+  AddOp("feed", {{"X", {"feed"}}}, {{"Out", {"h0"}}}, {{"col", 0}}, block);
+  for (int d = 0; d < depth; ++d) {
+    auto w = "w" + std::to_string(d);
+    auto in = "h" + std::to_string(d);
+    auto out = "h" + std::to_string(d + 1);
+    AddVar(w, f::proto::VarType::LOD_TENSOR, true, block);
+    AddVar(out, f::proto::VarType::LOD_TENSOR, false, block);
+    AddOp("mul", {{"X", {in}}, {"Y", {w}}}, {{"Out", {out}}}, {}, block);
+    float* w_data = scope->Var(w)->GetMutable<f::LoDTensor>()->mutable_data<
+        float>(f::make_ddim({width, width}), paddle::platform::CPUPlace());
+    for (int i = 0; i < width * width; ++i) {
+      w_data[i] = static_cast<float>((i * 7 + d) % 13 - 6) / width;
+    }
+  }
+  AddOp("fetch", {{"X", {"h" + std::to_string(depth)}}}, {{"Out", {"fetch"}}},
+        {{"col", 0}}, block);
+  return new paddle::inference::Predictor(
+      paddle::platform::CPUPlace(), std::move(program), std::move(scope));
+}
+
+TEST(Predictor, FreezeMemory) {
+  const int width = 16, depth = 4, batch = 3;
+  std::unique_ptr<paddle::inference::Predictor> predictor(
+      MakeDeepPredictor(width, depth));
+  auto frozen = predictor->Clone();
+  frozen->FreezeMemory();
+
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  for (int r = 0; r < 6; ++r) {
+    // the shapes change once, the arena is planned again
+    int rows = r < 4 ? batch : 2 * batch;
+    std::vector<f::LoDTensor> feeds(1);
+    float* x = feeds[0].mutable_data<float>(f::make_ddim({rows, width}),
+                                            paddle::platform::CPUPlace());
+    for (int i = 0; i < rows * width; ++i) x[i] = dist(rng);
+    std::vector<f::LoDTensor> expected, fetchs;
+    predictor->Run(feeds, &expected);
+    int64_t allocs = frozen->MemoryStats().allocs;
+    frozen->Run(feeds, &fetchs);
+    ASSERT_EQ(fetchs[0].dims(), expected[0].dims());
+    for (int i = 0; i < rows * width; ++i) {
+      EXPECT_EQ(fetchs[0].data<float>()[i], expected[0].data<float>()[i]);
+    }
+    if (r == 2 || r == 3) {
+      // the arena is recorded in the first two runs after freezing
+      EXPECT_EQ(frozen->MemoryStats().allocs, allocs);
+      EXPECT_EQ(frozen->MemoryStats().plans, 1);
+      // h1 ... h4 are packed by their lives, h_i and h_{i+2} share memory
+      EXPECT_LT(frozen->MemoryStats().arena_bytes,
+                static_cast<size_t>(depth * rows * width) * sizeof(float));
+    }
+  }
+  EXPECT_EQ(frozen->MemoryStats().runs, 6);
+  EXPECT_EQ(frozen->MemoryStats().plans, 1);
+}
+
+TEST(Predictor, BindFeedFetch) {
+  const int width = 16, depth = 3, batch = 4;
+  std::unique_ptr<paddle::inference::Predictor> predictor(
+      MakeDeepPredictor(width, depth));
+  for (bool freeze : {false, true}) {
+    auto bound = predictor->Clone();
+    if (freeze) bound->FreezeMemory();
+    f::LoDTensor x;
+    float* x_data = x.mutable_data<float>(f::make_ddim({batch, width}),
+                                          paddle::platform::CPUPlace());
+    std::vector<float> buffer(batch * width);
+    bound->BindFeed(0, &x);
+    bound->BindFetch(0, buffer.data(), buffer.size() * sizeof(float));
+
+    for (int r = 0; r < 5; ++r) {
+      // the caller writes the next feed in place
+      for (int i = 0; i < batch * width; ++i) x_data[i] = (i + r) % 7 * 0.1f;
+      std::vector<f::LoDTensor> feeds(1), expected, fetchs;
+      feeds[0].ShareDataWith(x);
+      predictor->Run(feeds, &expected);
+      int64_t allocs = bound->MemoryStats().allocs;
+      // the feeds of the bound columns are ignored
+      bound->Run(std::vector<f::LoDTensor>(1), &fetchs);
+      ASSERT_EQ(fetchs.size(), 1UL);
+      ASSERT_EQ(fetchs[0].dims(), expected[0].dims());
+      // the last operator wrote the fetch into the buffer
+      EXPECT_EQ(fetchs[0].data<float>(), buffer.data());
+      for (int i = 0; i < batch * width; ++i) {
+        EXPECT_EQ(buffer[i], expected[0].data<float>()[i]);
+      }
+      if (r > 2) {
+        // nothing is copied to the feed holder or from the fetch operator
+        EXPECT_EQ(bound->MemoryStats().allocs, allocs);
+      }
+    }
+  }
+}
+
+TEST(Predictor, BindFetchTooSmall) {
+  const int width = 8, batch = 2;
+  std::unique_ptr<paddle::inference::Predictor> predictor(
+      MakeDeepPredictor(width, 2));
+  std::vector<float> buffer(batch * width - 1);
+  predictor->BindFetch(0, buffer.data(), buffer.size() * sizeof(float));
+  std::vector<f::LoDTensor> feeds(1), fetchs;
+  feeds[0].mutable_data<float>(f::make_ddim({batch, width}),
+                               paddle::platform::CPUPlace());
+  EXPECT_THROW(predictor->Run(feeds, &fetchs),
+               paddle::platform::EnforceNotMet);
+  predictor->Unbind();
+  predictor->Run(feeds, &fetchs);
+  EXPECT_EQ(fetchs[0].dims(), f::make_ddim({batch, width}));
+}
+
+TEST(Predictor, BindPersistable) {
+  // fetch the parameter w of x * w
+  std::unique_ptr<f::ProgramDesc> program(new f::ProgramDesc);
+  auto* block = program->MutableBlock(0);
+  AddVar("feed", f::proto::VarType::FEED_MINIBATCH, true, block);
+  AddVar("fetch", f::proto::VarType::FETCH_LIST, true, block);
+  AddVar("x", f::proto::VarType::LOD_TENSOR, false, block);
+  AddVar("w", f::proto::VarType::LOD_TENSOR, true, block);
+  AddVar("out", f::proto::VarType::LOD_TENSOR, false, block);
+  AddOp("feed", {{"X", {"feed"}}}, {{"Out", {"x"}}}, {{"col", 0}}, block);
+  AddOp("mul", {{"X", {"x"}}, {"Y", {"w"}}}, {{"Out", {"out"}}}, {}, block);
+  AddOp("fetch", {{"X", {"w"}}}, {{"Out", {"fetch"}}}, {{"col", 0}}, block);
+  std::unique_ptr<f::Scope> scope(new f::Scope);
+  scope->Var("w")->GetMutable<f::LoDTensor>()->mutable_data<float>(
+      f::make_ddim({kIn, kOut}), paddle::platform::CPUPlace());
+  paddle::inference::Predictor predictor(
+      paddle::platform::CPUPlace(), std::move(program), std::move(scope));
+
+  std::vector<float> buffer(kIn * kOut);
+  EXPECT_THROW(
+      predictor.BindFetch(0, buffer.data(), buffer.size() * sizeof(float)),
+      paddle::platform::EnforceNotMet);
+  f::LoDTensor x;
+  predictor.BindFeed(0, &x);
+}
@@ -0,0 +1,334 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/quantize.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <unordered_set>
+#include "paddle/fluid/framework/block_desc.h"
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/program_pass.h"
+#include "paddle/fluid/inference/io.h"
+#include "paddle/fluid/operators/math/quantization.h"
+
+namespace paddle {
+namespace inference {
+
+namespace {
+
+// The parameters of the input, weight and output of an op with INT8 kernel.
+struct Int8OpParams {
+  std::string input;
+  std::string weight;
+  std::string output;
+};
+
+const std::unordered_map<std::string, Int8OpParams>& Int8Ops() {
+  static const std::unordered_map<std::string, Int8OpParams> ops = {
+      {"mul", {"X", "Y", "Out"}}, {"conv2d", {"Input", "Filter", "Output"}}};
+  return ops;
+}
+
+// The INT8 parameters of op, nullptr if op has no INT8 kernel or its weight
+// is not a persistable float variable.
+const Int8OpParams* GetInt8Params(const framework::BlockDesc& block,
+                                  const framework::OpDesc& op) {
+  auto it = Int8Ops().find(op.Type());
+  if (it == Int8Ops().end()) return nullptr;
+  auto& params = it->second;
+  if (op.Input(params.input).size() != 1 ||
+      op.Input(params.weight).size() != 1) {
+    return nullptr;
+  }
+  if (!framework::IsParameter(block, op.Input(params.weight)[0])) {
+    return nullptr;
+  }
+  return &params;
+}
+
+// Quantize the float weight to the int8 variable name + ".int8" in scope.
+// The weight is viewed as [pre, channels, post], and the scales of the
+// channels are stored in the float variable name + ".scale".
+void QuantizeWeight(const std::string& name, int64_t pre, int64_t channels,
+                    bool per_channel, framework::Scope* scope,
+                    framework::BlockDesc* block) {
+  auto* var = scope->FindVar(name);
+  PADDLE_ENFORCE_NOT_NULL(var, "The weight %s is not loaded", name);
+  auto& weight = var->Get<framework::LoDTensor>();
+  const float* weight_data = weight.data<float>();
+  int64_t numel = weight.numel();
+  PADDLE_ENFORCE_EQ(numel % (pre * channels), 0,
+                    "The weight %s can not be split into %d channels", name,
+                    channels);
+  int64_t post = numel / (pre * channels);
+
+  int64_t num_scales = per_channel ? channels : 1;
+  std::vector<float> ranges(num_scales, 0.0f);
+  for (int64_t i = 0; i < pre; ++i) {
+    for (int64_t c = 0; c < channels; ++c) {
+      const float* data = weight_data + (i * channels + c) * post;
+      float& range = ranges[per_channel ? c : 0];
+      for (int64_t j = 0; j < post; ++j) {
+        range = std::max(range, std::fabs(data[j]));
+      }
+    }
+  }
+
+  auto* scale = scope->Var(name + ".scale")->GetMutable<framework::LoDTensor>();
+  scale->Resize(framework::make_ddim({num_scales}));
+  float* scale_data = scale->mutable_data<float>(platform::CPUPlace());
+  for (int64_t c = 0; c < num_scales; ++c) {
+    scale_data[c] = operators::math::Int8Scale(ranges[c]);
+  }
+
+  auto* quantized =
+      scope->Var(name + ".int8")->GetMutable<framework::LoDTensor>();
+  quantized->Resize(weight.dims());
+  int8_t* quantized_data =
+      quantized->mutable_data<int8_t>(platform::CPUPlace());
+  for (int64_t i = 0; i < pre; ++i) {
+    for (int64_t c = 0; c < channels; ++c) {
+      int64_t offset = (i * channels + c) * post;
+      float s = scale_data[per_channel ? c : 0];
+      for (int64_t j = 0; j < post; ++j) {
+        quantized_data[offset + j] =
+            operators::math::QuantizeToInt8(weight_data[offset + j], s);
+      }
+    }
+  }
+
+  auto* weight_desc = block->FindVar(name);
+  framework::CreateVar(block, name + ".int8", framework::proto::VarType::INT8,
+                       weight_desc->GetShape(), true);
+  framework::CreateVar(block, name + ".scale", framework::proto::VarType::FP32,
+                       {num_scales}, true);
+}
+
+// The int32 output of an INT8 kernel which is not dequantized yet.
+struct Int32Output {
+  std::string name;
+  std::string weight_scale;
+  float input_scale;
+  int axis;
+};
+
+}  // namespace
+
+Calibrator::Calibrator(framework::ProgramDesc& program) : program_(program) {
+  const framework::BlockDesc& block = program_.Block(0);
+  std::unordered_set<std::string> inputs;
+  for (auto* op : block.AllOps()) {
+    auto* params = GetInt8Params(block, *op);
+    if (params == nullptr) continue;
+    auto& input = op->Input(params->input)[0];
+    if (inputs.insert(input).second) inputs_.push_back(input);
+  }
+}
+
+void Calibrator::Run(framework::Executor& executor, framework::Scope& scope,
+                     const std::vector<framework::LoDTensor*>& feeds) {
+  const std::vector<std::string> feed_target_names =
+      program_.GetFeedTargetNames();
+  const std::vector<std::string> fetch_target_names =
+      program_.GetFetchTargetNames();
+  PADDLE_ENFORCE_EQ(feeds.size(), feed_target_names.size(),
+                    "The calibration data should feed all the feed targets");
+
+  std::map<std::string, const framework::LoDTensor*> feed_targets;
+  for (size_t i = 0; i < feeds.size(); ++i) {
+    feed_targets[feed_target_names[i]] = feeds[i];
+  }
+  std::vector<framework::LoDTensor> fetches(fetch_target_names.size());
+  std::map<std::string, framework::LoDTensor*> fetch_targets;
+  for (size_t i = 0; i < fetches.size(); ++i) {
+    fetch_targets[fetch_target_names[i]] = &fetches[i];
+  }
+
+  // Run in scope without the local scope, so that the inputs are kept.
+  executor.CreateVariables(program_, &scope, 0);
+  executor.Run(program_, &scope, feed_targets, fetch_targets, false);
+
+  for (auto& input : inputs_) {
+    auto* var = scope.FindVar(input);
+    if (var == nullptr || !var->IsType<framework::LoDTensor>()) continue;
+    auto& tensor = var->Get<framework::LoDTensor>();
+    if (!tensor.IsInitialized() ||
+        framework::ToDataType(tensor.type()) !=
+            framework::proto::VarType::FP32) {
+      continue;
+    }
+    const float* data = tensor.data<float>();
+    float& range = ranges_[input];
+    for (int64_t i = 0; i < tensor.numel(); ++i) {
+      range = std::max(range, std::fabs(data[i]));
+    }
+  }
+}
+
+void QuantizeProgram(const std::unordered_map<std::string, float>& ranges,
+                     bool per_channel, framework::Scope* scope,
+                     framework::ProgramDesc* program) {
+  framework::BlockDesc* block = program->MutableBlock(0);
+
+  std::unordered_map<std::string, int> num_consumers;
+  for (auto* op : block->AllOps()) {
+    for (auto& name : op->InputArgumentNames()) ++num_consumers[name];
+  }
+
+  std::unordered_set<std::string> quantized_weights;
+  // The float outputs which are computed as int32 and not dequantized yet.
+  std::unordered_map<std::string, Int32Output> int32_outputs;
+
+  auto insert_dequantize = [&](size_t index, const std::string& out,
+                               const Int32Output& int32_output) {
+    auto* op = block->InsertOp(index);
+    op->SetType("dequantize");
+    op->SetInput("X", {int32_output.name});
+    op->SetInput("Scale", {int32_output.weight_scale});
+    op->SetOutput("Out", {out});
+    op->SetAttr("scale", int32_output.input_scale);
+    op->SetAttr("axis", int32_output.axis);
+    op->CheckAttrs();
+  };
+
+  for (size_t i = 0; i < block->OpSize(); ++i) {
+    auto* op = block->Op(i);
+
+    // Max pooling on the int32 output which has no other consumer. The
+    // pooling mixes the values in a window of H and W, so the scales should
+    // not vary along them, i.e. the scales are per tensor or per the channel
+    // dim 1 of NCHW.
+    if (op->Type() == "pool2d" &&
+        boost::get<std::string>(op->GetAttr("pooling_type")) == "max") {
+      auto input = op->Input("X")[0];
+      auto it = int32_outputs.find(input);
+      if (it != int32_outputs.end() && num_consumers[input] == 1 &&
+          (!per_channel || it->second.axis == 1)) {
+        Int32Output int32_output = it->second;
+        int32_outputs.erase(it);
+        auto out = op->Output("Out")[0];
+        op->SetInput("X", {int32_output.name});
+        int32_output.name = out + ".int32";
+        framework::CreateVar(block, int32_output.name,
+                             framework::proto::VarType::INT32,
+                             block->FindVar(out)->GetShape(), false);
+        op->SetOutput("Out", {int32_output.name});
+        op->SetAttr("use_cudnn", false);
+        op->SetAttr("use_mkldnn", false);
+        int32_outputs[out] = int32_output;
+        continue;
+      }
+    }
+
+    // Dequantize the int32 outputs before their first float consumer.
+    for (auto& input : op->InputArgumentNames()) {
+      auto it = int32_outputs.find(input);
+      if (it == int32_outputs.end()) continue;
+      insert_dequantize(i++, input, it->second);
+      int32_outputs.erase(it);
+    }
+
+    auto* params = GetInt8Params(*block, *op);
+    if (params == nullptr) continue;
+    auto input = op->Input(params->input)[0];
+    auto range = ranges.find(input);
+    if (range == ranges.end()) continue;
+
+    auto weight = op->Input(params->weight)[0];
+    auto weight_shape = block->FindVar(weight)->GetShape();
+    int axis = 1;
+    if (quantized_weights.insert(weight).second) {
+      if (op->Type() == "mul") {
+        // The channels are the columns of the flattened weight.
+        int y_num_col_dims = boost::get<int>(op->GetAttr("y_num_col_dims"));
+        int64_t pre = 1;
+        for (int d = 0; d < y_num_col_dims; ++d) pre *= weight_shape[d];
+        int64_t channels = 1;
+        for (size_t d = y_num_col_dims; d < weight_shape.size(); ++d) {
+          channels *= weight_shape[d];
+        }
+        QuantizeWeight(weight, pre, channels, per_channel, scope, block);
+      } else {
+        // The channels are the output channels of the filter.
+        QuantizeWeight(weight, 1, weight_shape[0], per_channel, scope, block);
+      }
+    }
+    if (op->Type() == "mul") {
+      axis = boost::get<int>(op->GetAttr("x_num_col_dims"));
+    }
+
+    float scale = operators::math::Int8Scale(range->second);
+    auto quantized_input = input + ".int8";
+    framework::CreateVar(block, quantized_input,
+                         framework::proto::VarType::INT8,
+                         block->FindVar(input)->GetShape(), false);
+    auto* quantize = block->InsertOp(i++);
+    quantize->SetType("quantize");
+    quantize->SetInput("X", {input});
+    quantize->SetOutput("Out", {quantized_input});
+    quantize->SetAttr("scale", scale);
+    quantize->CheckAttrs();
+
+    auto out = op->Output(params->output)[0];
+    Int32Output int32_output{out + ".int32", weight + ".scale", scale, axis};
+    framework::CreateVar(block, int32_output.name,
+                         framework::proto::VarType::INT32,
+                         block->FindVar(out)->GetShape(), false);
+    op->SetInput(params->input, {quantized_input});
+    op->SetInput(params->weight, {weight + ".int8"});
+    op->SetOutput(params->output, {int32_output.name});
+    if (op->Type() == "conv2d") {
+      op->SetAttr("use_cudnn", false);
+      op->SetAttr("use_mkldnn", false);
+    }
+    int32_outputs[out] = int32_output;
+  }
+
+  for (auto& it : int32_outputs) {
+    insert_dequantize(block->OpSize(), it.first, it.second);
+  }
+
+  // Drop the float weights which are not used any more.
+  std::unordered_set<std::string> used;
+  for (auto* op : block->AllOps()) {
+    for (auto& name : op->InputArgumentNames()) used.insert(name);
+  }
+  std::vector<std::string> unused;
+  for (auto& weight : quantized_weights) {
+    if (used.count(weight) == 0) unused.push_back(weight);
+  }
+  framework::RemoveVars(block, unused);
+  scope->EraseVars(unused);
+  block->Flush();
+}
+
+std::unique_ptr<framework::ProgramDesc> LoadQuantized(
+    framework::Executor& executor, framework::Scope& scope,
+    const std::string& dirname,
+    const std::vector<std::vector<framework::LoDTensor*>>& samples,
+    bool per_channel) {
+  std::unique_ptr<framework::ProgramDesc> program =
+      Load(executor, scope, dirname);
+  Calibrator calibrator(*program);
+  for (auto& feeds : samples) {
+    calibrator.Run(executor, scope, feeds);
+  }
+  QuantizeProgram(calibrator.Ranges(), per_channel, &scope, program.get());
+  return program;
+}
+
+}  // namespace inference
+}  // namespace paddle
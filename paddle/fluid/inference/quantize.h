@@ -0,0 +1,78 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/framework/executor.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/scope.h"
+
+namespace paddle {
+namespace inference {
+
+// Post-training INT8 quantization of the inference programs on CPU.
+//
+// Calibrator runs the program on some sample data and records the max
+// absolute values of the float inputs of the ops with INT8 kernels.
+// QuantizeProgram then quantizes the weights of these ops to int8 in the
+// scope, and rewrites
+//   mul/conv2d(X, W) -> Out
+// to
+//   quantize(X) -> mul/conv2d(X.int8, W.int8) -> Out.int32
+//     -> dequantize(Out.int32, W.scale) -> Out
+// A max pool2d which reads the int32 output is run before the dequantize,
+// since the max pooling commutes with the positive scales if they do not
+// vary in its windows.
+class Calibrator {
+ public:
+  explicit Calibrator(framework::ProgramDesc& program);
+
+  // Run the program on a batch of the sample data, feeds are in the order
+  // of the feed targets of the program.
+  void Run(framework::Executor& executor, framework::Scope& scope,
+           const std::vector<framework::LoDTensor*>& feeds);
+
+  // The calibrated ranges of the inputs.
+  const std::unordered_map<std::string, float>& Ranges() const {
+    return ranges_;
+  }
+
+ private:
+  framework::ProgramDesc& program_;
+  std::vector<std::string> inputs_;
+  std::unordered_map<std::string, float> ranges_;
+};
+
+// Rewrite the ops whose inputs are calibrated in ranges to the INT8
+// kernels. If per_channel is true, every output channel of a weight has
+// its own scale, otherwise the weight has one scale.
+void QuantizeProgram(const std::unordered_map<std::string, float>& ranges,
+                     bool per_channel, framework::Scope* scope,
+                     framework::ProgramDesc* program);
+
+// Load the inference model in dirname, calibrate it on the samples and
+// quantize it.
+std::unique_ptr<framework::ProgramDesc> LoadQuantized(
+    framework::Executor& executor, framework::Scope& scope,
+    const std::string& dirname,
+    const std::vector<std::vector<framework::LoDTensor*>>& samples,
+    bool per_channel = true);
+
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,199 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/quantize.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/op_registry.h"
+
+USE_OP(mul);
+USE_OP(pool2d);
+USE_CPU_ONLY_OP(conv2d);
+USE_CPU_ONLY_OP(quantize);
+USE_CPU_ONLY_OP(dequantize);
+USE_NO_KERNEL_OP(feed);
+USE_NO_KERNEL_OP(fetch);
+
+namespace f = paddle::framework;
+
+static void AddVar(const std::string& name, f::proto::VarType::Type type,
+                   const std::vector<int64_t>& shape, bool persistable,
+                   f::BlockDesc* block) {
+  auto* var = block->Var(name);
+  var->SetType(type);
+  // the feed and fetch lists have no data type
+  if (type == f::proto::VarType::LOD_TENSOR) {
+    var->SetDataType(f::proto::VarType::FP32);
+    var->SetShape(shape);
+  }
+  var->SetPersistable(persistable);
+}
+
+static void AddOp(const std::string& type, const f::VariableNameMap& inputs,
+                  const f::VariableNameMap& outputs,
+                  const f::AttributeMap& attrs, f::BlockDesc* block) {
+  auto* op = block->AppendOp();
+  op->SetType(type);
+  for (auto& kv : inputs) op->SetInput(kv.first, kv.second);
+  for (auto& kv : outputs) op->SetOutput(kv.first, kv.second);
+  op->SetAttrMap(attrs);
+  op->CheckAttrs();
+}
+
+// feed -> mul -> max pool2d -> conv2d -> max pool2d -> fetch. The mul
+// multiplies the last dim of x [2, 3, 8, 6] by w [6, 8], so its output is
+// an image whose columns are the channels of w.
+static void MakeProgram(f::ProgramDesc* program) {
+  const f::AttributeMap kMaxPool = {{"pooling_type", std::string("max")},
+                                    {"ksize", std::vector<int>({2, 2})},
+                                    {"strides", std::vector<int>({2, 2})}};
+  auto* block = program->MutableBlock(0);
+  AddVar("feed", f::proto::VarType::FEED_MINIBATCH, {}, true, block);
+  AddVar("fetch", f::proto::VarType::FETCH_LIST, {}, true, block);
+  AddVar("x", f::proto::VarType::LOD_TENSOR, {2, 3, 8, 6}, false, block);
+  AddVar("w", f::proto::VarType::LOD_TENSOR, {6, 8}, true, block);
+  AddVar("mul_out", f::proto::VarType::LOD_TENSOR, {2, 3, 8, 8}, false,
+         block);
+  AddVar("pool_out", f::proto::VarType::LOD_TENSOR, {2, 3, 4, 4}, false,
+         block);
+  AddVar("filter", f::proto::VarType::LOD_TENSOR, {4, 3, 3, 3}, true, block);
+  AddVar("conv_out", f::proto::VarType::LOD_TENSOR, {2, 4, 2, 2}, false,
+         block);
+  AddVar("out", f::proto::VarType::LOD_TENSOR, {2, 4, 1, 1}, false, block);
+  AddOp("feed", {{"X", {"feed"}}}, {{"Out", {"x"}}}, {{"col", 0}}, block);
+  AddOp("mul", {{"X", {"x"}}, {"Y", {"w"}}}, {{"Out", {"mul_out"}}},
+        {{"x_num_col_dims", 3}, {"y_num_col_dims", 1}}, block);
+  AddOp("pool2d", {{"X", {"mul_out"}}}, {{"Out", {"pool_out"}}}, kMaxPool,
+        block);
+  AddOp("conv2d", {{"Input", {"pool_out"}}, {"Filter", {"filter"}}},
+        {{"Output", {"conv_out"}}}, {}, block);
+  AddOp("pool2d", {{"X", {"conv_out"}}}, {{"Out", {"out"}}}, kMaxPool,
+        block);
+  AddOp("fetch", {{"X", {"out"}}}, {{"Out", {"fetch"}}}, {{"col", 0}},
+        block);
+}
+
+static void SetRandom(f::LoDTensor* tensor, const std::vector<int64_t>& shape,
+                      std::mt19937* engine) {
+  std::uniform_real_distribution<float> dist(-1, 1);
+  float* data = tensor->mutable_data<float>(f::make_ddim(shape),
+                                            paddle::platform::CPUPlace());
+  for (int64_t i = 0; i < tensor->numel(); ++i) data[i] = dist(*engine);
+}
+
+// The weights, the columns of w differ in magnitude, so that the
+// per-channel scales matter.
+static void MakeWeights(f::Scope* scope) {
+  std::mt19937 engine(0);
+  auto* w = scope->Var("w")->GetMutable<f::LoDTensor>();
+  SetRandom(w, {6, 8}, &engine);
+  for (int i = 0; i < 6; ++i) {
+    for (int j = 0; j < 8; ++j) w->data<float>()[i * 8 + j] *= 1 + j;
+  }
+  SetRandom(scope->Var("filter")->GetMutable<f::LoDTensor>(), {4, 3, 3, 3},
+            &engine);
+}
+
+static f::LoDTensor Run(const f::ProgramDesc& program, f::Scope* scope,
+                        const f::LoDTensor& x) {
+  paddle::platform::CPUPlace place;
+  f::Executor executor(place);
+  f::LoDTensor out;
+  std::map<std::string, const f::LoDTensor*> feeds = {{"x", &x}};
+  std::map<std::string, f::LoDTensor*> fetches = {{"out", &out}};
+  executor.Run(program, scope, feeds, fetches);
+  return out;
+}
+
+static std::vector<std::string> OpTypes(const f::ProgramDesc& program) {
+  std::vector<std::string> types;
+  for (auto* op : program.Block(0).AllOps()) types.push_back(op->Type());
+  return types;
+}
+
+static void CheckQuantize(bool per_channel) {
+  std::mt19937 engine(1);
+  std::vector<f::LoDTensor> samples(4);
+  for (auto& sample : samples) SetRandom(&sample, {2, 3, 8, 6}, &engine);
+
+  f::ProgramDesc program;
+  MakeProgram(&program);
+  f::Scope scope;
+  MakeWeights(&scope);
+  paddle::platform::CPUPlace place;
+  f::Executor executor(place);
+  paddle::inference::Calibrator calibrator(program);
+  for (auto& sample : samples) calibrator.Run(executor, scope, {&sample});
+  auto& ranges = calibrator.Ranges();
+  EXPECT_EQ(ranges.size(), 2UL);
+  EXPECT_GT(ranges.at("x"), 0.9f);
+  EXPECT_GT(ranges.at("pool_out"), 0.f);
+
+  f::ProgramDesc quantized(program);
+  f::Scope quantized_scope;
+  MakeWeights(&quantized_scope);
+  paddle::inference::QuantizeProgram(ranges, per_channel, &quantized_scope,
+                                     &quantized);
+  // The scales of the channels of w vary along the W dim of the output of
+  // mul, so the first pooling runs on float if they are per channel. The
+  // scales of the filter are per the channel dim of NCHW, so the second one
+  // always runs on int32.
+  std::vector<std::string> types = {"feed", "quantize", "mul", "pool2d",
+                                    "dequantize", "quantize", "conv2d",
+                                    "pool2d", "dequantize", "fetch"};
+  if (per_channel) std::swap(types[3], types[4]);
+  EXPECT_EQ(OpTypes(quantized), types);
+  auto* block = quantized.MutableBlock(0);
+  auto* mul_dequantize = block->Op(per_channel ? 3 : 4);
+  EXPECT_EQ(block->Op(2)->Input("Y")[0], "w.int8");
+  EXPECT_EQ(block->Op(3)->Input("X")[0], "mul_out.int32");
+  EXPECT_EQ(boost::get<int>(mul_dequantize->GetAttr("axis")), 3);
+  EXPECT_EQ(block->Op(6)->Input("Filter")[0], "filter.int8");
+  EXPECT_EQ(block->Op(7)->Input("X")[0], "conv_out.int32");
+  EXPECT_EQ(block->Op(8)->Input("X")[0], "out.int32");
+  EXPECT_EQ(boost::get<int>(block->Op(8)->GetAttr("axis")), 1);
+  EXPECT_EQ(block->FindVar("w"), nullptr);
+  EXPECT_EQ(quantized_scope.FindVar("filter"), nullptr);
+  int64_t num_scales = per_channel ? 8 : 1;
+  EXPECT_EQ(
+      quantized_scope.FindVar("w.scale")->Get<f::LoDTensor>().numel(),
+      num_scales);
+
+  // The error of the two INT8 layers on the calibrated inputs is within 5%
+  // of the range of the float output, it is about 2% here.
+  float range = 0.f;
+  float max_error = 0.f;
+  for (auto& sample : samples) {
+    f::LoDTensor expected = Run(program, &scope, sample);
+    f::LoDTensor actual = Run(quantized, &quantized_scope, sample);
+    ASSERT_EQ(expected.dims(), actual.dims());
+    for (int64_t i = 0; i < expected.numel(); ++i) {
+      range = std::max(range, std::fabs(expected.data<float>()[i]));
+      max_error = std::max(max_error, std::fabs(expected.data<float>()[i] -
+                                                actual.data<float>()[i]));
+    }
+  }
+  EXPECT_LE(max_error, 0.05f * range);
+}
+
+TEST(Quantize, per_channel) { CheckQuantize(true); }
+
+TEST(Quantize, per_tensor) { CheckQuantize(false); }
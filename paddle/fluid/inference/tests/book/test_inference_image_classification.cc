@@ -15,6 +15,7 @@ limitations under the License. */
 #include "gflags/gflags.h"
 #include "gtest/gtest.h"
 #include "paddle/fluid/inference/tests/test_helper.h"
+#include "paddle/fluid/inference/tests/test_multi_thread_helper.h"
 
 DEFINE_string(dirname, "", "Directory of the inference model.");
 DEFINE_int32(batch_size, 1, "Batch size of input data");
@@ -50,6 +51,62 @@ TEST(inference, image_classification) {
                                                    cpu_fetchs1, FLAGS_repeat);
   LOG(INFO) << output1.dims();
 
+  paddle::framework::LoDTensor output_fused;
+  std::vector<paddle::framework::LoDTensor*> cpu_fetchs_fused;
+  cpu_fetchs_fused.push_back(&output_fused);
+
+  // Run the fused program on CPU, the outputs should match the unfused ones
+  LOG(INFO) << "--- CPU Fused Runs: ---";
+  TestInference<paddle::platform::CPUPlace, false>(
+      dirname, cpu_feeds, cpu_fetchs_fused, FLAGS_repeat, false, true);
+  CheckError<float>(output1, output_fused);
+
+  paddle::framework::LoDTensor output_optimized;
+  std::vector<paddle::framework::LoDTensor*> cpu_fetchs_optimized;
+  cpu_fetchs_optimized.push_back(&output_optimized);
+
+  // Run the optimized program on CPU, the dropouts and the constant ops are
+  // folded, so the outputs should match the original ones
+  LOG(INFO) << "--- CPU Optimized Runs: ---";
+  TestOptimizedInference(dirname, cpu_feeds, cpu_fetchs_optimized,
+                         FLAGS_repeat);
+  CheckError<float>(output1, output_optimized);
+
+  paddle::framework::LoDTensor output_int8;
+  std::vector<paddle::framework::LoDTensor*> cpu_fetchs_int8;
+  cpu_fetchs_int8.push_back(&output_int8);
+
+  // Run the INT8 inference on CPU, calibrated on the same input
+  LOG(INFO) << "--- CPU INT8 Runs: ---";
+  TestQuantizedInference(dirname, cpu_feeds, cpu_fetchs_int8, FLAGS_repeat);
+  // The outputs are the softmax probabilities
+  CheckQuantizedError(output1, output_int8, 0.1f);
+
+  // Run the inference on CPU with the FP16 and BF16 weights
+  for (auto dtype : {paddle::framework::proto::VarType::FP16,
+                     paddle::framework::proto::VarType::BF16}) {
+    paddle::framework::LoDTensor output_half;
+    std::vector<paddle::framework::LoDTensor*> cpu_fetchs_half;
+    cpu_fetchs_half.push_back(&output_half);
+
+    std::string name = paddle::framework::DataTypeToString(dtype);
+    LOG(INFO) << "--- CPU " << name << " Weight Runs: ---";
+    TestHalfInference(dirname, cpu_feeds, cpu_fetchs_half, dtype,
+                      FLAGS_repeat);
+    float max_error_bound =
+        dtype == paddle::framework::proto::VarType::FP16 ? 0.01f : 0.05f;
+    CheckQuantizedError(output1, output_half, max_error_bound, name);
+  }
+
+  // Serve the model from several threads sharing the parameters
+  for (int num_threads : {1, 4}) {
+    LOG(INFO) << "--- CPU Predictor Runs (num_threads: " << num_threads
+              << "): ---";
+    auto outputs = TestPredictorThroughput<paddle::platform::CPUPlace>(
+        dirname, cpu_feeds, num_threads, FLAGS_repeat);
+    CheckError<float>(output1, outputs[0]);
+  }
+
 #ifdef PADDLE_WITH_CUDA
   paddle::framework::LoDTensor output2;
   std::vector<paddle::framework::LoDTensor*> cpu_fetchs2;
@@ -13,13 +13,21 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 #pragma once
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
 #include <map>
 #include <random>
 #include <string>
 #include <vector>
 
+#include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/inference/fusion.h"
+#include "paddle/fluid/inference/half_precision.h"
 #include "paddle/fluid/inference/io.h"
+#include "paddle/fluid/inference/optimize.h"
+#include "paddle/fluid/inference/quantize.h"
 #include "paddle/fluid/platform/profiler.h"
 
 template <typename T>
@@ -93,7 +101,8 @@ template <typename Place, bool CreateVars = true>
 void TestInference(const std::string& dirname,
                    const std::vector<paddle::framework::LoDTensor*>& cpu_feeds,
                    const std::vector<paddle::framework::LoDTensor*>& cpu_fetchs,
-                   const int repeat = 1, const bool is_combined = false) {
+                   const int repeat = 1, const bool is_combined = false,
+                   const bool fuse = false) {
   // 1. Define place, executor, scope
   auto place = Place();
   auto executor = paddle::framework::Executor(place);
@@ -140,6 +149,12 @@ void TestInference(const std::string& dirname,
       // `dirname`.
       inference_program = paddle::inference::Load(executor, *scope, dirname);
     }
+
+    if (fuse) {
+      int fusions =
+          paddle::inference::FuseProgram(scope, inference_program.get());
+      LOG(INFO) << "Fused " << fusions << " patterns of the program";
+    }
   }
   // Disable the profiler and print the timing information
   paddle::platform::DisableProfiler(paddle::platform::EventSortingKey::kDefault,
@@ -200,3 +215,161 @@ void TestInference(const std::string& dirname,
 
   delete scope;
 }
+
+// Run the loaded inference_program on cpu_feeds on CPU, the runs after the
+// first one are profiled to name + "_profiler.txt".
+inline void RunCPUInference(
+    paddle::framework::Executor& executor, paddle::framework::Scope* scope,
+    paddle::framework::ProgramDesc& inference_program,
+    const std::vector<paddle::framework::LoDTensor*>& cpu_feeds,
+    const std::vector<paddle::framework::LoDTensor*>& cpu_fetchs,
+    const int repeat, const std::string& name) {
+  const std::vector<std::string>& feed_target_names =
+      inference_program.GetFeedTargetNames();
+  const std::vector<std::string>& fetch_target_names =
+      inference_program.GetFetchTargetNames();
+  std::map<std::string, const paddle::framework::LoDTensor*> feed_targets;
+  for (size_t i = 0; i < feed_target_names.size(); ++i) {
+    feed_targets[feed_target_names[i]] = cpu_feeds[i];
+  }
+  std::map<std::string, paddle::framework::LoDTensor*> fetch_targets;
+  for (size_t i = 0; i < fetch_target_names.size(); ++i) {
+    fetch_targets[fetch_target_names[i]] = cpu_fetchs[i];
+  }
+
+  // Ignore the profiling results of the first run
+  executor.Run(inference_program, scope, feed_targets, fetch_targets);
+
+  paddle::platform::EnableProfiler(paddle::platform::ProfilerState::kCPU);
+  for (int i = 0; i < repeat; ++i) {
+    paddle::platform::RecordEvent record_event(
+        name, paddle::platform::DeviceContextPool::Instance().Get(
+                  paddle::platform::CPUPlace()));
+    executor.Run(inference_program, scope, feed_targets, fetch_targets);
+  }
+  paddle::platform::DisableProfiler(paddle::platform::EventSortingKey::kDefault,
+                                    name + "_profiler.txt");
+  paddle::platform::ResetProfiler();
+}
+
+// Calibrate the model on cpu_feeds, quantize it to INT8 and run it on CPU.
+inline void TestQuantizedInference(
+    const std::string& dirname,
+    const std::vector<paddle::framework::LoDTensor*>& cpu_feeds,
+    const std::vector<paddle::framework::LoDTensor*>& cpu_fetchs,
+    const int repeat = 1) {
+  auto place = paddle::platform::CPUPlace();
+  auto executor = paddle::framework::Executor(place);
+  auto* scope = new paddle::framework::Scope();
+
+  std::unique_ptr<paddle::framework::ProgramDesc> inference_program =
+      paddle::inference::LoadQuantized(executor, *scope, dirname, {cpu_feeds});
+  RunCPUInference(executor, scope, *inference_program, cpu_feeds, cpu_fetchs,
+                  repeat, "run_quantized_inference");
+
+  delete scope;
+}
+
+// Store the weights of the model in dtype, FP16 or BF16, and run it on CPU.
+inline void TestHalfInference(
+    const std::string& dirname,
+    const std::vector<paddle::framework::LoDTensor*>& cpu_feeds,
+    const std::vector<paddle::framework::LoDTensor*>& cpu_fetchs,
+    paddle::framework::proto::VarType::Type dtype, const int repeat = 1) {
+  auto place = paddle::platform::CPUPlace();
+  auto executor = paddle::framework::Executor(place);
+  auto* scope = new paddle::framework::Scope();
+
+  // Convert all the weights of the small book models.
+  std::unique_ptr<paddle::framework::ProgramDesc> inference_program =
+      paddle::inference::LoadHalf(executor, *scope, dirname, dtype, 0);
+  RunCPUInference(executor, scope, *inference_program, cpu_feeds, cpu_fetchs,
+                  repeat,
+                  "run_" + paddle::framework::DataTypeToString(dtype) +
+                      "_inference");
+
+  delete scope;
+}
+
+// Run the program loaded from dirname on CPU before and after
+// OptimizeProgram, and log the number of the ops and the mean latency of
+// both. The outputs of the optimized program are in cpu_fetchs.
+inline void TestOptimizedInference(
+    const std::string& dirname,
+    const std::vector<paddle::framework::LoDTensor*>& cpu_feeds,
+    const std::vector<paddle::framework::LoDTensor*>& cpu_fetchs,
+    const int repeat = 1) {
+  auto place = paddle::platform::CPUPlace();
+  auto executor = paddle::framework::Executor(place);
+  size_t num_ops[2];
+  double latency_ms[2];
+  for (int optimize = 0; optimize < 2; ++optimize) {
+    paddle::framework::Scope scope;
+    auto inference_program = paddle::inference::Load(executor, scope, dirname);
+    if (optimize) {
+      int rewrites =
+          paddle::inference::OptimizeProgram(&scope, inference_program.get(),
+                                             place);
+      LOG(INFO) << "Optimized the program with " << rewrites << " rewrites";
+    }
+    num_ops[optimize] = inference_program->Block(0).OpSize();
+
+    std::map<std::string, const paddle::framework::LoDTensor*> feed_targets;
+    auto& feed_target_names = inference_program->GetFeedTargetNames();
+    for (size_t i = 0; i < feed_target_names.size(); ++i) {
+      feed_targets[feed_target_names[i]] = cpu_feeds[i];
+    }
+    std::map<std::string, paddle::framework::LoDTensor*> fetch_targets;
+    auto& fetch_target_names = inference_program->GetFetchTargetNames();
+    for (size_t i = 0; i < fetch_target_names.size(); ++i) {
+      fetch_targets[fetch_target_names[i]] = cpu_fetchs[i];
+    }
+
+    // Ignore the first run
+    executor.Run(*inference_program, &scope, feed_targets, fetch_targets);
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; ++i) {
+      executor.Run(*inference_program, &scope, feed_targets, fetch_targets);
+    }
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - begin;
+    latency_ms[optimize] = elapsed.count() / repeat;
+  }
+  LOG(INFO) << "Optimized inference: " << num_ops[0] << " -> " << num_ops[1]
+            << " ops, " << latency_ms[0] << " -> " << latency_ms[1]
+            << " ms per run";
+}
+
+// Compare the output of the INT8 or half precision inference with the
+// float one. The outputs are not exact, so the max error should be at most
+// max_error_bound, and the number of the rows whose argmax changed is logged.
+inline void CheckQuantizedError(const paddle::framework::LoDTensor& output,
+                                const paddle::framework::LoDTensor& quantized,
+                                float max_error_bound,
+                                const std::string& name = "INT8") {
+  EXPECT_EQ(output.dims(), quantized.dims());
+  if (output.dims() != quantized.dims()) return;
+
+  const float* data = output.data<float>();
+  const float* quantized_data = quantized.data<float>();
+  float max_error = 0;
+  for (int64_t i = 0; i < output.numel(); ++i) {
+    max_error = std::max(max_error, std::fabs(data[i] - quantized_data[i]));
+  }
+
+  int64_t rows = output.dims()[0];
+  int64_t width = output.numel() / rows;
+  int64_t mismatches = 0;
+  for (int64_t i = 0; i < rows; ++i) {
+    const float* row = data + i * width;
+    const float* quantized_row = quantized_data + i * width;
+    if (std::max_element(row, row + width) - row !=
+        std::max_element(quantized_row, quantized_row + width) -
+            quantized_row) {
+      mismatches++;
+    }
+  }
+  LOG(INFO) << name << " inference: max error " << max_error << ", "
+            << mismatches << " of " << rows << " rows changed the argmax";
+  EXPECT_LE(max_error, max_error_bound) << name;
+}
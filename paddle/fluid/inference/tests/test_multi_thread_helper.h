@@ -14,12 +14,15 @@ limitations under the License. */
 
 #pragma once
 
+#include <algorithm>
+#include <chrono>  // NOLINT
 #include <map>
 #include <string>
 #include <thread>  // NOLINT
 #include <vector>
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/inference/io.h"
+#include "paddle/fluid/inference/predictor.h"
 
 void ThreadedRunInference(
     const std::unique_ptr<paddle::framework::ProgramDesc>& inference_program,
@@ -88,3 +91,48 @@ void TestMultiThreadInference(
 
   delete scope;
 }
+
+// Serve the model with num_threads clones of one Predictor, every thread
+// runs cpu_feeds repeat times. Logs the QPS and the percentiles of the
+// latency, and returns the outputs of the last run of the first thread.
+template <typename Place>
+std::vector<paddle::framework::LoDTensor> TestPredictorThroughput(
+    const std::string& dirname,
+    const std::vector<paddle::framework::LoDTensor*>& cpu_feeds,
+    const int num_threads, const int repeat) {
+  paddle::inference::Predictor predictor(Place(), dirname);
+  std::vector<paddle::framework::LoDTensor> feeds;
+  for (auto* feed : cpu_feeds) feeds.push_back(*feed);
+
+  std::vector<std::vector<double>> latencies(num_threads);
+  std::vector<paddle::framework::LoDTensor> fetchs;
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&, i] {
+      auto local = predictor.Clone();
+      std::vector<paddle::framework::LoDTensor> outs;
+      for (int r = 0; r < repeat; ++r) {
+        auto begin = std::chrono::steady_clock::now();
+        local->Run(feeds, &outs);
+        latencies[i].push_back(std::chrono::duration<double, std::milli>(
+                                   std::chrono::steady_clock::now() - begin)
+                                   .count());
+      }
+      if (i == 0) fetchs = outs;
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+  std::vector<double> all;
+  for (auto& each : latencies) all.insert(all.end(), each.begin(), each.end());
+  std::sort(all.begin(), all.end());
+  LOG(INFO) << "Predictor threads: " << num_threads
+            << ", QPS: " << all.size() / seconds
+            << ", latency p50: " << all[all.size() / 2]
+            << "ms, p99: " << all[all.size() * 99 / 100] << "ms";
+  return fetchs;
+}
@@ -16,6 +16,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/detail/safe_ref.h"
+#include "paddle/fluid/operators/math/cpu_vec.h"
 #include "paddle/fluid/platform/float16.h"
 
 #ifdef PADDLE_WITH_MKLDNN
@@ -25,6 +26,14 @@ limitations under the License. */
 namespace paddle {
 namespace operators {
 
+// The activations with a vectorized kernel in math/cpu_vec.h, Compute
+// returns false for the others.
+template <typename DeviceContext, typename Functor>
+struct VecActivation {
+  using T = typename Functor::ELEMENT_TYPE;
+  static bool Compute(int64_t n, const T* x, T* out) { return false; }
+};
+
 template <typename DeviceContext, typename Functor>
 class ActivationKernel
     : public framework::OpKernel<typename Functor::ELEMENT_TYPE> {
@@ -40,6 +49,10 @@ class ActivationKernel
                             "Cannot get output tensor Out, variable name = %s",
                             context.op().Output("Out"));
     Out.mutable_data<T>(context.GetPlace());
+    if (VecActivation<DeviceContext, Functor>::Compute(
+            X.numel(), X.data<T>(), Out.data<T>())) {
+      return;
+    }
     auto x = framework::EigenVector<T>::Flatten(X);
     auto out = framework::EigenVector<T>::Flatten(Out);
     auto* place =
@@ -199,6 +212,21 @@ struct TanhGradFunctor : public BaseActivationFunctor<T> {
   }
 };
 
+#define DEFINE_VEC_ACTIVATION(functor, vec_func)                           \
+  template <>                                                              \
+  struct VecActivation<platform::CPUDeviceContext, functor<float>> {       \
+    static bool Compute(int64_t n, const float* x, float* out) {           \
+      math::vec_func(n, x, out);                                           \
+      return true;                                                         \
+    }                                                                      \
+  }
+
+DEFINE_VEC_ACTIVATION(SigmoidFunctor, VecSigmoid);
+DEFINE_VEC_ACTIVATION(ExpFunctor, VecExp);
+DEFINE_VEC_ACTIVATION(ReluFunctor, VecRelu);
+DEFINE_VEC_ACTIVATION(TanhFunctor, VecTanh);
+#undef DEFINE_VEC_ACTIVATION
+
 // tanhshrink(x) = x - tanh(x)
 // where tanh(x) = (exp(x) - exp(-x)) / (exp(x) + exp(-x))
 template <typename T>
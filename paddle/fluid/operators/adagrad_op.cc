@@ -17,6 +17,7 @@ limitations under the License. */
 
 #include <cmath>
 
+#include "paddle/fluid/operators/lazy_sparse_update.h"
 #include "paddle/fluid/operators/math/math_function.h"
 #include "paddle/fluid/operators/math/selected_rows_functor.h"
 
@@ -93,12 +94,6 @@ for numerical stability to avoid the division by zero error.
   }
 };
 
-namespace {
-size_t FindPos(const std::vector<int64_t>& rows, int64_t value) {
-  return std::find(rows.begin(), rows.end(), value) - rows.begin();
-}
-}  // namespace
-
 template <typename T>
 struct SparseAdagradFunctor<platform::CPUDeviceContext, T> {
   void operator()(const platform::CPUDeviceContext& context,
@@ -107,30 +102,24 @@ struct SparseAdagradFunctor<platform::CPUDeviceContext, T> {
                   framework::Tensor* moment, framework::Tensor* param) {
     // 1. g_m.rows = set(g.rows)
     auto grad_width = grad.value().dims()[1];
-    math::scatter::MergeAdd<platform::CPUDeviceContext, T> merge_func;
-    auto grad_merge = merge_func(context, grad);
-    auto& merge_rows = grad_merge.rows();
-    auto* grad_merge_data = grad_merge.mutable_value()->template data<T>();
-
-    // 2. m += g_m * g_m
-    math::scatter::Mul<platform::CPUDeviceContext, T> sqare_func;
-    auto grad_square = sqare_func(context, grad_merge, grad_merge);
+    auto grad_merge = MergeSparseGrad<T>(context, grad);
+    const int64_t* merge_rows = grad_merge.rows().data();
+    const T* grad_merge_data = grad_merge.value().template data<T>();
 
-    math::SelectedRowsAddToTensor<platform::CPUDeviceContext, T> functor;
-    functor(context, grad_square, moment);
-
-    // 3. update parameter
-    auto* lr = learning_rate.data<T>();
+    // 2. m += g_m * g_m, and update the parameter, the rows are updated in
+    // parallel.
+    T lr = learning_rate.data<T>()[0];
     auto* param_data = param->data<T>();
     auto* moment_data = moment->data<T>();
-
-    for (size_t i = 0; i < merge_rows.size(); i++) {
+    ParallelForRows(grad_merge.rows().size(), grad_width, [&](int64_t i) {
+      const T* g = grad_merge_data + i * grad_width;
+      T* m = moment_data + merge_rows[i] * grad_width;
+      T* p = param_data + merge_rows[i] * grad_width;
       for (int64_t j = 0; j < grad_width; j++) {
-        param_data[merge_rows[i] * grad_width + j] -=
-            lr[0] * grad_merge_data[i * grad_width + j] /
-            (std::sqrt(moment_data[merge_rows[i] * grad_width + j]) + epsilon);
+        m[j] += g[j] * g[j];
+        p[j] -= lr * g[j] / (std::sqrt(m[j]) + epsilon);
       }
-    }
+    });
   }
 };
 
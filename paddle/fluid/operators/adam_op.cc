@@ -68,6 +68,16 @@ class AdamOp : public framework::OperatorWithKernel {
     ctx->SetOutputDim("ParamOut", param_dims);
     ctx->SetOutputDim("Moment1Out", param_dims);
     ctx->SetOutputDim("Moment2Out", param_dims);
+    if (ctx->HasInput("RowStep")) {
+      ctx->SetOutputDim("RowStepOut", ctx->GetInputDim("RowStep"));
+    }
+  }
+
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext &ctx) const override {
+    // RowStep is int64, the kernel type follows Param.
+    auto data_type = framework::GetDataTypeOfVar(ctx.InputVar("Param"));
+    return framework::OpKernelType(data_type, ctx.device_context());
   }
 };
 
@@ -86,6 +96,13 @@ class AdamOpMaker : public framework::OpProtoAndCheckerMaker {
     AddOutput("ParamOut", "(Tensor) Output parameter");
     AddOutput("Moment1Out", "(Tensor) Output first moment");
     AddOutput("Moment2Out", "(Tensor) Output second moment");
+    AddInput("RowStep",
+             "(Tensor<int64>, optional) The step on which every row was last "
+             "updated by a sparse gradient, of shape [height + 1], the last "
+             "element counts the steps. Only used in the lazy sparse update.")
+        .AsDispensable();
+    AddOutput("RowStepOut", "(Tensor<int64>, optional) Output RowStep")
+        .AsDispensable();
 
     AddAttr<float>("beta1",
                    "(float, default 0.9) "
@@ -120,6 +137,11 @@ learning\_rate = learning\_rate *
 param\_out = param - learning\_rate * \frac{moment\_1}{\sqrt{moment\_2} + \epsilon}
 $$
 
+If Grad is SelectedRows, only the rows in it are updated (the lazy mode), and
+the cost of a step is proportional to the number of the unique rows. With
+RowStep, the decay of the moments on the steps a row was skipped is applied
+when the row is updated again.
+
 )DOC");
   }
 };
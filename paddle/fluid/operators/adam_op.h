@@ -16,6 +16,7 @@ limitations under the License. */
 #include <math.h>  // for sqrt in CPU and CUDA
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/detail/safe_ref.h"
+#include "paddle/fluid/operators/lazy_sparse_update.h"
 #include "paddle/fluid/operators/math/selected_rows_functor.h"
 #include "paddle/fluid/platform/for_range.h"
 
@@ -199,6 +200,12 @@ class AdamOpKernel : public framework::OpKernel<T> {
           merge_func(ctx.template device_context<DeviceContext>(), grad);
       auto& grad_tensor = grad_merge.value();
       const T* grad_data = grad_tensor.template data<T>();
+      if (platform::is_cpu_place(ctx.GetPlace())) {
+        LazyUpdateCPU(ctx, beta1, beta2, epsilon, grad_merge, param, mom1,
+                      mom2, lr, beta1_pow, beta2_pow, &param_out, &mom1_out,
+                      &mom2_out);
+        return;
+      }
       int64_t* rows = nullptr;
       if (platform::is_gpu_place(ctx.GetPlace())) {
         rows = grad_merge.mutable_rows()->CUDAMutableData(ctx.GetPlace());
@@ -223,6 +230,92 @@ class AdamOpKernel : public framework::OpKernel<T> {
       PADDLE_THROW("Variable type not supported by adam_op");
     }
   }
+
+ private:
+  // Only the rows of the merged gradient are updated, in parallel. If
+  // RowStep is set, the moments of a row skipped for k steps are decayed by
+  // beta1^k and beta2^k, and the parameter is moved by the updates of those
+  // steps when it is touched again.
+  void LazyUpdateCPU(const framework::ExecutionContext& ctx, T beta1, T beta2,
+                     T epsilon, const framework::SelectedRows& grad,
+                     const framework::Tensor& param,
+                     const framework::Tensor& mom1,
+                     const framework::Tensor& mom2,
+                     const framework::Tensor& lr,
+                     const framework::Tensor& beta1_pow,
+                     const framework::Tensor& beta2_pow,
+                     framework::Tensor* param_out, framework::Tensor* mom1_out,
+                     framework::Tensor* mom2_out) const {
+    int64_t height = param.dims()[0];
+    // the step is counted even if no row is updated on it.
+    RowStep row_step(GetRowStep(ctx), height);
+    if (grad.rows().size() == 0) return;
+    int64_t row_numel = grad.value().numel() / grad.rows().size();
+    const int64_t* rows = grad.rows().data();
+    for (size_t i = 0; i < grad.rows().size(); ++i) {
+      PADDLE_ENFORCE_LT(rows[i], height,
+                        "Input rows index should less than height");
+    }
+
+    const T* g = grad.value().template data<T>();
+    const T* p = param.template data<T>();
+    const T* m1 = mom1.template data<T>();
+    const T* m2 = mom2.template data<T>();
+    T* p_out = param_out->template mutable_data<T>(ctx.GetPlace());
+    T* m1_out = mom1_out->template mutable_data<T>(ctx.GetPlace());
+    T* m2_out = mom2_out->template mutable_data<T>(ctx.GetPlace());
+    T b1_pow = *beta1_pow.template data<T>();
+    T b2_pow = *beta2_pow.template data<T>();
+    T lr_val = *lr.template data<T>();
+    T lr_t = lr_val * sqrt(1 - b2_pow) / (1 - b1_pow);
+
+    ParallelForRows(grad.rows().size(), row_numel, [&](int64_t i) {
+      int64_t skipped = row_step.Touch(rows[i]);
+      T decay1 = std::pow(beta1, static_cast<T>(skipped));
+      T decay2 = std::pow(beta2, static_cast<T>(skipped));
+      T moved = SkippedStepsRate(lr_val, beta1, beta2,
+                                 row_step.Step() - skipped - 1, skipped);
+      int64_t offset = rows[i] * row_numel;
+      for (int64_t j = 0; j < row_numel; ++j) {
+        T gj = g[i * row_numel + j];
+        T p_old = p[offset + j];
+        if (moved != 0) {
+          p_old -= moved * m1[offset + j] / (sqrt(m2[offset + j]) + epsilon);
+        }
+        T mom1 = beta1 * decay1 * m1[offset + j] + (1 - beta1) * gj;
+        T mom2 = beta2 * decay2 * m2[offset + j] + (1 - beta2) * gj * gj;
+        m1_out[offset + j] = mom1;
+        m2_out[offset + j] = mom2;
+        p_out[offset + j] = p_old - lr_t * (mom1 / (sqrt(mom2) + epsilon));
+      }
+    });
+  }
+
+  // On a skipped step s the parameter moves by
+  //   lr_s * beta1^q * m / (sqrt(beta2^q * v) + epsilon),
+  // q being the number of steps since the last update and lr_s the bias
+  // corrected learning rate of step s. Taking the epsilon as unscaled by
+  // sqrt(beta2^q), this is m / (sqrt(v) + epsilon) times the sum of
+  // lr_s * (beta1 / sqrt(beta2))^q over the skipped steps, which is
+  // returned here. last is the step on which the row was last updated. The
+  // terms decay geometrically, so the sum stops once they are negligible.
+  static T SkippedStepsRate(T lr, T beta1, T beta2, int64_t last,
+                            int64_t skipped) {
+    T rate = 0;
+    if (skipped <= 0) return rate;
+    T b1_pow = std::pow(beta1, static_cast<T>(last));
+    T b2_pow = std::pow(beta2, static_cast<T>(last));
+    T ratio = beta1 / std::sqrt(beta2);
+    T weight = 1;
+    for (int64_t q = 1; q <= skipped; ++q) {
+      b1_pow *= beta1;
+      b2_pow *= beta2;
+      weight *= ratio;
+      rate += lr * std::sqrt(1 - b2_pow) / (1 - b1_pow) * weight;
+      if (weight < static_cast<T>(1e-7)) break;
+    }
+    return rate;
+  }
 };
 
 }  // namespace operators
@@ -62,6 +62,16 @@ class AdamaxOp : public framework::OperatorWithKernel {
     ctx->SetOutputDim("ParamOut", param_dims);
     ctx->SetOutputDim("MomentOut", param_dims);
     ctx->SetOutputDim("InfNormOut", param_dims);
+    if (ctx->HasInput("RowStep")) {
+      ctx->SetOutputDim("RowStepOut", ctx->GetInputDim("RowStep"));
+    }
+  }
+
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext &ctx) const override {
+    // RowStep is int64, the kernel type follows Param.
+    auto data_type = framework::GetDataTypeOfVar(ctx.InputVar("Param"));
+    return framework::OpKernelType(data_type, ctx.device_context());
   }
 };
 
@@ -83,6 +93,13 @@ class AdamaxOpMaker : public framework::OpProtoAndCheckerMaker {
     AddOutput("InfNormOut",
               "(Tensor) "
               "Output exponentially weighted infinity norm");
+    AddInput("RowStep",
+             "(Tensor<int64>, optional) The step on which every row was last "
+             "updated by a sparse gradient, of shape [height + 1], the last "
+             "element counts the steps. Only used in the lazy sparse update.")
+        .AsDispensable();
+    AddOutput("RowStepOut", "(Tensor<int64>, optional) Output RowStep")
+        .AsDispensable();
 
     AddAttr<float>("beta1",
                    "(float, default 0.9) "
@@ -114,6 +131,11 @@ learning\_rate = \frac{learning\_rate}{1 - \beta_{1\_pow}} \\
 param\_out = param - learning\_rate * \frac{moment\_out}{inf\_norm\_out}
 $$
 
+If Grad is SelectedRows, only the rows in it are updated (the lazy mode), and
+the cost of a step is proportional to the number of the unique rows. With
+RowStep, the decay of the moments on the steps a row was skipped is applied
+when the row is updated again.
+
 The original paper does not have an epsilon attribute.
 However, it is added here for numerical stability to prevent the
 division by 0 error.
@@ -15,6 +15,7 @@ limitations under the License. */
 #pragma once
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/lazy_sparse_update.h"
 
 namespace paddle {
 namespace operators {
@@ -35,6 +36,14 @@ class AdamaxOpKernel : public framework::OpKernel<T> {
     T beta2 = static_cast<T>(ctx.Attr<float>("beta2"));
     T epsilon = static_cast<T>(ctx.Attr<float>("epsilon"));
 
+    auto* grad_var = ctx.InputVar("Grad");
+    if (grad_var->IsType<framework::SelectedRows>()) {
+      LazyUpdate(ctx, grad_var->Get<framework::SelectedRows>(), beta1, beta2,
+                 epsilon, param_out_tensor, moment_out_tensor,
+                 inf_norm_out_tensor);
+      return;
+    }
+
     auto param = framework::EigenVector<T>::Flatten(
         *ctx.Input<framework::Tensor>("Param"));
     auto grad = framework::EigenVector<T>::Flatten(
@@ -61,6 +70,65 @@ class AdamaxOpKernel : public framework::OpKernel<T> {
     param_out.device(*place) =
         param - lr_t.broadcast(m_dsize) * (moment_out / inf_norm_out);
   }
+
+ private:
+  // Only the rows of the merged gradient are updated, in parallel. If
+  // RowStep is set, the moment of a row skipped for k steps is decayed by
+  // beta1^k and the infinity norm by beta2^k (plus the epsilon added on
+  // every step) when it is touched again. The parameter updates of the
+  // skipped steps are not replayed.
+  void LazyUpdate(const framework::ExecutionContext& ctx,
+                  const framework::SelectedRows& grad, T beta1, T beta2,
+                  T epsilon, framework::Tensor* param_out,
+                  framework::Tensor* moment_out,
+                  framework::Tensor* inf_norm_out) const {
+    PADDLE_ENFORCE(platform::is_cpu_place(ctx.GetPlace()),
+                   "sparse adamax only supports CPUPlace");
+    auto& param = *ctx.Input<framework::Tensor>("Param");
+    int64_t height = param.dims()[0];
+    // the step is counted even if no row is updated on it.
+    RowStep row_step(GetRowStep(ctx), height);
+    if (grad.rows().size() == 0) return;
+    auto grad_merge = MergeSparseGrad<T>(
+        ctx.template device_context<platform::CPUDeviceContext>(), grad);
+    const int64_t* rows = grad_merge.rows().data();
+    int64_t num_rows = grad_merge.rows().size();
+    int64_t row_numel = grad_merge.value().numel() / num_rows;
+    for (int64_t i = 0; i < num_rows; ++i) {
+      PADDLE_ENFORCE_LT(rows[i], height,
+                        "Input rows index should less than height");
+    }
+
+    const T* g = grad_merge.value().template data<T>();
+    const T* p = param.template data<T>();
+    const T* m = ctx.Input<framework::Tensor>("Moment")->template data<T>();
+    const T* u = ctx.Input<framework::Tensor>("InfNorm")->template data<T>();
+    T lr = ctx.Input<framework::Tensor>("LearningRate")->template data<T>()[0];
+    T beta1_pow =
+        ctx.Input<framework::Tensor>("Beta1Pow")->template data<T>()[0];
+    T lr_t = lr / (1 - beta1_pow);
+    T* p_out = param_out->template data<T>();
+    T* m_out = moment_out->template data<T>();
+    T* u_out = inf_norm_out->template data<T>();
+    ParallelForRows(num_rows, row_numel, [&](int64_t i) {
+      int64_t skipped = row_step.Touch(rows[i]);
+      T m_decay = std::pow(beta1, static_cast<T>(skipped));
+      T u_decay = std::pow(beta2, static_cast<T>(skipped));
+      // epsilon * (1 + beta2 + ... + beta2^(k-1))
+      T u_eps = skipped > 0 ? epsilon * (1 + GeometricSum(beta2, skipped - 1))
+                            : static_cast<T>(0);
+      int64_t offset = rows[i] * row_numel;
+      for (int64_t j = 0; j < row_numel; ++j) {
+        T g_val = g[i * row_numel + j];
+        T m_new = beta1 * m_decay * m[offset + j] + (1 - beta1) * g_val;
+        T u_old = u_decay * u[offset + j] + u_eps;
+        T u_new = std::max(std::abs(g_val), beta2 * u_old + epsilon);
+        m_out[offset + j] = m_new;
+        u_out[offset + j] = u_new;
+        p_out[offset + j] = p[offset + j] - lr_t * (m_new / u_new);
+      }
+    });
+  }
 };
 
 }  // namespace operators
@@ -91,8 +91,16 @@ framework::OpKernelType ConvOp::GetExpectedKernelType(
       framework::ToDataType(ctx.Input<Tensor>("Input")->type());
   auto filter_data_type =
       framework::ToDataType(ctx.Input<Tensor>("Filter")->type());
-  PADDLE_ENFORCE_EQ(input_data_type, filter_data_type,
-                    "input and filter data type should be consistent");
+  // The float kernel widens the FP16 or BF16 filter of the half precision
+  // CPU inference.
+  bool half_filter = platform::is_cpu_place(ctx.GetPlace()) &&
+                     input_data_type == framework::proto::VarType::FP32 &&
+                     (filter_data_type == framework::proto::VarType::FP16 ||
+                      filter_data_type == framework::proto::VarType::BF16);
+  if (!half_filter) {
+    PADDLE_ENFORCE_EQ(input_data_type, filter_data_type,
+                      "input and filter data type should be consistent");
+  }
 
   if (input_data_type == framework::proto::VarType::FP16) {
     PADDLE_ENFORCE_EQ(library, framework::LibraryType::kCUDNN,
@@ -331,6 +339,70 @@ framework::OpKernelType ConvOpGrad::GetExpectedKernelType(
       layout_, library_);
 }
 
+bool FastConv2D<platform::CPUDeviceContext, float>::Compute(
+    const platform::CPUDeviceContext& context, const Tensor& input,
+    const Tensor& filter, int groups, const std::vector<int>& strides,
+    const std::vector<int>& paddings, const std::vector<int>& dilations,
+    Tensor* output) {
+  if (filter.dims().size() != 4) return false;
+  math::Conv2DShape shape;
+  shape.in_c = static_cast<int>(input.dims()[1]) / groups;
+  shape.in_h = static_cast<int>(input.dims()[2]);
+  shape.in_w = static_cast<int>(input.dims()[3]);
+  shape.out_c = static_cast<int>(output->dims()[1]) / groups;
+  shape.out_h = static_cast<int>(output->dims()[2]);
+  shape.out_w = static_cast<int>(output->dims()[3]);
+  shape.k_h = static_cast<int>(filter.dims()[2]);
+  shape.k_w = static_cast<int>(filter.dims()[3]);
+  shape.stride_h = strides[0];
+  shape.stride_w = strides[1];
+  shape.pad_h = paddings[0];
+  shape.pad_w = paddings[1];
+  shape.dilation_h = dilations[0];
+  shape.dilation_w = dilations[1];
+
+  math::Conv2DAlgo algo = math::SelectConv2DAlgo(shape);
+  if (algo == math::Conv2DAlgo::kGemm1x1 || algo == math::Conv2DAlgo::kIm2Col) {
+    return false;
+  }
+
+  const int batch_size = static_cast<int>(input.dims()[0]);
+  const int64_t in_size =
+      static_cast<int64_t>(shape.in_c) * shape.in_h * shape.in_w;
+  const int64_t out_size =
+      static_cast<int64_t>(shape.out_c) * shape.out_h * shape.out_w;
+  const int64_t filter_size = filter.numel() / groups;
+  const float* input_data = input.data<float>();
+  const float* filter_data = filter.data<float>();
+  float* output_data = output->data<float>();
+
+  // the filter is transformed once for the batch
+  Tensor u;
+  float* u_data = nullptr;
+  int64_t u_size = math::WinogradFilterSize(shape);
+  if (algo == math::Conv2DAlgo::kWinograd3x3) {
+    u_data = u.mutable_data<float>({groups * u_size}, platform::CPUPlace());
+    for (int g = 0; g < groups; ++g) {
+      math::WinogradTransformFilter(shape, filter_data + g * filter_size,
+                                    u_data + g * u_size);
+    }
+  }
+
+  for (int i = 0; i < batch_size; ++i) {
+    for (int g = 0; g < groups; ++g) {
+      const float* in = input_data + (i * groups + g) * in_size;
+      float* out = output_data + (i * groups + g) * out_size;
+      if (algo == math::Conv2DAlgo::kWinograd3x3) {
+        math::WinogradConv3x3(context, shape, in, u_data + g * u_size, out);
+      } else {
+        math::TiledIm2ColConv(context, shape, in,
+                              filter_data + g * filter_size, out);
+      }
+    }
+  }
+  return true;
+}
+
 }  // namespace operators
 }  // namespace paddle
 
@@ -358,7 +430,8 @@ REGISTER_OP_CPU_KERNEL(
 
 REGISTER_OP_CPU_KERNEL(
     conv2d, ops::GemmConvKernel<paddle::platform::CPUDeviceContext, float>,
-    ops::GemmConvKernel<paddle::platform::CPUDeviceContext, double>);
+    ops::GemmConvKernel<paddle::platform::CPUDeviceContext, double>,
+    ops::GemmConvInt8Kernel);
 REGISTER_OP_CPU_KERNEL(
     conv2d_grad,
     ops::GemmConvGradKernel<paddle::platform::CPUDeviceContext, float>,
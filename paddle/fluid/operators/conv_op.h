@@ -16,9 +16,12 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/cpu_conv.h"
 #include "paddle/fluid/operators/math/depthwise_conv.h"
+#include "paddle/fluid/operators/math/half_weight.h"
 #include "paddle/fluid/operators/math/im2col.h"
 #include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/operators/math/quantization.h"
 #include "paddle/fluid/operators/math/vol2col.h"
 
 namespace paddle {
@@ -86,6 +89,28 @@ class ConvOpGrad : public framework::OperatorWithKernel {
       const framework::ExecutionContext& ctx) const override;
 };
 
+// The CPU algorithms of math/cpu_conv.h of the float conv2d, Compute
+// returns false if the convolution should run im2col + gemm.
+template <typename DeviceContext, typename T>
+struct FastConv2D {
+  static bool Compute(const DeviceContext& context, const Tensor& input,
+                      const Tensor& filter, int groups,
+                      const std::vector<int>& strides,
+                      const std::vector<int>& paddings,
+                      const std::vector<int>& dilations, Tensor* output) {
+    return false;
+  }
+};
+
+template <>
+struct FastConv2D<platform::CPUDeviceContext, float> {
+  static bool Compute(const platform::CPUDeviceContext& context,
+                      const Tensor& input, const Tensor& filter, int groups,
+                      const std::vector<int>& strides,
+                      const std::vector<int>& paddings,
+                      const std::vector<int>& dilations, Tensor* output);
+};
+
 template <typename DeviceContext, typename T>
 class GemmConvKernel : public framework::OpKernel<T> {
  public:
@@ -103,6 +128,23 @@ class GemmConvKernel : public framework::OpKernel<T> {
     std::vector<int> paddings = context.Attr<std::vector<int>>("paddings");
     std::vector<int> dilations = context.Attr<std::vector<int>>("dilations");
 
+    // The filter of a conv is small next to its input and output, so a half
+    // filter is widened once per call, and the fast CPU algorithms run on
+    // it like on a float filter.
+    if (math::IsHalfTensor(filter)) {
+      Tensor float_filter;
+      PADDLE_ENFORCE(
+          (math::HalfWeightMatMul<DeviceContext, T>::Widen(filter,
+                                                            &float_filter)),
+          "The half filter is only supported by the float CPU kernel");
+      filter = float_filter;
+    }
+    if (FastConv2D<DeviceContext, T>::Compute(
+            context.template device_context<DeviceContext>(), *input, filter,
+            groups, strides, paddings, dilations, output)) {
+      return;
+    }
+
     const int batch_size = static_cast<int>(input->dims()[0]);
 
     // filter_shape_vec: {k_o, k_i, k_h, k_w} or {k_o, k_i, k_d, k_h, k_w}
@@ -191,6 +233,80 @@ class GemmConvKernel : public framework::OpKernel<T> {
   }
 };
 
+// The CPU kernel of the INT8 inference of conv2d. Input and Filter are
+// quantized to int8 and Output is their int32 convolution, which is scaled
+// back to float by the dequantize op. The zero padding of im2col is exact
+// since the quantization is symmetric.
+class GemmConvInt8Kernel : public framework::OpKernel<int8_t> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    const Tensor* input = context.Input<Tensor>("Input");
+    const Tensor* filter = context.Input<Tensor>("Filter");
+    Tensor* output = context.Output<Tensor>("Output");
+    int32_t* output_data = output->mutable_data<int32_t>(context.GetPlace());
+
+    int groups = context.Attr<int>("groups");
+    std::vector<int> strides = context.Attr<std::vector<int>>("strides");
+    std::vector<int> paddings = context.Attr<std::vector<int>>("paddings");
+    std::vector<int> dilations = context.Attr<std::vector<int>>("dilations");
+
+    std::vector<int64_t> filter_shape_vec(framework::vectorize(filter->dims()));
+    std::vector<int64_t> output_shape_vec(framework::vectorize(output->dims()));
+    PADDLE_ENFORCE_EQ(filter_shape_vec.size(), 4UL,
+                      "The INT8 kernel only supports conv2d");
+
+    // col_shape_vec: {i_c/g, k_h, k_w, o_h, o_w}
+    std::vector<int64_t> col_shape_vec = {
+        input->dims()[1] / groups, filter_shape_vec[2], filter_shape_vec[3],
+        output_shape_vec[2], output_shape_vec[3]};
+    framework::DDim col_shape(framework::make_ddim(col_shape_vec));
+    int col_height = static_cast<int>(col_shape_vec[0] * col_shape_vec[1] *
+                                      col_shape_vec[2]);
+    int col_width = static_cast<int>(col_shape_vec[3] * col_shape_vec[4]);
+
+    bool is_expand = IsExpand(filter_shape_vec, strides, paddings, dilations);
+    Tensor col;
+    if (is_expand) {
+      col.mutable_data<int8_t>(col_shape, context.GetPlace());
+    }
+
+    framework::DDim input_shape = framework::slice_ddim(
+        input->dims(), 1, static_cast<int>(input->dims().size()));
+    int in_step = static_cast<int>(input->dims()[1]) / groups;
+    int out_step = static_cast<int>(output->dims()[1]) / groups;
+    int64_t out_batch_size = output->numel() / output->dims()[0];
+    const int8_t* filter_data = filter->data<int8_t>();
+
+    math::Im2ColFunctor<math::ColFormat::kCFO, platform::CPUDeviceContext,
+                        int8_t>
+        im2col;
+    auto& dev_ctx =
+        context.template device_context<platform::CPUDeviceContext>();
+    const int batch_size = static_cast<int>(input->dims()[0]);
+    for (int i = 0; i < batch_size; i++) {
+      Tensor in_batch = input->Slice(i, i + 1).Resize(input_shape);
+      for (int g = 0; g < groups; g++) {
+        Tensor in_slice = in_batch.Slice(g * in_step, (g + 1) * in_step);
+        const int8_t* col_data = in_slice.data<int8_t>();
+        if (is_expand) {
+          im2col(dev_ctx, in_slice, dilations, strides,
+                 std::vector<int>{paddings[0], paddings[1], paddings[0],
+                                  paddings[1]},
+                 &col);
+          col_data = col.data<int8_t>();
+        }
+        // out_slice[out_step, o_h * o_w] = filter_slice * col_matrix
+        math::Int8Gemm(out_step, col_width, col_height,
+                       filter_data + g * out_step * col_height, col_height,
+                       col_data, col_width,
+                       output_data + i * out_batch_size +
+                           g * out_step * col_width,
+                       col_width);
+      }
+    }
+  }
+};
+
 template <typename DeviceContext, typename T>
 class GemmConvGradKernel : public framework::OpKernel<T> {
  public:
@@ -0,0 +1,188 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/detail/grad_codec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/float16.h"
+
+namespace paddle {
+namespace operators {
+namespace detail {
+
+using VarMsg = sendrecv::VariableMessage;
+
+CodecConfig ParseCodecConfig(const std::string& str) {
+  CodecConfig config;
+  auto pos = str.find(':');
+  std::string name = str.substr(0, pos);
+  std::string arg = pos == std::string::npos ? "" : str.substr(pos + 1);
+  if (name.empty() || name == "none") {
+    config.type = VarMsg::CODEC_NONE;
+  } else if (name == "fp16") {
+    config.type = VarMsg::CODEC_FP16;
+  } else if (name == "int8") {
+    config.type = VarMsg::CODEC_INT8;
+    if (!arg.empty()) config.block_size = std::stoll(arg);
+    PADDLE_ENFORCE_GT(config.block_size, 0, "invalid int8 block size %s", str);
+  } else if (name == "topk") {
+    config.type = VarMsg::CODEC_TOPK;
+    if (!arg.empty()) config.ratio = std::stof(arg);
+    PADDLE_ENFORCE(config.ratio > 0.0f && config.ratio <= 1.0f,
+                   "invalid topk ratio %s", str);
+  } else {
+    PADDLE_THROW("Unknown gradient codec %s", str);
+  }
+  return config;
+}
+
+static void EncodeFP16(const float* data, int64_t numel,
+                       std::vector<char>* out) {
+  out->resize(numel * sizeof(platform::float16));
+  auto* dst = reinterpret_cast<platform::float16*>(out->data());
+  for (int64_t i = 0; i < numel; ++i) {
+    dst[i] = platform::float16(data[i]);
+  }
+}
+
+static void EncodeInt8(const float* data, int64_t numel, int64_t block_size,
+                       std::vector<char>* out) {
+  int64_t num_blocks = (numel + block_size - 1) / block_size;
+  out->resize(num_blocks * sizeof(float) + numel);
+  auto* scales = reinterpret_cast<float*>(out->data());
+  auto* dst =
+      reinterpret_cast<int8_t*>(out->data() + num_blocks * sizeof(float));
+  for (int64_t b = 0; b < num_blocks; ++b) {
+    int64_t begin = b * block_size;
+    int64_t end = std::min(begin + block_size, numel);
+    float max_abs = 0.0f;
+    for (int64_t i = begin; i < end; ++i) {
+      max_abs = std::max(max_abs, std::fabs(data[i]));
+    }
+    float scale = max_abs / 127.0f;
+    float inv_scale = scale > 0.0f ? 1.0f / scale : 0.0f;
+    scales[b] = scale;
+    for (int64_t i = begin; i < end; ++i) {
+      float q = std::round(data[i] * inv_scale);
+      dst[i] = static_cast<int8_t>(std::min(127.0f, std::max(-127.0f, q)));
+    }
+  }
+}
+
+static void EncodeTopK(const float* data, int64_t numel, float ratio,
+                       float* residual, std::vector<char>* out) {
+  PADDLE_ENFORCE_NOT_NULL(residual, "topk codec needs a residual buffer");
+  // ratio is a float, e.g. 0.05f is a bit above 0.05, so its rounding error
+  // is dropped before k is rounded up.
+  double real_k = static_cast<double>(ratio) * numel * (1.0 - 1e-7);
+  int64_t k = std::max<int64_t>(1, static_cast<int64_t>(std::ceil(real_k)));
+  k = std::min(k, numel);
+
+  // error feedback: residual holds what was not sent in previous steps.
+  for (int64_t i = 0; i < numel; ++i) {
+    residual[i] += data[i];
+  }
+
+  std::vector<int64_t> index(numel);
+  std::iota(index.begin(), index.end(), 0);
+  std::nth_element(index.begin(), index.begin() + (k - 1), index.end(),
+                   [residual](int64_t a, int64_t b) {
+                     return std::fabs(residual[a]) > std::fabs(residual[b]);
+                   });
+  std::sort(index.begin(), index.begin() + k);
+
+  out->resize(k * (sizeof(int64_t) + sizeof(float)));
+  auto* idx = reinterpret_cast<int64_t*>(out->data());
+  auto* val = reinterpret_cast<float*>(out->data() + k * sizeof(int64_t));
+  for (int64_t i = 0; i < k; ++i) {
+    idx[i] = index[i];
+    val[i] = residual[index[i]];
+    residual[index[i]] = 0.0f;
+  }
+}
+
+void EncodeGradient(const CodecConfig& config, const float* data,
+                    int64_t numel, float* residual, std::vector<char>* out) {
+  switch (config.type) {
+    case VarMsg::CODEC_FP16:
+      EncodeFP16(data, numel, out);
+      break;
+    case VarMsg::CODEC_INT8:
+      EncodeInt8(data, numel, config.block_size, out);
+      break;
+    case VarMsg::CODEC_TOPK:
+      EncodeTopK(data, numel, config.ratio, residual, out);
+      break;
+    default:
+      out->resize(numel * sizeof(float));
+      memcpy(out->data(), data, numel * sizeof(float));
+      break;
+  }
+}
+
+bool DecodeGradient(VarMsg::Codec type, int64_t block_size, const char* data,
+                    int64_t size, int64_t numel, float* out) {
+  switch (type) {
+    case VarMsg::CODEC_FP16: {
+      if (size != numel * static_cast<int64_t>(sizeof(platform::float16))) {
+        return false;
+      }
+      auto* src = reinterpret_cast<const platform::float16*>(data);
+      for (int64_t i = 0; i < numel; ++i) {
+        out[i] = static_cast<float>(src[i]);
+      }
+      return true;
+    }
+    case VarMsg::CODEC_INT8: {
+      if (block_size <= 0) return false;
+      int64_t num_blocks = (numel + block_size - 1) / block_size;
+      if (size != num_blocks * static_cast<int64_t>(sizeof(float)) + numel) {
+        return false;
+      }
+      auto* scales = reinterpret_cast<const float*>(data);
+      auto* src = reinterpret_cast<const int8_t*>(data +
+                                                  num_blocks * sizeof(float));
+      for (int64_t i = 0; i < numel; ++i) {
+        out[i] = src[i] * scales[i / block_size];
+      }
+      return true;
+    }
+    case VarMsg::CODEC_TOPK: {
+      const int64_t pair_size = sizeof(int64_t) + sizeof(float);
+      if (size % pair_size != 0) return false;
+      int64_t k = size / pair_size;
+      auto* idx = reinterpret_cast<const int64_t*>(data);
+      auto* val = reinterpret_cast<const float*>(data + k * sizeof(int64_t));
+      std::fill(out, out + numel, 0.0f);
+      for (int64_t i = 0; i < k; ++i) {
+        if (idx[i] < 0 || idx[i] >= numel) return false;
+        out[idx[i]] = val[i];
+      }
+      return true;
+    }
+    default:
+      if (size != numel * static_cast<int64_t>(sizeof(float))) return false;
+      memcpy(out, data, size);
+      return true;
+  }
+}
+
+}  // namespace detail
+}  // namespace operators
+}  // namespace paddle
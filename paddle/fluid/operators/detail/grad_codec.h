@@ -0,0 +1,57 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/operators/detail/send_recv.pb.h"
+
+namespace paddle {
+namespace operators {
+namespace detail {
+
+// Gradient codecs applied to dense FP32 tensors before they are sent to
+// the parameter server. The encoded layouts are:
+//   FP16: numel float16 values.
+//   INT8: ceil(numel / block) float scales followed by numel int8 values,
+//         every block of elements is scaled by max(abs(x)) / 127.
+//   TOPK: k int64 indices followed by k float values, the elements which
+//         are not sent are accumulated into a local residual and added to
+//         the gradient of the next step (error feedback).
+struct CodecConfig {
+  sendrecv::VariableMessage::Codec type = sendrecv::VariableMessage::CODEC_NONE;
+  // elements per scale of INT8.
+  int64_t block_size = 256;
+  // fraction of the elements sent by TOPK.
+  float ratio = 0.01f;
+};
+
+// Parse the codec from a string like "none", "fp16", "int8", "int8:128",
+// "topk" or "topk:0.001".
+CodecConfig ParseCodecConfig(const std::string& str);
+
+// Encode numel floats into out. residual is only used by TOPK, it must
+// hold numel floats and is updated in place.
+void EncodeGradient(const CodecConfig& config, const float* data,
+                    int64_t numel, float* residual, std::vector<char>* out);
+
+// Decode the encoded bytes into numel floats.
+bool DecodeGradient(sendrecv::VariableMessage::Codec type, int64_t block_size,
+                    const char* data, int64_t size, int64_t numel, float* out);
+
+}  // namespace detail
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,165 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/operators/detail/grad_codec.h"
+#include "paddle/fluid/operators/detail/sendrecvop_utils.h"
+#include "paddle/fluid/operators/detail/variable_response.h"
+
+namespace framework = paddle::framework;
+namespace platform = paddle::platform;
+namespace detail = paddle::operators::detail;
+
+using VarMsg = sendrecv::VariableMessage;
+
+static std::vector<float> RandomGradient(int64_t numel) {
+  std::mt19937 rng(10);
+  std::normal_distribution<float> dist(0.0f, 1.0f);
+  std::vector<float> grad(numel);
+  for (auto& g : grad) g = dist(rng);
+  return grad;
+}
+
+TEST(GradCodec, Parse) {
+  EXPECT_EQ(detail::ParseCodecConfig("").type, VarMsg::CODEC_NONE);
+  EXPECT_EQ(detail::ParseCodecConfig("fp16").type, VarMsg::CODEC_FP16);
+  auto int8 = detail::ParseCodecConfig("int8:64");
+  EXPECT_EQ(int8.type, VarMsg::CODEC_INT8);
+  EXPECT_EQ(int8.block_size, 64);
+  auto topk = detail::ParseCodecConfig("topk:0.1");
+  EXPECT_EQ(topk.type, VarMsg::CODEC_TOPK);
+  EXPECT_FLOAT_EQ(topk.ratio, 0.1f);
+}
+
+TEST(GradCodec, FP16AndInt8) {
+  const int64_t numel = 1000;
+  auto grad = RandomGradient(numel);
+  std::vector<char> encoded;
+  std::vector<float> decoded(numel);
+
+  detail::CodecConfig fp16 = detail::ParseCodecConfig("fp16");
+  detail::EncodeGradient(fp16, grad.data(), numel, nullptr, &encoded);
+  EXPECT_EQ(encoded.size(), numel * 2UL);
+  ASSERT_TRUE(detail::DecodeGradient(VarMsg::CODEC_FP16, 0, encoded.data(),
+                                     encoded.size(), numel, decoded.data()));
+  for (int64_t i = 0; i < numel; ++i) {
+    EXPECT_NEAR(decoded[i], grad[i], 1e-3 * std::fabs(grad[i]) + 1e-6);
+  }
+
+  detail::CodecConfig int8 = detail::ParseCodecConfig("int8:100");
+  detail::EncodeGradient(int8, grad.data(), numel, nullptr, &encoded);
+  EXPECT_EQ(encoded.size(), 10 * sizeof(float) + numel);
+  ASSERT_TRUE(detail::DecodeGradient(VarMsg::CODEC_INT8, 100, encoded.data(),
+                                     encoded.size(), numel, decoded.data()));
+  for (int64_t b = 0; b < 10; ++b) {
+    float max_abs = 0.0f;
+    for (int64_t i = b * 100; i < (b + 1) * 100; ++i) {
+      max_abs = std::max(max_abs, std::fabs(grad[i]));
+    }
+    for (int64_t i = b * 100; i < (b + 1) * 100; ++i) {
+      EXPECT_NEAR(decoded[i], grad[i], max_abs / 127.0f);
+    }
+  }
+}
+
+TEST(GradCodec, TopKErrorFeedback) {
+  const int64_t numel = 1000;
+  const int steps = 5;
+  detail::CodecConfig topk = detail::ParseCodecConfig("topk:0.05");
+  std::vector<float> residual(numel, 0.0f);
+  std::vector<float> sent(numel, 0.0f);
+  std::vector<float> total(numel, 0.0f);
+  std::vector<char> encoded;
+  std::vector<float> decoded(numel);
+
+  for (int step = 0; step < steps; ++step) {
+    auto grad = RandomGradient(numel);
+    for (int64_t i = 0; i < numel; ++i) total[i] += grad[i];
+    detail::EncodeGradient(topk, grad.data(), numel, residual.data(),
+                           &encoded);
+    EXPECT_EQ(encoded.size(), 50 * (sizeof(int64_t) + sizeof(float)));
+    ASSERT_TRUE(detail::DecodeGradient(VarMsg::CODEC_TOPK, 0, encoded.data(),
+                                       encoded.size(), numel,
+                                       decoded.data()));
+    for (int64_t i = 0; i < numel; ++i) sent[i] += decoded[i];
+  }
+  // nothing is lost: what was not sent stays in the residual.
+  for (int64_t i = 0; i < numel; ++i) {
+    EXPECT_NEAR(sent[i] + residual[i], total[i], 1e-4);
+  }
+}
+
+TEST(GradCodec, Serde) {
+  platform::CPUPlace place;
+  platform::CPUDeviceContext ctx(place);
+  framework::Variable var;
+  auto* tensor = var.GetMutable<framework::LoDTensor>();
+  tensor->Resize(framework::make_ddim({32, 64}));
+  float* data = tensor->mutable_data<float>(place);
+  for (int64_t i = 0; i < tensor->numel(); ++i) data[i] = i * 0.01f;
+
+  for (auto& name : {"fp16", "int8", "topk:1.0"}) {
+    framework::Tensor residual;
+    ::grpc::ByteBuffer msg;
+    detail::SerializeCompressedToByteBuffer(
+        "myvar", &var, ctx, detail::ParseCodecConfig(name), &residual, &msg);
+
+    framework::Scope scope;
+    scope.Var("myvar");
+    detail::VariableResponse resp(&scope, &ctx);
+    EXPECT_EQ(resp.Parse(msg), 0);
+    auto& tensor2 = scope.FindVar("myvar")->Get<framework::LoDTensor>();
+    EXPECT_EQ(tensor2.dims(), tensor->dims());
+    const float* data2 = tensor2.data<float>();
+    for (int64_t i = 0; i < tensor2.numel(); ++i) {
+      EXPECT_NEAR(data2[i], data[i], 0.1f);
+    }
+  }
+}
+
+// Logs the encode and decode throughput of every codec on 16MB. It only
+// checks that the decoding succeeds, run it with
+// --gtest_also_run_disabled_tests.
+TEST(GradCodec, DISABLED_Throughput) {
+  const int64_t numel = 4 << 20;
+  auto grad = RandomGradient(numel);
+  std::vector<float> residual(numel, 0.0f);
+  std::vector<float> decoded(numel);
+  std::vector<char> encoded;
+  for (auto& name : {"fp16", "int8", "topk:0.01"}) {
+    auto config = detail::ParseCodecConfig(name);
+    auto start = std::chrono::steady_clock::now();
+    detail::EncodeGradient(config, grad.data(), numel, residual.data(),
+                           &encoded);
+    auto mid = std::chrono::steady_clock::now();
+    ASSERT_TRUE(detail::DecodeGradient(config.type, config.block_size,
+                                       encoded.data(), encoded.size(), numel,
+                                       decoded.data()));
+    auto end = std::chrono::steady_clock::now();
+    double mb = numel * sizeof(float) / static_cast<double>(1 << 20);
+    LOG(INFO) << name << ": ratio "
+              << numel * sizeof(float) / static_cast<double>(encoded.size())
+              << "x, encode "
+              << mb / std::chrono::duration<double>(mid - start).count()
+              << " MB/s, decode "
+              << mb / std::chrono::duration<double>(end - mid).count()
+              << " MB/s";
+  }
+}
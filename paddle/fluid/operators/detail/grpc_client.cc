@@ -28,18 +28,24 @@ bool RPCClient::AsyncSendVariable(const std::string& ep,
                                   const platform::DeviceContext& ctx,
                                   const framework::Scope& scope,
                                   const std::string& var_name,
-                                  int64_t time_out) {
+                                  const CodecConfig& codec, int64_t time_out) {
   const platform::DeviceContext* p_ctx = &ctx;
   const std::string ep_val = ep;
   const std::string var_name_val = var_name;
   const framework::Scope* p_scope = &scope;
   const auto ch = GetChannel(ep_val);
+  framework::Tensor* residual =
+      codec.type == sendrecv::VariableMessage::CODEC_TOPK
+          ? GetResidual(var_name_val)
+          : nullptr;
 
-  framework::Async([var_name_val, p_ctx, ep_val, p_scope, time_out, ch, this] {
+  framework::Async([var_name_val, p_ctx, ep_val, p_scope, codec, residual,
+                    time_out, ch, this] {
     auto* var = p_scope->FindVar(var_name_val);
 
     ::grpc::ByteBuffer req;
-    SerializeToByteBuffer(var_name_val, var, *p_ctx, &req);
+    SerializeCompressedToByteBuffer(var_name_val, var, *p_ctx, codec, residual,
+                                    &req);
 
     // varhandle
     VarHandle var_h;
@@ -64,6 +70,101 @@ bool RPCClient::AsyncSendVariable(const std::string& ep,
   return true;
 }
 
+bool SendStreamProcessor::Send(const std::vector<::grpc::ByteBuffer>& msgs) {
+  ::grpc::CompletionQueue cq;
+  auto next = [&cq]() {
+    void* tag = NULL;
+    bool ok = false;
+    return cq.Next(&tag, &ok) && ok;
+  };
+
+  auto call = stub_g_.PrepareCall(
+      context_.get(), "/sendrecv.SendRecvService/SendVariableStream", &cq);
+  call->StartCall(this);
+  bool ok = next();
+  for (size_t i = 0; ok && i < msgs.size(); ++i) {
+    call->Write(msgs[i], this);
+    ok = next();
+  }
+  if (ok) {
+    call->WritesDone(this);
+    ok = next();
+  }
+  if (ok) {
+    call->Read(&reply_, this);
+    next();
+  }
+  call->Finish(&status_, this);
+  next();
+
+  cq.Shutdown();
+  void* tag = NULL;
+  bool drained = false;
+  while (cq.Next(&tag, &drained)) {
+  }
+  return ok && status_.ok();
+}
+
+bool RPCClient::AsyncSendVariables(const std::string& ep,
+                                   const platform::DeviceContext& ctx,
+                                   const framework::Scope& scope,
+                                   const std::vector<std::string>& var_names,
+                                   const std::vector<CodecConfig>& codecs,
+                                   int64_t time_out, int64_t slice_bytes) {
+  PADDLE_ENFORCE(codecs.empty() || codecs.size() == var_names.size(),
+                 "codecs should be empty or one per variable");
+  const platform::DeviceContext* p_ctx = &ctx;
+  const std::string ep_val = ep;
+  const std::vector<std::string> var_names_val = var_names;
+  const framework::Scope* p_scope = &scope;
+  const auto ch = GetChannel(ep_val);
+  std::vector<CodecConfig> codecs_val(codecs);
+  codecs_val.resize(var_names.size());
+  std::vector<framework::Tensor*> residuals(var_names.size(), nullptr);
+  for (size_t i = 0; i < var_names.size(); ++i) {
+    if (codecs_val[i].type == sendrecv::VariableMessage::CODEC_TOPK) {
+      residuals[i] = GetResidual(var_names[i]);
+    }
+  }
+
+  stream_waits_.push_back(framework::Async(
+      [var_names_val, codecs_val, residuals, p_ctx, ep_val, p_scope, time_out,
+       slice_bytes, ch, this] {
+        std::vector<::grpc::ByteBuffer> msgs;
+        for (size_t i = 0; i < var_names_val.size(); ++i) {
+          auto* var = p_scope->FindVar(var_names_val[i]);
+          if (codecs_val[i].type != sendrecv::VariableMessage::CODEC_NONE) {
+            // compressed tensors are small enough to be sent unsliced.
+            msgs.emplace_back();
+            SerializeCompressedToByteBuffer(var_names_val[i], var, *p_ctx,
+                                            codecs_val[i], residuals[i],
+                                            &msgs.back());
+            continue;
+          }
+          std::vector<::grpc::ByteBuffer> var_msgs;
+          SerializeToByteBuffers(var_names_val[i], var, *p_ctx, &var_msgs,
+                                 slice_bytes);
+          msgs.insert(msgs.end(), var_msgs.begin(), var_msgs.end());
+        }
+
+        VarHandle var_h;
+        var_h.ep = ep_val;
+        var_h.scope = p_scope;
+        var_h.name = var_names_val.empty() ? "" : var_names_val.front();
+        var_h.ctx = p_ctx;
+
+        SendStreamProcessor s(ch);
+        s.Prepare(var_h, time_out);
+        if (!s.Send(msgs)) {
+          LOG(ERROR) << "send stream error:" << var_h.String()
+                     << " grpc error:" << s.status_.error_message();
+          stream_failures_++;
+        }
+      }));
+
+  return true;
+}
+
 void ProcGetResponse(const VarHandle& var_h,
                      const ::grpc::ByteBuffer& ret_msg) {
   framework::Variable* outvar = nullptr;
@@ -188,8 +289,18 @@ void RPCClient::AsyncSendFetchBarrier(const std::string& ep, int64_t time_out) {
 }
 
 bool RPCClient::Wait() {
+  bool stream_ok = true;
+  for (auto& f : stream_waits_) {
+    f.wait();
+  }
+  stream_waits_.clear();
+  if (stream_failures_ > 0) {
+    stream_failures_ = 0;
+    stream_ok = false;
+  }
+
   if (req_count_ <= 0) {
-    return true;
+    return stream_ok;
   }
   const size_t kReqCnt = req_count_;
   bool a[kReqCnt];
@@ -212,7 +323,7 @@ bool RPCClient::Wait() {
     }
   }
 
-  return true;
+  return stream_ok;
 }
 
 bool RPCClient::Proceed() {
@@ -242,6 +353,26 @@ bool RPCClient::Proceed() {
   return true;
 }
 
+framework::Tensor* RPCClient::GetResidual(const std::string& var_name) {
+  std::lock_guard<std::mutex> lock(residual_mutex_);
+  auto& residual = residuals_[var_name];
+  if (residual == nullptr) {
+    residual.reset(new framework::Tensor());
+  }
+  return residual.get();
+}
+
+PrefetchRowCache* RPCClient::GetRowCache(const std::string& table_name,
+                                         size_t capacity,
+                                         int64_t max_staleness) {
+  std::lock_guard<std::mutex> lock(row_cache_mutex_);
+  auto& cache = row_caches_[table_name];
+  if (cache == nullptr) {
+    cache.reset(new PrefetchRowCache(capacity, max_staleness));
+  }
+  return cache.get();
+}
+
 std::shared_ptr<grpc::Channel> RPCClient::GetChannel(const std::string& ep) {
   auto it = channels_.find(ep);
   if (it != channels_.end()) {
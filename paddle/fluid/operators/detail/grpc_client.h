@@ -16,11 +16,15 @@ limitations under the License. */
 
 #include <time.h>
 
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <ctime>
 #include <functional>
+#include <future>  // NOLINT
 #include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <vector>
 
@@ -33,6 +37,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/operators/detail/prefetch_row_cache.h"
 #include "paddle/fluid/operators/detail/sendrecvop_utils.h"
 #include "paddle/fluid/operators/detail/simple_block_queue.h"
 
@@ -108,6 +113,25 @@ class SendProcessor : public BaseProcessor {
   RequestSendCallBack response_call_back_ = NULL;
 };
 
+// SendStreamProcessor drives a streaming call on its own completion queue,
+// it is used synchronously in a thread of the thread pool.
+class SendStreamProcessor : public BaseProcessor {
+ public:
+  explicit SendStreamProcessor(std::shared_ptr<grpc::Channel> ch)
+      : BaseProcessor(ch), stub_g_(ch) {}
+
+  virtual ~SendStreamProcessor() {}
+
+  virtual void Process() {}
+
+  // Write all the messages in one call, return true if the server has
+  // received all of them.
+  bool Send(const std::vector<::grpc::ByteBuffer>& msgs);
+
+  ::grpc::GenericStub stub_g_;
+  ::grpc::ByteBuffer reply_;
+};
+
 typedef std::function<void(const VarHandle&, const ::grpc::ByteBuffer&)>
     RequestGetCallBack;
 
@@ -163,8 +187,19 @@ class RPCClient {
                          const platform::DeviceContext& ctx,
                          const framework::Scope& scope,
                          const std::string& var_name,
+                         const CodecConfig& codec = CodecConfig(),
                          int64_t time_out = 600 * 1000);
 
+  // Send a batch of variables to one endpoint in a single streaming call,
+  // the dense tensors larger than slice_bytes are split into slices.
+  bool AsyncSendVariables(const std::string& ep,
+                          const platform::DeviceContext& ctx,
+                          const framework::Scope& scope,
+                          const std::vector<std::string>& var_names,
+                          const std::vector<CodecConfig>& codecs = {},
+                          int64_t time_out = 600 * 1000,
+                          int64_t slice_bytes = kStreamSliceBytes);
+
   bool AsyncGetVariable(const std::string& ep,
                         const platform::DeviceContext& ctx,
                         const framework::Scope& scope,
@@ -186,14 +221,28 @@ class RPCClient {
 
   bool Wait();
 
+  // The trainer side cache of the rows prefetched for table_name, it is
+  // created on the first call and kept across mini-batches.
+  PrefetchRowCache* GetRowCache(const std::string& table_name,
+                                size_t capacity, int64_t max_staleness);
+
  private:
   bool Proceed();
   std::shared_ptr<grpc::Channel> GetChannel(const std::string& ep);
+  // The residual of TOPK gradient codec, it is kept across mini-batches.
+  framework::Tensor* GetResidual(const std::string& var_name);
 
  private:
   grpc::CompletionQueue cq_;
   std::map<std::string, std::shared_ptr<grpc::Channel>> channels_;
   int64_t req_count_ = 0;
+  // streaming calls do not use cq_, wait for them separately.
+  std::vector<std::future<void>> stream_waits_;
+  std::atomic<int> stream_failures_{0};
+  std::mutex residual_mutex_;
+  std::map<std::string, std::unique_ptr<framework::Tensor>> residuals_;
+  std::mutex row_cache_mutex_;
+  std::map<std::string, std::unique_ptr<PrefetchRowCache>> row_caches_;
 };
 
 }  // namespace detail
@@ -17,13 +17,14 @@ limitations under the License. */
 #include <limits>
 #include <string>
 
+using ::grpc::ServerAsyncReader;
 using ::grpc::ServerAsyncResponseWriter;
 
 namespace paddle {
 namespace operators {
 namespace detail {
 
-enum CallStatus { PROCESS = 0, FINISH };
+enum CallStatus { PROCESS = 0, FINISH, READ };
 
 // reference:
 // https://stackoverflow.com/questions/41732884/grpc-multiple-services-in-cpp-async-server
@@ -37,6 +38,9 @@ class RequestBase {
   }
   virtual ~RequestBase() {}
   virtual void Process() { assert(false); }
+  // Only for streaming requests, called when a message of the stream is
+  // read, ok is false when the client has finished writing.
+  virtual void ProcessRead(bool ok) { assert(false); }
 
   CallStatus Status() { return status_; }
   void SetStatus(CallStatus status) { status_ = status; }
@@ -58,9 +62,10 @@ class RequestSend final : public RequestBase {
   explicit RequestSend(GrpcService::AsyncService* service,
                        ::grpc::ServerCompletionQueue* cq,
                        framework::Scope* scope, ReceivedQueue* queue,
-                       const platform::DeviceContext* dev_ctx)
+                       const platform::DeviceContext* dev_ctx,
+                       ReceivedSums* sums)
       : RequestBase(service, cq, dev_ctx), queue_(queue), responder_(&ctx_) {
-    request_.reset(new VariableResponse(scope, dev_ctx_));
+    request_.reset(new VariableResponse(scope, dev_ctx_, sums));
     int method_id = static_cast<int>(detail::GrpcMethod::kSendVariable);
     service_->RequestAsyncUnary(method_id, &ctx_, request_.get(), &responder_,
                                 cq_, cq_, this);
@@ -84,6 +89,63 @@ class RequestSend final : public RequestBase {
   ServerAsyncResponseWriter<sendrecv::VoidMessage> responder_;
 };
 
+class RequestSendStream final : public RequestBase {
+ public:
+  explicit RequestSendStream(GrpcService::AsyncService* service,
+                             ::grpc::ServerCompletionQueue* cq,
+                             framework::Scope* scope, ReceivedQueue* queue,
+                             const platform::DeviceContext* dev_ctx,
+                             ReceivedSums* sums)
+      : RequestBase(service, cq, dev_ctx),
+        scope_(scope),
+        queue_(queue),
+        sums_(sums),
+        reader_(&ctx_) {
+    int method_id = static_cast<int>(detail::GrpcMethod::kSendVariableStream);
+    service_->RequestAsyncClientStreaming(method_id, &ctx_, &reader_, cq_, cq_,
+                                          this);
+  }
+
+  virtual ~RequestSendStream() {}
+
+  virtual std::string GetReqName() {
+    return request_ ? request_->Varname() : "";
+  }
+
+  virtual void Process() {
+    status_ = READ;
+    ReadNext();
+  }
+
+  virtual void ProcessRead(bool ok) {
+    if (!ok) {
+      sendrecv::VoidMessage reply;
+      reader_.Finish(reply, ::grpc::Status::OK, this);
+      status_ = FINISH;
+      return;
+    }
+
+    // The data is already copied into the scope while parsing, so the
+    // variable can be used as soon as its last slice arrives.
+    if (request_->IsLastSlice()) {
+      queue_->Push(std::make_pair(request_->Varname(), request_));
+    }
+    ReadNext();
+  }
+
+ protected:
+  void ReadNext() {
+    request_.reset(new VariableResponse(scope_, dev_ctx_, sums_));
+    reader_.Read(request_.get(), this);
+  }
+
+  std::shared_ptr<VariableResponse> request_;
+  framework::Scope* scope_;
+  ReceivedQueue* queue_;
+  ReceivedSums* sums_;
+  ServerAsyncReader<sendrecv::VoidMessage, VariableResponse> reader_;
+};
+
 class RequestGet final : public RequestBase {
  public:
   explicit RequestGet(GrpcService::AsyncService* service,
@@ -203,6 +265,7 @@ void AsyncGRPCServer::RunSyncUpdate() {
   builder.RegisterService(&service_);
 
   cq_send_ = builder.AddCompletionQueue();
+  cq_send_stream_ = builder.AddCompletionQueue();
   cq_get_ = builder.AddCompletionQueue();
   cq_prefetch_ = builder.AddCompletionQueue();
 
@@ -212,6 +275,8 @@ void AsyncGRPCServer::RunSyncUpdate() {
 
   std::function<void()> send_register =
       std::bind(&AsyncGRPCServer::TryToRegisterNewSendOne, this);
+  std::function<void()> send_stream_register =
+      std::bind(&AsyncGRPCServer::TryToRegisterNewSendStreamOne, this);
   std::function<void()> get_register =
       std::bind(&AsyncGRPCServer::TryToRegisterNewGetOne, this);
   std::function<void()> prefetch_register =
@@ -220,6 +285,9 @@ void AsyncGRPCServer::RunSyncUpdate() {
   t_send_.reset(
       new std::thread(std::bind(&AsyncGRPCServer::HandleRequest, this,
                                 cq_send_.get(), "cq_send", send_register)));
+  t_send_stream_.reset(new std::thread(
+      std::bind(&AsyncGRPCServer::HandleRequest, this, cq_send_stream_.get(),
+                "cq_send_stream", send_stream_register)));
 
   t_get_.reset(
       new std::thread(std::bind(&AsyncGRPCServer::HandleRequest, this,
@@ -230,6 +298,7 @@ void AsyncGRPCServer::RunSyncUpdate() {
   // wait server
   server_->Wait();
   t_send_->join();
+  t_send_stream_->join();
   t_get_->join();
   t_prefetch_->join();
 }
@@ -237,6 +306,7 @@ void AsyncGRPCServer::RunSyncUpdate() {
 void AsyncGRPCServer::ShutdownQueue() {
   std::unique_lock<std::mutex> lock(cq_mutex_);
   cq_send_->Shutdown();
+  cq_send_stream_->Shutdown();
   cq_get_->Shutdown();
   cq_prefetch_->Shutdown();
 }
@@ -254,11 +324,24 @@ void AsyncGRPCServer::TryToRegisterNewSendOne() {
     VLOG(3) << "shutdown, do not TryToRegisterNewSendOne";
     return;
   }
-  RequestSend* send = new RequestSend(&service_, cq_send_.get(), scope_,
-                                      &var_recv_queue_, dev_ctx_);
+  RequestSend* send =
+      new RequestSend(&service_, cq_send_.get(), scope_, &var_recv_queue_,
+                      dev_ctx_, &received_sums_);
   VLOG(4) << "Create RequestSend status:" << send->Status();
 }
 
+void AsyncGRPCServer::TryToRegisterNewSendStreamOne() {
+  std::unique_lock<std::mutex> lock(cq_mutex_);
+  if (is_shut_down_) {
+    VLOG(3) << "shutdown, do not TryToRegisterNewSendStreamOne";
+    return;
+  }
+  RequestSendStream* send =
+      new RequestSendStream(&service_, cq_send_stream_.get(), scope_,
+                            &var_recv_queue_, dev_ctx_, &received_sums_);
+  VLOG(4) << "Create RequestSendStream status:" << send->Status();
+}
+
 void AsyncGRPCServer::TryToRegisterNewGetOne() {
   std::unique_lock<std::mutex> lock(cq_mutex_);
   if (is_shut_down_) {
@@ -304,13 +387,15 @@ void AsyncGRPCServer::HandleRequest(::grpc::ServerCompletionQueue* cq,
     // FIXME(typhoonzero): de-couple the barriers with recv_op
     if (!is_shut_down_ && cq_name == "cq_get") WaitCond(1);
     if (!is_shut_down_ && cq_name == "cq_send") WaitCond(0);
+    if (!is_shut_down_ && cq_name == "cq_send_stream") WaitCond(0);
 
     RequestBase* base = reinterpret_cast<RequestBase*>(tag);
     // reference:
     // https://github.com/tensorflow/tensorflow/issues/5596
     // https://groups.google.com/forum/#!topic/grpc-io/xftlRy-IQwM
     // https://groups.google.com/forum/#!topic/grpc-io/ywATt88Ef_I
-    if (!ok) {
+    // a failed read of a stream only means the client has done writing.
+    if (!ok && base->Status() != READ) {
       LOG(WARNING) << cq_name << " recv no regular event:argument name["
                    << base->GetReqName() << "]";
       TryToRegisterNewOne();
@@ -325,6 +410,11 @@ void AsyncGRPCServer::HandleRequest(::grpc::ServerCompletionQueue* cq,
         base->Process();
         break;
       }
+      case READ: {
+        VLOG(4) << cq_name << " status:" << base->Status();
+        base->ProcessRead(ok);
+        break;
+      }
       case FINISH: {
         VLOG(4) << cq_name << " status:" << base->Status();
         delete base;
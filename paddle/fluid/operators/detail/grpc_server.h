@@ -55,6 +55,15 @@ class AsyncGRPCServer final {
 
   void SetScope(framework::Scope *scope) { scope_ = scope; }
 
+  // The received variable recv_name is summed into sum_name on receiving.
+  void AddReceivedSum(const std::string &recv_name,
+                      const std::string &sum_name) {
+    received_sums_.Add(recv_name, sum_name);
+  }
+
+  // Should be called after the summed variables of a mini-batch are used.
+  void ResetReceivedSums() { received_sums_.Reset(); }
+
   void SetDevCtx(const platform::DeviceContext *dev_ctx) { dev_ctx_ = dev_ctx; }
 
   void SetProgram(framework::ProgramDesc *program) { program_ = program; }
@@ -82,6 +91,7 @@ class AsyncGRPCServer final {
                      const std::string &cq_name,
                      std::function<void()> TryToRegisterNewOne);
   void TryToRegisterNewSendOne();
+  void TryToRegisterNewSendStreamOne();
   void TryToRegisterNewGetOne();
   void TryToRegisterNewPrefetchOne();
   void ShutdownQueue();
@@ -90,6 +100,7 @@ class AsyncGRPCServer final {
   std::mutex cq_mutex_;
   volatile bool is_shut_down_ = false;
   std::unique_ptr<::grpc::ServerCompletionQueue> cq_send_;
+  std::unique_ptr<::grpc::ServerCompletionQueue> cq_send_stream_;
   std::unique_ptr<::grpc::ServerCompletionQueue> cq_get_;
   std::unique_ptr<::grpc::ServerCompletionQueue> cq_prefetch_;
 
@@ -99,6 +110,7 @@ class AsyncGRPCServer final {
   std::string address_;
   framework::Scope *scope_;
   const platform::DeviceContext *dev_ctx_;
+  ReceivedSums received_sums_;
 
   // received variable from RPC, operators fetch variable from this queue.
   SimpleBlockQueue<MessageWithName> var_get_queue_;
@@ -111,6 +123,7 @@ class AsyncGRPCServer final {
   std::condition_variable barrier_condition_;
 
   std::unique_ptr<std::thread> t_send_;
+  std::unique_ptr<std::thread> t_send_stream_;
   std::unique_ptr<std::thread> t_get_;
   std::unique_ptr<std::thread> t_prefetch_;
 
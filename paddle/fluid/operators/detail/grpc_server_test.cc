@@ -13,8 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include <unistd.h>
+#include <chrono>  // NOLINT
 #include <string>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "paddle/fluid/operators/detail/grpc_client.h"
@@ -138,3 +140,145 @@ TEST(PREFETCH, CPU) {
     EXPECT_EQ(ptr[0 + i * value.dims()[1]], static_cast<float>(i * 2));
   }
 }
+
+void StartSendServer(const std::string& endpoint,
+                     const std::vector<std::string>& var_names) {
+  rpc_service_.reset(new detail::AsyncGRPCServer(endpoint));
+  framework::Scope scope;
+  platform::CPUPlace place;
+  platform::CPUDeviceContext ctx(place);
+  for (auto& name : var_names) {
+    scope.Var(name)->GetMutable<framework::LoDTensor>();
+  }
+
+  rpc_service_->SetDevCtx(&ctx);
+  rpc_service_->SetScope(&scope);
+  rpc_service_->SetCond(0);
+
+  rpc_service_->RunSyncUpdate();
+}
+
+double SendAndWait(detail::RPCClient* client, const framework::Scope& scope,
+                   const platform::DeviceContext& ctx,
+                   const std::vector<std::string>& var_names, bool stream) {
+  const std::string ep = "127.0.0.1:8890";
+  auto start = std::chrono::steady_clock::now();
+  if (stream) {
+    client->AsyncSendVariables(ep, ctx, scope, var_names);
+  } else {
+    for (auto& name : var_names) {
+      client->AsyncSendVariable(ep, ctx, scope, name);
+    }
+  }
+  EXPECT_TRUE(client->Wait());
+  for (size_t i = 0; i < var_names.size(); ++i) {
+    auto msg = rpc_service_->Get();
+    auto& tensor = msg.second->GetVar()->Get<framework::LoDTensor>();
+    EXPECT_FLOAT_EQ(tensor.data<float>()[tensor.numel() - 1], 1.0f);
+  }
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+// Streams a small LoDTensor in slices of 4KB, which do not end at its rows,
+// and a tensor small enough to be sent in one message, to a real server,
+// and checks the server reassembles both.
+TEST(SendStream, Sliced) {
+  const std::string ep = "127.0.0.1:8891";
+  std::vector<std::string> names = {"sliced", "unsliced"};
+  std::thread server_thread(StartSendServer, ep, names);
+  sleep(2);
+
+  framework::Scope scope;
+  platform::CPUPlace place;
+  platform::CPUDeviceContext ctx(place);
+  auto* sliced = scope.Var("sliced")->GetMutable<framework::LoDTensor>();
+  sliced->Resize({1000, 37});
+  sliced->set_lod({{0, 400, 1000}});
+  float* data = sliced->mutable_data<float>(place);
+  for (int64_t i = 0; i < sliced->numel(); ++i) {
+    data[i] = static_cast<float>(i);
+  }
+  auto* unsliced = scope.Var("unsliced")->GetMutable<framework::LoDTensor>();
+  unsliced->Resize({4, 3});
+  data = unsliced->mutable_data<float>(place);
+  for (int64_t i = 0; i < unsliced->numel(); ++i) {
+    data[i] = static_cast<float>(-i);
+  }
+
+  // 148000 bytes of the first tensor are sent in 37 slices.
+  detail::RPCClient client;
+  client.AsyncSendVariables(ep, ctx, scope, names, {}, 600 * 1000, 4096);
+  EXPECT_TRUE(client.Wait());
+  for (size_t n = 0; n < names.size(); ++n) {
+    auto msg = rpc_service_->Get();
+    auto& expected = scope.FindVar(msg.first)->Get<framework::LoDTensor>();
+    auto& tensor = msg.second->GetVar()->Get<framework::LoDTensor>();
+    ASSERT_EQ(tensor.dims(), expected.dims()) << msg.first;
+    EXPECT_EQ(tensor.lod(), expected.lod()) << msg.first;
+    for (int64_t i = 0; i < tensor.numel(); ++i) {
+      ASSERT_FLOAT_EQ(tensor.data<float>()[i], expected.data<float>()[i])
+          << msg.first << " at " << i;
+    }
+  }
+
+  rpc_service_->ShutDown();
+  server_thread.join();
+  rpc_service_.reset(nullptr);
+}
+
+// Compares the bandwidth of unary and streaming sends over loopback, from
+// 1KB up to 1GB. It is a benchmark rather than a check and allocates a few
+// GB, so it is disabled by default; run it with
+// --gtest_also_run_disabled_tests --gtest_filter=*SendStream*.
+TEST(SendStream, DISABLED_CPU) {
+  std::vector<int64_t> sizes = {1LL << 10,  1LL << 16,  1LL << 20,
+                                16LL << 20, 64LL << 20, 256LL << 20,
+                                1LL << 30};
+  const int kSmallVars = 100;
+  std::vector<std::string> names;
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    names.push_back("x" + std::to_string(i));
+  }
+  std::vector<std::string> small_names;
+  for (int i = 0; i < kSmallVars; ++i) {
+    small_names.push_back("small" + std::to_string(i));
+  }
+  std::vector<std::string> server_names(names);
+  server_names.insert(server_names.end(), small_names.begin(),
+                      small_names.end());
+
+  std::thread server_thread(StartSendServer, "127.0.0.1:8890", server_names);
+  sleep(2);
+
+  framework::Scope scope;
+  platform::CPUPlace place;
+  platform::CPUDeviceContext ctx(place);
+  auto init_var = [&](const std::string& name, int64_t bytes) {
+    auto* tensor = scope.Var(name)->GetMutable<framework::LoDTensor>();
+    tensor->Resize({bytes / static_cast<int64_t>(sizeof(float))});
+    float* data = tensor->mutable_data<float>(place);
+    for (int64_t j = 0; j < tensor->numel(); ++j) data[j] = 1.0f;
+  };
+  for (size_t i = 0; i < sizes.size(); ++i) init_var(names[i], sizes[i]);
+  for (auto& name : small_names) init_var(name, 1 << 10);
+
+  detail::RPCClient client;
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    double unary = SendAndWait(&client, scope, ctx, {names[i]}, false);
+    double stream = SendAndWait(&client, scope, ctx, {names[i]}, true);
+    LOG(INFO) << "send " << sizes[i] << " bytes, unary: "
+              << sizes[i] / unary / (1 << 20)
+              << " MB/s, stream: " << sizes[i] / stream / (1 << 20) << " MB/s";
+  }
+
+  double unary = SendAndWait(&client, scope, ctx, small_names, false);
+  double stream = SendAndWait(&client, scope, ctx, small_names, true);
+  LOG(INFO) << "send " << kSmallVars << " vars of 1KB, unary: " << unary * 1000
+            << " ms, stream: " << stream * 1000 << " ms";
+
+  rpc_service_->ShutDown();
+  server_thread.join();
+  rpc_service_.reset(nullptr);
+}
@@ -77,10 +77,11 @@ enum class GrpcMethod {
   kSendVariable,
   kGetVariable,
   kPrefetchVariable,
+  kSendVariableStream,
 };
 
 static const int kGrpcNumMethods =
-    static_cast<int>(GrpcMethod::kPrefetchVariable) + 1;
+    static_cast<int>(GrpcMethod::kSendVariableStream) + 1;
 
 inline const char* GrpcMethodName(GrpcMethod id) {
   switch (id) {
@@ -90,6 +91,8 @@ inline const char* GrpcMethodName(GrpcMethod id) {
       return "/sendrecv.SendRecvService/GetVariable";
     case GrpcMethod::kPrefetchVariable:
       return "/sendrecv.SendRecvService/PrefetchVariable";
+    case GrpcMethod::kSendVariableStream:
+      return "/sendrecv.SendRecvService/SendVariableStream";
   }
 
   // Shouldn't be reached.
@@ -103,9 +106,13 @@ class GrpcService final {
    public:
     AsyncService() {
       for (int i = 0; i < kGrpcNumMethods; ++i) {
+        auto method_type =
+            static_cast<GrpcMethod>(i) == GrpcMethod::kSendVariableStream
+                ? ::grpc::internal::RpcMethod::CLIENT_STREAMING
+                : ::grpc::internal::RpcMethod::NORMAL_RPC;
         AddMethod(new ::grpc::internal::RpcServiceMethod(
-            GrpcMethodName(static_cast<GrpcMethod>(i)),
-            ::grpc::internal::RpcMethod::NORMAL_RPC, nullptr));
+            GrpcMethodName(static_cast<GrpcMethod>(i)), method_type,
+            nullptr));
         ::grpc::Service::MarkMethodAsync(i);
       }
     }
@@ -113,6 +120,7 @@ class GrpcService final {
 
     // Make RequestAsyncUnary public for grpc_call.h
     using ::grpc::Service::RequestAsyncUnary;
+    using ::grpc::Service::RequestAsyncClientStreaming;
   };
 };
 
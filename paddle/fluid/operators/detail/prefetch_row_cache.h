@@ -0,0 +1,103 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace detail {
+
+// PrefetchRowCache is a small LRU cache of the rows prefetched from the
+// parameter servers on the trainer side. The table on the pservers is
+// updated every mini-batch, so every row records the version at which it
+// was fetched, and it is treated as a miss once it is more than
+// max_staleness versions old. The caller bumps the version once per
+// prefetch call.
+class PrefetchRowCache {
+ public:
+  PrefetchRowCache(size_t capacity, int64_t max_staleness)
+      : capacity_(capacity), max_staleness_(max_staleness) {}
+
+  void NextVersion() { ++version_; }
+
+  int64_t Version() const { return version_; }
+
+  // Width of the cached rows, -1 if nothing is cached yet.
+  int64_t Width() const { return width_; }
+
+  // Return the cached row of id, nullptr if it is missing or stale. The
+  // pointer is valid until the next Put.
+  const float* Get(int64_t id) {
+    auto it = entries_.find(id);
+    if (it == entries_.end()) {
+      return nullptr;
+    }
+    if (version_ - it->second.version > max_staleness_) {
+      lru_.erase(it->second.lru_pos);
+      entries_.erase(it);
+      return nullptr;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second.lru_pos);
+    return it->second.row.data();
+  }
+
+  void Put(int64_t id, const float* row, int64_t width) {
+    if (capacity_ == 0) return;
+    PADDLE_ENFORCE(width_ == -1 || width_ == width,
+                   "all the cached rows should be of the same width");
+    width_ = width;
+
+    auto it = entries_.find(id);
+    if (it != entries_.end()) {
+      lru_.splice(lru_.begin(), lru_, it->second.lru_pos);
+    } else {
+      if (entries_.size() >= capacity_) {
+        entries_.erase(lru_.back());
+        lru_.pop_back();
+      }
+      lru_.push_front(id);
+      it = entries_.emplace(id, Entry()).first;
+      it->second.lru_pos = lru_.begin();
+    }
+    it->second.row.assign(row, row + width);
+    it->second.version = version_;
+  }
+
+  size_t Size() const { return entries_.size(); }
+
+ private:
+  struct Entry {
+    std::vector<float> row;
+    int64_t version;
+    std::list<int64_t>::iterator lru_pos;
+  };
+
+  size_t capacity_;
+  int64_t max_staleness_;
+  int64_t version_ = 0;
+  int64_t width_ = -1;
+  // most recently used id at the front.
+  std::list<int64_t> lru_;
+  std::unordered_map<int64_t, Entry> entries_;
+};
+
+}  // namespace detail
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,89 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <cmath>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/fluid/operators/detail/prefetch_row_cache.h"
+
+namespace detail = paddle::operators::detail;
+
+TEST(PrefetchRowCache, LRUAndStaleness) {
+  detail::PrefetchRowCache cache(2, 1);
+  std::vector<float> row0(4, 0.0f), row1(4, 1.0f), row2(4, 2.0f);
+  cache.NextVersion();
+  cache.Put(0, row0.data(), 4);
+  cache.Put(1, row1.data(), 4);
+  ASSERT_NE(cache.Get(0), nullptr);
+  // 1 is the least recently used one.
+  cache.Put(2, row2.data(), 4);
+  EXPECT_EQ(cache.Get(1), nullptr);
+  ASSERT_NE(cache.Get(2), nullptr);
+  EXPECT_EQ(cache.Get(2)[3], 2.0f);
+  EXPECT_EQ(cache.Size(), 2UL);
+
+  cache.NextVersion();
+  EXPECT_NE(cache.Get(0), nullptr);
+  cache.NextVersion();
+  EXPECT_EQ(cache.Get(0), nullptr);
+  EXPECT_EQ(cache.Get(2), nullptr);
+  EXPECT_EQ(cache.Size(), 0UL);
+}
+
+// Ids of click-through models follow a Zipfian distribution, report the
+// rows saved by de-duplicating the ids of a batch and by the row cache.
+TEST(PrefetchRowCache, Zipfian) {
+  const int64_t vocab = 100000;
+  const int batch_size = 1024;
+  const int slots = 8;
+  const int batches = 50;
+  const int64_t width = 64;
+
+  std::vector<double> weights(vocab);
+  for (int64_t i = 0; i < vocab; ++i) weights[i] = 1.0 / std::pow(i + 1, 1.1);
+  std::discrete_distribution<int64_t> zipf(weights.begin(), weights.end());
+  std::mt19937 rng(10);
+
+  detail::PrefetchRowCache cache(10000, 4);
+  std::vector<float> row(width, 1.0f);
+  int64_t total_ids = 0, unique_ids = 0, fetched_ids = 0;
+  for (int b = 0; b < batches; ++b) {
+    cache.NextVersion();
+    std::unordered_set<int64_t> batch_ids;
+    for (int i = 0; i < batch_size * slots; ++i) {
+      batch_ids.insert(zipf(rng));
+    }
+    total_ids += batch_size * slots;
+    unique_ids += batch_ids.size();
+    std::vector<int64_t> misses;
+    for (auto id : batch_ids) {
+      if (cache.Get(id) == nullptr) misses.push_back(id);
+    }
+    fetched_ids += misses.size();
+    for (auto id : misses) cache.Put(id, row.data(), width);
+  }
+
+  EXPECT_LT(unique_ids, total_ids);
+  EXPECT_LT(fetched_ids, unique_ids);
+  const double row_mb = width * sizeof(float) / 1024.0 / 1024.0;
+  LOG(INFO) << "zipfian prefetch: " << total_ids << " ids ("
+            << total_ids * row_mb << " MB), " << unique_ids
+            << " after de-duplication (" << unique_ids * row_mb << " MB), "
+            << fetched_ids << " with the row cache ("
+            << fetched_ids * row_mb << " MB)";
+}
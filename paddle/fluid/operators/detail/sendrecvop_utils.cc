@@ -15,6 +15,7 @@ limitations under the License. */
 #include "paddle/fluid/operators/detail/sendrecvop_utils.h"
 
 #include <sys/time.h>
+#include <algorithm>
 #include <thread>  // NOLINT
 
 #include "google/protobuf/io/coded_stream.h"
@@ -181,6 +182,174 @@ void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
   msg->Swap(&tmp);
 }
 
+// Encode the meta fields of a dense tensor, the tag and length of the
+// serialized field are not included.
+static void EncodeLoDTensorMeta(const std::string& name,
+                                const framework::LoDTensor& tensor,
+                                ProtoEncodeHelper* e) {
+  using VarMsg = sendrecv::VariableMessage;
+  e->WriteString(VarMsg::kVarnameFieldNumber, name);
+  e->WriteUint64(VarMsg::kTypeFieldNumber, 0);
+  e->WriteUint64(VarMsg::kDataTypeFieldNumber,
+                 framework::ToDataType(tensor.type()));
+  for (auto& dim : framework::vectorize(tensor.dims())) {
+    e->WriteUint64(VarMsg::kDimsFieldNumber, dim);
+  }
+  auto& lod = tensor.lod();
+  if (lod.size() > 0) {
+    e->WriteUint64(VarMsg::kLodLevelFieldNumber, lod.size());
+    for (auto& each : lod) {
+      size_t lod_bytes = 0;
+      for (auto& d : each) {
+        lod_bytes += 1 + VarintLength(d);
+      }
+      e->WriteVarlengthBeginning(VarMsg::kLodFieldNumber, lod_bytes);
+      for (auto& d : each) {
+        e->WriteUint64(VarMsg::LodData::kLodDataFieldNumber, d);
+      }
+    }
+  }
+}
+
+static size_t LoDTensorMetaSize(const framework::LoDTensor& tensor) {
+  size_t meta_size = 1024;
+  for (auto& each : tensor.lod()) {
+    meta_size += each.size() * 10;
+  }
+  return meta_size;
+}
+
+void SerializeToByteBuffers(const std::string& name, framework::Variable* var,
+                            const platform::DeviceContext& ctx,
+                            std::vector<::grpc::ByteBuffer>* msgs,
+                            int64_t slice_bytes) {
+  using VarMsg = sendrecv::VariableMessage;
+  PADDLE_ENFORCE_GT(slice_bytes, 0);
+  msgs->clear();
+  if (!var->IsType<framework::LoDTensor>() ||
+      static_cast<int64_t>(var->Get<framework::LoDTensor>().memory_size()) <=
+          slice_bytes) {
+    msgs->resize(1);
+    SerializeToByteBuffer(name, var, ctx, &msgs->at(0));
+    return;
+  }
+
+  auto& tensor = var->Get<framework::LoDTensor>();
+  const int64_t elem_size = framework::SizeOfType(tensor.type());
+  const int64_t total = tensor.numel() * elem_size;
+  // slices hold whole elements, so that the receiver can sum them in place.
+  slice_bytes = std::max(slice_bytes / elem_size, int64_t(1)) * elem_size;
+  const char* data = reinterpret_cast<const char*>(tensor.data<void>());
+
+  // NOTE: only the meta part is encoded here, a slice references the
+  // tensor memory directly, so the tensor must be alive until the
+  // messages are sent.
+  size_t meta_size = LoDTensorMetaSize(tensor);
+  std::vector<char> buf(meta_size);
+
+  for (int64_t offset = 0; offset < total; offset += slice_bytes) {
+    const int64_t size = std::min(slice_bytes, total - offset);
+    ProtoEncodeHelper e(buf.data(), meta_size);
+    EncodeLoDTensorMeta(name, tensor, &e);
+    e.WriteUint64(VarMsg::kSliceOffsetFieldNumber, offset);
+    e.WriteUint64(VarMsg::kSliceTotalFieldNumber, total);
+    e.WriteVarlengthBeginning(VarMsg::kSerializedFieldNumber, size);
+
+    DestroyCallback destroy_callback = [](void* backing) {};
+    void* payload = const_cast<char*>(data + offset);
+    if (platform::is_gpu_place(ctx.GetPlace())) {
+#ifdef PADDLE_WITH_CUDA
+      PADDLE_ENFORCE(platform::is_gpu_place(tensor.place()));
+      platform::CPUPlace cpu;
+      auto& gpu_dev_ctx = static_cast<const platform::CUDADeviceContext&>(ctx);
+      payload = memory::Alloc(cpu, size);
+      memory::Copy(cpu, payload,
+                   boost::get<platform::CUDAPlace>(tensor.place()),
+                   reinterpret_cast<const void*>(data + offset), size,
+                   gpu_dev_ctx.stream());
+      ctx.Wait();
+      destroy_callback = [](void* backing) {
+        platform::CPUPlace cpu;
+        memory::Free(cpu, backing);
+      };
+#endif
+    }
+
+    ::grpc::Slice slices[2];
+    slices[0] = ::grpc::Slice(e.size());
+    memcpy(const_cast<uint8_t*>(slices[0].begin()), e.data(), e.size());
+    slices[1] = ::grpc::Slice(
+        grpc_slice_new_with_user_data(payload, size, destroy_callback,
+                                      static_cast<char*>(payload)),
+        ::grpc::Slice::STEAL_REF);
+    msgs->emplace_back(&slices[0], 2);
+  }
+}
+
+void SerializeCompressedToByteBuffer(const std::string& name,
+                                     framework::Variable* var,
+                                     const platform::DeviceContext& ctx,
+                                     const CodecConfig& codec,
+                                     framework::Tensor* residual,
+                                     ::grpc::ByteBuffer* msg) {
+  using VarMsg = sendrecv::VariableMessage;
+  if (codec.type == VarMsg::CODEC_NONE ||
+      !var->IsType<framework::LoDTensor>() ||
+      var->Get<framework::LoDTensor>().type() != typeid(float)) {
+    SerializeToByteBuffer(name, var, ctx, msg);
+    return;
+  }
+
+  auto& tensor = var->Get<framework::LoDTensor>();
+  platform::CPUPlace cpu;
+  const float* data = nullptr;
+  framework::Tensor cpu_tensor;
+  if (platform::is_gpu_place(tensor.place())) {
+    framework::TensorCopy(tensor, cpu, ctx, &cpu_tensor);
+    ctx.Wait();
+    data = cpu_tensor.data<float>();
+  } else {
+    data = tensor.data<float>();
+  }
+
+  float* residual_data = nullptr;
+  if (codec.type == VarMsg::CODEC_TOPK) {
+    PADDLE_ENFORCE_NOT_NULL(residual, "topk codec needs a residual tensor");
+    if (!residual->IsInitialized() || residual->numel() != tensor.numel()) {
+      residual->Resize(tensor.dims());
+      float* r = residual->mutable_data<float>(cpu);
+      std::fill(r, r + residual->numel(), 0.0f);
+    }
+    residual_data = residual->mutable_data<float>(cpu);
+  }
+
+  // the encoded buffer is owned by the slice and freed after sending.
+  auto* encoded = new std::vector<char>();
+  EncodeGradient(codec, data, tensor.numel(), residual_data, encoded);
+
+  size_t meta_size = LoDTensorMetaSize(tensor);
+  std::vector<char> buf(meta_size);
+  ProtoEncodeHelper e(buf.data(), meta_size);
+  EncodeLoDTensorMeta(name, tensor, &e);
+  e.WriteUint64(VarMsg::kCodecFieldNumber, codec.type);
+  e.WriteUint64(VarMsg::kCodecBlockFieldNumber, codec.block_size);
+  e.WriteVarlengthBeginning(VarMsg::kSerializedFieldNumber, encoded->size());
+
+  ::grpc::Slice slices[2];
+  slices[0] = ::grpc::Slice(e.size());
+  memcpy(const_cast<uint8_t*>(slices[0].begin()), e.data(), e.size());
+  slices[1] = ::grpc::Slice(
+      grpc_slice_new_with_user_data(
+          encoded->data(), encoded->size(),
+          [](void* backing) {
+            delete reinterpret_cast<std::vector<char>*>(backing);
+          },
+          encoded),
+      ::grpc::Slice::STEAL_REF);
+  ::grpc::ByteBuffer tmp(&slices[0], 2);
+  msg->Swap(&tmp);
+}
+
 void DeserializeFromByteBuffer(const ::grpc::ByteBuffer& msg,
                                const platform::DeviceContext& ctx,
                                const framework::Scope* scope,
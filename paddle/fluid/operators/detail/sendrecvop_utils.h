@@ -25,6 +25,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/framework/var_type.h"
 
+#include "paddle/fluid/operators/detail/grad_codec.h"
 #include "paddle/fluid/operators/detail/send_recv.grpc.pb.h"
 #include "paddle/fluid/operators/detail/send_recv.pb.h"
 
@@ -42,6 +43,11 @@ static int64_t GetTimestamp() {
   return tp.tv_sec * 1000 + tp.tv_usec / 1000;
 }
 
+// Dense tensors larger than this are sent as several slices by the
+// streaming API, so that the server can start copying the data before
+// the whole tensor arrives.
+constexpr int64_t kStreamSliceBytes = 4 * 1024 * 1024;
+
 typedef void (*DestroyCallback)(void*);
 
 void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
@@ -49,6 +55,25 @@ void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
                            ::grpc::ByteBuffer* msg,
                            const std::string& out_varname = std::string());
 
+// Serialize a variable into one or more messages. A LoDTensor whose data is
+// larger than slice_bytes is split into slices, each of them carries the
+// full meta info with slice_offset and slice_total. Other variables are
+// serialized into exactly one message as SerializeToByteBuffer does.
+void SerializeToByteBuffers(const std::string& name, framework::Variable* var,
+                            const platform::DeviceContext& ctx,
+                            std::vector<::grpc::ByteBuffer>* msgs,
+                            int64_t slice_bytes = kStreamSliceBytes);
+
+// Serialize a variable with a gradient codec. Only dense FP32 LoDTensors
+// are encoded, other variables are serialized as SerializeToByteBuffer
+// does. residual keeps the error feedback of TOPK codec between calls.
+void SerializeCompressedToByteBuffer(const std::string& name,
+                                     framework::Variable* var,
+                                     const platform::DeviceContext& ctx,
+                                     const CodecConfig& codec,
+                                     framework::Tensor* residual,
+                                     ::grpc::ByteBuffer* msg);
+
 void DeserializeFromByteBuffer(const ::grpc::ByteBuffer& msg,
                                const platform::DeviceContext& ctx,
                                const framework::Scope* scope,
@@ -13,8 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include <unistd.h>
+#include <algorithm>
 #include <string>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "google/protobuf/text_format.h"
 #include "gtest/gtest.h"
@@ -210,6 +212,125 @@ TEST(LodTensor, Run) {
 #endif
 }
 
+TEST(LodTensor, RunSliced) {
+  platform::CPUPlace place;
+  platform::CPUDeviceContext ctx(place);
+
+  framework::Variable var;
+  auto* tensor = var.GetMutable<framework::LoDTensor>();
+  tensor->Resize(framework::make_ddim({1000, 37}));
+  framework::LoD lod;
+  lod.push_back(framework::Vector<size_t>({0, 400, 1000}));
+  tensor->set_lod(lod);
+  float* data = tensor->mutable_data<float>(place);
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = static_cast<float>(i);
+  }
+
+  // 148000 bytes of data are split into 37 slices.
+  std::vector<::grpc::ByteBuffer> msgs;
+  operators::detail::SerializeToByteBuffers("myvar", &var, ctx, &msgs, 4096);
+  EXPECT_EQ(msgs.size(), 37UL);
+
+  framework::Scope scope;
+  scope.Var("myvar");
+  for (size_t i = 0; i < msgs.size(); ++i) {
+    operators::detail::VariableResponse resp(&scope, &ctx);
+    EXPECT_EQ(resp.Parse(msgs[i]), 0);
+    EXPECT_EQ(resp.IsLastSlice(), i + 1 == msgs.size());
+  }
+
+  auto& tensor2 = scope.FindVar("myvar")->Get<framework::LoDTensor>();
+  EXPECT_EQ(tensor2.dims(), tensor->dims());
+  EXPECT_TRUE(tensor2.lod() == lod);
+  const float* data2 = tensor2.data<float>();
+  for (int64_t i = 0; i < tensor2.numel(); ++i) {
+    EXPECT_FLOAT_EQ(data2[i], static_cast<float>(i));
+  }
+
+  // small tensors are never sliced.
+  operators::detail::SerializeToByteBuffers("myvar", &var, ctx, &msgs);
+  EXPECT_EQ(msgs.size(), 1UL);
+}
+
+TEST(LodTensor, SumOnRecv) {
+  platform::CPUPlace place;
+  platform::CPUDeviceContext ctx(place);
+  const int trainers = 4;
+  // 256KB of rows of 256 bytes.
+  const int64_t numel = 64 * 1024;
+
+  std::vector<::grpc::ByteBuffer> msgs(trainers);
+  std::vector<std::vector<::grpc::ByteBuffer>> sliced_msgs(trainers);
+  // the messages share the memory of the tensors they are serialized from.
+  std::vector<framework::Variable> vars(trainers);
+  for (int t = 0; t < trainers; ++t) {
+    auto& var = vars[t];
+    auto* tensor = var.GetMutable<framework::LoDTensor>();
+    tensor->Resize(framework::make_ddim({numel / 64, 64}));
+    float* data = tensor->mutable_data<float>(place);
+    for (int64_t i = 0; i < numel; ++i) {
+      data[i] = static_cast<float>(t + i % 7);
+    }
+    auto name = paddle::string::Sprintf("grad.trainer_%d", t);
+    operators::detail::SerializeToByteBuffer(name, &var, ctx, &msgs[t]);
+    // the slices of 9000 bytes do not end at row boundaries.
+    operators::detail::SerializeToByteBuffers(name, &var, ctx,
+                                              &sliced_msgs[t], 9000);
+  }
+
+  framework::Scope scope;
+  scope.Var("grad");
+  operators::detail::ReceivedSums sums;
+  for (int t = 0; t < trainers; ++t) {
+    auto name = paddle::string::Sprintf("grad.trainer_%d", t);
+    scope.Var(name);
+    sums.Add(name, "grad");
+  }
+
+  // receive a copy per trainer and sum them, as the sum operator does.
+  framework::LoDTensor sum;
+  for (int t = 0; t < trainers; ++t) {
+    operators::detail::VariableResponse resp(&scope, &ctx);
+    EXPECT_EQ(resp.Parse(msgs[t]), 0);
+  }
+  float* sum_data =
+      sum.mutable_data<float>(framework::make_ddim({numel / 64, 64}), place);
+  std::fill(sum_data, sum_data + numel, 0.0f);
+  for (int t = 0; t < trainers; ++t) {
+    auto name = paddle::string::Sprintf("grad.trainer_%d", t);
+    const float* data =
+        scope.FindVar(name)->Get<framework::LoDTensor>().data<float>();
+    for (int64_t i = 0; i < numel; ++i) sum_data[i] += data[i];
+  }
+
+  // sum into the buffer of grad while parsing.
+  for (int t = 0; t < trainers; ++t) {
+    operators::detail::VariableResponse resp(&scope, &ctx, &sums);
+    EXPECT_EQ(resp.Parse(msgs[t]), 0);
+  }
+
+  auto& grad = scope.FindVar("grad")->Get<framework::LoDTensor>();
+  const float* grad_data = grad.data<float>();
+  for (int64_t i = 0; i < numel; ++i) {
+    ASSERT_FLOAT_EQ(grad_data[i], sum_data[i]);
+  }
+
+  // the next mini-batch overwrites the sum, in slices this time.
+  sums.Reset();
+  for (int t = 0; t < trainers; ++t) {
+    EXPECT_EQ(sliced_msgs[t].size(), 30UL);
+    for (auto& msg : sliced_msgs[t]) {
+      operators::detail::VariableResponse resp(&scope, &ctx, &sums);
+      EXPECT_EQ(resp.Parse(msg), 0);
+    }
+  }
+  EXPECT_EQ(grad.data<float>(), grad_data);
+  for (int64_t i = 0; i < numel; ++i) {
+    ASSERT_FLOAT_EQ(grad_data[i], sum_data[i]);
+  }
+}
+
 TEST(SelectedRows, Run) {
   platform::CPUPlace place;
   RunSerdeTestSelectedRows(place);
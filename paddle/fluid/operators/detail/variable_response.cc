@@ -14,6 +14,8 @@
 
 #include "paddle/fluid/operators/detail/variable_response.h"
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <utility>
 #include <vector>
@@ -110,10 +112,160 @@ bool ReadRaw(::google::protobuf::io::CodedInputStream* input,
   return true;
 }
 
+// Add size bytes of FP32 data in input to dest, the data is consumed in the
+// buffers of the input stream without being copied out. A float may be
+// split over two buffers, its bytes are gathered in carry.
+bool AddRaw(::google::protobuf::io::CodedInputStream* input, float* dest,
+            int size) {
+  const void* data = NULL;
+  int size_to_add = 0;
+  int total_added = 0;
+  char carry[sizeof(float)];
+  int carry_size = 0;
+
+  while (total_added < size) {
+    if (!input->GetDirectBufferPointer(&data, &size_to_add)) {
+      return false;
+    }
+    if (total_added + size_to_add > size) {
+      size_to_add = size - total_added;
+    }
+    const char* p = reinterpret_cast<const char*>(data);
+    int remain = size_to_add;
+    if (carry_size > 0) {
+      int fill = std::min(static_cast<int>(sizeof(float)) - carry_size, remain);
+      memcpy(carry + carry_size, p, fill);
+      carry_size += fill;
+      p += fill;
+      remain -= fill;
+      if (carry_size == sizeof(float)) {
+        float v;
+        memcpy(&v, carry, sizeof(float));
+        *dest++ += v;
+        carry_size = 0;
+      }
+    }
+    int n = remain / sizeof(float);
+    for (int i = 0; i < n; ++i) {
+      float v;
+      memcpy(&v, p + i * sizeof(float), sizeof(float));
+      dest[i] += v;
+    }
+    dest += n;
+    p += n * sizeof(float);
+    remain -= n * sizeof(float);
+    if (remain > 0) {
+      memcpy(carry, p, remain);
+      carry_size = remain;
+    }
+
+    total_added += size_to_add;
+    input->Skip(size_to_add);
+  }
+
+  return carry_size == 0;
+}
+
+void ReceivedSums::Add(const std::string& recv_name,
+                       const std::string& sum_name) {
+  recv_to_sum_[recv_name] = sum_name;
+  auto& sum = sums_[sum_name];
+  if (sum == nullptr) {
+    sum.reset(new Sum());
+  }
+}
+
+const std::string* ReceivedSums::SumVarName(
+    const std::string& recv_name) const {
+  auto it = recv_to_sum_.find(recv_name);
+  return it == recv_to_sum_.end() ? nullptr : &it->second;
+}
+
+std::unique_lock<std::mutex> ReceivedSums::Lock(const std::string& sum_name,
+                                                bool* first_write) {
+  auto& sum = sums_.at(sum_name);
+  std::unique_lock<std::mutex> lock(sum->mutex);
+  *first_write = !sum->written;
+  sum->written = true;
+  return lock;
+}
+
+void ReceivedSums::Reset() {
+  for (auto& sum : sums_) {
+    std::lock_guard<std::mutex> lock(sum.second->mutex);
+    sum.second->written = false;
+  }
+}
+
+bool VariableResponse::AddLodTensorData(
+    ::google::protobuf::io::CodedInputStream* input,
+    const platform::DeviceContext& ctx, const framework::DDim& dims,
+    int length, const std::string& sum_name) {
+  PADDLE_ENFORCE(meta_.data_type() == sendrecv::VariableMessage::FP32,
+                 "only FP32 gradients can be summed on receiving, var %s",
+                 meta_.varname());
+  PADDLE_ENFORCE(platform::is_cpu_place(ctx.GetPlace()),
+                 "gradients can only be summed on receiving on CPU");
+  auto* var = scope_->FindVar(sum_name);
+  PADDLE_ENFORCE_NOT_NULL(var, "Can not find sum var %s", sum_name);
+  auto* tensor = var->GetMutable<framework::LoDTensor>();
+
+  bool first_write = false;
+  auto lock = sums_->Lock(sum_name, &first_write);
+  if (first_write) {
+    // reuse the memory of the last mini-batch.
+    tensor->Resize(dims);
+    float* data = tensor->mutable_data<float>(ctx.GetPlace());
+    std::fill(data, data + tensor->numel(), 0.0f);
+  } else {
+    PADDLE_ENFORCE(tensor->dims() == dims,
+                   "var %s does not match the shape of sum var %s",
+                   meta_.varname(), sum_name);
+  }
+  float* dst = tensor->data<float>();
+
+  if (meta_.codec() != sendrecv::VariableMessage::CODEC_NONE) {
+    platform::CPUPlace cpu;
+    std::vector<char> encoded(length);
+    if (!ReadRaw(input, ctx, cpu, encoded.data(), length)) {
+      return false;
+    }
+    std::vector<float> decoded(tensor->numel());
+    if (!DecodeGradient(meta_.codec(), meta_.codec_block(), encoded.data(),
+                        length, tensor->numel(), decoded.data())) {
+      return false;
+    }
+    for (int64_t i = 0; i < tensor->numel(); ++i) {
+      dst[i] += decoded[i];
+    }
+    return true;
+  }
+
+  int64_t offset = 0;
+  if (meta_.slice_total() > 0) {
+    PADDLE_ENFORCE_EQ(tensor->numel() * static_cast<int64_t>(sizeof(float)),
+                      meta_.slice_total(),
+                      "slice total size mismatch for var %s", meta_.varname());
+    PADDLE_ENFORCE_LE(meta_.slice_offset() + length, meta_.slice_total(),
+                      "slice out of range for var %s", meta_.varname());
+    PADDLE_ENFORCE_EQ(meta_.slice_offset() % sizeof(float), 0,
+                      "slice of var %s is not aligned", meta_.varname());
+    offset = meta_.slice_offset() / sizeof(float);
+  }
+  return AddRaw(input, dst + offset, length);
+}
+
 bool VariableResponse::CopyLodTensorData(
     ::google::protobuf::io::CodedInputStream* input,
     const platform::DeviceContext& ctx, const framework::DDim& dims,
     int length) {
+  if (sums_ != nullptr) {
+    auto* sum_name = sums_->SumVarName(meta_.varname());
+    if (sum_name != nullptr) {
+      return AddLodTensorData(input, ctx, dims, length, *sum_name);
+    }
+  }
+
   auto var = scope_->FindVar(meta_.varname());
   auto* tensor = var->GetMutable<framework::LoDTensor>();
   tensor->Resize(dims);
@@ -131,6 +283,45 @@ bool VariableResponse::CopyLodTensorData(
   void* tensor_data =
       tensor->mutable_data(ctx.GetPlace(), ToTypeIndex(meta_.data_type()));
 
+  if (meta_.codec() != sendrecv::VariableMessage::CODEC_NONE) {
+    // compressed gradient, decode it into the FP32 tensor.
+    PADDLE_ENFORCE(meta_.data_type() == sendrecv::VariableMessage::FP32,
+                   "only FP32 tensors can be compressed");
+    platform::CPUPlace cpu;
+    std::vector<char> encoded(length);
+    if (!ReadRaw(input, ctx, cpu, encoded.data(), length)) {
+      return false;
+    }
+
+    framework::Tensor cpu_tensor;
+    float* dst = reinterpret_cast<float*>(tensor_data);
+    if (platform::is_gpu_place(tensor->place())) {
+      cpu_tensor.Resize(dims);
+      dst = cpu_tensor.mutable_data<float>(cpu);
+    }
+    if (!DecodeGradient(meta_.codec(), meta_.codec_block(), encoded.data(),
+                        length, tensor->numel(), dst)) {
+      return false;
+    }
+    if (platform::is_gpu_place(tensor->place())) {
+      framework::TensorCopy(cpu_tensor, tensor->place(), ctx, tensor);
+      ctx.Wait();
+    }
+    return true;
+  }
+
+  if (meta_.slice_total() > 0) {
+    // A slice of a large tensor, the first slice allocates the memory and
+    // every slice is copied to its offset directly.
+    int64_t tensor_bytes =
+        tensor->numel() * framework::SizeOfType(tensor->type());
+    PADDLE_ENFORCE_EQ(tensor_bytes, meta_.slice_total(),
+                      "slice total size mismatch for var %s", meta_.varname());
+    PADDLE_ENFORCE_LE(meta_.slice_offset() + length, meta_.slice_total(),
+                      "slice out of range for var %s", meta_.varname());
+    tensor_data = static_cast<char*>(tensor_data) + meta_.slice_offset();
+  }
+
   if (!ReadRaw(input, ctx, tensor->place(), tensor_data, length)) {
     return false;
   }
@@ -380,6 +571,7 @@ int VariableResponse::Parse(Source* source) {
           return tag;
         }
 
+        payload_size_ = length;
         framework::DDim dims = GetDims(meta_.dims());
         if (meta_.type() == sendrecv::LOD_TENSOR) {
           PADDLE_ENFORCE(meta_.lod_size() >= 0,
@@ -430,6 +622,38 @@ int VariableResponse::Parse(Source* source) {
         meta_.set_out_varname(temp);
         break;
       }
+      case sendrecv::VariableMessage::kSliceOffsetFieldNumber: {
+        uint64_t v = 0;
+        if ((wt != WIRETYPE_VARINT) || !input.ReadVarint64(&v)) {
+          return tag;
+        }
+        meta_.set_slice_offset(static_cast<int64_t>(v));
+        break;
+      }
+      case sendrecv::VariableMessage::kCodecFieldNumber: {
+        uint64_t v = 0;
+        if ((wt != WIRETYPE_VARINT) || !input.ReadVarint64(&v)) {
+          return tag;
+        }
+        meta_.set_codec(static_cast<sendrecv::VariableMessage_Codec>(v));
+        break;
+      }
+      case sendrecv::VariableMessage::kCodecBlockFieldNumber: {
+        uint64_t v = 0;
+        if ((wt != WIRETYPE_VARINT) || !input.ReadVarint64(&v)) {
+          return tag;
+        }
+        meta_.set_codec_block(static_cast<int64_t>(v));
+        break;
+      }
+      case sendrecv::VariableMessage::kSliceTotalFieldNumber: {
+        uint64_t v = 0;
+        if ((wt != WIRETYPE_VARINT) || !input.ReadVarint64(&v)) {
+          return tag;
+        }
+        meta_.set_slice_total(static_cast<int64_t>(v));
+        break;
+      }
 
       default: {
         // Unknown tag, return unknown error.
@@ -14,7 +14,10 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <unordered_map>
 
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/lod_tensor.h"
@@ -34,11 +37,41 @@ namespace paddle {
 namespace operators {
 namespace detail {
 
+// ReceivedSums maps the per-trainer gradients received by the pserver to
+// the variables they are summed into. Dense FP32 gradients are added to the
+// sum variable while they are parsed, so the per-trainer copies and the sum
+// operator are not needed.
+class ReceivedSums {
+ public:
+  // The received variable recv_name is summed into sum_name.
+  void Add(const std::string& recv_name, const std::string& sum_name);
+
+  // Return the sum variable of recv_name, nullptr if it is not summed.
+  const std::string* SumVarName(const std::string& recv_name) const;
+
+  // Lock the sum variable, first_write is set if nothing has been added to
+  // it since the last Reset, the caller should overwrite it then.
+  std::unique_lock<std::mutex> Lock(const std::string& sum_name,
+                                    bool* first_write);
+
+  // Start a new mini-batch, should be called after the sums are consumed.
+  void Reset();
+
+ private:
+  struct Sum {
+    std::mutex mutex;
+    bool written = false;
+  };
+  std::unordered_map<std::string, std::string> recv_to_sum_;
+  std::unordered_map<std::string, std::unique_ptr<Sum>> sums_;
+};
+
 class VariableResponse {
  public:
   VariableResponse(const framework::Scope* scope,
-                   const platform::DeviceContext* dev_ctx)
-      : scope_(scope), dev_ctx_(dev_ctx) {}
+                   const platform::DeviceContext* dev_ctx,
+                   ReceivedSums* sums = nullptr)
+      : scope_(scope), dev_ctx_(dev_ctx), sums_(sums) {}
 
   virtual ~VariableResponse() {}
 
@@ -57,6 +90,13 @@ class VariableResponse {
   inline std::string Varname() { return meta_.varname(); }
   inline std::string OutVarname() { return meta_.out_varname(); }
 
+  // Whether the variable is complete after this message is parsed, it is
+  // always true for messages which are not slices of a large tensor.
+  inline bool IsLastSlice() {
+    return meta_.slice_total() == 0 ||
+           meta_.slice_offset() + payload_size_ == meta_.slice_total();
+  }
+
   // should call parse first.
   framework::Variable* GetVar() { return scope_->FindVar(meta_.varname()); }
 
@@ -72,11 +112,19 @@ class VariableResponse {
                          const platform::DeviceContext& ctx,
                          const framework::DDim& dims, int length);
 
+  bool AddLodTensorData(::google::protobuf::io::CodedInputStream* input,
+                        const platform::DeviceContext& ctx,
+                        const framework::DDim& dims, int length,
+                        const std::string& sum_name);
+
  private:
   const framework::Scope* scope_;
   const platform::DeviceContext* dev_ctx_;
+  ReceivedSums* sums_;
   // only Skeleton
   sendrecv::VariableMessage meta_;
+  // bytes of the serialized tensor data in this message.
+  int64_t payload_size_ = 0;
 };
 
 };  // namespace detail
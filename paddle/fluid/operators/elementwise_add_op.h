@@ -24,6 +24,14 @@ struct AddFunctor {
   inline HOSTDEVICE T operator()(T a, T b) const { return a + b; }
 };
 
+template <>
+struct VecElementwise<platform::CPUDeviceContext, AddFunctor<float>> {
+  static constexpr bool value = true;
+  static void Compute(int64_t n, const float* x, const float* y, float* z) {
+    math::VecAdd(n, x, y, z);
+  }
+};
+
 template <typename DeviceContext, typename T>
 class ElementwiseAddKernel : public framework::OpKernel<T> {
  public:
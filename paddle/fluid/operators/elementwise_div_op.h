@@ -24,6 +24,14 @@ struct DivFunctor {
   inline HOSTDEVICE T operator()(T a, T b) const { return a / b; }
 };
 
+template <>
+struct VecElementwise<platform::CPUDeviceContext, DivFunctor<float>> {
+  static constexpr bool value = true;
+  static void Compute(int64_t n, const float* x, const float* y, float* z) {
+    math::VecDiv(n, x, y, z);
+  }
+};
+
 template <typename DeviceContext, typename T>
 class ElementwiseDivKernel : public framework::OpKernel<T> {
  public:
@@ -23,6 +23,14 @@ struct MulFunctor {
   inline HOSTDEVICE T operator()(T a, T b) const { return a * b; }
 };
 
+template <>
+struct VecElementwise<platform::CPUDeviceContext, MulFunctor<float>> {
+  static constexpr bool value = true;
+  static void Compute(int64_t n, const float* x, const float* y, float* z) {
+    math::VecMul(n, x, y, z);
+  }
+};
+
 template <typename DeviceContext, typename T>
 class ElementwiseMulKernel : public framework::OpKernel<T> {
  public:
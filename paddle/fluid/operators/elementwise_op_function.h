@@ -14,9 +14,11 @@ limitations under the License. */
 
 #pragma once
 #include <algorithm>
+#include <vector>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/threadpool.h"
 #include "paddle/fluid/platform/transform.h"
 
 #ifdef __NVCC__
@@ -25,6 +27,7 @@ limitations under the License. */
 constexpr int ELEMWISE_MAX_BLOCK_DIM = 1024;
 #endif
 
+#include "paddle/fluid/operators/math/cpu_vec.h"
 #include "paddle/fluid/operators/math/math_function.h"
 #include "paddle/fluid/platform/for_range.h"
 
@@ -81,74 +84,48 @@ class RowwiseTransformIterator;
 template <typename T, typename DeviceContext>
 class MidWiseTransformIterator;
 
-template <typename T>
-class RowwiseTransformIterator<T, platform::CPUDeviceContext> {
- public:
-  RowwiseTransformIterator(const T* ptr, int n) : ptr_(ptr), i_(0), n_(n) {}
-
-  RowwiseTransformIterator<T, platform::CPUDeviceContext>& operator++() {
-    ++i_;
-    if (UNLIKELY(i_ == n_)) {
-      i_ = 0;
-    }
-    return *this;
-  }
-
-  bool operator==(const RowwiseTransformIterator<T, platform::CPUDeviceContext>&
-                      rhs) const {
-    return (ptr_ + i_) == &(*rhs);
-  }
-
-  bool operator!=(const RowwiseTransformIterator<T, platform::CPUDeviceContext>&
-                      rhs) const {
-    return (ptr_ + i_) != &(*rhs);
-  }
-
-  const T& operator*() { return ptr_[i_]; }
-
- private:
-  const T* ptr_;
-  int i_;
-  int64_t n_;
-};
-
-template <typename T>
-class MidWiseTransformIterator<T, platform::CPUDeviceContext> {
- public:
-  MidWiseTransformIterator(const T* ptr, int n, int post)
-      : ptr_(ptr), i_(0), j_(0), n_(n), post_(post) {}
-
-  MidWiseTransformIterator<T, platform::CPUDeviceContext>& operator++() {
-    ++j_;
-    if (UNLIKELY(j_ == post_)) {
-      ++i_;
-      j_ = 0;
-      if (UNLIKELY(i_ == n_)) {
-        i_ = 0;
+// The CPU broadcast kernels of y of shape [n] to x of shape [pre, n] (row
+// wise) or [pre, n, post] (mid wise). The inner loops are contiguous, so
+// the compiler can vectorize them, and the outer loops are split on the
+// threads of the framework thread pool for the large tensors.
+
+// The elements of a task of the thread pool.
+constexpr int64_t kElemwiseParallelGrain = 1 << 16;
+
+template <typename Functor, typename T, typename OutType>
+void ElemwiseRowWiseCPU(const T* x, const T* y, OutType* z, int pre, int n,
+                        Functor func) {
+  int64_t rows_per_task =
+      std::max<int64_t>(1, kElemwiseParallelGrain / std::max(n, 1));
+  framework::ParallelFor(pre, rows_per_task, [=](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      const T* x_row = x + i * n;
+      OutType* z_row = z + i * n;
+      for (int j = 0; j < n; ++j) {
+        z_row[j] = func(x_row[j], y[j]);
       }
     }
-    return *this;
-  }
-
-  bool operator==(const MidWiseTransformIterator<T, platform::CPUDeviceContext>&
-                      rhs) const {
-    return (ptr_ + i_) == &(*rhs);
-  }
-
-  bool operator!=(const MidWiseTransformIterator<T, platform::CPUDeviceContext>&
-                      rhs) const {
-    return (ptr_ + i_) != &(*rhs);
-  }
-
-  const T& operator*() { return ptr_[i_]; }
+  });
+}
 
- private:
-  const T* ptr_;
-  int64_t i_;
-  int64_t j_;
-  int64_t n_;
-  int64_t post_;
-};
+template <typename Functor, typename T, typename OutType>
+void ElemwiseMidWiseCPU(const T* x, const T* y, OutType* z, int pre, int n,
+                        int post, Functor func) {
+  int64_t rows_per_task =
+      std::max<int64_t>(1, kElemwiseParallelGrain / std::max(post, 1));
+  framework::ParallelFor(
+      static_cast<int64_t>(pre) * n, rows_per_task,
+      [=](int64_t begin, int64_t end) {
+        for (int64_t r = begin; r < end; ++r) {
+          const T y_value = y[r % n];
+          const T* x_row = x + r * post;
+          OutType* z_row = z + r * post;
+          for (int k = 0; k < post; ++k) {
+            z_row[k] = func(x_row[k], y_value);
+          }
+        }
+      });
+}
 
 #ifdef __NVCC__
 template <typename T>
@@ -212,18 +189,38 @@ class TransformFunctor {
   }
 
   inline void RunRowWise(int n, int pre) const {
+    RunRowWise(ctx_, n, pre);
+  }
+
+  inline void RunMidWise(int n, int pre, int post) const {
+    RunMidWise(ctx_, n, pre, post);
+  }
+
+ private:
+  inline void RunRowWise(const platform::CPUDeviceContext& ctx, int n,
+                         int pre) const {
+    ElemwiseRowWiseCPU(x_, y_, z_, pre, n, func_);
+  }
+
+  inline void RunMidWise(const platform::CPUDeviceContext& ctx, int n, int pre,
+                         int post) const {
+    ElemwiseMidWiseCPU(x_, y_, z_, pre, n, post, func_);
+  }
+
+  template <typename Context>
+  inline void RunRowWise(const Context& ctx, int n, int pre) const {
     platform::Transform<DeviceContext> trans;
     trans(ctx_, x_, x_ + nx_, RowwiseTransformIterator<T, DeviceContext>(y_, n),
           z_, func_);
   }
 
-  inline void RunMidWise(int n, int pre, int post) const {
+  template <typename Context>
+  inline void RunMidWise(const Context& ctx, int n, int pre, int post) const {
     platform::Transform<DeviceContext> trans;
     trans(ctx_, x_, x_ + nx_,
           MidWiseTransformIterator<T, DeviceContext>(y_, n, post), z_, func_);
   }
 
- private:
   const T* x_;
   const T* y_;
   OutType* z_;
@@ -312,27 +309,65 @@ struct ElemwiseGradNoBroadcast {
   T* dy_;
 };
 
+// The gradients of y of shape [w] broadcast to x of shape [h, w]. The tasks
+// are the blocks of columns of the chunks of rows, the partial sums of dy of
+// a block stay in the cache while its rows are accumulated. The chunks do
+// not depend on the threads and their partial sums are reduced in order, so
+// the result is deterministic.
 template <typename T, typename DX_OP, typename DY_OP>
 static void ElemwiseGradBroadcast1CPU(const T* x, const T* y, const T* out,
                                       const T* dout, int h, int w, DX_OP dx_op,
                                       DY_OP dy_op, T* dx, T* dy) {
-  for (int i = 0; i < h; ++i) {
-    for (int j = 0; j < w; ++j) {
-      int x_offset = i * w + j;
-      if (dx != nullptr) {
-        dx[x_offset] = dx_op(x[x_offset], y[j], out[x_offset], dout[x_offset]);
-      }
-      if (dy != nullptr) {
-        T tmp = dy_op(x[x_offset], y[j], out[x_offset], dout[x_offset]);
-        if (i == 0) {
-          dy[j] = tmp;
-        } else {
-          dy[j] += tmp;
+  if (h == 0) {
+    if (dy != nullptr) std::fill(dy, dy + w, static_cast<T>(0));
+    return;
+  }
+  const int kColumnBlock = 1024;
+  const int64_t kMaxChunks = 64;
+  const int64_t rows_per_chunk = std::max<int64_t>(
+      {1, kElemwiseParallelGrain / std::max(w, 1),
+       (h + kMaxChunks - 1) / kMaxChunks});
+  const int64_t num_chunks = (h + rows_per_chunk - 1) / rows_per_chunk;
+  const int64_t num_blocks = (w + kColumnBlock - 1) / kColumnBlock;
+  std::vector<T> partial(dy == nullptr ? 0 : num_chunks * w);
+
+  auto run = [&](int64_t begin, int64_t end) {
+    for (int64_t task = begin; task < end; ++task) {
+      const int64_t chunk = task / num_blocks;
+      const int64_t row_begin = chunk * rows_per_chunk;
+      const int64_t row_end = std::min<int64_t>(h, row_begin + rows_per_chunk);
+      const int j0 = static_cast<int>(task % num_blocks) * kColumnBlock;
+      const int j1 = std::min(w, j0 + kColumnBlock);
+      T* acc = dy == nullptr ? nullptr : partial.data() + chunk * w;
+      if (acc != nullptr) std::fill(acc + j0, acc + j1, static_cast<T>(0));
+      for (int64_t i = row_begin; i < row_end; ++i) {
+        const int64_t offset = i * w;
+        if (dx != nullptr) {
+          for (int j = j0; j < j1; ++j) {
+            dx[offset + j] =
+                dx_op(x[offset + j], y[j], out[offset + j], dout[offset + j]);
+          }
+        }
+        if (acc != nullptr) {
+          for (int j = j0; j < j1; ++j) {
+            acc[j] +=
+                dy_op(x[offset + j], y[j], out[offset + j], dout[offset + j]);
+          }
         }
       }
     }
+  };
+  framework::ParallelFor(num_chunks * num_blocks, 1, run);
+
+  if (dy != nullptr) {
+    std::copy(partial.begin(), partial.begin() + w, dy);
+    for (int64_t chunk = 1; chunk < num_chunks; ++chunk) {
+      const T* acc = partial.data() + chunk * w;
+      for (int j = 0; j < w; ++j) dy[j] += acc[j];
+    }
   }
 }
+
 #ifdef __NVCC__
 
 // __shfl_down has been deprecated as of CUDA 9.0.
@@ -425,29 +460,38 @@ static void ElemwiseGradBroadcast1CUDA(cudaStream_t stream, const T* x,
 
 #endif
 
+// The gradients of y of shape [n] broadcast to x of shape [pre, n, post].
+// Every dy[j] is reduced by one task over the contiguous rows of post
+// elements of j, the tasks are split on j.
 template <typename T, typename DX_OP, typename DY_OP>
 static void ElemwiseGradBroadcast2CPU(const T* x, const T* y, const T* out,
                                       const T* dout, int pre, int n, int post,
                                       DX_OP dx_op, DY_OP dy_op, T* dx, T* dy) {
-  for (int i = 0; i < pre; ++i) {
-    for (int j = 0; j < n; ++j) {
-      for (int k = 0; k < post; ++k) {
-        int x_offset = i * n * post + j * post + k;
+  const int64_t cols_per_task = std::max<int64_t>(
+      1, kElemwiseParallelGrain /
+             std::max<int64_t>(1, static_cast<int64_t>(pre) * post));
+  framework::ParallelFor(n, cols_per_task, [&](int64_t begin, int64_t end) {
+    for (int64_t j = begin; j < end; ++j) {
+      const T y_value = y[j];
+      T sum = static_cast<T>(0);
+      for (int i = 0; i < pre; ++i) {
+        const int64_t offset = (static_cast<int64_t>(i) * n + j) * post;
         if (dx != nullptr) {
-          dx[x_offset] =
-              dx_op(x[x_offset], y[j], out[x_offset], dout[x_offset]);
+          for (int k = 0; k < post; ++k) {
+            dx[offset + k] = dx_op(x[offset + k], y_value, out[offset + k],
+                                   dout[offset + k]);
+          }
         }
         if (dy != nullptr) {
-          T tmp = dy_op(x[x_offset], y[j], out[x_offset], dout[x_offset]);
-          if (i == 0 && k == 0) {
-            dy[j] = tmp;
-          } else {
-            dy[j] += tmp;
+          for (int k = 0; k < post; ++k) {
+            sum += dy_op(x[offset + k], y_value, out[offset + k],
+                         dout[offset + k]);
           }
         }
       }
+      if (dy != nullptr) dy[j] = sum;
     }
-  }
+  });
 }
 
 #ifdef __NVCC__
@@ -610,6 +654,15 @@ void ElementwiseGradCompute(const framework::ExecutionContext& ctx,
   }
 }
 
+// The functors with a vectorized kernel in math/cpu_vec.h, which is used
+// when y is of the shape of x or of its rows.
+template <typename DeviceContext, typename Functor>
+struct VecElementwise {
+  static constexpr bool value = false;
+  template <typename T, typename OutType>
+  static void Compute(int64_t n, const T* x, const T* y, OutType* z) {}
+};
+
 template <typename Functor, typename DeviceContext, typename T,
           typename OutType = T>
 void ElementwiseComputeEx(const framework::ExecutionContext& ctx,
@@ -624,8 +677,14 @@ void ElementwiseComputeEx(const framework::ExecutionContext& ctx,
   PADDLE_ENFORCE_GE(x_dims.size(), y_dims.size(),
                     "Rank of first input must >= rank of second input.");
 
+  using Vec = VecElementwise<DeviceContext, Functor>;
   if (x_dims == y_dims) {
-    functor.Run();
+    if (Vec::value) {
+      Vec::Compute(x->numel(), x->data<T>(), y->data<T>(),
+                   z->data<OutType>());
+    } else {
+      functor.Run();
+    }
     return;
   }
 
@@ -638,7 +697,22 @@ void ElementwiseComputeEx(const framework::ExecutionContext& ctx,
   int pre, n, post;
   get_mid_dims(x_dims, y_dims, axis, &pre, &n, &post);
   if (post == 1) {
-    functor.RunRowWise(n, pre);
+    if (Vec::value) {
+      const T* x_data = x->data<T>();
+      const T* y_data = y->data<T>();
+      OutType* z_data = z->data<OutType>();
+      int64_t rows_per_task =
+          std::max<int64_t>(1, kElemwiseParallelGrain / std::max(n, 1));
+      framework::ParallelFor(pre, rows_per_task,
+                             [=](int64_t begin, int64_t end) {
+                               for (int64_t i = begin; i < end; ++i) {
+                                 Vec::Compute(n, x_data + i * n, y_data,
+                                              z_data + i * n);
+                               }
+                             });
+    } else {
+      functor.RunRowWise(n, pre);
+    }
     return;
   } else {
     functor.RunMidWise(n, pre, post);
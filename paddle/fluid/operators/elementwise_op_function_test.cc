@@ -0,0 +1,232 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/elementwise_op_function.h"
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <vector>
+#include "paddle/fluid/operators/elementwise_add_op.h"
+#include "paddle/fluid/operators/elementwise_mul_op.h"
+
+namespace paddle {
+namespace operators {
+
+static std::vector<float> RandomVec(size_t n) {
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  std::vector<float> x(n);
+  for (auto& v : x) v = dist(rng);
+  return x;
+}
+
+static void ExpectNear(const std::vector<float>& actual,
+                       const std::vector<float>& expected, float abs_error) {
+  ASSERT_EQ(actual.size(), expected.size());
+  for (size_t i = 0; i < actual.size(); ++i) {
+    ASSERT_NEAR(actual[i], expected[i], abs_error) << "at " << i;
+  }
+}
+
+// The reference loops over x of shape [pre, n, post] and y of shape [n].
+template <typename Functor>
+static void RefForward(const float* x, const float* y, float* z, int pre,
+                       int n, int post, Functor func) {
+  for (int i = 0; i < pre; ++i) {
+    for (int j = 0; j < n; ++j) {
+      for (int k = 0; k < post; ++k) {
+        int offset = (i * n + j) * post + k;
+        z[offset] = func(x[offset], y[j]);
+      }
+    }
+  }
+}
+
+template <typename DX_OP, typename DY_OP>
+static void RefBackward(const float* x, const float* y, const float* out,
+                        const float* dout, int pre, int n, int post,
+                        DX_OP dx_op, DY_OP dy_op, float* dx, float* dy) {
+  std::fill(dy, dy + n, 0.f);
+  for (int i = 0; i < pre; ++i) {
+    for (int j = 0; j < n; ++j) {
+      for (int k = 0; k < post; ++k) {
+        int offset = (i * n + j) * post + k;
+        dx[offset] = dx_op(x[offset], y[j], out[offset], dout[offset]);
+        dy[j] += dy_op(x[offset], y[j], out[offset], dout[offset]);
+      }
+    }
+  }
+}
+
+struct BroadcastShape {
+  int pre;
+  int n;
+  int post;
+};
+
+// Small shapes, shapes of a single task and shapes split on the threads,
+// with the widths which are not multiples of the column blocks.
+static const std::vector<BroadcastShape> kShapes = {
+    {1, 1, 1},      {3, 5, 1},    {7, 3, 11},   {1000, 3, 1},
+    {257, 1031, 1}, {2, 3000, 1}, {4, 64, 784}, {16, 33, 1025}};
+
+TEST(ElemwiseBroadcast, Forward) {
+  for (auto& s : kShapes) {
+    size_t numel = static_cast<size_t>(s.pre) * s.n * s.post;
+    auto x = RandomVec(numel);
+    auto y = RandomVec(s.n);
+    std::vector<float> z(numel), expected(numel);
+
+    RefForward(x.data(), y.data(), expected.data(), s.pre, s.n, s.post,
+               MulFunctor<float>());
+    if (s.post == 1) {
+      ElemwiseRowWiseCPU(x.data(), y.data(), z.data(), s.pre, s.n,
+                         MulFunctor<float>());
+      ExpectNear(z, expected, 0);
+    }
+    ElemwiseMidWiseCPU(x.data(), y.data(), z.data(), s.pre, s.n, s.post,
+                       MulFunctor<float>());
+    ExpectNear(z, expected, 0);
+  }
+}
+
+TEST(ElemwiseBroadcast, Backward) {
+  for (auto& s : kShapes) {
+    size_t numel = static_cast<size_t>(s.pre) * s.n * s.post;
+    auto x = RandomVec(numel);
+    auto y = RandomVec(s.n);
+    auto dout = RandomVec(numel);
+    std::vector<float> out(numel), dx(numel), dy(s.n);
+    std::vector<float> expected_dx(numel), expected_dy(s.n);
+
+    RefBackward(x.data(), y.data(), out.data(), dout.data(), s.pre, s.n,
+                s.post, MulGradDX<float>(), MulGradDY<float>(),
+                expected_dx.data(), expected_dy.data());
+    float dy_error = 1e-5f * s.pre * s.post;
+    if (s.post == 1) {
+      ElemwiseGradBroadcast1CPU(x.data(), y.data(), out.data(), dout.data(),
+                                s.pre, s.n, MulGradDX<float>(),
+                                MulGradDY<float>(), dx.data(), dy.data());
+      ExpectNear(dx, expected_dx, 0);
+      ExpectNear(dy, expected_dy, dy_error);
+    }
+    ElemwiseGradBroadcast2CPU(x.data(), y.data(), out.data(), dout.data(),
+                              s.pre, s.n, s.post, MulGradDX<float>(),
+                              MulGradDY<float>(), dx.data(), dy.data());
+    ExpectNear(dx, expected_dx, 0);
+    ExpectNear(dy, expected_dy, dy_error);
+
+    // Only one of the gradients is needed.
+    std::vector<float> dy_only(s.n);
+    ElemwiseGradBroadcast2CPU(x.data(), y.data(), out.data(), dout.data(),
+                              s.pre, s.n, s.post, MulGradDX<float>(),
+                              MulGradDY<float>(), static_cast<float*>(nullptr),
+                              dy_only.data());
+    ExpectNear(dy_only, dy, 0);
+  }
+}
+
+// The sum of dy should not depend on the threads which ran the chunks.
+TEST(ElemwiseBroadcast, DeterministicGrad) {
+  const int h = 4096, w = 100;
+  auto x = RandomVec(h * w);
+  auto y = RandomVec(w);
+  auto dout = RandomVec(h * w);
+  std::vector<float> first(w), dy(w);
+  ElemwiseGradBroadcast1CPU(x.data(), y.data(), x.data(), dout.data(), h, w,
+                            IdentityGrad<float>(), IdentityGrad<float>(),
+                            static_cast<float*>(nullptr), first.data());
+  for (int i = 0; i < 10; ++i) {
+    ElemwiseGradBroadcast1CPU(x.data(), y.data(), x.data(), dout.data(), h, w,
+                              IdentityGrad<float>(), IdentityGrad<float>(),
+                              static_cast<float*>(nullptr), dy.data());
+    ExpectNear(dy, first, 0);
+  }
+}
+
+// A batch of no rows gives a zero dy.
+TEST(ElemwiseBroadcast, EmptyGrad) {
+  const int w = 10;
+  auto y = RandomVec(w);
+  std::vector<float> dy(w, 1.f);
+  ElemwiseGradBroadcast1CPU(y.data(), y.data(), y.data(), y.data(), 0, w,
+                            IdentityGrad<float>(), IdentityGrad<float>(),
+                            static_cast<float*>(nullptr), dy.data());
+  ExpectNear(dy, std::vector<float>(w, 0.f), 0);
+}
+
+static double TimeIt(const std::function<void()>& func) {
+  const int kRepeat = 20;
+  func();
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kRepeat; ++i) func();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count() /
+         kRepeat;
+}
+
+// Logs the time of the reference loops and the broadcast kernels of the
+// bias shapes, [batch, size] + [size] of fc and NCHW + [C] of conv. It checks
+// nothing, run it with --gtest_also_run_disabled_tests.
+TEST(ElemwiseBroadcast, DISABLED_Benchmark) {
+  const std::vector<BroadcastShape> shapes = {
+      {128, 1024, 1}, {1024, 4096, 1}, {32, 64, 56 * 56}, {32, 256, 14 * 14}};
+  for (auto& s : shapes) {
+    size_t numel = static_cast<size_t>(s.pre) * s.n * s.post;
+    auto x = RandomVec(numel);
+    auto y = RandomVec(s.n);
+    auto dout = RandomVec(numel);
+    std::vector<float> z(numel), dx(numel), dy(s.n);
+    float* zp = z.data();
+    float* dxp = dx.data();
+    float* dyp = dy.data();
+    const float* xp = x.data();
+    const float* yp = y.data();
+    const float* doutp = dout.data();
+    const BroadcastShape shape = s;
+
+    double ref_add = TimeIt([=] {
+      RefForward(xp, yp, zp, shape.pre, shape.n, shape.post,
+                 AddFunctor<float>());
+    });
+    double add = TimeIt([=] {
+      ElemwiseMidWiseCPU(xp, yp, zp, shape.pre, shape.n, shape.post,
+                         AddFunctor<float>());
+    });
+    double ref_mul_grad = TimeIt([=] {
+      RefBackward(xp, yp, zp, doutp, shape.pre, shape.n, shape.post,
+                  MulGradDX<float>(), MulGradDY<float>(), dxp, dyp);
+    });
+    double mul_grad = TimeIt([=] {
+      if (shape.post == 1) {
+        ElemwiseGradBroadcast1CPU(xp, yp, zp, doutp, shape.pre, shape.n,
+                                  MulGradDX<float>(), MulGradDY<float>(), dxp,
+                                  dyp);
+      } else {
+        ElemwiseGradBroadcast2CPU(xp, yp, zp, doutp, shape.pre, shape.n,
+                                  shape.post, MulGradDX<float>(),
+                                  MulGradDY<float>(), dxp, dyp);
+      }
+    });
+    LOG(INFO) << "[" << s.pre << ", " << s.n << ", " << s.post
+              << "] add: " << ref_add << "us -> " << add
+              << "us, mul grad: " << ref_mul_grad << "us -> " << mul_grad
+              << "us";
+  }
+}
+
+}  // namespace operators
+}  // namespace paddle
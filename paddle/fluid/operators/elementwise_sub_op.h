@@ -23,6 +23,14 @@ struct SubFunctor {
   inline HOSTDEVICE T operator()(T a, T b) const { return a - b; }
 };
 
+template <>
+struct VecElementwise<platform::CPUDeviceContext, SubFunctor<float>> {
+  static constexpr bool value = true;
+  static void Compute(int64_t n, const float* x, const float* y, float* z) {
+    math::VecSub(n, x, y, z);
+  }
+};
+
 template <typename DeviceContext, typename T>
 class ElementwiseSubKernel : public framework::OpKernel<T> {
  public:
@@ -124,6 +124,10 @@ if (lr\_power == -0.5) {
 squared\_accum += grad^2;
 $$
 
+If Grad is SelectedRows, only the rows in it are updated (the lazy mode), and
+the cost of a step is proportional to the number of the unique rows. The rows
+not in Grad would not change in a dense update either.
+
 The paper that proposed Follow The Regularized Leader (FTRL):
 (https://www.eecs.tufts.edu/~dsculley/papers/ad-click-prediction.pdf)
 
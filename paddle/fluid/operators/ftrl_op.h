@@ -15,6 +15,7 @@ limitations under the License. */
 #pragma once
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/lazy_sparse_update.h"
 
 namespace paddle {
 namespace operators {
@@ -36,12 +37,18 @@ class FTRLOpKernel : public framework::OpKernel<T> {
     sq_accum_out->mutable_data<T>(ctx.GetPlace());
     lin_accum_out->mutable_data<T>(ctx.GetPlace());
 
-    auto grad = ctx.Input<Tensor>("Grad");
-
     auto l1 = static_cast<T>(ctx.Attr<float>("l1"));
     auto l2 = static_cast<T>(ctx.Attr<float>("l2"));
     auto lr_power = static_cast<T>(ctx.Attr<float>("lr_power"));
 
+    auto* grad_var = ctx.InputVar("Grad");
+    if (grad_var->IsType<framework::SelectedRows>()) {
+      LazyUpdate(ctx, grad_var->Get<framework::SelectedRows>(), l1, l2,
+                 lr_power, param_out, sq_accum_out, lin_accum_out);
+      return;
+    }
+    auto grad = ctx.Input<Tensor>("Grad");
+
     auto p = EigenVector<T>::Flatten(*ctx.Input<Tensor>("Param"));
     auto sq_accum =
         EigenVector<T>::Flatten(*ctx.Input<Tensor>("SquaredAccumulator"));
@@ -90,6 +97,61 @@ class FTRLOpKernel : public framework::OpKernel<T> {
 
     s_acc_out.device(place) = sq_accum + g * g;
   }
+
+ private:
+  // Only the rows of the merged gradient are updated, in parallel. A zero
+  // gradient does not change the accumulators nor the parameter, so the
+  // result is the same as the dense update.
+  void LazyUpdate(const framework::ExecutionContext& ctx,
+                  const framework::SelectedRows& grad, T l1, T l2, T lr_power,
+                  Tensor* param_out, Tensor* sq_accum_out,
+                  Tensor* lin_accum_out) const {
+    PADDLE_ENFORCE(platform::is_cpu_place(ctx.GetPlace()),
+                   "sparse ftrl only supports CPUPlace");
+    if (grad.rows().size() == 0) return;
+    auto grad_merge = MergeSparseGrad<T>(
+        ctx.template device_context<platform::CPUDeviceContext>(), grad);
+    auto& param = *ctx.Input<Tensor>("Param");
+    int64_t height = param.dims()[0];
+    const int64_t* rows = grad_merge.rows().data();
+    int64_t num_rows = grad_merge.rows().size();
+    int64_t row_numel = grad_merge.value().numel() / num_rows;
+    for (int64_t i = 0; i < num_rows; ++i) {
+      PADDLE_ENFORCE_LT(rows[i], height,
+                        "Input rows index should less than height");
+    }
+
+    const T* g = grad_merge.value().template data<T>();
+    const T* p = param.template data<T>();
+    const T* sq =
+        ctx.Input<Tensor>("SquaredAccumulator")->template data<T>();
+    const T* lin = ctx.Input<Tensor>("LinearAccumulator")->template data<T>();
+    T lr = ctx.Input<Tensor>("LearningRate")->template data<T>()[0];
+    T* p_out = param_out->template data<T>();
+    T* sq_out = sq_accum_out->template data<T>();
+    T* lin_out = lin_accum_out->template data<T>();
+    bool sqrt_power = lr_power == static_cast<T>(-0.5);
+    ParallelForRows(num_rows, row_numel, [&](int64_t i) {
+      int64_t offset = rows[i] * row_numel;
+      for (int64_t j = 0; j < row_numel; ++j) {
+        T g_val = g[i * row_numel + j];
+        T p_val = p[offset + j];
+        T sq_val = sq[offset + j];
+        T new_accum = sq_val + g_val * g_val;
+        T new_pow = sqrt_power ? std::sqrt(new_accum)
+                               : std::pow(new_accum, -lr_power);
+        T old_pow =
+            sqrt_power ? std::sqrt(sq_val) : std::pow(sq_val, -lr_power);
+        T lin_val = lin[offset + j] + g_val - (new_pow - old_pow) / lr * p_val;
+        T sign = lin_val > 0 ? 1 : (lin_val < 0 ? -1 : 0);
+        T x = l1 * sign - lin_val;
+        T y = new_pow / lr + static_cast<T>(2) * l2;
+        lin_out[offset + j] = lin_val;
+        p_out[offset + j] = std::abs(lin_val) > l1 ? x / y : 0;
+        sq_out[offset + j] = new_accum;
+      }
+    });
+  }
 };
 
 }  // namespace operators
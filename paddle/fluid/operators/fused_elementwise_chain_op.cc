@@ -0,0 +1,107 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/fused_elementwise_chain_op.h"
+
+namespace paddle {
+namespace operators {
+
+class FusedElementwiseChainOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("X"),
+                   "Input(X) of FusedElementwiseChainOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("Out"),
+                   "Output(Out) of FusedElementwiseChainOp should not be "
+                   "null.");
+
+    auto functors =
+        ctx->Attrs().Get<std::vector<std::string>>("functor_list");
+    size_t num_binary = 0;
+    for (auto& functor : functors) {
+      if (math::IsFusableElementwise(functor)) {
+        ++num_binary;
+      } else {
+        PADDLE_ENFORCE(math::IsFusableActivation(functor),
+                       "Functor %s can not be fused", functor);
+      }
+    }
+    size_t num_ys = ctx->HasInputs("Y") ? ctx->Inputs("Y").size() : 0;
+    PADDLE_ENFORCE_EQ(num_ys, num_binary,
+                      "Every binary functor should have an input in Y.");
+    if (num_ys > 0) {
+      auto x_dims = ctx->GetInputDim("X");
+      for (auto& y_dims : ctx->GetInputsDim("Y")) {
+        PADDLE_ENFORCE_GE(x_dims.size(), y_dims.size(),
+                          "The rank of Y should be no more than that of X.");
+      }
+    }
+
+    ctx->SetOutputDim("Out", ctx->GetInputDim("X"));
+    ctx->ShareLoD("X", /*->*/ "Out");
+  }
+};
+
+class FusedElementwiseChainOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  FusedElementwiseChainOpMaker(OpProto* proto, OpAttrChecker* op_checker)
+      : OpProtoAndCheckerMaker(proto, op_checker) {
+    AddInput("X", "(Tensor) The first input of the chain.");
+    AddInput("Y",
+             "(Tensors) The second inputs of the binary functors, in the "
+             "order of the functors.")
+        .AsDuplicable()
+        .AsDispensable();
+    AddOutput("Out", "(Tensor) The output of the chain, of the shape of X.");
+    AddAttr<std::vector<std::string>>(
+        "functor_list",
+        "(vector<string>) The functors of the chain in order, each one is "
+        "elementwise_add, elementwise_sub, elementwise_mul, elementwise_div, "
+        "relu, sigmoid or tanh.");
+    AddAttr<std::vector<int>>(
+        "axis_list",
+        "(vector<int>, default {}) The broadcast axis of each input in Y, as "
+        "the axis of the elementwise ops. -1 if not set.")
+        .SetDefault({});
+    AddComment(R"DOC(
+FusedElementwiseChain Operator.
+
+Computes a chain of the elementwise ops and activations in one pass:
+
+$$Out = f_k(...f_2(f_1(X, Y_1), Y_2)...)$$
+
+where each $f_i$ is either a binary elementwise op whose second input is the
+next tensor of $Y$, broadcast to $X$ as by the elementwise ops, or an
+activation. The intermediate tensors of the chain are never written. It is
+created by the fusion passes of the inference library and has no gradient.
+
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(fused_elementwise_chain, ops::FusedElementwiseChainOp,
+                  ops::FusedElementwiseChainOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    fused_elementwise_chain,
+    ops::FusedElementwiseChainKernel<paddle::platform::CPUDeviceContext,
+                                     float>,
+    ops::FusedElementwiseChainKernel<paddle::platform::CPUDeviceContext,
+                                     double>);
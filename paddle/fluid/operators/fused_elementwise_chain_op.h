@@ -0,0 +1,127 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/elementwise_op_function.h"
+#include "paddle/fluid/operators/math/fused_functors.h"
+
+namespace paddle {
+namespace operators {
+
+// The elements computed at a time by the fused chain, small enough for the
+// buffer to stay in L1 cache.
+constexpr int64_t kElementwiseChainBlock = 1024;
+
+// Y of a binary functor of the chain, broadcast to X as [pre, n, post] of
+// the elementwise ops.
+template <typename T>
+struct ChainOperand {
+  const T* data;
+  int64_t n;
+  int64_t post;
+
+  ChainOperand(const framework::Tensor& x, const framework::Tensor& y,
+               int axis)
+      : data(y.data<T>()), n(1), post(1) {
+    if (x.dims() == y.dims()) {
+      n = x.numel();
+      return;
+    }
+    auto x_dims = x.dims();
+    auto y_dims = y.dims();
+    axis = (axis == -1 ? x_dims.size() - y_dims.size() : axis);
+    trim_trailing_singular_dims(&y_dims);
+    axis = (y_dims.size() == 0) ? x_dims.size() : axis;
+    int pre, mid, post_size;
+    get_mid_dims(x_dims, y_dims, axis, &pre, &mid, &post_size);
+    n = mid;
+    post = post_size;
+  }
+
+  T At(int64_t i) const { return data[(i / post) % n]; }
+};
+
+template <typename T>
+void ApplyBinary(const std::string& type, const ChainOperand<T>& y,
+                 int64_t begin, T* buf, int64_t size) {
+  // Y has the shape of X, or is broadcast along the rows.
+  bool contiguous = y.post == 1 && begin % y.n + size <= y.n;
+  const T* y_data = y.data + (contiguous ? begin % y.n : 0);
+  if (type == "elementwise_add") {
+    for (int64_t j = 0; j < size; ++j) {
+      buf[j] += contiguous ? y_data[j] : y.At(begin + j);
+    }
+  } else if (type == "elementwise_sub") {
+    for (int64_t j = 0; j < size; ++j) {
+      buf[j] -= contiguous ? y_data[j] : y.At(begin + j);
+    }
+  } else if (type == "elementwise_mul") {
+    for (int64_t j = 0; j < size; ++j) {
+      buf[j] *= contiguous ? y_data[j] : y.At(begin + j);
+    }
+  } else if (type == "elementwise_div") {
+    for (int64_t j = 0; j < size; ++j) {
+      buf[j] /= contiguous ? y_data[j] : y.At(begin + j);
+    }
+  } else {
+    PADDLE_THROW("Elementwise op %s can not be fused", type);
+  }
+}
+
+// Out = f_k(...f_2(f_1(X, Y_1), Y_2)...), where f_i is a binary elementwise
+// op whose second input is the next Y, or an activation. The chain is
+// computed a block of elements at a time in a local buffer, so only Out is
+// written to memory.
+template <typename DeviceContext, typename T>
+class FusedElementwiseChainKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* x = ctx.Input<framework::Tensor>("X");
+    auto ys = ctx.MultiInput<framework::Tensor>("Y");
+    auto* out = ctx.Output<framework::Tensor>("Out");
+    auto functors = ctx.Attr<std::vector<std::string>>("functor_list");
+    auto axes = ctx.Attr<std::vector<int>>("axis_list");
+
+    std::vector<ChainOperand<T>> operands;
+    for (size_t i = 0; i < ys.size(); ++i) {
+      operands.emplace_back(*x, *ys[i], i < axes.size() ? axes[i] : -1);
+    }
+
+    const T* x_data = x->data<T>();
+    T* out_data = out->mutable_data<T>(ctx.GetPlace());
+    int64_t numel = x->numel();
+    T buf[kElementwiseChainBlock];
+    for (int64_t begin = 0; begin < numel; begin += kElementwiseChainBlock) {
+      int64_t size = std::min(kElementwiseChainBlock, numel - begin);
+      std::copy(x_data + begin, x_data + begin + size, buf);
+      size_t operand = 0;
+      for (auto& functor : functors) {
+        if (math::IsFusableElementwise(functor)) {
+          ApplyBinary(functor, operands[operand++], begin, buf, size);
+        } else {
+          math::ActivateInPlace(functor, buf, size);
+        }
+      }
+      std::copy(buf, buf + size, out_data + begin);
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,119 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/fused_fc_op.h"
+#include <vector>
+
+namespace paddle {
+namespace operators {
+
+class FusedFCOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("Input"),
+                   "Input(Input) of FusedFCOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasInput("W"),
+                   "Input(W) of FusedFCOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("Out"),
+                   "Output(Out) of FusedFCOp should not be null.");
+
+    auto in_dims = ctx->GetInputDim("Input");
+    auto w_dims = ctx->GetInputDim("W");
+    int in_num_col_dims = ctx->Attrs().Get<int>("in_num_col_dims");
+    PADDLE_ENFORCE_GT(in_dims.size(), in_num_col_dims,
+                      "The rank of Input(Input) should be larger than "
+                      "in_num_col_dims.");
+    PADDLE_ENFORCE_EQ(w_dims.size(), 2, "Input(W) should be a matrix.");
+    auto in_mat_dims = framework::flatten_to_2d(in_dims, in_num_col_dims);
+    PADDLE_ENFORCE_EQ(in_mat_dims[1], w_dims[0],
+                      "The width of Input(Input) should be equal to the "
+                      "height of Input(W).");
+    if (ctx->HasInput("Bias")) {
+      auto bias_dims = ctx->GetInputDim("Bias");
+      PADDLE_ENFORCE_EQ(framework::product(bias_dims), w_dims[1],
+                        "The size of Input(Bias) should be equal to the "
+                        "width of Input(W).");
+    }
+
+    std::vector<int64_t> output_dims;
+    for (int i = 0; i < in_num_col_dims; ++i) {
+      output_dims.push_back(in_dims[i]);
+    }
+    output_dims.push_back(w_dims[1]);
+    ctx->SetOutputDim("Out", framework::make_ddim(output_dims));
+    ctx->ShareLoD("Input", /*->*/ "Out");
+  }
+
+ protected:
+  // W may be the FP16 or BF16 weight of the half precision inference, the
+  // kernel is picked by Input.
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        framework::ToDataType(ctx.Input<Tensor>("Input")->type()),
+        ctx.device_context());
+  }
+};
+
+class FusedFCOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  FusedFCOpMaker(OpProto* proto, OpAttrChecker* op_checker)
+      : OpProtoAndCheckerMaker(proto, op_checker) {
+    AddInput("Input", "(Tensor) The input tensor of fused_fc op.");
+    AddInput("W", "(Tensor) The weight matrix of fused_fc op.");
+    AddInput("Bias",
+             "(Tensor, optional) The bias of fused_fc op, its size is the "
+             "width of W.")
+        .AsDispensable();
+    AddOutput("Out", "(Tensor) The output tensor of fused_fc op.");
+    AddAttr<int>("in_num_col_dims",
+                 "(int, default 1) The first in_num_col_dims dims of Input "
+                 "are flattened to the height of the input matrix, as the "
+                 "x_num_col_dims of mul op.")
+        .SetDefault(1)
+        .EqualGreaterThan(1);
+    AddAttr<std::string>("activation_type",
+                         "(string, default identity) The activation applied "
+                         "on the output, one of identity, relu, sigmoid and "
+                         "tanh.")
+        .SetDefault("identity")
+        .InEnum({"identity", "relu", "sigmoid", "tanh"});
+    AddComment(R"DOC(
+FusedFC Operator.
+
+The fully connected layer of the inference programs, fused from mul,
+elementwise_add and an activation op:
+
+$$Out = act(Input * W + Bias)$$
+
+The bias and the activation are applied to each row of the output right after
+the matrix multiplication, so the intermediate tensors of the unfused ops are
+never written. It is created by the fusion passes of the inference library and
+has no gradient.
+
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(fused_fc, ops::FusedFCOp, ops::FusedFCOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    fused_fc, ops::FusedFCKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::FusedFCKernel<paddle::platform::CPUDeviceContext, double>);
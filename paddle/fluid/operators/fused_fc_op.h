@@ -0,0 +1,71 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <string>
+
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/fused_functors.h"
+#include "paddle/fluid/operators/math/half_weight.h"
+#include "paddle/fluid/operators/math/math_function.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+
+template <typename DeviceContext, typename T>
+class FusedFCKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* input = ctx.Input<Tensor>("Input");
+    auto* w = ctx.Input<Tensor>("W");
+    auto* bias = ctx.Input<Tensor>("Bias");
+    auto* out = ctx.Output<Tensor>("Out");
+    int in_num_col_dims = ctx.Attr<int>("in_num_col_dims");
+    std::string activation_type = ctx.Attr<std::string>("activation_type");
+
+    const Tensor x_matrix =
+        input->dims().size() > 2
+            ? framework::ReshapeToMatrix(*input, in_num_col_dims)
+            : *input;
+    int M = x_matrix.dims()[0];
+    int K = x_matrix.dims()[1];
+    int N = w->dims()[1];
+    T* out_data = out->mutable_data<T>(ctx.GetPlace());
+
+    auto& dev_ctx = ctx.template device_context<DeviceContext>();
+    if (!math::HalfWeightMatMul<DeviceContext, T>::WeightRight(
+            dev_ctx, M, N, K, x_matrix.data<T>(), *w, 0, out_data)) {
+      math::gemm<DeviceContext, T>(dev_ctx, CblasNoTrans, CblasNoTrans, M, N,
+                                   K, static_cast<T>(1), x_matrix.data<T>(),
+                                   w->data<T>(), static_cast<T>(0), out_data);
+    }
+
+    // Add the bias and activate a row at a time, while it is in the cache.
+    const T* bias_data = bias == nullptr ? nullptr : bias->data<T>();
+    for (int i = 0; i < M; ++i) {
+      T* row = out_data + i * N;
+      if (bias_data != nullptr) {
+        for (int j = 0; j < N; ++j) {
+          row[j] += bias_data[j];
+        }
+      }
+      math::ActivateInPlace(activation_type, row, N);
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
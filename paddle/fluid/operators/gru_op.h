@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #pragma once
+#include <memory>
 #include <string>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
@@ -96,6 +97,13 @@ class GRUKernel : public framework::OpKernel<T> {
         context.Attr<std::string>("activation"));
     auto active_gate = math::detail::GetActivationType(
         context.Attr<std::string>("gate_activation"));
+    // The recurrent weights are multiplied by the hidden of every time step,
+    // pack them once for all of them.
+    std::unique_ptr<math::GRUPackedWeight<DeviceContext, T>> packed_weight;
+    if (num_batch > 1) {
+      packed_weight.reset(new math::GRUPackedWeight<DeviceContext, T>(
+          dev_ctx, weight_data, frame_size));
+    }
     for (size_t n = 0; n < num_batch; n++) {
       int bstart = static_cast<int>(batch_starts[n]);
       int bend = static_cast<int>(batch_starts[n + 1]);
@@ -109,7 +117,7 @@ class GRUKernel : public framework::OpKernel<T> {
       gru_value.reset_output_value = reset_hidden_prev_t.data<T>();
       math::GRUUnitFunctor<DeviceContext, T>::compute(
           dev_ctx, gru_value, frame_size, cur_batch_size, active_node,
-          active_gate);
+          active_gate, packed_weight.get());
       gru_value.prev_out_value = gru_value.output_value;
     }
 
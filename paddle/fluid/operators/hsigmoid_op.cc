@@ -0,0 +1,220 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/hsigmoid_op.h"
+#include <string>
+
+namespace paddle {
+namespace operators {
+
+class HSigmoidOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("X"), "Input(X) should not be null.");
+    PADDLE_ENFORCE(ctx->HasInput("W"), "Input(W) should not be null.");
+    PADDLE_ENFORCE(ctx->HasInput("Label"), "Input(Label) should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("Out"), "Output(Out) should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("PreOut"),
+                   "Output(PreOut) should not be null.");
+
+    auto x_dims = ctx->GetInputDim("X");
+    auto w_dims = ctx->GetInputDim("W");
+    PADDLE_ENFORCE_EQ(x_dims.size(), 2, "Input(X) should be a 2-D tensor.");
+    PADDLE_ENFORCE_EQ(w_dims.size(), 2, "Input(W) should be a 2-D tensor.");
+    PADDLE_ENFORCE_EQ(x_dims[1], w_dims[1],
+                      "The widths of Input(X) and Input(W) should be equal.");
+
+    int64_t code_length = 0;
+    if (ctx->HasInput("PathTable")) {
+      PADDLE_ENFORCE(ctx->HasInput("PathCode"),
+                     "Input(PathCode) should be set with Input(PathTable).");
+      auto table_dims = ctx->GetInputDim("PathTable");
+      PADDLE_ENFORCE_EQ(table_dims, ctx->GetInputDim("PathCode"),
+                        "PathTable and PathCode should be of the same shape.");
+      PADDLE_ENFORCE_EQ(table_dims[0], x_dims[0]);
+      code_length = table_dims[1];
+    } else {
+      int num_classes = ctx->Attrs().Get<int>("num_classes");
+      PADDLE_ENFORCE_GE(num_classes, 2, "num_classes should be at least 2.");
+      PADDLE_ENFORCE_EQ(w_dims[0], num_classes - 1,
+                        "Input(W) should have num_classes - 1 rows.");
+      code_length = math::MatrixBitCodeFunctor<float>::MaxCodeLength(
+          num_classes);
+    }
+    if (ctx->HasInput("Bias")) {
+      PADDLE_ENFORCE_EQ(framework::product(ctx->GetInputDim("Bias")),
+                        w_dims[0],
+                        "Input(Bias) should have a value per row of W.");
+    }
+
+    ctx->SetOutputDim("Out", {x_dims[0], 1});
+    ctx->SetOutputDim("PreOut", {x_dims[0], code_length});
+    ctx->ShareLoD("X", /*->*/ "Out");
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        framework::ToDataType(ctx.Input<Tensor>("X")->type()),
+        ctx.GetPlace());
+  }
+};
+
+class HSigmoidOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  HSigmoidOpMaker(OpProto* proto, OpAttrChecker* op_checker)
+      : OpProtoAndCheckerMaker(proto, op_checker) {
+    AddInput("X", "(Tensor) The input of shape [batch_size, dim].");
+    AddInput("W",
+             "(Tensor) The weight of shape [num_nodes, dim], a row for each "
+             "non-leaf node of the tree. num_nodes is num_classes - 1 for "
+             "the default complete binary tree.");
+    AddInput("Label",
+             "(Tensor<int64>) The labels of shape [batch_size, 1], in "
+             "[0, num_classes).");
+    AddInput("Bias",
+             "(Tensor) The bias of shape [num_nodes, 1]. It is a dispensable "
+             "input.")
+        .AsDispensable();
+    AddInput("PathTable",
+             "(Tensor<int64>) The custom tree of shape [batch_size, "
+             "max_code_length], the j-th column holds the index of the j-th "
+             "non-leaf node on the path of the label, and the path ends at "
+             "the first negative index. It is a dispensable input, the "
+             "complete binary tree of num_classes leaves is used if it is "
+             "not set.")
+        .AsDispensable();
+    AddInput("PathCode",
+             "(Tensor<int64>) The codes of the custom tree of the same shape "
+             "as PathTable, the j-th column is 1 if the path goes to the "
+             "right child of the j-th node, otherwise 0.")
+        .AsDispensable();
+    AddOutput("Out", "(Tensor) The cost of shape [batch_size, 1].");
+    AddOutput("PreOut",
+              "(Tensor) The clipped pre-activations of the nodes on the "
+              "paths, of shape [batch_size, max_code_length]. It is used "
+              "by the backward kernel.")
+        .AsIntermediate();
+    AddAttr<int>("num_classes", "The number of classes.").SetDefault(2);
+    AddAttr<bool>("is_sparse",
+                  "(boolean, default false) "
+                  "Whether the gradient of W is a SelectedRows which only "
+                  "holds the rows of the nodes on the paths.")
+        .SetDefault(false);
+    AddComment(R"DOC(
+Hierarchical Sigmoid Operator.
+
+The classes are the leaves of a binary tree, and the probability of a
+class is the product of the probabilities of the binary decisions on the
+path from the root to its leaf, each of which is a logistic regression on
+the input with the weight and the bias of the non-leaf node. The cost of a
+sample is
+
+$$
+Out = \sum_j softrelu(PreOut_j) - bit_j * PreOut_j,
+PreOut_j = W_{index_j} X + Bias_{index_j},
+$$
+
+where $index_j$ and $bit_j$ are the index and the code of the j-th node on
+the path. The cost of a sample is O(log(num_classes)) instead of
+O(num_classes) of the softmax.
+
+By default the tree is the complete binary tree of num_classes leaves, a
+custom tree (e.g. a Huffman tree of the class frequencies) is given by the
+inputs PathTable and PathCode.
+)DOC");
+  }
+};
+
+class HSigmoidGradOpDescMaker
+    : public framework::DefaultGradOpDescMaker<true> {
+  using ::paddle::framework::DefaultGradOpDescMaker<
+      true>::DefaultGradOpDescMaker;
+
+ protected:
+  virtual std::string GradOpType() const { return "hsigmoid_grad"; }
+};
+
+class HSigmoidGradOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("X"), "Input(X) should not be null.");
+    PADDLE_ENFORCE(ctx->HasInput("W"), "Input(W) should not be null.");
+    PADDLE_ENFORCE(ctx->HasInput("Label"), "Input(Label) should not be null.");
+    PADDLE_ENFORCE(ctx->HasInput("PreOut"),
+                   "Input(PreOut) should not be null.");
+    PADDLE_ENFORCE(ctx->HasInput(framework::GradVarName("Out")),
+                   "Input(Out@GRAD) should not be null.");
+
+    auto x_grad_name = framework::GradVarName("X");
+    if (ctx->HasOutput(x_grad_name)) {
+      ctx->SetOutputDim(x_grad_name, ctx->GetInputDim("X"));
+    }
+    auto w_grad_name = framework::GradVarName("W");
+    if (ctx->HasOutput(w_grad_name)) {
+      ctx->SetOutputDim(w_grad_name, ctx->GetInputDim("W"));
+    }
+    auto bias_grad_name = framework::GradVarName("Bias");
+    if (ctx->HasOutput(bias_grad_name)) {
+      ctx->SetOutputDim(bias_grad_name, ctx->GetInputDim("Bias"));
+    }
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        framework::ToDataType(ctx.Input<Tensor>("X")->type()),
+        ctx.GetPlace());
+  }
+};
+
+class HSigmoidGradOpVarTypeInference : public framework::VarTypeInference {
+ public:
+  void operator()(const framework::OpDesc& op_desc,
+                  framework::BlockDesc* block) const override {
+    auto w_grad = op_desc.Output(framework::GradVarName("W"));
+    if (w_grad.empty()) return;
+    bool is_sparse = boost::get<bool>(op_desc.GetAttr("is_sparse"));
+    if (is_sparse) {
+      VLOG(3) << "hsigmoid_grad op " << framework::GradVarName("W")
+              << " is set to SelectedRows";
+      block->Var(w_grad.front())
+          ->SetType(framework::proto::VarType::SELECTED_ROWS);
+    } else {
+      VLOG(3) << "hsigmoid_grad op " << framework::GradVarName("W")
+              << " is set to LoDTensor";
+      block->Var(w_grad.front())
+          ->SetType(framework::proto::VarType::LOD_TENSOR);
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(hsigmoid, ops::HSigmoidOp, ops::HSigmoidGradOpDescMaker,
+                  ops::HSigmoidOpMaker);
+REGISTER_OPERATOR(hsigmoid_grad, ops::HSigmoidGradOp,
+                  ops::HSigmoidGradOpVarTypeInference);
+REGISTER_OP_CPU_KERNEL(hsigmoid, ops::HSigmoidKernel<float>,
+                       ops::HSigmoidKernel<double>);
+REGISTER_OP_CPU_KERNEL(hsigmoid_grad, ops::HSigmoidGradKernel<float>,
+                       ops::HSigmoidGradKernel<double>);
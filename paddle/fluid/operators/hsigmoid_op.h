@@ -0,0 +1,162 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/operators/math/matrix_bit_code.h"
+
+namespace paddle {
+namespace operators {
+
+using framework::Tensor;
+
+// The pre-activations are clipped to this range as the legacy
+// HierarchicalSigmoidLayer does, so that softrelu does not overflow.
+static constexpr double kHSigmoidClip = 40.0;
+
+template <typename T>
+std::unique_ptr<math::MatrixBitCodeFunctor<T>> CreateBitCode(
+    const framework::ExecutionContext& ctx) {
+  auto* path_table = ctx.Input<Tensor>("PathTable");
+  if (path_table != nullptr) {
+    auto* path_code = ctx.Input<Tensor>("PathCode");
+    PADDLE_ENFORCE_NOT_NULL(path_code,
+                            "PathCode should be set with PathTable");
+    return std::unique_ptr<math::MatrixBitCodeFunctor<T>>(
+        new math::MatrixBitCodeFunctor<T>(*path_table, *path_code));
+  }
+  return std::unique_ptr<math::MatrixBitCodeFunctor<T>>(
+      new math::MatrixBitCodeFunctor<T>(*ctx.Input<Tensor>("Label"),
+                                        ctx.Attr<int>("num_classes")));
+}
+
+template <typename T>
+class HSigmoidKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* in = ctx.Input<Tensor>("X");
+    auto* w = ctx.Input<Tensor>("W");
+    auto* bias = ctx.Input<Tensor>("Bias");
+    auto* out = ctx.Output<Tensor>("Out");
+    auto* pre_out = ctx.Output<Tensor>("PreOut");
+
+    auto bit_code = CreateBitCode<T>(ctx);
+    int64_t batch_size = bit_code->size();
+    int width = bit_code->max_code_length();
+    PADDLE_ENFORCE_EQ(batch_size, in->dims()[0]);
+    if (ctx.Input<Tensor>("PathTable") != nullptr) {
+      int64_t num_nodes = w->dims()[0];
+      for (int64_t i = 0; i < batch_size; ++i) {
+        math::Code code = bit_code->GetCode(i);
+        for (int j = 0; j < code.length(); ++j) {
+          PADDLE_ENFORCE_LT(code.index(j), num_nodes,
+                            "The node index in PathTable is out of range");
+        }
+      }
+    }
+
+    T* pre_out_data = pre_out->mutable_data<T>(ctx.GetPlace());
+    std::memset(pre_out_data, 0, sizeof(T) * pre_out->numel());
+    T* out_data = out->mutable_data<T>(ctx.GetPlace());
+
+    if (bias != nullptr) bit_code->Add(*bias, pre_out);
+    bit_code->Mul(pre_out, *w, *in);
+    // out = \sum_j softrelu(pre_out(i, j)) - bit(i, j) * pre_out(i, j)
+    const T clip = static_cast<T>(kHSigmoidClip);
+    for (int64_t i = 0; i < batch_size; ++i) {
+      math::Code code = bit_code->GetCode(i);
+      T* pre = pre_out_data + i * width;
+      T* pre_end = pre + code.length();
+      T softrelu_sum = 0;
+      for (; pre != pre_end; ++pre) {
+        *pre = std::min(std::max(*pre, -clip), clip);
+        softrelu_sum += std::log(static_cast<T>(1) + std::exp(*pre));
+      }
+      out_data[i] = softrelu_sum;
+    }
+    bit_code->Sum(*pre_out, out, static_cast<T>(-1));
+  }
+};
+
+template <typename T>
+class HSigmoidGradKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* in = ctx.Input<Tensor>("X");
+    auto* w = ctx.Input<Tensor>("W");
+    auto* pre_out = ctx.Input<Tensor>("PreOut");
+    auto* out_grad = ctx.Input<Tensor>(framework::GradVarName("Out"));
+    auto* in_grad = ctx.Output<Tensor>(framework::GradVarName("X"));
+    auto* bias_grad = ctx.Output<Tensor>(framework::GradVarName("Bias"));
+
+    auto bit_code = CreateBitCode<T>(ctx);
+    int64_t batch_size = bit_code->size();
+    int width = bit_code->max_code_length();
+
+    // pre_out_grad(i, j) = (sigmoid(pre_out(i, j)) - bit(i, j)) * out_grad(i)
+    Tensor pre_out_grad;
+    T* grad = pre_out_grad.mutable_data<T>(pre_out->dims(), ctx.GetPlace());
+    std::memset(grad, 0, sizeof(T) * pre_out_grad.numel());
+    const T* pre = pre_out->data<T>();
+    for (int64_t i = 0; i < batch_size; ++i) {
+      int length = bit_code->GetCode(i).length();
+      for (int j = 0; j < length; ++j) {
+        grad[i * width + j] =
+            static_cast<T>(1) /
+            (static_cast<T>(1) + std::exp(-pre[i * width + j]));
+      }
+    }
+    bit_code->Sub(&pre_out_grad);
+    const T* out_grad_data = out_grad->data<T>();
+    for (int64_t i = 0; i < batch_size; ++i) {
+      for (int j = 0; j < width; ++j) grad[i * width + j] *= out_grad_data[i];
+    }
+
+    if (bias_grad != nullptr) {
+      T* data = bias_grad->mutable_data<T>(ctx.GetPlace());
+      std::memset(data, 0, sizeof(T) * bias_grad->numel());
+      bit_code->AddGrad(pre_out_grad, bias_grad);
+    }
+
+    auto* w_grad_var = ctx.OutputVar(framework::GradVarName("W"));
+    if (w_grad_var != nullptr) {
+      if (ctx.Attr<bool>("is_sparse")) {
+        auto* w_grad = ctx.Output<framework::SelectedRows>(
+            framework::GradVarName("W"));
+        w_grad->set_height(w->dims()[0]);
+        bit_code->MulGradWeight(pre_out_grad, w_grad, *in);
+      } else {
+        auto* w_grad = ctx.Output<Tensor>(framework::GradVarName("W"));
+        T* data = w_grad->mutable_data<T>(ctx.GetPlace());
+        std::memset(data, 0, sizeof(T) * w_grad->numel());
+        bit_code->MulGradWeight(pre_out_grad, w_grad, *in);
+      }
+    }
+
+    if (in_grad != nullptr) {
+      T* data = in_grad->mutable_data<T>(ctx.GetPlace());
+      std::memset(data, 0, sizeof(T) * in_grad->numel());
+      bit_code->MulGradError(pre_out_grad, *w, in_grad);
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
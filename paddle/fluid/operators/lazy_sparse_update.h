@@ -0,0 +1,118 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/framework/threadpool.h"
+#include "paddle/fluid/operators/math/selected_rows_functor.h"
+
+namespace paddle {
+namespace operators {
+
+// The lazy mode of the sparse optimizers: only the rows in the merged
+// gradient are updated, so the cost of a step is proportional to the
+// number of unique ids in the batch instead of the height of the table.
+//
+// The moments of the rows which are not in the gradient should decay on
+// every step, the optional RowStep tensor records the step on which every
+// row was last updated, so the decay of the skipped steps is applied when
+// the row is touched again. RowStep is an int64 tensor of shape
+// [height + 1], the last element counts the steps of the optimizer.
+
+// Elements per task of ParallelForRows.
+constexpr int64_t kLazyUpdateGrainSize = 1 << 16;
+
+// Call func(i) for every i in [0, num_rows) on the threads of the
+// framework thread pool, row_numel is the number of elements per row. The
+// rows must be unique.
+template <typename Func>
+void ParallelForRows(int64_t num_rows, int64_t row_numel, Func func) {
+  int64_t rows_per_chunk = std::max<int64_t>(
+      1, kLazyUpdateGrainSize / std::max<int64_t>(1, row_numel));
+  framework::ParallelFor(num_rows, rows_per_chunk,
+                         [&func](int64_t begin, int64_t end) {
+                           for (int64_t i = begin; i < end; ++i) func(i);
+                         });
+}
+
+// Merge the duplicated rows of a sparse gradient, the rows are then
+// unique and can be updated in parallel.
+template <typename T>
+framework::SelectedRows MergeSparseGrad(
+    const platform::CPUDeviceContext& context,
+    const framework::SelectedRows& grad) {
+  math::scatter::MergeAdd<platform::CPUDeviceContext, T> merge_func;
+  return merge_func(context, grad);
+}
+
+// r + r^2 + ... + r^k, the total weight of a value decayed by r on each of
+// k steps.
+template <typename T>
+inline T GeometricSum(T r, int64_t k) {
+  if (k <= 0) return static_cast<T>(0);
+  if (r == static_cast<T>(1)) return static_cast<T>(k);
+  return r * (static_cast<T>(1) - std::pow(r, static_cast<T>(k))) /
+         (static_cast<T>(1) - r);
+}
+
+// Reads and updates the RowStep tensor of a lazy optimizer step.
+class RowStep {
+ public:
+  // row_step is nullptr if the optimizer does not record the steps, no
+  // decay is caught up then.
+  RowStep(framework::Tensor* row_step, int64_t height)
+      : data_(nullptr), step_(0) {
+    if (row_step == nullptr) return;
+    PADDLE_ENFORCE_EQ(row_step->numel(), height + 1,
+                      "RowStep should be of shape [height + 1]");
+    data_ = row_step->data<int64_t>();
+    step_ = ++data_[height];
+  }
+
+  // The step of this update, counted from 1, 0 if the steps are not
+  // recorded.
+  int64_t Step() const { return step_; }
+
+  // The number of the steps row was skipped since it was last updated,
+  // and mark it as updated on this step. Rows should be unique.
+  int64_t Touch(int64_t row) const {
+    if (data_ == nullptr) return 0;
+    int64_t skipped = step_ - 1 - data_[row];
+    data_[row] = step_;
+    return skipped;
+  }
+
+ private:
+  int64_t* data_;
+  int64_t step_;
+};
+
+// The RowStep tensor of a lazy optimizer op, nullptr if it is not set.
+inline framework::Tensor* GetRowStep(const framework::ExecutionContext& ctx) {
+  auto* row_step = ctx.Input<framework::Tensor>("RowStep");
+  if (row_step == nullptr) return nullptr;
+  auto* row_step_out = ctx.Output<framework::Tensor>("RowStepOut");
+  PADDLE_ENFORCE_EQ(row_step, row_step_out,
+                    "RowStep should be updated in place");
+  return row_step_out;
+}
+
+}  // namespace operators
+}  // namespace paddle
@@ -17,6 +17,7 @@ limitations under the License. */
 #include <vector>
 
 #include "paddle/fluid/operators/listen_and_serv_op.h"
+#include "paddle/fluid/string/printf.h"
 
 namespace paddle {
 namespace operators {
@@ -111,6 +112,14 @@ void ListenAndServOp::RunImpl(const framework::Scope &scope,
 
   rpc_service_->SetScope(&recv_scope);
   rpc_service_->SetDevCtx(&dev_ctx);
+  // the gradients of all the trainers are added to the merged gradient
+  // while they are received.
+  for (auto &sum_name : Attr<std::vector<std::string>>("sum_grads")) {
+    for (int i = 0; i < fan_in; ++i) {
+      rpc_service_->AddReceivedSum(
+          string::Sprintf("%s.trainer_%d", sum_name, i), sum_name);
+    }
+  }
   // TODO(qiao) set proper fields for table lookup and update
   rpc_service_->SetExecutor(&executor);
   VLOG(3) << "prefetch block id is " << prefetch_block->ID();
@@ -197,6 +206,7 @@ void ListenAndServOp::RunImpl(const framework::Scope &scope,
     for (auto &var : sparse_vars) {
       var->GetMutable<framework::SelectedRows>()->mutable_rows()->clear();
     }
+    rpc_service_->ResetReceivedSums();
     rpc_service_->SetCond(1);
     // FIXME(typhoonzero): use another condition to sync wait clients get.
     rpc_service_->WaitClientGet(fan_in);
@@ -226,6 +236,13 @@ from send_op and send back variables to recv_op.
                                     "prefetch block to run on server side.");
     AddAttr<int>("Fanin", "How many clients send to this server.")
         .SetDefault(1);
+    AddAttr<std::vector<std::string>>(
+        "sum_grads",
+        "(string vector, default empty)"
+        "Dense FP32 gradients whose copies from the trainers, named "
+        "'<grad>.trainer_<id>', are summed into <grad> while received, "
+        "instead of by a sum operator.")
+        .SetDefault({});
   }
 };
 
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 #include <fstream>
 
+#include "paddle/fluid/framework/mapped_tensor_file.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/platform/device_context.h"
 
@@ -44,6 +45,12 @@ class LoadCombineOp : public framework::OperatorBase {
     platform::DeviceContextPool &pool = platform::DeviceContextPool::Instance();
     auto &dev_ctx = *pool.Get(place);
 
+    if (framework::IsMappedTensorFile(filename)) {
+      fin.close();
+      LoadMapped(scope, place, dev_ctx, filename, out_var_names);
+      return;
+    }
+
     for (size_t i = 0; i < out_var_names.size(); i++) {
       auto *out_var = scope.FindVar(out_var_names[i]);
 
@@ -73,6 +80,24 @@ class LoadCombineOp : public framework::OperatorBase {
       }
     }
   }
+
+  void LoadMapped(const framework::Scope &scope, const platform::Place &place,
+                  const platform::DeviceContext &dev_ctx,
+                  const std::string &filename,
+                  const std::vector<std::string> &out_var_names) const {
+    bool share = Attr<bool>("use_mmap") && platform::is_cpu_place(place);
+    framework::MappedTensorReader reader(filename);
+    PADDLE_ENFORCE_EQ(reader.size(), out_var_names.size(),
+                      "%s holds %d tensors, but %d outputs are given",
+                      filename, reader.size(), out_var_names.size());
+    for (auto &name : out_var_names) {
+      auto *out_var = scope.FindVar(name);
+      PADDLE_ENFORCE(out_var != nullptr, "Output variable %s cannot be found",
+                     name);
+      reader.Next(out_var->GetMutable<framework::LoDTensor>(), share, place,
+                  dev_ctx);
+    }
+  }
 };
 
 class LoadCombineOpProtoMaker : public framework::OpProtoAndCheckerMaker {
@@ -88,6 +113,12 @@ class LoadCombineOpProtoMaker : public framework::OpProtoAndCheckerMaker {
                          "LoDTensors will be loaded from \"file_path\".")
         .AddCustomChecker(
             [](const std::string &path) { return !path.empty(); });
+    AddAttr<bool>("use_mmap",
+                  "(boolean, default false) "
+                  "If the file is saved with aligned = true and the place is "
+                  "CPU, the LoDTensors alias the pages of the mapped file "
+                  "instead of being copied.")
+        .SetDefault(false);
     AddComment(R"DOC(
 LoadCombine Operator.
 
@@ -99,6 +130,11 @@ in the SaveCombine operator. Hence, the LoadCombine operator is tightly coupled
 with the SaveCombine operator, and can only deserialize one or more LoDTensors 
 that were saved using the SaveCombine operator.
 
+The files saved with the attribute aligned of SaveCombine are mapped instead
+of read. With use_mmap, the loaded LoDTensors then share the pages of the file
+with all the processes which load it, so loading is O(1) in the size of the
+model, and the pages are copied only if the LoDTensors are written.
+
 )DOC");
   }
 };
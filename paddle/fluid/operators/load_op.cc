@@ -37,6 +37,10 @@ class LoadOp : public framework::OperatorBase {
     std::ifstream fin(filename);
     PADDLE_ENFORCE(static_cast<bool>(fin), "Cannot open file %s for load op",
                    filename);
+    auto offset = Attr<int64_t>("offset");
+    if (offset > 0) {
+      fin.seekg(static_cast<std::streamoff>(offset));
+    }
 
     auto out_var_name = Output("Out");
     auto *out_var = scope.FindVar(out_var_name);
@@ -72,6 +76,11 @@ class LoadOpProtoMaker : public framework::OpProtoAndCheckerMaker {
                          "Variable will be loaded from \"file_path\".")
         .AddCustomChecker(
             [](const std::string &path) { return !path.empty(); });
+    AddAttr<int64_t>("offset",
+                     "(int64_t, default 0) "
+                     "The offset in bytes of the tensor in \"file_path\", "
+                     "to load one tensor of a file saved by save_combine.")
+        .SetDefault(0);
     AddComment(R"DOC(
 Load Operator.
 
@@ -52,6 +52,13 @@ class LookupTableOp : public framework::OperatorWithKernel {
   framework::OpKernelType GetExpectedKernelType(
       const framework::ExecutionContext& ctx) const override {
     auto data_type = framework::GetDataTypeOfVar(ctx.InputVar("W"));
+    // The FP16 or BF16 table of the half precision CPU inference is widened
+    // by the float kernel.
+    if (platform::is_cpu_place(ctx.GetPlace()) &&
+        (data_type == framework::proto::VarType::FP16 ||
+         data_type == framework::proto::VarType::BF16)) {
+      data_type = framework::proto::VarType::FP32;
+    }
     return framework::OpKernelType(data_type, ctx.device_context());
   }
 };
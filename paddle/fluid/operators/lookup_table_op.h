@@ -21,6 +21,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/operators/math/half_weight.h"
 
 namespace paddle {
 namespace operators {
@@ -32,6 +33,31 @@ using DDim = framework::DDim;
 
 constexpr int64_t kNoPadding = -1;
 
+// Look up the rows of the FP16 or BF16 table of the half precision
+// inference, which are widened to float.
+inline void LookupHalfRows(const Tensor &table, const int64_t *ids,
+                           int64_t ids_numel, int64_t padding_idx,
+                           float *output) {
+  int64_t row_number = table.dims()[0];
+  int64_t row_width = table.dims()[1];
+  for (int64_t i = 0; i < ids_numel; ++i) {
+    if (padding_idx != kNoPadding && ids[i] == padding_idx) {
+      memset(output + i * row_width, 0, row_width * sizeof(float));
+    } else {
+      PADDLE_ENFORCE_LT(ids[i], row_number);
+      PADDLE_ENFORCE_GE(ids[i], 0);
+      math::WidenToFloat(table, ids[i] * row_width, row_width,
+                         output + i * row_width);
+    }
+  }
+}
+
+template <typename T>
+void LookupHalfRows(const Tensor &table, const int64_t *ids,
+                    int64_t ids_numel, int64_t padding_idx, T *output) {
+  PADDLE_THROW("The FP16 or BF16 table is only supported by the float kernel");
+}
+
 template <typename T>
 class LookupTableKernel : public framework::OpKernel<T> {
  public:
@@ -79,8 +105,12 @@ class LookupTableKernel : public framework::OpKernel<T> {
       int64_t row_number = table_t->dims()[0];
       int64_t row_width = table_t->dims()[1];
 
-      auto *table = table_t->data<T>();
       auto *output = output_t->mutable_data<T>(context.GetPlace());
+      if (math::IsHalfTensor(*table_t)) {
+        LookupHalfRows(*table_t, ids, ids_numel, padding_idx, output);
+        return;
+      }
+      auto *table = table_t->data<T>();
 
       for (int64_t i = 0; i < ids_numel; ++i) {
         if (padding_idx != kNoPadding && ids[i] == padding_idx) {
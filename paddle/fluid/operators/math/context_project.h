@@ -16,6 +16,7 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/operators/math/im2col.h"
+#include "paddle/fluid/operators/math/lod_schedule.h"
 #include "paddle/fluid/operators/math/math_function.h"
 
 namespace paddle {
@@ -97,20 +98,20 @@ class ContextProjectFunctor {
     std::vector<int> padding({up_pad, 0, down_pad, 0});
     std::vector<int> stride({context_stride, 1});
 
-    int input_row_begin, input_row_end;
-    int sequence_height, sequence_width;
-    sequence_width = in.dims()[1];
+    int sequence_width = in.dims()[1];
 
-    for (int i = 0; i < static_cast<int>(lod_level_0.size()) - 1; ++i) {
-      input_row_begin = (context_start > 0)
-                            ? static_cast<int>(lod_level_0[i]) + context_start
-                            : static_cast<int>(lod_level_0[i]);
-      input_row_end = static_cast<int>(lod_level_0[i + 1]);
+    // The sequences write their own rows of col.
+    const size_t* offsets = lod_level_0.data();
+    auto project = [&](size_t i) {
+      int input_row_begin = (context_start > 0)
+                                ? static_cast<int>(offsets[i]) + context_start
+                                : static_cast<int>(offsets[i]);
+      int input_row_end = static_cast<int>(offsets[i + 1]);
 
-      Tensor out_t = col->Slice(static_cast<int>(lod_level_0[i]),
-                                static_cast<int>(lod_level_0[i + 1]));
+      Tensor out_t = col->Slice(static_cast<int>(offsets[i]),
+                                static_cast<int>(offsets[i + 1]));
 
-      sequence_height = static_cast<int>(out_t.dims()[0]);
+      int sequence_height = static_cast<int>(out_t.dims()[0]);
 
       if (input_row_begin < input_row_end) {
         Tensor in_t = in.Slice(input_row_begin, input_row_end);
@@ -128,13 +129,15 @@ class ContextProjectFunctor {
         im2col_ocf(context, in_t, dilation, stride, padding, &out_t);
         out_t.Resize({sequence_height, context_length * sequence_width});
       }
-    }
+    };
+    ForEachSequence<DeviceContext>::Run(
+        lod_level_0, context_length * sequence_width, project);
     if (padding_trainable) {
       for (int i = 0; i < static_cast<int>(lod_level_0.size()) - 1; ++i) {
         Tensor out_t = col->Slice(static_cast<int>(lod_level_0[i]),
                                   static_cast<int>(lod_level_0[i + 1]));
 
-        sequence_height = static_cast<int>(out_t.dims()[0]);
+        int sequence_height = static_cast<int>(out_t.dims()[0]);
 
         // add up trainable data
         out_t.Resize({sequence_height * context_length, sequence_width});
@@ -206,21 +209,21 @@ class ContextProjectGradFunctor {
     std::vector<int> padding({up_pad, 0, down_pad, 0});
     std::vector<int> stride({context_stride, 1});
 
-    int input_row_begin, input_row_end;
-    int sequence_height, sequence_width;
-    sequence_width = in.dims()[1];
+    int sequence_width = in.dims()[1];
 
     if (input_grad) {
-      for (int i = 0; i < static_cast<int>(lod_level_0.size()) - 1; ++i) {
-        input_row_begin = (context_start > 0)
-                              ? static_cast<int>(lod_level_0[i]) + context_start
-                              : static_cast<int>(lod_level_0[i]);
-        input_row_end = static_cast<int>(lod_level_0[i + 1]);
+      // The sequences accumulate to their own rows of in.
+      const size_t* offsets = lod_level_0.data();
+      auto project_grad = [&](size_t i) {
+        int input_row_begin = (context_start > 0)
+                                  ? static_cast<int>(offsets[i]) + context_start
+                                  : static_cast<int>(offsets[i]);
+        int input_row_end = static_cast<int>(offsets[i + 1]);
 
-        Tensor out_t = col->Slice(static_cast<int>(lod_level_0[i]),
-                                  static_cast<int>(lod_level_0[i + 1]));
+        Tensor out_t = col->Slice(static_cast<int>(offsets[i]),
+                                  static_cast<int>(offsets[i + 1]));
 
-        sequence_height = static_cast<int>(out_t.dims()[0]);
+        int sequence_height = static_cast<int>(out_t.dims()[0]);
 
         if (input_row_begin < input_row_end) {
           Tensor in_t = in.Slice(input_row_begin, input_row_end);
@@ -239,7 +242,9 @@ class ContextProjectGradFunctor {
           col2im_ocf(context, out_t, dilation, stride, padding, &in_t);
           out_t.Resize({sequence_height, context_length * sequence_width});
         }
-      }
+      };
+      ForEachSequence<DeviceContext>::Run(
+          lod_level_0, context_length * sequence_width, project_grad);
     }
     if (pad_grad) {
       if (padding_trainable) {
@@ -247,7 +252,7 @@ class ContextProjectGradFunctor {
           Tensor out_t = col->Slice(static_cast<int>(lod_level_0[i]),
                                     static_cast<int>(lod_level_0[i + 1]));
 
-          sequence_height = static_cast<int>(out_t.dims()[0]);
+          int sequence_height = static_cast<int>(out_t.dims()[0]);
           out_t.Resize({sequence_height * context_length, sequence_width});
 
           if (up_pad > 0) {
@@ -0,0 +1,238 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/cpu_conv.h"
+#include <algorithm>
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/operators/math/math_function.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The floats of the col buffer of the tiled im2col, 1MB.
+constexpr int64_t kConvColBlockSize = 1 << 18;
+// The 2x2 output tiles of a Winograd block, the GEMMs are of this width.
+constexpr int kWinogradTileBlock = 64;
+// The transforms of Winograd do not pay off with fewer channels.
+constexpr int kWinogradMinChannels = 16;
+
+Conv2DAlgo SelectConv2DAlgo(const Conv2DShape& shape) {
+  bool stride_1 = shape.stride_h == 1 && shape.stride_w == 1;
+  bool dilation_1 = shape.dilation_h == 1 && shape.dilation_w == 1;
+  if (shape.k_h == 1 && shape.k_w == 1 && stride_1 && dilation_1 &&
+      shape.pad_h == 0 && shape.pad_w == 0) {
+    return Conv2DAlgo::kGemm1x1;
+  }
+  if (shape.k_h == 3 && shape.k_w == 3 && stride_1 && dilation_1 &&
+      shape.in_c >= kWinogradMinChannels &&
+      shape.out_c >= kWinogradMinChannels) {
+    return Conv2DAlgo::kWinograd3x3;
+  }
+  int64_t col_size = static_cast<int64_t>(shape.in_c) * shape.k_h *
+                     shape.k_w * shape.out_h * shape.out_w;
+  return col_size > kConvColBlockSize ? Conv2DAlgo::kTiledIm2Col
+                                      : Conv2DAlgo::kIm2Col;
+}
+
+int64_t WinogradFilterSize(const Conv2DShape& shape) {
+  return 16 * static_cast<int64_t>(shape.out_c) * shape.in_c;
+}
+
+// F(2x2, 3x3), see "Fast Algorithms for Convolutional Neural Networks",
+// Lavin and Gray:
+//
+//   B^T = [1  0 -1  0]   G = [  1    0    0]   A^T = [1  1  1  0]
+//         [0  1  1  0]       [1/2  1/2  1/2]         [0  1 -1 -1]
+//         [0 -1  1  0]       [1/2 -1/2  1/2]
+//         [0  1  0 -1]       [  0    0    1]
+//
+// Y = A^T [(G g G^T) .* (B^T d B)] A of every 4x4 input tile d with the
+// stride of 2, the element-wise products summed over the input channels
+// are 16 GEMMs.
+void WinogradTransformFilter(const Conv2DShape& shape, const float* filter,
+                             float* u) {
+  PADDLE_ENFORCE(shape.k_h == 3 && shape.k_w == 3,
+                 "Winograd F(2x2, 3x3) needs a 3x3 filter");
+  const int64_t u_stride = static_cast<int64_t>(shape.out_c) * shape.in_c;
+  for (int o = 0; o < shape.out_c; ++o) {
+    for (int c = 0; c < shape.in_c; ++c) {
+      const float* g = filter + (static_cast<int64_t>(o) * shape.in_c + c) * 9;
+      // G g
+      float t[4][3];
+      for (int j = 0; j < 3; ++j) {
+        t[0][j] = g[j];
+        t[1][j] = 0.5f * (g[j] + g[3 + j] + g[6 + j]);
+        t[2][j] = 0.5f * (g[j] - g[3 + j] + g[6 + j]);
+        t[3][j] = g[6 + j];
+      }
+      // (G g) G^T
+      float* dst = u + static_cast<int64_t>(o) * shape.in_c + c;
+      for (int i = 0; i < 4; ++i) {
+        dst[(i * 4 + 0) * u_stride] = t[i][0];
+        dst[(i * 4 + 1) * u_stride] = 0.5f * (t[i][0] + t[i][1] + t[i][2]);
+        dst[(i * 4 + 2) * u_stride] = 0.5f * (t[i][0] - t[i][1] + t[i][2]);
+        dst[(i * 4 + 3) * u_stride] = t[i][2];
+      }
+    }
+  }
+}
+
+void WinogradConv3x3(const platform::CPUDeviceContext& context,
+                     const Conv2DShape& shape, const float* input,
+                     const float* u, float* output) {
+  PADDLE_ENFORCE(shape.k_h == 3 && shape.k_w == 3 && shape.stride_h == 1 &&
+                     shape.stride_w == 1 && shape.dilation_h == 1 &&
+                     shape.dilation_w == 1,
+                 "Winograd F(2x2, 3x3) needs a 3x3 stride 1 convolution");
+  const int tiles_h = (shape.out_h + 1) / 2;
+  const int tiles_w = (shape.out_w + 1) / 2;
+  const int num_tiles = tiles_h * tiles_w;
+  const int block = std::min(kWinogradTileBlock, num_tiles);
+
+  // V = B^T d B of the tiles of a block, [16, in_c, tiles], and M = U V,
+  // [16, out_c, tiles].
+  framework::Tensor v_buffer, m_buffer;
+  float* v = v_buffer.mutable_data<float>({16, shape.in_c, block},
+                                          platform::CPUPlace());
+  float* m = m_buffer.mutable_data<float>({16, shape.out_c, block},
+                                          platform::CPUPlace());
+
+  for (int t0 = 0; t0 < num_tiles; t0 += block) {
+    const int nb = std::min(block, num_tiles - t0);
+    const int64_t v_stride = static_cast<int64_t>(shape.in_c) * nb;
+    for (int c = 0; c < shape.in_c; ++c) {
+      const float* in = input + static_cast<int64_t>(c) * shape.in_h *
+                                    shape.in_w;
+      for (int b = 0; b < nb; ++b) {
+        const int y0 = (t0 + b) / tiles_w * 2 - shape.pad_h;
+        const int x0 = (t0 + b) % tiles_w * 2 - shape.pad_w;
+        float d[4][4];
+        for (int i = 0; i < 4; ++i) {
+          int y = y0 + i;
+          for (int j = 0; j < 4; ++j) {
+            int x = x0 + j;
+            d[i][j] = (y >= 0 && y < shape.in_h && x >= 0 && x < shape.in_w)
+                          ? in[y * shape.in_w + x]
+                          : 0.f;
+          }
+        }
+        // B^T d
+        float t[4][4];
+        for (int j = 0; j < 4; ++j) {
+          t[0][j] = d[0][j] - d[2][j];
+          t[1][j] = d[1][j] + d[2][j];
+          t[2][j] = d[2][j] - d[1][j];
+          t[3][j] = d[1][j] - d[3][j];
+        }
+        // (B^T d) B
+        float* dst = v + static_cast<int64_t>(c) * nb + b;
+        for (int i = 0; i < 4; ++i) {
+          dst[(i * 4 + 0) * v_stride] = t[i][0] - t[i][2];
+          dst[(i * 4 + 1) * v_stride] = t[i][1] + t[i][2];
+          dst[(i * 4 + 2) * v_stride] = t[i][2] - t[i][1];
+          dst[(i * 4 + 3) * v_stride] = t[i][1] - t[i][3];
+        }
+      }
+    }
+
+    batched_gemm<platform::CPUDeviceContext, float>(
+        context, CblasNoTrans, CblasNoTrans, shape.out_c, nb, shape.in_c, 1.f,
+        u, v, 0.f, m, 16, shape.out_c * shape.in_c, shape.in_c * nb);
+
+    const int64_t m_stride = static_cast<int64_t>(shape.out_c) * nb;
+    for (int o = 0; o < shape.out_c; ++o) {
+      float* out = output + static_cast<int64_t>(o) * shape.out_h *
+                                shape.out_w;
+      for (int b = 0; b < nb; ++b) {
+        const float* src = m + static_cast<int64_t>(o) * nb + b;
+        // A^T M
+        float t[2][4];
+        for (int j = 0; j < 4; ++j) {
+          float m0 = src[j * m_stride];
+          float m1 = src[(4 + j) * m_stride];
+          float m2 = src[(8 + j) * m_stride];
+          float m3 = src[(12 + j) * m_stride];
+          t[0][j] = m0 + m1 + m2;
+          t[1][j] = m1 - m2 - m3;
+        }
+        // (A^T M) A, the tiles on the bottom and right edges may be cut
+        const int y0 = (t0 + b) / tiles_w * 2;
+        const int x0 = (t0 + b) % tiles_w * 2;
+        for (int i = 0; i < 2 && y0 + i < shape.out_h; ++i) {
+          float* row = out + (y0 + i) * shape.out_w + x0;
+          row[0] = t[i][0] + t[i][1] + t[i][2];
+          if (x0 + 1 < shape.out_w) row[1] = t[i][1] - t[i][2] - t[i][3];
+        }
+      }
+    }
+  }
+}
+
+void TiledIm2ColConv(const platform::CPUDeviceContext& context,
+                     const Conv2DShape& shape, const float* input,
+                     const float* filter, float* output, int rows_per_block) {
+  const int col_height = shape.in_c * shape.k_h * shape.k_w;
+  if (rows_per_block <= 0) {
+    rows_per_block = static_cast<int>(std::max<int64_t>(
+        1, kConvColBlockSize / (static_cast<int64_t>(col_height) *
+                                shape.out_w)));
+  }
+  rows_per_block = std::min(rows_per_block, shape.out_h);
+
+  framework::Tensor col_buffer;
+  float* col = col_buffer.mutable_data<float>(
+      {col_height, rows_per_block * shape.out_w}, platform::CPUPlace());
+
+  for (int r0 = 0; r0 < shape.out_h; r0 += rows_per_block) {
+    const int rows = std::min(rows_per_block, shape.out_h - r0);
+    const int col_width = rows * shape.out_w;
+    // the im2col of the output rows [r0, r0 + rows), of the kCFO format
+    for (int c = 0; c < shape.in_c; ++c) {
+      const float* in = input + static_cast<int64_t>(c) * shape.in_h *
+                                    shape.in_w;
+      for (int i = 0; i < shape.k_h; ++i) {
+        for (int j = 0; j < shape.k_w; ++j) {
+          float* dst =
+              col + static_cast<int64_t>((c * shape.k_h + i) * shape.k_w + j) *
+                        col_width;
+          for (int r = 0; r < rows; ++r) {
+            int y = (r0 + r) * shape.stride_h - shape.pad_h +
+                    i * shape.dilation_h;
+            float* dst_row = dst + r * shape.out_w;
+            if (y < 0 || y >= shape.in_h) {
+              std::fill(dst_row, dst_row + shape.out_w, 0.f);
+              continue;
+            }
+            const float* in_row = in + y * shape.in_w;
+            for (int x_out = 0; x_out < shape.out_w; ++x_out) {
+              int x = x_out * shape.stride_w - shape.pad_w +
+                      j * shape.dilation_w;
+              dst_row[x_out] = (x >= 0 && x < shape.in_w) ? in_row[x] : 0.f;
+            }
+          }
+        }
+      }
+    }
+
+    gemm<platform::CPUDeviceContext, float>(
+        context, false, false, shape.out_c, col_width, col_height, 1.f,
+        filter, col_height, col, col_width, 0.f, output + r0 * shape.out_w,
+        shape.out_h * shape.out_w);
+  }
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,78 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The shape of a 2-D convolution of one image and one group: input
+// [in_c, in_h, in_w], filter [out_c, in_c, k_h, k_w] and output
+// [out_c, out_h, out_w], all in NCHW.
+struct Conv2DShape {
+  int in_c, in_h, in_w;
+  int out_c, out_h, out_w;
+  int k_h, k_w;
+  int stride_h, stride_w;
+  int pad_h, pad_w;
+  int dilation_h, dilation_w;
+};
+
+// The CPU algorithms of a float 2-D convolution.
+enum class Conv2DAlgo {
+  // The input of a 1x1, stride 1 and no padding convolution is already
+  // the GEMM operand.
+  kGemm1x1,
+  // Winograd F(2x2, 3x3) of the 3x3 stride 1 convolutions, which does 2.25x
+  // fewer multiplications and transforms the input to a buffer 4 / 9 of the
+  // size of the im2col one.
+  kWinograd3x3,
+  // im2col + gemm on blocks of the output rows, the col buffer of the whole
+  // image is never allocated.
+  kTiledIm2Col,
+  // im2col + gemm of the whole image.
+  kIm2Col,
+};
+
+// Choose the algorithm by the shape.
+Conv2DAlgo SelectConv2DAlgo(const Conv2DShape& shape);
+
+// The number of floats of the filter transformed by Winograd, which is of
+// shape [16, out_c, in_c].
+int64_t WinogradFilterSize(const Conv2DShape& shape);
+
+// Transform the [out_c, in_c, 3, 3] filter, U = G g G^T.
+void WinogradTransformFilter(const Conv2DShape& shape, const float* filter,
+                             float* u);
+
+// The convolution by Winograd F(2x2, 3x3) with the transformed filter u.
+// The 2x2 output tiles are computed in blocks, so the buffers are bounded.
+void WinogradConv3x3(const platform::CPUDeviceContext& context,
+                     const Conv2DShape& shape, const float* input,
+                     const float* u, float* output);
+
+// The convolution by im2col + gemm on blocks of rows_per_block output
+// rows, 0 to choose the rows by the size of the col buffer. rows_per_block
+// of out_h is the plain im2col + gemm.
+void TiledIm2ColConv(const platform::CPUDeviceContext& context,
+                     const Conv2DShape& shape, const float* input,
+                     const float* filter, float* output,
+                     int rows_per_block = 0);
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,176 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/cpu_conv.h"
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace math = paddle::operators::math;
+
+static math::Conv2DShape MakeShape(int in_c, int in_h, int in_w, int out_c,
+                                   int k, int stride, int pad) {
+  math::Conv2DShape shape;
+  shape.in_c = in_c;
+  shape.in_h = in_h;
+  shape.in_w = in_w;
+  shape.out_c = out_c;
+  shape.k_h = shape.k_w = k;
+  shape.stride_h = shape.stride_w = stride;
+  shape.pad_h = shape.pad_w = pad;
+  shape.dilation_h = shape.dilation_w = 1;
+  shape.out_h = (in_h + 2 * pad - k) / stride + 1;
+  shape.out_w = (in_w + 2 * pad - k) / stride + 1;
+  return shape;
+}
+
+static std::vector<float> RandomVec(size_t n) {
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  std::vector<float> x(n);
+  for (auto& v : x) v = dist(rng);
+  return x;
+}
+
+static void NaiveConv(const math::Conv2DShape& s, const float* input,
+                      const float* filter, float* output) {
+  for (int o = 0; o < s.out_c; ++o) {
+    for (int y = 0; y < s.out_h; ++y) {
+      for (int x = 0; x < s.out_w; ++x) {
+        float sum = 0.f;
+        for (int c = 0; c < s.in_c; ++c) {
+          for (int i = 0; i < s.k_h; ++i) {
+            for (int j = 0; j < s.k_w; ++j) {
+              int in_y = y * s.stride_h - s.pad_h + i * s.dilation_h;
+              int in_x = x * s.stride_w - s.pad_w + j * s.dilation_w;
+              if (in_y < 0 || in_y >= s.in_h || in_x < 0 || in_x >= s.in_w) {
+                continue;
+              }
+              sum += input[(c * s.in_h + in_y) * s.in_w + in_x] *
+                     filter[((o * s.in_c + c) * s.k_h + i) * s.k_w + j];
+            }
+          }
+        }
+        output[(o * s.out_h + y) * s.out_w + x] = sum;
+      }
+    }
+  }
+}
+
+static void TestConv(const math::Conv2DShape& s) {
+  paddle::platform::CPUDeviceContext context;
+  auto input = RandomVec(s.in_c * s.in_h * s.in_w);
+  auto filter = RandomVec(s.out_c * s.in_c * s.k_h * s.k_w);
+  std::vector<float> expected(s.out_c * s.out_h * s.out_w);
+  std::vector<float> out(expected.size());
+  NaiveConv(s, input.data(), filter.data(), expected.data());
+
+  // the blocks of 1 and 2 rows cut the last block
+  for (int rows : {0, 1, 2}) {
+    math::TiledIm2ColConv(context, s, input.data(), filter.data(),
+                          out.data(), rows);
+    for (size_t i = 0; i < out.size(); ++i) {
+      ASSERT_NEAR(out[i], expected[i], 1e-4);
+    }
+  }
+
+  if (s.k_h == 3 && s.k_w == 3 && s.stride_h == 1 && s.stride_w == 1) {
+    std::vector<float> u(math::WinogradFilterSize(s));
+    math::WinogradTransformFilter(s, filter.data(), u.data());
+    math::WinogradConv3x3(context, s, input.data(), u.data(), out.data());
+    for (size_t i = 0; i < out.size(); ++i) {
+      ASSERT_NEAR(out[i], expected[i], 1e-4);
+    }
+  }
+}
+
+TEST(CpuConv, Select) {
+  EXPECT_EQ(math::SelectConv2DAlgo(MakeShape(64, 56, 56, 256, 1, 1, 0)),
+            math::Conv2DAlgo::kGemm1x1);
+  EXPECT_EQ(math::SelectConv2DAlgo(MakeShape(64, 56, 56, 64, 3, 1, 1)),
+            math::Conv2DAlgo::kWinograd3x3);
+  // the first layer has too few channels for Winograd
+  EXPECT_EQ(math::SelectConv2DAlgo(MakeShape(3, 224, 224, 64, 3, 1, 1)),
+            math::Conv2DAlgo::kTiledIm2Col);
+  EXPECT_EQ(math::SelectConv2DAlgo(MakeShape(128, 56, 56, 128, 3, 2, 1)),
+            math::Conv2DAlgo::kTiledIm2Col);
+  EXPECT_EQ(math::SelectConv2DAlgo(MakeShape(3, 8, 8, 4, 3, 2, 1)),
+            math::Conv2DAlgo::kIm2Col);
+}
+
+TEST(CpuConv, Correctness) {
+  // odd sizes cut the 2x2 tiles of Winograd on the edges
+  TestConv(MakeShape(16, 7, 9, 17, 3, 1, 1));
+  TestConv(MakeShape(16, 8, 8, 16, 3, 1, 0));
+  TestConv(MakeShape(20, 5, 6, 18, 3, 1, 2));
+  TestConv(MakeShape(3, 11, 10, 4, 5, 2, 2));
+  TestConv(MakeShape(4, 9, 9, 5, 3, 2, 1));
+  TestConv(MakeShape(8, 6, 6, 8, 1, 2, 0));
+}
+
+// The time of a call in milliseconds.
+static double TimeIt(const std::function<void()>& func) {
+  const int kRepeat = 3;
+  func();
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kRepeat; ++i) func();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() /
+         kRepeat;
+}
+
+// Logs the time of the algorithms on the 3x3 layers of ResNet and VGG of
+// one image. It takes seconds and checks nothing, so it does not run in
+// ctest, run it with --gtest_also_run_disabled_tests.
+TEST(CpuConv, DISABLED_Benchmark) {
+  paddle::platform::CPUDeviceContext context;
+  std::vector<std::pair<const char*, math::Conv2DShape>> layers = {
+      {"vgg conv1_2", MakeShape(64, 224, 224, 64, 3, 1, 1)},
+      {"vgg conv3_2", MakeShape(256, 56, 56, 256, 3, 1, 1)},
+      {"resnet conv2_x", MakeShape(64, 56, 56, 64, 3, 1, 1)},
+      {"resnet conv3_x", MakeShape(128, 28, 28, 128, 3, 1, 1)},
+      {"resnet conv4_x", MakeShape(256, 14, 14, 256, 3, 1, 1)},
+      {"resnet conv5_x", MakeShape(512, 7, 7, 512, 3, 1, 1)},
+      {"resnet conv3_1 stride 2", MakeShape(128, 56, 56, 128, 3, 2, 1)},
+      {"resnet conv1", MakeShape(3, 224, 224, 64, 7, 2, 3)}};
+  for (auto& layer : layers) {
+    const math::Conv2DShape& s = layer.second;
+    auto input = RandomVec(s.in_c * s.in_h * s.in_w);
+    auto filter = RandomVec(s.out_c * s.in_c * s.k_h * s.k_w);
+    std::vector<float> out(s.out_c * s.out_h * s.out_w);
+
+    LOG(INFO) << layer.first << " select "
+              << static_cast<int>(math::SelectConv2DAlgo(s)) << ", im2col: "
+              << TimeIt([&] {
+                   math::TiledIm2ColConv(context, s, input.data(),
+                                         filter.data(), out.data(), s.out_h);
+                 })
+              << "ms, tiled im2col: " << TimeIt([&] {
+                   math::TiledIm2ColConv(context, s, input.data(),
+                                         filter.data(), out.data());
+                 })
+              << "ms";
+    if (s.stride_h == 1 && s.k_h == 3) {
+      std::vector<float> u(math::WinogradFilterSize(s));
+      LOG(INFO) << layer.first << " winograd: " << TimeIt([&] {
+        math::WinogradTransformFilter(s, filter.data(), u.data());
+        math::WinogradConv3x3(context, s, input.data(), u.data(), out.data());
+      }) << "ms";
+    }
+  }
+}
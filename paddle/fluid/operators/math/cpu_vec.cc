@@ -0,0 +1,234 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/cpu_vec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "paddle/fluid/framework/threadpool.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/operators/math/cpu_vec_impl.h"
+
+DEFINE_int64(cpu_vec_parallel_threshold, 1 << 16,
+             "The vectorized CPU kernels split the inputs of more elements "
+             "on the threads of the thread pool, 0 to run them on the "
+             "calling thread only.");
+
+namespace paddle {
+namespace operators {
+namespace math {
+namespace detail {
+
+// The kernels of the instruction sets, defined in cpu_vec_<isa>.cc.
+#ifdef PADDLE_WITH_CPU_VEC_SSE42
+const VecKernels* GetSSE42VecKernels();
+#endif
+#ifdef PADDLE_WITH_CPU_VEC_AVX2
+const VecKernels* GetAVX2VecKernels();
+#endif
+#ifdef PADDLE_WITH_CPU_VEC_AVX512F
+const VecKernels* GetAVX512FVecKernels();
+#endif
+
+struct Scalar {
+  typedef float Reg;
+  static const int kWidth = 1;
+
+  static inline Reg Load(const float* p) { return *p; }
+  static inline void Store(float* p, Reg a) { *p = a; }
+  static inline Reg Set1(float a) { return a; }
+  static inline Reg Add(Reg a, Reg b) { return a + b; }
+  static inline Reg Sub(Reg a, Reg b) { return a - b; }
+  static inline Reg Mul(Reg a, Reg b) { return a * b; }
+  static inline Reg Div(Reg a, Reg b) { return a / b; }
+  static inline Reg Max(Reg a, Reg b) { return a > b ? a : b; }
+  static inline Reg Min(Reg a, Reg b) { return a < b ? a : b; }
+  static inline Reg MulAdd(Reg a, Reg b, Reg c) { return a * b + c; }
+  static inline Reg Round(Reg a) { return std::nearbyint(a); }
+  static inline Reg Pow2(Reg n) {
+    int32_t e = (static_cast<int32_t>(n) + 127) << 23;
+    float r;
+    std::memcpy(&r, &e, sizeof(r));
+    return r;
+  }
+};
+
+const VecKernels* GetVecKernels(platform::cpu_isa_t cpu_isa) {
+  switch (cpu_isa) {
+    case platform::isa_any: {
+      static const VecKernels kernels = MakeVecKernels<Scalar>();
+      return &kernels;
+    }
+#ifdef PADDLE_WITH_CPU_VEC_SSE42
+    case platform::sse42:
+      return GetSSE42VecKernels();
+#endif
+#ifdef PADDLE_WITH_CPU_VEC_AVX2
+    case platform::avx2:
+      return GetAVX2VecKernels();
+#endif
+#ifdef PADDLE_WITH_CPU_VEC_AVX512F
+    case platform::avx512f:
+      return GetAVX512FVecKernels();
+#endif
+    default:
+      return nullptr;
+  }
+}
+
+platform::cpu_isa_t VecKernelsIsa() {
+  static const platform::cpu_isa_t isa = [] {
+    for (auto cpu_isa : {platform::avx512f, platform::avx2, platform::sse42}) {
+      if (platform::MayIUse(cpu_isa) && GetVecKernels(cpu_isa) != nullptr) {
+        return cpu_isa;
+      }
+    }
+    return platform::isa_any;
+  }();
+  return isa;
+}
+
+static const VecKernels& Kernels() {
+  static const VecKernels* kernels = GetVecKernels(VecKernelsIsa());
+  return *kernels;
+}
+
+// Run func(begin, end) on the n items of item_numel elements, split on the
+// thread pool if there are more than FLAGS_cpu_vec_parallel_threshold
+// elements. The ranges of elements are multiples of 64, so only the last
+// one has a tail.
+template <typename Func>
+static void Split(int64_t n, int64_t item_numel, Func func) {
+  int64_t threshold = FLAGS_cpu_vec_parallel_threshold;
+  if (threshold <= 0 || n * item_numel <= threshold) {
+    func(0, n);
+    return;
+  }
+  int64_t threads = framework::ThreadPool::GetInstance()->Threads() + 1;
+  int64_t grain = std::max((n + threads - 1) / threads,
+                           threshold / 2 / item_numel);
+  if (item_numel == 1) grain = (grain + 63) / 64 * 64;
+  framework::ParallelFor(n, grain, func);
+}
+
+}  // namespace detail
+
+void VecExp(int64_t n, const float* x, float* y) {
+  auto kernel = detail::Kernels().exp;
+  detail::Split(n, 1, [=](int64_t begin, int64_t end) {
+    kernel(end - begin, x + begin, y + begin);
+  });
+}
+
+void VecSigmoid(int64_t n, const float* x, float* y) {
+  auto kernel = detail::Kernels().sigmoid;
+  detail::Split(n, 1, [=](int64_t begin, int64_t end) {
+    kernel(end - begin, x + begin, y + begin);
+  });
+}
+
+void VecTanh(int64_t n, const float* x, float* y) {
+  auto kernel = detail::Kernels().tanh;
+  detail::Split(n, 1, [=](int64_t begin, int64_t end) {
+    kernel(end - begin, x + begin, y + begin);
+  });
+}
+
+void VecRelu(int64_t n, const float* x, float* y) {
+  auto kernel = detail::Kernels().relu;
+  detail::Split(n, 1, [=](int64_t begin, int64_t end) {
+    kernel(end - begin, x + begin, y + begin);
+  });
+}
+
+void VecAdd(int64_t n, const float* x, const float* y, float* z) {
+  auto kernel = detail::Kernels().add;
+  detail::Split(n, 1, [=](int64_t begin, int64_t end) {
+    kernel(end - begin, x + begin, y + begin, z + begin);
+  });
+}
+
+void VecSub(int64_t n, const float* x, const float* y, float* z) {
+  auto kernel = detail::Kernels().sub;
+  detail::Split(n, 1, [=](int64_t begin, int64_t end) {
+    kernel(end - begin, x + begin, y + begin, z + begin);
+  });
+}
+
+void VecMul(int64_t n, const float* x, const float* y, float* z) {
+  auto kernel = detail::Kernels().mul;
+  detail::Split(n, 1, [=](int64_t begin, int64_t end) {
+    kernel(end - begin, x + begin, y + begin, z + begin);
+  });
+}
+
+void VecDiv(int64_t n, const float* x, const float* y, float* z) {
+  auto kernel = detail::Kernels().div;
+  detail::Split(n, 1, [=](int64_t begin, int64_t end) {
+    kernel(end - begin, x + begin, y + begin, z + begin);
+  });
+}
+
+void VecSoftmax(int64_t rows, int64_t cols, const float* x, float* y) {
+  auto kernel = detail::Kernels().softmax;
+  if (cols <= 0) return;
+  detail::Split(rows, cols, [=](int64_t begin, int64_t end) {
+    for (int64_t row = begin; row < end; ++row) {
+      kernel(cols, x + row * cols, y + row * cols);
+    }
+  });
+}
+
+bool UseVecSmallGemm(int M, int N, int K) {
+  const int64_t kMaxVolume = 64 * 64 * 64;
+  return K <= detail::kSmallGemmMaxK &&
+         static_cast<int64_t>(M) * N * K <= kMaxVolume &&
+         detail::VecKernelsIsa() != platform::isa_any;
+}
+
+void VecSmallGemm(bool trans_a, bool trans_b, int M, int N, int K,
+                  float alpha, const float* A, int lda, const float* B,
+                  int ldb, float beta, float* C, int ldc) {
+  PADDLE_ENFORCE_LE(K, detail::kSmallGemmMaxK);
+  if (M <= 0 || N <= 0) return;
+  if (trans_b) {
+    // The kernel loads the rows of B, so B^T is copied to [K, N] first,
+    // which is cheap for the small K.
+    thread_local std::vector<float> packed;
+    packed.resize(static_cast<size_t>(K) * N);
+    for (int k = 0; k < K; ++k) {
+      for (int j = 0; j < N; ++j) packed[k * N + j] = B[j * ldb + k];
+    }
+    B = packed.data();
+    ldb = N;
+  }
+  int a_row = trans_a ? 1 : lda;
+  int a_col = trans_a ? lda : 1;
+  // The vector kernels pad the columns to the register width, which costs
+  // more than the scalar loop on the narrowest matrices.
+  const int kMinVecCols = 8;
+  auto kernel = N < kMinVecCols
+                    ? detail::GetVecKernels(platform::isa_any)->small_gemm
+                    : detail::Kernels().small_gemm;
+  kernel(M, N, K, alpha, A, a_row, a_col, B, ldb, beta, C, ldc);
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
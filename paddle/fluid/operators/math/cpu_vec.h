@@ -0,0 +1,98 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+
+#include "paddle/fluid/platform/cpu_info.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// Vectorized float kernels of the CPU activations, softmax and elementwise
+// ops. The kernels are compiled for SSE4.2, AVX2 and AVX-512F, the widest
+// instruction set supported by the CPU is chosen at runtime by
+// platform::MayIUse, and a scalar version runs on the other CPUs. Inputs of
+// more than FLAGS_cpu_vec_parallel_threshold elements are split on the
+// threads of the framework thread pool.
+//
+// exp clamps the input to [-87.33, 88.02], so it never returns zero or
+// inf, and softmax clips the shifted logits at -64 like SoftmaxFunctor.
+// The in-place calls, y == x, are allowed.
+
+void VecExp(int64_t n, const float* x, float* y);
+void VecSigmoid(int64_t n, const float* x, float* y);
+void VecTanh(int64_t n, const float* x, float* y);
+void VecRelu(int64_t n, const float* x, float* y);
+
+void VecAdd(int64_t n, const float* x, const float* y, float* z);
+void VecSub(int64_t n, const float* x, const float* y, float* z);
+void VecMul(int64_t n, const float* x, const float* y, float* z);
+void VecDiv(int64_t n, const float* x, const float* y, float* z);
+
+// The softmax of every row of the [rows, cols] matrix x.
+void VecSoftmax(int64_t rows, int64_t cols, const float* x, float* y);
+
+// C = alpha * op(A) * op(B) + beta * C of the row major matrices, op(A) is
+// [M, K] and op(B) is [K, N]. The tiles of C are kept in the registers over
+// the K loop and nothing is packed, so it beats BLAS on the small matrices
+// for which UseVecSmallGemm is true, where the call and packing overheads
+// of BLAS dominate. C is not read if beta is 0. It runs on the calling
+// thread.
+bool UseVecSmallGemm(int M, int N, int K);
+void VecSmallGemm(bool trans_a, bool trans_b, int M, int N, int K,
+                  float alpha, const float* A, int lda, const float* B,
+                  int ldb, float beta, float* C, int ldc);
+
+namespace detail {
+
+typedef void (*VecUnaryKernel)(int64_t n, const float* x, float* y);
+typedef void (*VecBinaryKernel)(int64_t n, const float* x, const float* y,
+                                float* z);
+// C = alpha * A * B + beta * C, the element (i, k) of A is at
+// A[i * a_row + k * a_col], and K is at most kSmallGemmMaxK.
+typedef void (*VecGemmKernel)(int M, int N, int K, float alpha,
+                              const float* A, int a_row, int a_col,
+                              const float* B, int ldb, float beta, float* C,
+                              int ldc);
+
+constexpr int kSmallGemmMaxK = 256;
+
+// The kernels of one instruction set, softmax works on one row.
+struct VecKernels {
+  VecUnaryKernel exp;
+  VecUnaryKernel sigmoid;
+  VecUnaryKernel tanh;
+  VecUnaryKernel relu;
+  VecBinaryKernel add;
+  VecBinaryKernel sub;
+  VecBinaryKernel mul;
+  VecBinaryKernel div;
+  VecUnaryKernel softmax;
+  VecGemmKernel small_gemm;
+};
+
+// The kernels of cpu_isa, nullptr if they are not compiled in. isa_any
+// returns the scalar kernels.
+const VecKernels* GetVecKernels(platform::cpu_isa_t cpu_isa);
+
+// The instruction set the Vec functions run with.
+platform::cpu_isa_t VecKernelsIsa();
+
+}  // namespace detail
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,60 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <immintrin.h>
+
+#include "paddle/fluid/operators/math/cpu_vec_impl.h"
+
+// Compiled with -mavx2 -mfma, see CMakeLists.txt.
+
+namespace paddle {
+namespace operators {
+namespace math {
+namespace detail {
+
+struct AVX2 {
+  typedef __m256 Reg;
+  static const int kWidth = 8;
+
+  static inline Reg Load(const float* p) { return _mm256_loadu_ps(p); }
+  static inline void Store(float* p, Reg a) { _mm256_storeu_ps(p, a); }
+  static inline Reg Set1(float a) { return _mm256_set1_ps(a); }
+  static inline Reg Add(Reg a, Reg b) { return _mm256_add_ps(a, b); }
+  static inline Reg Sub(Reg a, Reg b) { return _mm256_sub_ps(a, b); }
+  static inline Reg Mul(Reg a, Reg b) { return _mm256_mul_ps(a, b); }
+  static inline Reg Div(Reg a, Reg b) { return _mm256_div_ps(a, b); }
+  static inline Reg Max(Reg a, Reg b) { return _mm256_max_ps(a, b); }
+  static inline Reg Min(Reg a, Reg b) { return _mm256_min_ps(a, b); }
+  static inline Reg MulAdd(Reg a, Reg b, Reg c) {
+    return _mm256_fmadd_ps(a, b, c);
+  }
+  static inline Reg Round(Reg a) {
+    return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  }
+  static inline Reg Pow2(Reg n) {
+    __m256i e =
+        _mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127));
+    return _mm256_castsi256_ps(_mm256_slli_epi32(e, 23));
+  }
+};
+
+const VecKernels* GetAVX2VecKernels() {
+  static const VecKernels kernels = MakeVecKernels<AVX2>();
+  return &kernels;
+}
+
+}  // namespace detail
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,61 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <immintrin.h>
+
+#include "paddle/fluid/operators/math/cpu_vec_impl.h"
+
+// Compiled with -mavx512f, see CMakeLists.txt.
+
+namespace paddle {
+namespace operators {
+namespace math {
+namespace detail {
+
+struct AVX512F {
+  typedef __m512 Reg;
+  static const int kWidth = 16;
+
+  static inline Reg Load(const float* p) { return _mm512_loadu_ps(p); }
+  static inline void Store(float* p, Reg a) { _mm512_storeu_ps(p, a); }
+  static inline Reg Set1(float a) { return _mm512_set1_ps(a); }
+  static inline Reg Add(Reg a, Reg b) { return _mm512_add_ps(a, b); }
+  static inline Reg Sub(Reg a, Reg b) { return _mm512_sub_ps(a, b); }
+  static inline Reg Mul(Reg a, Reg b) { return _mm512_mul_ps(a, b); }
+  static inline Reg Div(Reg a, Reg b) { return _mm512_div_ps(a, b); }
+  static inline Reg Max(Reg a, Reg b) { return _mm512_max_ps(a, b); }
+  static inline Reg Min(Reg a, Reg b) { return _mm512_min_ps(a, b); }
+  static inline Reg MulAdd(Reg a, Reg b, Reg c) {
+    return _mm512_fmadd_ps(a, b, c);
+  }
+  static inline Reg Round(Reg a) {
+    return _mm512_roundscale_ps(a,
+                                _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  }
+  static inline Reg Pow2(Reg n) {
+    __m512i e =
+        _mm512_add_epi32(_mm512_cvtps_epi32(n), _mm512_set1_epi32(127));
+    return _mm512_castsi512_ps(_mm512_slli_epi32(e, 23));
+  }
+};
+
+const VecKernels* GetAVX512FVecKernels() {
+  static const VecKernels kernels = MakeVecKernels<AVX512F>();
+  return &kernels;
+}
+
+}  // namespace detail
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,350 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include "paddle/fluid/operators/math/cpu_vec.h"
+
+// The kernels of cpu_vec.h written once over the traits of an instruction
+// set, which is a struct of:
+//
+//   typedef ... Reg;             // the vector register
+//   static const int kWidth;     // the floats in a register
+//   Reg Load(const float* p);    // unaligned
+//   void Store(float* p, Reg a); // unaligned
+//   Reg Set1(float a);
+//   Reg Add/Sub/Mul/Div/Max/Min(Reg a, Reg b);
+//   Reg MulAdd(Reg a, Reg b, Reg c);  // a * b + c
+//   Reg Round(Reg a);                 // to the nearest integer
+//   Reg Pow2(Reg n);                  // 2^n of an integer n in [-126, 127]
+//
+// This header is included by the files compiled with the flags of every
+// instruction set, so it should only instantiate templates of the traits and
+// not use the functions of the standard library, whose copies compiled with
+// the wider instruction sets could be picked by the linker for the others.
+
+namespace paddle {
+namespace operators {
+namespace math {
+namespace detail {
+
+// Cephes expf: exp(x) = 2^n * exp(r), |r| <= ln(2) / 2.
+constexpr float kExpMax = 88.02969f;   // n <= 127
+constexpr float kExpMin = -87.33654f;  // n >= -126
+constexpr float kLog2e = 1.44269504088896341f;
+constexpr float kLn2Hi = 0.693359375f;
+constexpr float kLn2Lo = -2.12194440e-4f;
+constexpr float kExpP0 = 1.9875691500e-4f;
+constexpr float kExpP1 = 1.3981999507e-3f;
+constexpr float kExpP2 = 8.3334519073e-3f;
+constexpr float kExpP3 = 4.1665795894e-2f;
+constexpr float kExpP4 = 1.6666665459e-1f;
+constexpr float kExpP5 = 5.0000001201e-1f;
+
+// The threshold of the shifted logits of softmax, see ValueClip.
+constexpr float kSoftmaxClip = -64.f;
+
+template <typename V>
+inline typename V::Reg Exp(typename V::Reg x) {
+  typedef typename V::Reg Reg;
+  x = V::Max(V::Min(x, V::Set1(kExpMax)), V::Set1(kExpMin));
+  Reg n = V::Round(V::Mul(x, V::Set1(kLog2e)));
+  Reg r = V::Sub(x, V::Mul(n, V::Set1(kLn2Hi)));
+  r = V::Sub(r, V::Mul(n, V::Set1(kLn2Lo)));
+  Reg p = V::Set1(kExpP0);
+  p = V::MulAdd(p, r, V::Set1(kExpP1));
+  p = V::MulAdd(p, r, V::Set1(kExpP2));
+  p = V::MulAdd(p, r, V::Set1(kExpP3));
+  p = V::MulAdd(p, r, V::Set1(kExpP4));
+  p = V::MulAdd(p, r, V::Set1(kExpP5));
+  p = V::MulAdd(p, V::Mul(r, r), V::Add(r, V::Set1(1.f)));
+  return V::Mul(p, V::Pow2(n));
+}
+
+template <typename V>
+struct ExpOp {
+  static inline typename V::Reg Compute(typename V::Reg x) {
+    return Exp<V>(x);
+  }
+};
+
+template <typename V>
+struct SigmoidOp {
+  static inline typename V::Reg Compute(typename V::Reg x) {
+    typename V::Reg one = V::Set1(1.f);
+    return V::Div(one, V::Add(one, Exp<V>(V::Sub(V::Set1(0.f), x))));
+  }
+};
+
+// tanh(x) = 2 / (1 + exp(-2x)) - 1
+template <typename V>
+struct TanhOp {
+  static inline typename V::Reg Compute(typename V::Reg x) {
+    typename V::Reg one = V::Set1(1.f);
+    typename V::Reg e = Exp<V>(V::Mul(x, V::Set1(-2.f)));
+    return V::Sub(V::Div(V::Set1(2.f), V::Add(one, e)), one);
+  }
+};
+
+template <typename V>
+struct ReluOp {
+  static inline typename V::Reg Compute(typename V::Reg x) {
+    return V::Max(x, V::Set1(0.f));
+  }
+};
+
+template <typename V>
+struct AddOp {
+  static inline typename V::Reg Compute(typename V::Reg x,
+                                        typename V::Reg y) {
+    return V::Add(x, y);
+  }
+};
+
+template <typename V>
+struct SubOp {
+  static inline typename V::Reg Compute(typename V::Reg x,
+                                        typename V::Reg y) {
+    return V::Sub(x, y);
+  }
+};
+
+template <typename V>
+struct MulOp {
+  static inline typename V::Reg Compute(typename V::Reg x,
+                                        typename V::Reg y) {
+    return V::Mul(x, y);
+  }
+};
+
+template <typename V>
+struct DivOp {
+  static inline typename V::Reg Compute(typename V::Reg x,
+                                        typename V::Reg y) {
+    return V::Div(x, y);
+  }
+};
+
+// The tails shorter than a register are computed through a buffer.
+template <typename V, template <typename> class Op>
+void VecUnary(int64_t n, const float* x, float* y) {
+  int64_t i = 0;
+  for (; i + V::kWidth <= n; i += V::kWidth) {
+    V::Store(y + i, Op<V>::Compute(V::Load(x + i)));
+  }
+  if (i < n) {
+    float buf[V::kWidth] = {0.f};
+    for (int64_t j = 0; i + j < n; ++j) buf[j] = x[i + j];
+    V::Store(buf, Op<V>::Compute(V::Load(buf)));
+    for (int64_t j = 0; i + j < n; ++j) y[i + j] = buf[j];
+  }
+}
+
+template <typename V, template <typename> class Op>
+void VecBinary(int64_t n, const float* x, const float* y, float* z) {
+  int64_t i = 0;
+  for (; i + V::kWidth <= n; i += V::kWidth) {
+    V::Store(z + i, Op<V>::Compute(V::Load(x + i), V::Load(y + i)));
+  }
+  if (i < n) {
+    // y is padded with ones for div.
+    float x_buf[V::kWidth] = {0.f};
+    float y_buf[V::kWidth];
+    for (int j = 0; j < V::kWidth; ++j) y_buf[j] = 1.f;
+    for (int64_t j = 0; i + j < n; ++j) {
+      x_buf[j] = x[i + j];
+      y_buf[j] = y[i + j];
+    }
+    V::Store(x_buf, Op<V>::Compute(V::Load(x_buf), V::Load(y_buf)));
+    for (int64_t j = 0; i + j < n; ++j) z[i + j] = x_buf[j];
+  }
+}
+
+// The softmax of one row of n elements.
+template <typename V>
+void VecSoftmaxRow(int64_t n, const float* x, float* y) {
+  typedef typename V::Reg Reg;
+  if (n <= 0) return;
+  float buf[V::kWidth];
+
+  float max = x[0];
+  int64_t i = 0;
+  if (n >= V::kWidth) {
+    Reg m = V::Load(x);
+    for (i = V::kWidth; i + V::kWidth <= n; i += V::kWidth) {
+      m = V::Max(m, V::Load(x + i));
+    }
+    V::Store(buf, m);
+    for (int j = 0; j < V::kWidth; ++j) {
+      if (buf[j] > max) max = buf[j];
+    }
+  }
+  for (; i < n; ++i) {
+    if (x[i] > max) max = x[i];
+  }
+
+  Reg shift = V::Set1(max);
+  Reg clip = V::Set1(kSoftmaxClip);
+  Reg sum = V::Set1(0.f);
+  for (i = 0; i + V::kWidth <= n; i += V::kWidth) {
+    Reg e = Exp<V>(V::Max(V::Sub(V::Load(x + i), shift), clip));
+    V::Store(y + i, e);
+    sum = V::Add(sum, e);
+  }
+  V::Store(buf, sum);
+  float total = 0.f;
+  for (int j = 0; j < V::kWidth; ++j) total += buf[j];
+  if (i < n) {
+    for (int j = 0; j < V::kWidth; ++j) {
+      buf[j] = i + j < n ? x[i + j] : max;
+    }
+    V::Store(buf, Exp<V>(V::Max(V::Sub(V::Load(buf), shift), clip)));
+    for (int64_t j = 0; i + j < n; ++j) {
+      y[i + j] = buf[j];
+      total += buf[j];
+    }
+  }
+
+  Reg scale = V::Set1(1.f / total);
+  for (i = 0; i + V::kWidth <= n; i += V::kWidth) {
+    V::Store(y + i, V::Mul(V::Load(y + i), scale));
+  }
+  for (; i < n; ++i) y[i] *= 1.f / total;
+}
+
+// The rows of a tile of the small GEMM, a tile of [kSmallGemmRows,
+// Regs * V::kWidth] is accumulated in Regs * kSmallGemmRows registers.
+constexpr int kSmallGemmRows = 4;
+
+template <typename V, int Rows, int Regs>
+inline void SmallGemmTile(int K, float alpha, const float* A, int a_row,
+                          int a_col, const float* B, int ldb, float beta,
+                          float* C, int ldc) {
+  typedef typename V::Reg Reg;
+  Reg acc[Rows][Regs];
+  for (int r = 0; r < Rows; ++r) {
+    for (int t = 0; t < Regs; ++t) acc[r][t] = V::Set1(0.f);
+  }
+  for (int k = 0; k < K; ++k) {
+    Reg b[Regs];
+    for (int t = 0; t < Regs; ++t) b[t] = V::Load(B + k * ldb + t * V::kWidth);
+    const float* a = A + k * a_col;
+    for (int r = 0; r < Rows; ++r) {
+      Reg ar = V::Set1(a[r * a_row]);
+      for (int t = 0; t < Regs; ++t) acc[r][t] = V::MulAdd(ar, b[t], acc[r][t]);
+    }
+  }
+  Reg va = V::Set1(alpha);
+  Reg vb = V::Set1(beta);
+  for (int r = 0; r < Rows; ++r) {
+    for (int t = 0; t < Regs; ++t) {
+      float* c = C + r * ldc + t * V::kWidth;
+      Reg out = V::Mul(acc[r][t], va);
+      if (beta != 0.f) out = V::MulAdd(vb, V::Load(c), out);
+      V::Store(c, out);
+    }
+  }
+}
+
+// The tiles of the rows [0, M) and the Regs * V::kWidth columns of B and C.
+template <typename V, int Regs>
+inline void SmallGemmPanel(int M, int K, float alpha, const float* A,
+                           int a_row, int a_col, const float* B, int ldb,
+                           float beta, float* C, int ldc) {
+  int i = 0;
+  for (; i + kSmallGemmRows <= M; i += kSmallGemmRows) {
+    SmallGemmTile<V, kSmallGemmRows, Regs>(K, alpha, A + i * a_row, a_row,
+                                           a_col, B, ldb, beta, C + i * ldc,
+                                           ldc);
+  }
+  const float* a = A + i * a_row;
+  float* c = C + i * ldc;
+  switch (M - i) {
+    case 3:
+      SmallGemmTile<V, 3, Regs>(K, alpha, a, a_row, a_col, B, ldb, beta, c,
+                                ldc);
+      break;
+    case 2:
+      SmallGemmTile<V, 2, Regs>(K, alpha, a, a_row, a_col, B, ldb, beta, c,
+                                ldc);
+      break;
+    case 1:
+      SmallGemmTile<V, 1, Regs>(K, alpha, a, a_row, a_col, B, ldb, beta, c,
+                                ldc);
+      break;
+  }
+}
+
+template <typename V>
+void VecSmallGemm(int M, int N, int K, float alpha, const float* A, int a_row,
+                  int a_col, const float* B, int ldb, float beta, float* C,
+                  int ldc) {
+  const int kWidth = V::kWidth;
+  int j = 0;
+  for (; j + 2 * kWidth <= N; j += 2 * kWidth) {
+    SmallGemmPanel<V, 2>(M, K, alpha, A, a_row, a_col, B + j, ldb, beta,
+                         C + j, ldc);
+  }
+  if (j + kWidth <= N) {
+    SmallGemmPanel<V, 1>(M, K, alpha, A, a_row, a_col, B + j, ldb, beta,
+                         C + j, ldc);
+    j += kWidth;
+  }
+  int cols = N - j;
+  if (cols == 0) return;
+  // The last columns are computed on a zero padded panel of B into a
+  // buffer of C, one register wide.
+  float b_tail[kSmallGemmMaxK * kWidth];
+  float c_tail[kSmallGemmRows * kWidth];
+  for (int k = 0; k < K; ++k) {
+    for (int t = 0; t < kWidth; ++t) {
+      b_tail[k * kWidth + t] = t < cols ? B[k * ldb + j + t] : 0.f;
+    }
+  }
+  for (int i = 0; i < M; i += kSmallGemmRows) {
+    int rows = M - i < kSmallGemmRows ? M - i : kSmallGemmRows;
+    float* c = C + i * ldc + j;
+    for (int r = 0; r < rows; ++r) {
+      for (int t = 0; t < kWidth; ++t) {
+        c_tail[r * kWidth + t] = t < cols && beta != 0.f ? c[r * ldc + t] : 0.f;
+      }
+    }
+    SmallGemmPanel<V, 1>(rows, K, alpha, A + i * a_row, a_row, a_col, b_tail,
+                         kWidth, beta, c_tail, kWidth);
+    for (int r = 0; r < rows; ++r) {
+      for (int t = 0; t < cols; ++t) c[r * ldc + t] = c_tail[r * kWidth + t];
+    }
+  }
+}
+
+template <typename V>
+VecKernels MakeVecKernels() {
+  VecKernels kernels;
+  kernels.exp = VecUnary<V, ExpOp>;
+  kernels.sigmoid = VecUnary<V, SigmoidOp>;
+  kernels.tanh = VecUnary<V, TanhOp>;
+  kernels.relu = VecUnary<V, ReluOp>;
+  kernels.add = VecBinary<V, AddOp>;
+  kernels.sub = VecBinary<V, SubOp>;
+  kernels.mul = VecBinary<V, MulOp>;
+  kernels.div = VecBinary<V, DivOp>;
+  kernels.softmax = VecSoftmaxRow<V>;
+  kernels.small_gemm = VecSmallGemm<V>;
+  return kernels;
+}
+
+}  // namespace detail
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,59 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <immintrin.h>
+
+#include "paddle/fluid/operators/math/cpu_vec_impl.h"
+
+// Compiled with -msse4.2, see CMakeLists.txt.
+
+namespace paddle {
+namespace operators {
+namespace math {
+namespace detail {
+
+struct SSE42 {
+  typedef __m128 Reg;
+  static const int kWidth = 4;
+
+  static inline Reg Load(const float* p) { return _mm_loadu_ps(p); }
+  static inline void Store(float* p, Reg a) { _mm_storeu_ps(p, a); }
+  static inline Reg Set1(float a) { return _mm_set1_ps(a); }
+  static inline Reg Add(Reg a, Reg b) { return _mm_add_ps(a, b); }
+  static inline Reg Sub(Reg a, Reg b) { return _mm_sub_ps(a, b); }
+  static inline Reg Mul(Reg a, Reg b) { return _mm_mul_ps(a, b); }
+  static inline Reg Div(Reg a, Reg b) { return _mm_div_ps(a, b); }
+  static inline Reg Max(Reg a, Reg b) { return _mm_max_ps(a, b); }
+  static inline Reg Min(Reg a, Reg b) { return _mm_min_ps(a, b); }
+  static inline Reg MulAdd(Reg a, Reg b, Reg c) {
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+  }
+  static inline Reg Round(Reg a) {
+    return _mm_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  }
+  static inline Reg Pow2(Reg n) {
+    __m128i e = _mm_add_epi32(_mm_cvtps_epi32(n), _mm_set1_epi32(127));
+    return _mm_castsi128_ps(_mm_slli_epi32(e, 23));
+  }
+};
+
+const VecKernels* GetSSE42VecKernels() {
+  static const VecKernels kernels = MakeVecKernels<SSE42>();
+  return &kernels;
+}
+
+}  // namespace detail
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,339 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/cpu_vec.h"
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+DECLARE_int64(cpu_vec_parallel_threshold);
+
+namespace math = paddle::operators::math;
+namespace platform = paddle::platform;
+
+static const std::vector<platform::cpu_isa_t> kIsas = {
+    platform::isa_any, platform::sse42, platform::avx2, platform::avx512f};
+static const char* kIsaNames[] = {"any", "sse42", "avx", "avx2", "avx512f"};
+
+static std::vector<float> RandomVec(size_t n, float low, float high) {
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> dist(low, high);
+  std::vector<float> x(n);
+  for (auto& v : x) v = dist(rng);
+  return x;
+}
+
+// The reference kernels with the functions of the standard library.
+static void RefExp(int64_t n, const float* x, float* y) {
+  for (int64_t i = 0; i < n; ++i) y[i] = std::exp(x[i]);
+}
+
+static void RefSigmoid(int64_t n, const float* x, float* y) {
+  for (int64_t i = 0; i < n; ++i) y[i] = 1.f / (1.f + std::exp(-x[i]));
+}
+
+static void RefTanh(int64_t n, const float* x, float* y) {
+  for (int64_t i = 0; i < n; ++i) y[i] = std::tanh(x[i]);
+}
+
+static void RefRelu(int64_t n, const float* x, float* y) {
+  for (int64_t i = 0; i < n; ++i) y[i] = std::max(x[i], 0.f);
+}
+
+static void RefAdd(int64_t n, const float* x, const float* y, float* z) {
+  for (int64_t i = 0; i < n; ++i) z[i] = x[i] + y[i];
+}
+
+static void RefSub(int64_t n, const float* x, const float* y, float* z) {
+  for (int64_t i = 0; i < n; ++i) z[i] = x[i] - y[i];
+}
+
+static void RefMul(int64_t n, const float* x, const float* y, float* z) {
+  for (int64_t i = 0; i < n; ++i) z[i] = x[i] * y[i];
+}
+
+static void RefDiv(int64_t n, const float* x, const float* y, float* z) {
+  for (int64_t i = 0; i < n; ++i) z[i] = x[i] / y[i];
+}
+
+static void RefSoftmax(int64_t n, const float* x, float* y) {
+  float max = x[0];
+  for (int64_t i = 1; i < n; ++i) max = std::max(max, x[i]);
+  float sum = 0.f;
+  for (int64_t i = 0; i < n; ++i) {
+    y[i] = std::exp(std::max(x[i] - max, -64.f));
+    sum += y[i];
+  }
+  for (int64_t i = 0; i < n; ++i) y[i] /= sum;
+}
+
+static void RefSmallGemm(int M, int N, int K, float alpha, const float* A,
+                         int a_row, int a_col, const float* B, int ldb,
+                         float beta, float* C, int ldc) {
+  for (int i = 0; i < M; ++i) {
+    for (int j = 0; j < N; ++j) {
+      float sum = 0.f;
+      for (int k = 0; k < K; ++k) {
+        sum += A[i * a_row + k * a_col] * B[k * ldb + j];
+      }
+      float& c = C[i * ldc + j];
+      c = alpha * sum + (beta == 0.f ? 0.f : beta * c);
+    }
+  }
+}
+
+static const math::detail::VecKernels kRefKernels = {
+    RefExp, RefSigmoid, RefTanh,    RefRelu,     RefAdd,
+    RefSub, RefMul,     RefDiv,     RefSoftmax,  RefSmallGemm};
+
+static void ExpectNear(const std::vector<float>& out,
+                       const std::vector<float>& expected, float rtol) {
+  ASSERT_EQ(out.size(), expected.size());
+  for (size_t i = 0; i < out.size(); ++i) {
+    EXPECT_NEAR(out[i], expected[i], rtol * (1.f + std::fabs(expected[i])))
+        << "at " << i;
+  }
+}
+
+static void TestKernels(const math::detail::VecKernels& kernels, int n) {
+  auto x = RandomVec(n, -20.f, 20.f);
+  auto y = RandomVec(n, 0.5f, 2.f);
+  std::vector<float> out(n), expected(n);
+
+  std::vector<std::pair<math::detail::VecUnaryKernel, float>> unary = {
+      {kernels.exp, 1e-6}, {kernels.sigmoid, 1e-6}, {kernels.tanh, 1e-6},
+      {kernels.relu, 0},   {kernels.softmax, 1e-6}};
+  std::vector<math::detail::VecUnaryKernel> unary_ref = {
+      kRefKernels.exp, kRefKernels.sigmoid, kRefKernels.tanh,
+      kRefKernels.relu, kRefKernels.softmax};
+  for (size_t i = 0; i < unary.size(); ++i) {
+    unary[i].first(n, x.data(), out.data());
+    unary_ref[i](n, x.data(), expected.data());
+    ExpectNear(out, expected, unary[i].second);
+    // in place
+    out = x;
+    unary[i].first(n, out.data(), out.data());
+    ExpectNear(out, expected, unary[i].second);
+  }
+
+  std::vector<math::detail::VecBinaryKernel> binary = {
+      kernels.add, kernels.sub, kernels.mul, kernels.div};
+  std::vector<math::detail::VecBinaryKernel> binary_ref = {
+      kRefKernels.add, kRefKernels.sub, kRefKernels.mul, kRefKernels.div};
+  for (size_t i = 0; i < binary.size(); ++i) {
+    binary[i](n, x.data(), y.data(), out.data());
+    binary_ref[i](n, x.data(), y.data(), expected.data());
+    ExpectNear(out, expected, 1e-7);
+  }
+}
+
+TEST(CpuVec, Kernels) {
+  for (auto isa : kIsas) {
+    auto* kernels = math::detail::GetVecKernels(isa);
+    if (!platform::MayIUse(isa) || kernels == nullptr) continue;
+    LOG(INFO) << "test the kernels of " << kIsaNames[isa];
+    // the lengths around the register widths test the tails
+    for (int n : {1, 3, 4, 7, 8, 15, 16, 17, 33, 100}) {
+      TestKernels(*kernels, n);
+    }
+  }
+}
+
+// C has a padding column to test ldc, and is NaN where it should not be
+// read if beta is 0.
+static void TestSmallGemm(math::detail::VecGemmKernel kernel, int M, int N,
+                          int K, float beta) {
+  auto a = RandomVec(M * K, -1.f, 1.f);
+  auto b = RandomVec(K * N, -1.f, 1.f);
+  int ldc = N + 1;
+  std::vector<float> out(M * ldc, beta == 0.f ? NAN : 0.5f);
+  std::vector<float> expected(M * ldc, 0.5f);
+  kernel(M, N, K, 2.f, a.data(), K, 1, b.data(), N, beta, out.data(), ldc);
+  RefSmallGemm(M, N, K, 2.f, a.data(), K, 1, b.data(), N, beta,
+               expected.data(), ldc);
+  for (int i = 0; i < M; ++i) {
+    for (int j = 0; j < N; ++j) {
+      EXPECT_NEAR(out[i * ldc + j], expected[i * ldc + j], 1e-4)
+          << M << "x" << N << "x" << K << " at " << i << ", " << j;
+    }
+  }
+}
+
+TEST(CpuVec, SmallGemm) {
+  for (auto isa : kIsas) {
+    auto* kernels = math::detail::GetVecKernels(isa);
+    if (!platform::MayIUse(isa) || kernels == nullptr) continue;
+    LOG(INFO) << "test the small gemm of " << kIsaNames[isa];
+    // the sizes around the tiles test the row and column tails
+    for (int M : {1, 3, 4, 5, 9}) {
+      for (int N : {1, 7, 16, 33}) {
+        for (int K : {1, 8, 17, 256}) {
+          TestSmallGemm(kernels->small_gemm, M, N, K, 0.f);
+          TestSmallGemm(kernels->small_gemm, M, N, K, 1.5f);
+        }
+      }
+    }
+  }
+}
+
+TEST(CpuVec, SmallGemmTranspose) {
+  const int M = 5, N = 19, K = 11;
+  auto a = RandomVec(M * K, -1.f, 1.f);
+  auto b = RandomVec(K * N, -1.f, 1.f);
+  // a_t is A^T of [K, M], b_t is B^T of [N, K]
+  std::vector<float> a_t(K * M), b_t(N * K);
+  for (int i = 0; i < M; ++i) {
+    for (int k = 0; k < K; ++k) a_t[k * M + i] = a[i * K + k];
+  }
+  for (int k = 0; k < K; ++k) {
+    for (int j = 0; j < N; ++j) b_t[j * K + k] = b[k * N + j];
+  }
+  std::vector<float> expected(M * N);
+  RefSmallGemm(M, N, K, 1.f, a.data(), K, 1, b.data(), N, 0.f,
+               expected.data(), N);
+  for (bool trans_a : {false, true}) {
+    for (bool trans_b : {false, true}) {
+      std::vector<float> out(M * N);
+      math::VecSmallGemm(trans_a, trans_b, M, N, K, 1.f,
+                         trans_a ? a_t.data() : a.data(), trans_a ? M : K,
+                         trans_b ? b_t.data() : b.data(), trans_b ? K : N,
+                         0.f, out.data(), N);
+      ExpectNear(out, expected, 1e-5);
+    }
+  }
+}
+
+TEST(CpuVec, Range) {
+  std::vector<float> x = {-100.f, -87.f, 0.f, 1e-8f, 87.f, 100.f};
+  std::vector<float> out(x.size());
+  math::VecExp(x.size(), x.data(), out.data());
+  for (float v : out) {
+    EXPECT_GT(v, 0.f);
+    EXPECT_TRUE(std::isfinite(v));
+  }
+  math::VecSigmoid(x.size(), x.data(), out.data());
+  ExpectNear(out, {0.f, 0.f, 0.5f, 0.5f, 1.f, 1.f}, 1e-6);
+  math::VecTanh(x.size(), x.data(), out.data());
+  ExpectNear(out, {-1.f, -1.f, 0.f, 0.f, 1.f, 1.f}, 1e-6);
+}
+
+TEST(CpuVec, Parallel) {
+  int64_t threshold = FLAGS_cpu_vec_parallel_threshold;
+  FLAGS_cpu_vec_parallel_threshold = 100;
+  const int64_t rows = 37, cols = 129, n = rows * cols;
+  auto x = RandomVec(n, -5.f, 5.f);
+  std::vector<float> out(n), expected(n);
+
+  math::VecTanh(n, x.data(), out.data());
+  RefTanh(n, x.data(), expected.data());
+  ExpectNear(out, expected, 1e-6);
+
+  math::VecMul(n, x.data(), x.data(), out.data());
+  RefMul(n, x.data(), x.data(), expected.data());
+  ExpectNear(out, expected, 0);
+
+  math::VecSoftmax(rows, cols, x.data(), out.data());
+  for (int64_t i = 0; i < rows; ++i) {
+    RefSoftmax(cols, x.data() + i * cols, expected.data() + i * cols);
+  }
+  ExpectNear(out, expected, 1e-6);
+  FLAGS_cpu_vec_parallel_threshold = threshold;
+}
+
+// The time of a call in microseconds.
+static double TimeIt(const std::function<void()>& func) {
+  const int kRepeat = 20;
+  func();
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kRepeat; ++i) func();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count() /
+         kRepeat;
+}
+
+static void BenchmarkKernels(const std::string& name,
+                             const math::detail::VecKernels& k, int64_t n) {
+  auto x = RandomVec(n, -5.f, 5.f);
+  auto y = RandomVec(n, 0.5f, 2.f);
+  std::vector<float> out(n);
+  float* o = out.data();
+  const float* a = x.data();
+  const float* b = y.data();
+  const int64_t cols = 1000;
+
+  std::vector<std::pair<std::string, std::function<void()>>> ops = {
+      {"exp", [=] { k.exp(n, a, o); }},
+      {"sigmoid", [=] { k.sigmoid(n, a, o); }},
+      {"tanh", [=] { k.tanh(n, a, o); }},
+      {"relu", [=] { k.relu(n, a, o); }},
+      {"add", [=] { k.add(n, a, b, o); }},
+      {"mul", [=] { k.mul(n, a, b, o); }},
+      {"softmax", [=] {
+         for (int64_t i = 0; i + cols <= n; i += cols) {
+           k.softmax(cols, a + i, o + i);
+         }
+       }}};
+  for (auto& op : ops) {
+    LOG(INFO) << op.first << " n=" << n << " " << name << ": "
+              << TimeIt(op.second) << "us";
+  }
+}
+
+// Logs the time of the std loops, the kernels of every instruction set and
+// the dispatched functions, which run on the threads for the large sizes.
+// It checks nothing, run it with --gtest_also_run_disabled_tests.
+TEST(CpuVec, DISABLED_Benchmark) {
+  math::detail::VecKernels dispatched = {
+      [](int64_t n, const float* x, float* y) { math::VecExp(n, x, y); },
+      [](int64_t n, const float* x, float* y) { math::VecSigmoid(n, x, y); },
+      [](int64_t n, const float* x, float* y) { math::VecTanh(n, x, y); },
+      [](int64_t n, const float* x, float* y) { math::VecRelu(n, x, y); },
+      [](int64_t n, const float* x, const float* y, float* z) {
+        math::VecAdd(n, x, y, z);
+      },
+      [](int64_t n, const float* x, const float* y, float* z) {
+        math::VecSub(n, x, y, z);
+      },
+      [](int64_t n, const float* x, const float* y, float* z) {
+        math::VecMul(n, x, y, z);
+      },
+      [](int64_t n, const float* x, const float* y, float* z) {
+        math::VecDiv(n, x, y, z);
+      },
+      [](int64_t n, const float* x, float* y) {
+        math::VecSoftmax(1, n, x, y);
+      },
+      RefSmallGemm};
+
+  for (int64_t n : {1 << 10, 1 << 14, 1 << 20}) {
+    BenchmarkKernels("std", kRefKernels, n);
+    for (auto isa : kIsas) {
+      auto* kernels = math::detail::GetVecKernels(isa);
+      if (!platform::MayIUse(isa) || kernels == nullptr) continue;
+      BenchmarkKernels(kIsaNames[isa], *kernels, n);
+    }
+    BenchmarkKernels(
+        std::string("dispatched ") +
+            kIsaNames[math::detail::VecKernelsIsa()],
+        dispatched, n);
+  }
+}
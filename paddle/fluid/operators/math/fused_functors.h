@@ -0,0 +1,61 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <cmath>
+#include <string>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The activations which can be fused into the fused_fc and
+// fused_elementwise_chain ops, they are applied in place on the output
+// buffer of the fused op, so the intermediate tensor is never written.
+inline bool IsFusableActivation(const std::string& type) {
+  return type == "relu" || type == "sigmoid" || type == "tanh";
+}
+
+// The binary ops which can be fused into fused_elementwise_chain.
+inline bool IsFusableElementwise(const std::string& type) {
+  return type == "elementwise_add" || type == "elementwise_sub" ||
+         type == "elementwise_mul" || type == "elementwise_div";
+}
+
+template <typename T>
+void ActivateInPlace(const std::string& type, T* x, int64_t n) {
+  if (type == "identity") {
+    return;
+  } else if (type == "relu") {
+    for (int64_t i = 0; i < n; ++i) {
+      x[i] = x[i] > static_cast<T>(0) ? x[i] : static_cast<T>(0);
+    }
+  } else if (type == "sigmoid") {
+    for (int64_t i = 0; i < n; ++i) {
+      x[i] = static_cast<T>(1) / (static_cast<T>(1) + std::exp(-x[i]));
+    }
+  } else if (type == "tanh") {
+    for (int64_t i = 0; i < n; ++i) {
+      x[i] = std::tanh(x[i]);
+    }
+  } else {
+    PADDLE_THROW("Activation %s can not be fused", type);
+  }
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
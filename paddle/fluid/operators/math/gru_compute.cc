@@ -20,12 +20,17 @@ namespace math {
 
 template <typename T>
 struct GRUUnitFunctor<platform::CPUDeviceContext, T> {
-  static void compute(const platform::CPUDeviceContext &context,
-                      GRUMetaValue<T> value, int frame_size, int batch_size,
-                      const detail::ActivationType active_node,
-                      const detail::ActivationType active_gate) {
+  static void compute(
+      const platform::CPUDeviceContext &context, GRUMetaValue<T> value,
+      int frame_size, int batch_size, const detail::ActivationType active_node,
+      const detail::ActivationType active_gate,
+      const GRUPackedWeight<platform::CPUDeviceContext, T> *packed_weight) {
 #ifndef __NVCC__
-    if (value.prev_out_value) {
+    if (value.prev_out_value && packed_weight) {
+      packed_weight->gate_weight.Compute(batch_size, value.prev_out_value,
+                                         frame_size, value.gate_value,
+                                         frame_size * 3);
+    } else if (value.prev_out_value) {
       math::gemm<platform::CPUDeviceContext, T>(
           context, false, false, batch_size, frame_size * 2, frame_size, 1,
           value.prev_out_value, frame_size, value.gate_weight, frame_size * 2,
@@ -35,7 +40,11 @@ struct GRUUnitFunctor<platform::CPUDeviceContext, T> {
     detail::forward_reset_output(detail::forward::gru_resetOutput<T>(), value,
                                  frame_size, batch_size, active_gate);
 
-    if (value.prev_out_value) {
+    if (value.prev_out_value && packed_weight) {
+      packed_weight->state_weight.Compute(
+          batch_size, value.reset_output_value, frame_size,
+          value.gate_value + frame_size * 2, frame_size * 3);
+    } else if (value.prev_out_value) {
       math::gemm<platform::CPUDeviceContext, T>(
           context, false, false, batch_size, frame_size, frame_size, 1,
           value.reset_output_value, frame_size, value.state_weight, frame_size,
@@ -20,10 +20,11 @@ namespace math {
 
 template <typename T>
 struct GRUUnitFunctor<platform::CUDADeviceContext, T> {
-  static void compute(const platform::CUDADeviceContext &context,
-                      GRUMetaValue<T> value, int frame_size, int batch_size,
-                      const detail::ActivationType active_node,
-                      const detail::ActivationType active_gate) {
+  static void compute(
+      const platform::CUDADeviceContext &context, GRUMetaValue<T> value,
+      int frame_size, int batch_size, const detail::ActivationType active_node,
+      const detail::ActivationType active_gate,
+      const GRUPackedWeight<platform::CUDADeviceContext, T> *packed_weight) {
     auto stream = context.stream();
     dim3 threads;
     dim3 grid;
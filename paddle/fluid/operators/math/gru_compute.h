@@ -12,6 +12,7 @@ limitations under the License. */
 #pragma once
 
 #include "paddle/fluid/operators/math/detail/activation_functions.h"
+#include "paddle/fluid/operators/math/packed_gemm.h"
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/enforce.h"
 
@@ -39,12 +40,29 @@ struct GRUMetaGrad {
   T *prev_out_grad;
 };
 
+// The gate_weight and state_weight of a GRU packed once for the recurrent
+// projections of all the time steps.
+template <typename DeviceContext, typename T>
+struct GRUPackedWeight {
+  GRUPackedWeight(const DeviceContext &context, const T *weight,
+                  int frame_size)
+      : gate_weight(context, weight, frame_size, frame_size * 2),
+        state_weight(context, weight + 2 * frame_size * frame_size,
+                     frame_size, frame_size) {}
+
+  PackedGemm<DeviceContext, T> gate_weight;
+  PackedGemm<DeviceContext, T> state_weight;
+};
+
+// If packed_weight is set, it is used instead of value.gate_weight and
+// value.state_weight.
 template <typename DeviceContext, typename T>
 struct GRUUnitFunctor {
-  static void compute(const DeviceContext &context, GRUMetaValue<T> value,
-                      int frame_size, int batch_size,
-                      const detail::ActivationType active_node,
-                      const detail::ActivationType active_gate);
+  static void compute(
+      const DeviceContext &context, GRUMetaValue<T> value, int frame_size,
+      int batch_size, const detail::ActivationType active_node,
+      const detail::ActivationType active_gate,
+      const GRUPackedWeight<DeviceContext, T> *packed_weight = nullptr);
 };
 
 template <typename DeviceContext, typename T>
@@ -0,0 +1,202 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/half_weight.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/platform/cpu_info.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+#ifdef PADDLE_WITH_F16C
+// The F16C conversions, defined in half_weight_f16c.cc.
+void HalfToFloatF16C(const uint16_t* x, float* y, int64_t n);
+void FloatToHalfF16C(const float* x, uint16_t* y, int64_t n);
+
+// F16C has no CPUID level of its own in cpu_isa_t, every CPU with AVX2 has
+// it.
+static bool UseF16C() {
+  static bool use = platform::MayIUse(platform::avx2);
+  return use;
+}
+#endif
+
+void HalfToFloat(const platform::float16* x, float* y, int64_t n) {
+#ifdef PADDLE_WITH_F16C
+  if (UseF16C()) {
+    HalfToFloatF16C(reinterpret_cast<const uint16_t*>(x), y, n);
+    return;
+  }
+#endif
+  for (int64_t i = 0; i < n; ++i) {
+    y[i] = static_cast<float>(x[i]);
+  }
+}
+
+void HalfToFloat(const platform::bfloat16* x, float* y, int64_t n) {
+  for (int64_t i = 0; i < n; ++i) {
+    y[i] = static_cast<float>(x[i]);
+  }
+}
+
+void FloatToHalf(const float* x, platform::float16* y, int64_t n) {
+#ifdef PADDLE_WITH_F16C
+  if (UseF16C()) {
+    FloatToHalfF16C(x, reinterpret_cast<uint16_t*>(y), n);
+    return;
+  }
+#endif
+  for (int64_t i = 0; i < n; ++i) {
+    y[i] = platform::float16(x[i]);
+  }
+}
+
+void FloatToHalf(const float* x, platform::bfloat16* y, int64_t n) {
+  for (int64_t i = 0; i < n; ++i) {
+    y[i] = platform::bfloat16(x[i]);
+  }
+}
+
+void WidenToFloat(const framework::Tensor& t, int64_t offset, int64_t n,
+                  float* y) {
+  if (t.type() == typeid(platform::float16)) {
+    HalfToFloat(t.data<platform::float16>() + offset, y, n);
+  } else if (t.type() == typeid(platform::bfloat16)) {
+    HalfToFloat(t.data<platform::bfloat16>() + offset, y, n);
+  } else {
+    PADDLE_THROW("The tensor should be FP16 or BF16");
+  }
+}
+
+template <typename W>
+void GemmHalfB(const platform::CPUDeviceContext& context, int M, int N,
+               int K, const float* A, const W* B, float* C) {
+  const int block_n = std::min(N, 512);
+  const int block_k = static_cast<int>(
+      std::max<int64_t>(1, std::min<int64_t>(K, kHalfBlockSize / block_n)));
+  std::vector<float> block(static_cast<size_t>(block_k) * block_n);
+  for (int n0 = 0; n0 < N; n0 += block_n) {
+    const int nb = std::min(block_n, N - n0);
+    for (int k0 = 0; k0 < K; k0 += block_k) {
+      const int kb = std::min(block_k, K - k0);
+      for (int k = 0; k < kb; ++k) {
+        HalfToFloat(B + static_cast<int64_t>(k0 + k) * N + n0,
+                    block.data() + k * nb, nb);
+      }
+      gemm<platform::CPUDeviceContext, float>(
+          context, false, false, M, nb, kb, 1.0f, A + k0, K, block.data(), nb,
+          k0 == 0 ? 0.0f : 1.0f, C + n0, N);
+    }
+  }
+}
+
+template <typename W>
+void GemmHalfA(const platform::CPUDeviceContext& context, int M, int N,
+               int K, const W* A, const float* B, float* C) {
+  const int block_k =
+      static_cast<int>(std::min<int64_t>(K, kHalfBlockSize / 16));
+  const int block_m = static_cast<int>(
+      std::max<int64_t>(1, std::min<int64_t>(M, kHalfBlockSize / block_k)));
+  std::vector<float> block(static_cast<size_t>(block_m) * block_k);
+  for (int m0 = 0; m0 < M; m0 += block_m) {
+    const int mb = std::min(block_m, M - m0);
+    for (int k0 = 0; k0 < K; k0 += block_k) {
+      const int kb = std::min(block_k, K - k0);
+      for (int m = 0; m < mb; ++m) {
+        HalfToFloat(A + static_cast<int64_t>(m0 + m) * K + k0,
+                    block.data() + m * kb, kb);
+      }
+      gemm<platform::CPUDeviceContext, float>(
+          context, false, false, mb, N, kb, 1.0f, block.data(), kb,
+          B + static_cast<int64_t>(k0) * N, N, k0 == 0 ? 0.0f : 1.0f,
+          C + static_cast<int64_t>(m0) * N, N);
+    }
+  }
+}
+
+template void GemmHalfB<platform::float16>(const platform::CPUDeviceContext&,
+                                           int, int, int, const float*,
+                                           const platform::float16*, float*);
+template void GemmHalfB<platform::bfloat16>(const platform::CPUDeviceContext&,
+                                            int, int, int, const float*,
+                                            const platform::bfloat16*, float*);
+template void GemmHalfA<platform::float16>(const platform::CPUDeviceContext&,
+                                           int, int, int,
+                                           const platform::float16*,
+                                           const float*, float*);
+template void GemmHalfA<platform::bfloat16>(const platform::CPUDeviceContext&,
+                                            int, int, int,
+                                            const platform::bfloat16*,
+                                            const float*, float*);
+
+void GemmHalfB(const platform::CPUDeviceContext& context, int M, int N,
+               int K, const float* A, const framework::Tensor& B,
+               int64_t b_offset, float* C) {
+  if (B.type() == typeid(platform::float16)) {
+    GemmHalfB(context, M, N, K, A, B.data<platform::float16>() + b_offset, C);
+  } else if (B.type() == typeid(platform::bfloat16)) {
+    GemmHalfB(context, M, N, K, A, B.data<platform::bfloat16>() + b_offset,
+              C);
+  } else {
+    PADDLE_THROW("The weight should be FP16 or BF16");
+  }
+}
+
+void GemmHalfA(const platform::CPUDeviceContext& context, int M, int N,
+               int K, const framework::Tensor& A, int64_t a_offset,
+               const float* B, float* C) {
+  if (A.type() == typeid(platform::float16)) {
+    GemmHalfA(context, M, N, K, A.data<platform::float16>() + a_offset, B, C);
+  } else if (A.type() == typeid(platform::bfloat16)) {
+    GemmHalfA(context, M, N, K, A.data<platform::bfloat16>() + a_offset, B,
+              C);
+  } else {
+    PADDLE_THROW("The weight should be FP16 or BF16");
+  }
+}
+
+bool HalfWeightMatMul<platform::CPUDeviceContext, float>::WeightRight(
+    const platform::CPUDeviceContext& context, int M, int N, int K,
+    const float* x, const framework::Tensor& weight, int64_t offset,
+    float* out) {
+  if (!IsHalfTensor(weight)) return false;
+  GemmHalfB(context, M, N, K, x, weight, offset, out);
+  return true;
+}
+
+bool HalfWeightMatMul<platform::CPUDeviceContext, float>::WeightLeft(
+    const platform::CPUDeviceContext& context, int M, int N, int K,
+    const framework::Tensor& weight, int64_t offset, const float* x,
+    float* out) {
+  if (!IsHalfTensor(weight)) return false;
+  GemmHalfA(context, M, N, K, weight, offset, x, out);
+  return true;
+}
+
+bool HalfWeightMatMul<platform::CPUDeviceContext, float>::Widen(
+    const framework::Tensor& weight, framework::Tensor* out) {
+  if (!IsHalfTensor(weight)) return false;
+  float* data = out->mutable_data<float>(weight.dims(), platform::CPUPlace());
+  WidenToFloat(weight, 0, weight.numel(), data);
+  return true;
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,114 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/bfloat16.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/float16.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The half precision weights of the CPU inference. The large weights are
+// stored in FP16 or BF16, which halves their memory and the bandwidth to
+// read them, and they are widened to float in blocks which fit in the
+// cache right before the blocks are used, so all the arithmetic stays in
+// float.
+
+// The elements of float of a widened block.
+constexpr int64_t kHalfBlockSize = 1 << 16;
+
+void HalfToFloat(const platform::float16* x, float* y, int64_t n);
+void HalfToFloat(const platform::bfloat16* x, float* y, int64_t n);
+void FloatToHalf(const float* x, platform::float16* y, int64_t n);
+void FloatToHalf(const float* x, platform::bfloat16* y, int64_t n);
+
+// Whether t is a FP16 or BF16 tensor.
+inline bool IsHalfTensor(const framework::Tensor& t) {
+  return t.type() == typeid(platform::float16) ||
+         t.type() == typeid(platform::bfloat16);
+}
+
+// Widen the n elements of the half tensor t from offset to y.
+void WidenToFloat(const framework::Tensor& t, int64_t offset, int64_t n,
+                  float* y);
+
+// C[M, N] = A[M, K] * B[K, N], where B is stored in half precision and
+// is widened a block of rows and columns at a time.
+template <typename W>
+void GemmHalfB(const platform::CPUDeviceContext& context, int M, int N,
+               int K, const float* A, const W* B, float* C);
+
+// C[M, N] = A[M, K] * B[K, N], where A is stored in half precision.
+template <typename W>
+void GemmHalfA(const platform::CPUDeviceContext& context, int M, int N,
+               int K, const W* A, const float* B, float* C);
+
+// GemmHalfB on the half tensor B, from the element b_offset.
+void GemmHalfB(const platform::CPUDeviceContext& context, int M, int N,
+               int K, const float* A, const framework::Tensor& B,
+               int64_t b_offset, float* C);
+
+// GemmHalfA on the half tensor A, from the element a_offset.
+void GemmHalfA(const platform::CPUDeviceContext& context, int M, int N,
+               int K, const framework::Tensor& A, int64_t a_offset,
+               const float* B, float* C);
+
+// The products of the kernels whose weight may be stored in half
+// precision. The functions return false if the weight is not half, the
+// kernel then runs its own gemm.
+template <typename DeviceContext, typename T>
+struct HalfWeightMatMul {
+  // out[M, N] = x[M, K] * weight[K, N], from the element offset of weight.
+  static bool WeightRight(const DeviceContext& context, int M, int N, int K,
+                          const T* x, const framework::Tensor& weight,
+                          int64_t offset, T* out) {
+    return false;
+  }
+
+  // out[M, N] = weight[M, K] * x[K, N], from the element offset of weight.
+  static bool WeightLeft(const DeviceContext& context, int M, int N, int K,
+                         const framework::Tensor& weight, int64_t offset,
+                         const T* x, T* out) {
+    return false;
+  }
+
+  // Widen the whole weight to the float tensor out.
+  static bool Widen(const framework::Tensor& weight, framework::Tensor* out) {
+    return false;
+  }
+};
+
+template <>
+struct HalfWeightMatMul<platform::CPUDeviceContext, float> {
+  static bool WeightRight(const platform::CPUDeviceContext& context, int M,
+                          int N, int K, const float* x,
+                          const framework::Tensor& weight, int64_t offset,
+                          float* out);
+
+  static bool WeightLeft(const platform::CPUDeviceContext& context, int M,
+                         int N, int K, const framework::Tensor& weight,
+                         int64_t offset, const float* x, float* out);
+
+  static bool Widen(const framework::Tensor& weight, framework::Tensor* out);
+};
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,182 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/half_weight.h"
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <random>
+#include <vector>
+#include "paddle/fluid/operators/math/math_function.h"
+
+namespace math = paddle::operators::math;
+namespace platform = paddle::platform;
+
+static std::vector<float> RandomVec(size_t n) {
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  std::vector<float> x(n);
+  for (auto& v : x) v = dist(rng);
+  return x;
+}
+
+// The float product of the reference, on the widened weight.
+static void RefGemm(int M, int N, int K, const float* A, const float* B,
+                    float* C) {
+  for (int i = 0; i < M; ++i) {
+    for (int j = 0; j < N; ++j) {
+      double sum = 0;
+      for (int k = 0; k < K; ++k) sum += A[i * K + k] * B[k * N + j];
+      C[i * N + j] = static_cast<float>(sum);
+    }
+  }
+}
+
+template <typename W>
+static void TestConversion(float abs_error) {
+  const int n = 1031;
+  auto x = RandomVec(n);
+  std::vector<W> half(n);
+  std::vector<float> y(n);
+  math::FloatToHalf(x.data(), half.data(), n);
+  math::HalfToFloat(half.data(), y.data(), n);
+  for (int i = 0; i < n; ++i) {
+    // The vectorized conversions round like the scalar ones.
+    ASSERT_EQ(half[i].x, W(x[i]).x) << "at " << i;
+    ASSERT_EQ(y[i], static_cast<float>(half[i])) << "at " << i;
+    ASSERT_NEAR(y[i], x[i], abs_error) << "at " << i;
+  }
+}
+
+TEST(HalfWeight, Conversion) {
+  TestConversion<platform::float16>(1.f / 2048);
+  TestConversion<platform::bfloat16>(1.f / 256);
+}
+
+// A half weight of n elements and its widened values.
+template <typename W>
+static void RandomHalf(size_t n, std::vector<W>* half,
+                       std::vector<float>* widened) {
+  *widened = RandomVec(n);
+  half->resize(n);
+  math::FloatToHalf(widened->data(), half->data(), n);
+  math::HalfToFloat(half->data(), widened->data(), n);
+}
+
+template <typename W>
+static void TestGemm(int M, int N, int K) {
+  platform::CPUDeviceContext context;
+  std::vector<W> half;
+  std::vector<float> w;
+  std::vector<float> out(M * N), expected(M * N);
+
+  // x[M, K] * w[K, N]
+  auto x = RandomVec(M * K);
+  RandomHalf(K * N, &half, &w);
+  RefGemm(M, N, K, x.data(), w.data(), expected.data());
+  math::GemmHalfB(context, M, N, K, x.data(), half.data(), out.data());
+  for (int i = 0; i < M * N; ++i) {
+    ASSERT_NEAR(out[i], expected[i], 1e-6 * K) << "at " << i;
+  }
+
+  // w[M, K] * x[K, N]
+  x = RandomVec(K * N);
+  RandomHalf(M * K, &half, &w);
+  RefGemm(M, N, K, w.data(), x.data(), expected.data());
+  math::GemmHalfA(context, M, N, K, half.data(), x.data(), out.data());
+  for (int i = 0; i < M * N; ++i) {
+    ASSERT_NEAR(out[i], expected[i], 1e-6 * K) << "at " << i;
+  }
+}
+
+TEST(HalfWeight, Gemm) {
+  // The small shapes, and the ones of several blocks of rows and columns.
+  TestGemm<platform::float16>(1, 1, 1);
+  TestGemm<platform::float16>(3, 7, 5);
+  TestGemm<platform::float16>(4, 1030, 300);
+  TestGemm<platform::bfloat16>(3, 7, 5);
+  TestGemm<platform::bfloat16>(4, 1030, 300);
+  TestGemm<platform::bfloat16>(70, 9, 5000);
+}
+
+TEST(HalfWeight, Tensor) {
+  platform::CPUDeviceContext context;
+  const int M = 2, N = 3, K = 4;
+  paddle::framework::Tensor weight;
+  auto* data = weight.mutable_data<platform::bfloat16>(
+      paddle::framework::make_ddim({2, K, N}), platform::CPUPlace());
+  for (int i = 0; i < 2 * K * N; ++i) data[i] = platform::bfloat16(i);
+  EXPECT_TRUE(math::IsHalfTensor(weight));
+
+  std::vector<float> widened(K * N);
+  math::WidenToFloat(weight, K * N, K * N, widened.data());
+  EXPECT_EQ(widened[0], K * N);
+  EXPECT_EQ(widened[K * N - 1], 2 * K * N - 1);
+
+  std::vector<float> a(M * K, 1.f), out(M * N), expected(M * N);
+  RefGemm(M, N, K, a.data(), widened.data(), expected.data());
+  math::GemmHalfB(context, M, N, K, a.data(), weight, K * N, out.data());
+  for (int i = 0; i < M * N; ++i) EXPECT_EQ(out[i], expected[i]);
+}
+
+static double TimeIt(const std::function<void()>& func) {
+  const int kRepeat = 20;
+  func();
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kRepeat; ++i) func();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count() /
+         kRepeat;
+}
+
+// Logs the time of the float gemm and the gemm of the FP16 and BF16
+// weights of a large fc, which is bound by the bandwidth of the weight for
+// the small batches. It checks nothing, run it with
+// --gtest_also_run_disabled_tests.
+TEST(HalfWeight, DISABLED_Benchmark) {
+  platform::CPUDeviceContext context;
+  const int N = 4096, K = 2048;
+  auto w = RandomVec(K * N);
+  std::vector<platform::float16> fp16(w.size());
+  std::vector<platform::bfloat16> bf16(w.size());
+  math::FloatToHalf(w.data(), fp16.data(), w.size());
+  math::FloatToHalf(w.data(), bf16.data(), w.size());
+  std::vector<float> widened(w.size());
+  LOG(INFO) << "widen " << K << "x" << N << ": fp16 " << TimeIt([&] {
+    math::HalfToFloat(fp16.data(), widened.data(), w.size());
+  }) << "us, bf16 " << TimeIt([&] {
+    math::HalfToFloat(bf16.data(), widened.data(), w.size());
+  }) << "us";
+
+  for (int M : {1, 16, 128}) {
+    auto a = RandomVec(M * K);
+    std::vector<float> out(M * N);
+    double fp32_time = TimeIt([&] {
+      math::gemm<platform::CPUDeviceContext, float>(
+          context, CblasNoTrans, CblasNoTrans, M, N, K, 1.0f, a.data(),
+          w.data(), 0.0f, out.data());
+    });
+    double fp16_time = TimeIt([&] {
+      math::GemmHalfB(context, M, N, K, a.data(), fp16.data(), out.data());
+    });
+    double bf16_time = TimeIt([&] {
+      math::GemmHalfB(context, M, N, K, a.data(), bf16.data(), out.data());
+    });
+    LOG(INFO) << "gemm " << M << "x" << K << "x" << N << ": fp32 "
+              << fp32_time << "us, fp16 " << fp16_time << "us, bf16 "
+              << bf16_time << "us";
+  }
+}
@@ -0,0 +1,62 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/lod_schedule.h"
+#include <algorithm>
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+std::vector<SequenceChunk> PartitionSequences(
+    const framework::Vector<size_t>& offsets, int64_t token_cost) {
+  std::vector<SequenceChunk> chunks;
+  if (offsets.size() < 2) return chunks;
+  const size_t* lod = offsets.data();
+  size_t num_seqs = offsets.size() - 1;
+  size_t total = lod[num_seqs] - lod[0];
+
+  int64_t work = static_cast<int64_t>(total) * std::max<int64_t>(1, token_cost);
+  int64_t max_chunks =
+      kSequenceChunksPerThread *
+      static_cast<int64_t>(framework::ThreadPool::GetInstance()->Threads());
+  size_t num_chunks = static_cast<size_t>(std::min<int64_t>(
+      std::min<int64_t>(work / kSequenceGrainSize, max_chunks), num_seqs));
+  if (num_chunks <= 1) {
+    chunks.push_back({0, num_seqs, total});
+    return chunks;
+  }
+
+  // Close a chunk when it reaches the prefix of the tokens it should end
+  // at, a sequence longer than a chunk makes a chunk by itself.
+  size_t begin = 0;
+  for (size_t k = 1; k <= num_chunks && begin < num_seqs; ++k) {
+    size_t target = lod[0] + total * k / num_chunks;
+    size_t end = begin + 1;
+    while (end < num_seqs && lod[end] < target) ++end;
+    if (k == num_chunks) end = num_seqs;
+    chunks.push_back({begin, end, lod[end] - lod[begin]});
+    begin = end;
+  }
+
+  std::stable_sort(chunks.begin(), chunks.end(),
+                   [](const SequenceChunk& a, const SequenceChunk& b) {
+                     return a.tokens > b.tokens;
+                   });
+  return chunks;
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,107 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <vector>
+#include "paddle/fluid/framework/mixed_vector.h"
+#include "paddle/fluid/framework/threadpool.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// Scheduling of the sequence ops over the sequences of a level of LoD.
+//
+// The sequences of a batch are of very different lengths, so one sequence
+// per task leaves the threads idle behind the long ones. The sequences are
+// partitioned into contiguous chunks of about equal numbers of tokens
+// instead, a chunk holds a single long sequence or many short ones, and
+// the chunks are run from the largest one on the threads of the framework
+// thread pool.
+
+// Elements per chunk below which the sequences are not split further.
+constexpr int64_t kSequenceGrainSize = 1 << 15;
+
+// Chunks per thread of the pool, more chunks balance the skewed lengths
+// better.
+constexpr int64_t kSequenceChunksPerThread = 4;
+
+// The sequences [begin, end) holding the rows [offsets[begin],
+// offsets[end]).
+struct SequenceChunk {
+  size_t begin;
+  size_t end;
+  size_t tokens;
+};
+
+// Partition the sequences of offsets, a level of LoD, into chunks for the
+// work of token_cost elements per token. The chunks are sorted by the
+// number of tokens in descending order, and a single chunk is returned if
+// the work is too small to be split.
+std::vector<SequenceChunk> PartitionSequences(
+    const framework::Vector<size_t>& offsets, int64_t token_cost);
+
+// Call func(chunk, i) for the i-th chunk of chunks on the threads of the
+// framework thread pool. The chunks with the same index always hold the
+// same sequences for the same offsets, so the partial results reduced in
+// the order of the chunks are deterministic.
+template <typename Func>
+void ParallelForChunks(const std::vector<SequenceChunk>& chunks, Func func) {
+  framework::ParallelFor(static_cast<int64_t>(chunks.size()), 1,
+                         [&](int64_t begin, int64_t end) {
+                           for (int64_t i = begin; i < end; ++i) {
+                             func(chunks[i], static_cast<size_t>(i));
+                           }
+                         });
+}
+
+// Call func(i) for every sequence i of offsets in parallel. func should
+// only write the rows of its own sequence.
+template <typename Func>
+void ParallelForSequences(const framework::Vector<size_t>& offsets,
+                          int64_t token_cost, Func func) {
+  ParallelForChunks(PartitionSequences(offsets, token_cost),
+                    [&func](const SequenceChunk& chunk, size_t) {
+                      for (size_t i = chunk.begin; i < chunk.end; ++i) {
+                        func(i);
+                      }
+                    });
+}
+
+// ForEachSequence<DeviceContext>::Run(offsets, token_cost, func) runs the
+// per-sequence loops of the kernels shared by the devices, in parallel on
+// CPU and in order on the other devices.
+template <typename DeviceContext>
+struct ForEachSequence {
+  template <typename Func>
+  static void Run(const framework::Vector<size_t>& offsets, int64_t token_cost,
+                  Func func) {
+    for (size_t i = 0; i + 1 < offsets.size(); ++i) func(i);
+  }
+};
+
+template <>
+struct ForEachSequence<platform::CPUDeviceContext> {
+  template <typename Func>
+  static void Run(const framework::Vector<size_t>& offsets, int64_t token_cost,
+                  Func func) {
+    ParallelForSequences(offsets, token_cost, func);
+  }
+};
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
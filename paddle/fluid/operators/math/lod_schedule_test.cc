@@ -0,0 +1,139 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/lod_schedule.h"
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace framework = paddle::framework;
+namespace math = paddle::operators::math;
+
+// The offsets of the sequences of skewed lengths, most of them are short
+// and a few are very long as the sentences of the text data.
+static framework::Vector<size_t> SkewedOffsets(size_t num_seqs,
+                                               size_t max_length) {
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<double> dist(0.0, 1.0);
+  std::vector<size_t> offsets(1, 0);
+  for (size_t i = 0; i < num_seqs; ++i) {
+    double u = dist(rng);
+    size_t length = 1 + static_cast<size_t>(max_length * u * u * u * u);
+    offsets.push_back(offsets.back() + length);
+  }
+  return framework::Vector<size_t>(offsets);
+}
+
+TEST(LoDSchedule, PartitionCoversSequences) {
+  auto offsets = SkewedOffsets(1000, 2000);
+  auto chunks = math::PartitionSequences(offsets, 64);
+  ASSERT_GT(chunks.size(), 1UL);
+
+  std::vector<int> visits(offsets.size() - 1, 0);
+  size_t tokens = 0;
+  for (size_t c = 0; c < chunks.size(); ++c) {
+    auto& chunk = chunks[c];
+    ASSERT_LT(chunk.begin, chunk.end);
+    EXPECT_EQ(chunk.tokens, offsets[chunk.end] - offsets[chunk.begin]);
+    if (c > 0) {
+      EXPECT_GE(chunks[c - 1].tokens, chunk.tokens);
+    }
+    for (size_t i = chunk.begin; i < chunk.end; ++i) ++visits[i];
+    tokens += chunk.tokens;
+  }
+  EXPECT_EQ(tokens, offsets.back());
+  for (int v : visits) ASSERT_EQ(v, 1);
+}
+
+TEST(LoDSchedule, PartitionIsBalanced) {
+  auto offsets = SkewedOffsets(1000, 2000);
+  auto chunks = math::PartitionSequences(offsets, 64);
+  size_t longest = 0;
+  for (size_t i = 0; i + 1 < offsets.size(); ++i) {
+    longest = std::max(longest, offsets[i + 1] - offsets[i]);
+  }
+  // A chunk ends at the first sequence reaching its share of the tokens,
+  // so it holds at most a share and a sequence.
+  size_t share = offsets.back() / chunks.size() + 1;
+  for (auto& chunk : chunks) EXPECT_LE(chunk.tokens, share + longest);
+}
+
+TEST(LoDSchedule, SmallWorkIsNotSplit) {
+  framework::Vector<size_t> offsets(std::vector<size_t>({0, 3, 4, 10}));
+  auto chunks = math::PartitionSequences(offsets, 8);
+  ASSERT_EQ(chunks.size(), 1UL);
+  EXPECT_EQ(chunks[0].begin, 0UL);
+  EXPECT_EQ(chunks[0].end, 3UL);
+  EXPECT_EQ(chunks[0].tokens, 10UL);
+
+  framework::Vector<size_t> empty(std::vector<size_t>({0}));
+  EXPECT_TRUE(math::PartitionSequences(empty, 8).empty());
+}
+
+TEST(LoDSchedule, ParallelForSequences) {
+  auto offsets = SkewedOffsets(5000, 500);
+  std::vector<std::atomic<int>> visits(offsets.size() - 1);
+  for (auto& v : visits) v = 0;
+  math::ParallelForSequences(offsets, 256, [&](size_t i) { ++visits[i]; });
+  for (auto& v : visits) ASSERT_EQ(v.load(), 1);
+}
+
+// Logs the tokens per second of a lookahead convolution of the width of
+// the row_conv op over the sequences of skewed lengths, run one sequence
+// after another and on the balanced chunks. It checks nothing, the
+// partition is checked by the tests above, run it with
+// --gtest_also_run_disabled_tests.
+TEST(LoDSchedule, DISABLED_Benchmark) {
+  const int64_t dim = 128, context = 4;
+  auto offsets = SkewedOffsets(1000, 1000);
+  size_t tokens = offsets.back();
+  std::vector<float> in(tokens * dim, 1.f), out(tokens * dim);
+  std::vector<float> weights(context * dim, 0.5f);
+  const size_t* lod = offsets.data();
+  auto conv = [&](size_t i) {
+    int64_t end = lod[i + 1];
+    for (int64_t k = lod[i]; k < end; ++k) {
+      float* cur_out = out.data() + k * dim;
+      std::fill(cur_out, cur_out + dim, 0.f);
+      for (int64_t w = 0; w < context && k + w < end; ++w) {
+        const float* cur_in = in.data() + (k + w) * dim;
+        for (int64_t d = 0; d < dim; ++d) {
+          cur_out[d] += weights[w * dim + d] * cur_in[d];
+        }
+      }
+    }
+  };
+  auto tokens_per_sec = [&](const std::function<void()>& func) {
+    const int kRepeat = 5;
+    func();
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < kRepeat; ++r) func();
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return tokens * kRepeat / seconds;
+  };
+  double serial = tokens_per_sec([&] {
+    for (size_t i = 0; i + 1 < offsets.size(); ++i) conv(i);
+  });
+  double parallel = tokens_per_sec(
+      [&] { math::ParallelForSequences(offsets, context * dim, conv); });
+  LOG(INFO) << tokens << " tokens in " << offsets.size() - 1
+            << " sequences: serial " << serial << " tokens/s, balanced "
+            << parallel << " tokens/s";
+}
@@ -13,7 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/math/math_function.h"
+#include <algorithm>
 #include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/threadpool.h"
+#include "paddle/fluid/operators/math/cpu_vec.h"
 #include "paddle/fluid/operators/math/math_function_impl.h"
 #include "paddle/fluid/platform/float16.h"
 
@@ -41,6 +44,15 @@ void gemm<platform::CPUDeviceContext, float>(
   int lda = (transA == CblasNoTrans) ? K : M;
   int ldb = (transB == CblasNoTrans) ? N : K;
   int ldc = N;
+#ifndef PADDLE_WITH_MKLML
+  // OpenBLAS packs A and B on every call, which dominates for the small
+  // matrices.
+  if (UseVecSmallGemm(M, N, K)) {
+    VecSmallGemm(transA == CblasTrans, transB == CblasTrans, M, N, K, alpha,
+                 A, lda, B, ldb, beta, C, ldc);
+    return;
+  }
+#endif
   cblas_sgemm(CblasRowMajor, transA, transB, M, N, K, alpha, A, lda, B, ldb,
               beta, C, ldc);
 }
@@ -211,16 +223,31 @@ void batched_gemm<platform::CPUDeviceContext, double>(
                     c_array.data(), &ldc, 1 /* group_count */, &batchCount);
 }
 #else
-// The below is a naive but correct serial implementation that just loops
-// over the batch dimension. This is a fallback for when the batched gemm
-// functions of Intel MKL are not available. In the future, this computation
-// should be parallelized.
+// The fallback for when the batched gemm functions of Intel MKL are not
+// available. The small matrices are multiplied by VecSmallGemm, split over
+// the batch dimension on the thread pool, the others loop over the batch
+// dimension with BLAS, which is threaded itself.
 template <>
 void batched_gemm<platform::CPUDeviceContext, float>(
     const platform::CPUDeviceContext& context, const CBLAS_TRANSPOSE transA,
     const CBLAS_TRANSPOSE transB, const int M, const int N, const int K,
     const float alpha, const float* A, const float* B, const float beta,
     float* C, const int batchCount, const int strideA, const int strideB) {
+  if (UseVecSmallGemm(M, N, K)) {
+    int lda = (transA == CblasNoTrans) ? K : M;
+    int ldb = (transB == CblasNoTrans) ? N : K;
+    // about 64K multiply-adds per task
+    int64_t grain = std::max<int64_t>(
+        1, (1 << 16) / std::max<int64_t>(1, static_cast<int64_t>(M) * N * K));
+    framework::ParallelFor(batchCount, grain, [&](int64_t begin, int64_t end) {
+      for (int64_t k = begin; k < end; ++k) {
+        VecSmallGemm(transA == CblasTrans, transB == CblasTrans, M, N, K,
+                     alpha, &A[k * strideA], lda, &B[k * strideB], ldb, beta,
+                     &C[k * M * N], N);
+      }
+    });
+    return;
+  }
   for (int k = 0; k < batchCount; ++k) {
     const float* Ak = &A[k * strideA];
     const float* Bk = &B[k * strideB];
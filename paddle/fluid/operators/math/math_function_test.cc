@@ -12,7 +12,12 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #include "paddle/fluid/operators/math/math_function.h"
+#include <chrono>
+#include <random>
+#include <vector>
+#include "glog/logging.h"
 #include "gtest/gtest.h"
+#include "paddle/fluid/operators/math/cpu_vec.h"
 
 TEST(math_function, gemm_notrans_cblas) {
   paddle::framework::Tensor input1;
@@ -165,3 +170,132 @@ TEST(math_funciton, set_constant) {
   }
   delete ctx;
 }
+
+static std::vector<float> RandomVec(size_t n) {
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  std::vector<float> x(n);
+  for (auto& v : x) v = dist(rng);
+  return x;
+}
+
+// The loop of cblas_sgemm, which batched_gemm replaces.
+static void BlasBatchedGemm(bool trans_a, bool trans_b, int m, int n, int k,
+                            const float* a, const float* b, float beta,
+                            float* c, int batch) {
+  for (int i = 0; i < batch; ++i) {
+    cblas_sgemm(CblasRowMajor, trans_a ? CblasTrans : CblasNoTrans,
+                trans_b ? CblasTrans : CblasNoTrans, m, n, k, 1.f,
+                a + i * m * k, trans_a ? m : k, b + i * k * n,
+                trans_b ? k : n, beta, c + i * m * n, n);
+  }
+}
+
+TEST(math_function, batched_gemm) {
+  paddle::platform::CPUDeviceContext context;
+  // the small shapes run on the small gemm kernel, with the tails of 1 to 3
+  // rows after the blocks of 4 and K up to its limit, the last one on BLAS
+  int shapes[][3] = {{1, 1, 1},   {4, 4, 4},    {5, 19, 11},
+                     {6, 3, 256}, {7, 9, 256},  {16, 16, 64},
+                     {33, 7, 40}, {128, 128, 300}};
+  const int batch = 7;
+  for (auto& shape : shapes) {
+    int m = shape[0], n = shape[1], k = shape[2];
+    auto a = RandomVec(batch * m * k);
+    auto b = RandomVec(batch * k * n);
+    for (bool trans_a : {false, true}) {
+      for (bool trans_b : {false, true}) {
+        for (float beta : {0.f, 1.f}) {
+          std::vector<float> out(batch * m * n, 0.5f);
+          std::vector<float> expected(batch * m * n, 0.5f);
+          paddle::operators::math::batched_gemm<
+              paddle::platform::CPUDeviceContext, float>(
+              context, trans_a ? CblasTrans : CblasNoTrans,
+              trans_b ? CblasTrans : CblasNoTrans, m, n, k, 1.f, a.data(),
+              b.data(), beta, out.data(), batch, m * k, k * n);
+          BlasBatchedGemm(trans_a, trans_b, m, n, k, a.data(), b.data(),
+                          beta, expected.data(), batch);
+          for (size_t i = 0; i < out.size(); ++i) {
+            ASSERT_NEAR(out[i], expected[i], 1e-3)
+                << m << "x" << n << "x" << k << " at " << i;
+          }
+        }
+      }
+    }
+  }
+}
+
+// VecSmallGemm against cblas_sgemm with alpha, beta and the leading
+// dimensions larger than the matrices.
+TEST(math_function, vec_small_gemm) {
+  int shapes[][3] = {{1, 1, 1}, {2, 5, 3},  {3, 8, 17},
+                     {4, 16, 64}, {5, 7, 128}, {7, 13, 256}};
+  const int pad = 3;
+  for (auto& shape : shapes) {
+    int m = shape[0], n = shape[1], k = shape[2];
+    for (bool trans_a : {false, true}) {
+      for (bool trans_b : {false, true}) {
+        int lda = (trans_a ? m : k) + pad, ldb = (trans_b ? k : n) + pad;
+        int ldc = n + pad;
+        auto a = RandomVec((trans_a ? k : m) * lda);
+        auto b = RandomVec((trans_b ? n : k) * ldb);
+        for (float beta : {0.f, 0.5f}) {
+          std::vector<float> out(m * ldc, 0.5f), expected(m * ldc, 0.5f);
+          paddle::operators::math::VecSmallGemm(trans_a, trans_b, m, n, k,
+                                                2.f, a.data(), lda, b.data(),
+                                                ldb, beta, out.data(), ldc);
+          cblas_sgemm(CblasRowMajor, trans_a ? CblasTrans : CblasNoTrans,
+                      trans_b ? CblasTrans : CblasNoTrans, m, n, k, 2.f,
+                      a.data(), lda, b.data(), ldb, beta, expected.data(),
+                      ldc);
+          for (size_t i = 0; i < out.size(); ++i) {
+            ASSERT_NEAR(out[i], expected[i], 1e-3)
+                << m << "x" << n << "x" << k << " at " << i;
+          }
+        }
+      }
+    }
+  }
+}
+
+// The time of a call in microseconds.
+template <typename Func>
+static double TimeIt(Func func) {
+  const int kRepeat = 10;
+  func();
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kRepeat; ++i) func();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count() /
+         kRepeat;
+}
+
+// Logs the time of batched_gemm and of the loop of cblas_sgemm of the BLAS
+// it is built with, OpenBLAS or MKL, on a grid of (M, N, K, batch). It
+// checks nothing, run it with --gtest_also_run_disabled_tests.
+TEST(math_function, DISABLED_batched_gemm_benchmark) {
+  paddle::platform::CPUDeviceContext context;
+  int shapes[][3] = {{4, 4, 4},    {16, 16, 16}, {16, 16, 64}, {16, 64, 16},
+                     {32, 32, 32}, {64, 64, 64}, {128, 128, 128}};
+  for (auto& shape : shapes) {
+    int m = shape[0], n = shape[1], k = shape[2];
+    for (int batch : {16, 1000}) {
+      auto a = RandomVec(batch * m * k);
+      auto b = RandomVec(batch * k * n);
+      std::vector<float> c(batch * m * n);
+      double blas = TimeIt([&] {
+        BlasBatchedGemm(false, false, m, n, k, a.data(), b.data(), 0.f,
+                        c.data(), batch);
+      });
+      double batched = TimeIt([&] {
+        paddle::operators::math::batched_gemm<
+            paddle::platform::CPUDeviceContext, float>(
+            context, CblasNoTrans, CblasNoTrans, m, n, k, 1.f, a.data(),
+            b.data(), 0.f, c.data(), batch, m * k, k * n);
+      });
+      LOG(INFO) << "M=" << m << " N=" << n << " K=" << k
+                << " batch=" << batch << " cblas_sgemm: " << blas
+                << "us, batched_gemm: " << batched << "us";
+    }
+  }
+}
@@ -0,0 +1,257 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/matrix_bit_code.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include "paddle/fluid/framework/threadpool.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+namespace {
+
+// Elements per task of the parallel loops.
+constexpr int64_t kBitCodeGrainSize = 1 << 16;
+
+// Columns per task of the weight gradients, the tasks update disjoint
+// columns of the rows of the weight, so the results are deterministic.
+constexpr int64_t kBitCodeColumnGrain = 16;
+
+// Call func(i) for every sample i, row_cost is the number of elements
+// touched per sample.
+template <typename Func>
+void ForEachSample(int64_t size, int64_t row_cost, Func func) {
+  int64_t grain =
+      std::max<int64_t>(1, kBitCodeGrainSize / std::max<int64_t>(1, row_cost));
+  framework::ParallelFor(size, grain, [&func](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) func(i);
+  });
+}
+
+}  // namespace
+
+template <typename T>
+MatrixBitCodeFunctor<T>::MatrixBitCodeFunctor(const framework::Tensor& ids,
+                                              int64_t num_classes)
+    : size_(ids.numel()),
+      num_classes_(num_classes),
+      max_code_length_(MaxCodeLength(num_classes)),
+      ids_(ids.data<int64_t>()),
+      path_table_(nullptr),
+      path_code_(nullptr) {
+  PADDLE_ENFORCE_GE(num_classes, 2, "num_classes should be at least 2");
+  for (int64_t i = 0; i < size_; ++i) {
+    PADDLE_ENFORCE(ids_[i] >= 0 && ids_[i] < num_classes,
+                   "The label %d is out of range [0, %d)", ids_[i],
+                   num_classes);
+  }
+}
+
+template <typename T>
+MatrixBitCodeFunctor<T>::MatrixBitCodeFunctor(
+    const framework::Tensor& path_table, const framework::Tensor& path_code)
+    : size_(path_table.dims()[0]),
+      num_classes_(0),
+      max_code_length_(static_cast<int>(path_table.dims()[1])),
+      ids_(nullptr),
+      path_table_(path_table.data<int64_t>()),
+      path_code_(path_code.data<int64_t>()) {
+  PADDLE_ENFORCE_EQ(path_table.dims(), path_code.dims(),
+                    "PathTable and PathCode should be of the same shape");
+}
+
+template <typename T>
+void MatrixBitCodeFunctor<T>::Add(const framework::Tensor& vec,
+                                  framework::Tensor* tmat) const {
+  const T* v = vec.data<T>();
+  T* t = tmat->data<T>();
+  int width = max_code_length_;
+  ForEachSample(size_, width, [&](int64_t i) {
+    Code code = GetCode(i);
+    for (int j = 0; j < code.length(); ++j) {
+      t[i * width + j] += v[code.index(j)];
+    }
+  });
+}
+
+template <typename T>
+void MatrixBitCodeFunctor<T>::AddGrad(const framework::Tensor& tmat,
+                                      framework::Tensor* vec) const {
+  const T* t = tmat.data<T>();
+  T* v = vec->data<T>();
+  int width = max_code_length_;
+  for (int64_t i = 0; i < size_; ++i) {
+    Code code = GetCode(i);
+    for (int j = 0; j < code.length(); ++j) {
+      v[code.index(j)] += t[i * width + j];
+    }
+  }
+}
+
+template <typename T>
+void MatrixBitCodeFunctor<T>::Mul(framework::Tensor* tmat,
+                                  const framework::Tensor& weight,
+                                  const framework::Tensor& input) const {
+  T* t = tmat->data<T>();
+  const T* w = weight.data<T>();
+  const T* x = input.data<T>();
+  int64_t dim = input.dims()[1];
+  PADDLE_ENFORCE_EQ(weight.dims()[1], dim);
+  int width = max_code_length_;
+  ForEachSample(size_, width * dim, [&](int64_t i) {
+    Code code = GetCode(i);
+    const T* xi = x + i * dim;
+    for (int j = 0; j < code.length(); ++j) {
+      const T* wj = w + code.index(j) * dim;
+      T dot = 0;
+      for (int64_t k = 0; k < dim; ++k) dot += wj[k] * xi[k];
+      t[i * width + j] += dot;
+    }
+  });
+}
+
+template <typename T>
+void MatrixBitCodeFunctor<T>::MulGradWeight(const framework::Tensor& tmat,
+                                            framework::Tensor* weight,
+                                            const framework::Tensor& input)
+    const {
+  const T* t = tmat.data<T>();
+  T* w = weight->data<T>();
+  const T* x = input.data<T>();
+  int64_t dim = input.dims()[1];
+  int width = max_code_length_;
+  framework::ParallelFor(
+      dim, kBitCodeColumnGrain, [&](int64_t begin, int64_t end) {
+        for (int64_t i = 0; i < size_; ++i) {
+          Code code = GetCode(i);
+          const T* xi = x + i * dim;
+          for (int j = 0; j < code.length(); ++j) {
+            T g = t[i * width + j];
+            T* wj = w + code.index(j) * dim;
+            for (int64_t k = begin; k < end; ++k) wj[k] += g * xi[k];
+          }
+        }
+      });
+}
+
+template <typename T>
+void MatrixBitCodeFunctor<T>::MulGradWeight(const framework::Tensor& tmat,
+                                            framework::SelectedRows* weight,
+                                            const framework::Tensor& input)
+    const {
+  std::vector<int64_t> rows = Rows();
+  std::unordered_map<int64_t, int64_t> positions;
+  for (size_t r = 0; r < rows.size(); ++r) positions[rows[r]] = r;
+
+  int width = max_code_length_;
+  std::vector<int64_t> pos(size_ * width, -1);
+  for (int64_t i = 0; i < size_; ++i) {
+    Code code = GetCode(i);
+    for (int j = 0; j < code.length(); ++j) {
+      pos[i * width + j] = positions[code.index(j)];
+    }
+  }
+
+  int64_t dim = input.dims()[1];
+  weight->set_rows(framework::Vector<int64_t>(rows));
+  auto* value = weight->mutable_value();
+  value->Resize({static_cast<int64_t>(rows.size()), dim});
+  T* w = value->mutable_data<T>(platform::CPUPlace());
+  std::memset(w, 0, sizeof(T) * value->numel());
+
+  const T* t = tmat.data<T>();
+  const T* x = input.data<T>();
+  framework::ParallelFor(
+      dim, kBitCodeColumnGrain, [&](int64_t begin, int64_t end) {
+        for (int64_t i = 0; i < size_; ++i) {
+          const T* xi = x + i * dim;
+          for (int j = 0; j < width && pos[i * width + j] >= 0; ++j) {
+            T g = t[i * width + j];
+            T* wj = w + pos[i * width + j] * dim;
+            for (int64_t k = begin; k < end; ++k) wj[k] += g * xi[k];
+          }
+        }
+      });
+}
+
+template <typename T>
+void MatrixBitCodeFunctor<T>::MulGradError(const framework::Tensor& tmat,
+                                           const framework::Tensor& weight,
+                                           framework::Tensor* input) const {
+  const T* t = tmat.data<T>();
+  const T* w = weight.data<T>();
+  T* x = input->data<T>();
+  int64_t dim = input->dims()[1];
+  int width = max_code_length_;
+  ForEachSample(size_, width * dim, [&](int64_t i) {
+    Code code = GetCode(i);
+    T* xi = x + i * dim;
+    for (int j = 0; j < code.length(); ++j) {
+      T g = t[i * width + j];
+      const T* wj = w + code.index(j) * dim;
+      for (int64_t k = 0; k < dim; ++k) xi[k] += g * wj[k];
+    }
+  });
+}
+
+template <typename T>
+void MatrixBitCodeFunctor<T>::Sum(const framework::Tensor& tmat,
+                                  framework::Tensor* sum, T scale) const {
+  const T* t = tmat.data<T>();
+  T* s = sum->data<T>();
+  int width = max_code_length_;
+  ForEachSample(size_, width, [&](int64_t i) {
+    Code code = GetCode(i);
+    T bits_sum = 0;
+    for (int j = 0; j < code.length(); ++j) {
+      if (code.bit(j)) bits_sum += t[i * width + j];
+    }
+    s[i] += scale * bits_sum;
+  });
+}
+
+template <typename T>
+void MatrixBitCodeFunctor<T>::Sub(framework::Tensor* tmat) const {
+  T* t = tmat->data<T>();
+  int width = max_code_length_;
+  ForEachSample(size_, width, [&](int64_t i) {
+    Code code = GetCode(i);
+    for (int j = 0; j < code.length(); ++j) {
+      if (code.bit(j)) t[i * width + j] -= 1;
+    }
+  });
+}
+
+template <typename T>
+std::vector<int64_t> MatrixBitCodeFunctor<T>::Rows() const {
+  std::vector<int64_t> rows;
+  rows.reserve(size_ * max_code_length_);
+  for (int64_t i = 0; i < size_; ++i) {
+    Code code = GetCode(i);
+    for (int j = 0; j < code.length(); ++j) rows.push_back(code.index(j));
+  }
+  std::sort(rows.begin(), rows.end());
+  rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+  return rows;
+}
+
+template class MatrixBitCodeFunctor<float>;
+template class MatrixBitCodeFunctor<double>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,156 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <vector>
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/framework/tensor.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The bit codes of the classes of the hierarchical sigmoid, ported from
+// paddle/math/MatrixBitCode.cpp.
+//
+// Every class is a leaf of a binary tree, its code is the path from the
+// root to the leaf: the j-th bit of the code tells which child is taken
+// at the j-th non-leaf node on the path, and the index of that node is
+// the row of the weight and the bias used for the j-th binary decision.
+//
+// By default the tree is the complete binary tree of num_classes leaves:
+// class c is encoded as c + num_classes, the nodes on its path are
+//   index(j) = ((c + num_classes) >> (j + 1)) - 1,
+//   bit(j)   = ((c + num_classes) >> j) & 1,
+// for j in [0, FindLastSet(c + num_classes) - 1). The weight has
+// num_classes - 1 rows then.
+//
+// A custom tree (e.g. a Huffman tree) is given by a path table and a path
+// code of shape [batch_size, max_code_length], the j-th column holds
+// index(j) and bit(j) of the class of the sample, and the path of a sample
+// ends at the first negative index.
+
+// The number of the bits of x, 0 if x is 0.
+inline int FindLastSet(uint64_t x) {
+  return x == 0 ? 0 : 64 - __builtin_clzll(x);
+}
+
+// The code of one sample.
+class Code {
+ public:
+  // The code of class id in the complete binary tree.
+  Code(int64_t id, int64_t num_classes)
+      : c_(static_cast<uint64_t>(id + num_classes)),
+        table_(nullptr),
+        bits_(nullptr),
+        length_(FindLastSet(c_) - 1) {}
+
+  // The code given by a row of the custom path table.
+  Code(const int64_t* table, const int64_t* bits, int max_length)
+      : c_(0), table_(table), bits_(bits), length_(0) {
+    while (length_ < max_length && table[length_] >= 0) ++length_;
+  }
+
+  int64_t index(int j) const {
+    return table_ ? table_[j] : static_cast<int64_t>(c_ >> (j + 1)) - 1;
+  }
+  bool bit(int j) const { return table_ ? bits_[j] != 0 : (c_ >> j) & 1; }
+  int length() const { return length_; }
+
+ private:
+  uint64_t c_;
+  const int64_t* table_;
+  const int64_t* bits_;
+  int length_;
+};
+
+// The matrix operations of the hierarchical sigmoid on the codes of a
+// batch. tmat is of shape [batch_size, max_code_length], its element
+// (i, j) is for the j-th node on the path of the i-th sample, the elements
+// beyond the length of the code are not touched.
+template <typename T>
+class MatrixBitCodeFunctor {
+ public:
+  // The codes of ids in the complete binary tree of num_classes leaves.
+  MatrixBitCodeFunctor(const framework::Tensor& ids, int64_t num_classes);
+
+  // The codes given by the custom path table and path code.
+  MatrixBitCodeFunctor(const framework::Tensor& path_table,
+                       const framework::Tensor& path_code);
+
+  int64_t size() const { return size_; }
+  int max_code_length() const { return max_code_length_; }
+
+  Code GetCode(int64_t i) const {
+    if (path_table_ != nullptr) {
+      return Code(path_table_ + i * max_code_length_,
+                  path_code_ + i * max_code_length_, max_code_length_);
+    }
+    return Code(ids_[i], num_classes_);
+  }
+
+  // The maximum code length of the complete binary tree.
+  static int MaxCodeLength(int64_t num_classes) {
+    return FindLastSet(num_classes - 1);
+  }
+
+  // tmat(i, j) += vec(0, index(i, j)), vec is the bias of shape
+  // [num_nodes, 1] or [1, num_nodes].
+  void Add(const framework::Tensor& vec, framework::Tensor* tmat) const;
+
+  // vec(0, index(i, j)) += tmat(i, j)
+  void AddGrad(const framework::Tensor& tmat, framework::Tensor* vec) const;
+
+  // tmat(i, j) += <weight.row(index(i, j)), input.row(i)>
+  void Mul(framework::Tensor* tmat, const framework::Tensor& weight,
+           const framework::Tensor& input) const;
+
+  // weight.row(index(i, j)) += tmat(i, j) * input.row(i)
+  void MulGradWeight(const framework::Tensor& tmat, framework::Tensor* weight,
+                     const framework::Tensor& input) const;
+
+  // The same as above, but weight only holds the rows of Rows(), its value
+  // is resized and zeroed.
+  void MulGradWeight(const framework::Tensor& tmat,
+                     framework::SelectedRows* weight,
+                     const framework::Tensor& input) const;
+
+  // input.row(i) += tmat(i, j) * weight.row(index(i, j))
+  void MulGradError(const framework::Tensor& tmat,
+                    const framework::Tensor& weight,
+                    framework::Tensor* input) const;
+
+  // sum(i, 0) += scale * \sum_j bit(i, j) * tmat(i, j)
+  void Sum(const framework::Tensor& tmat, framework::Tensor* sum,
+           T scale) const;
+
+  // tmat(i, j) -= bit(i, j)
+  void Sub(framework::Tensor* tmat) const;
+
+  // The sorted unique indices of the nodes on the paths of the batch.
+  std::vector<int64_t> Rows() const;
+
+ private:
+  int64_t size_;
+  int64_t num_classes_;
+  int max_code_length_;
+  const int64_t* ids_;
+  const int64_t* path_table_;
+  const int64_t* path_code_;
+};
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
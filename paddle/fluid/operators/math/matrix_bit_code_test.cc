@@ -0,0 +1,252 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/matrix_bit_code.h"
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <set>
+#include <vector>
+#include "paddle/fluid/operators/math/math_function.h"
+
+namespace framework = paddle::framework;
+namespace math = paddle::operators::math;
+namespace platform = paddle::platform;
+
+static void RandomFill(framework::Tensor* t, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  float* data = t->data<float>();
+  for (int64_t i = 0; i < t->numel(); ++i) data[i] = dist(rng);
+}
+
+static framework::Tensor RandomIds(int64_t n, int64_t num_classes) {
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<int64_t> dist(0, num_classes - 1);
+  framework::Tensor ids;
+  int64_t* data = ids.mutable_data<int64_t>({n, 1}, platform::CPUPlace());
+  for (int64_t i = 0; i < n; ++i) data[i] = dist(rng);
+  return ids;
+}
+
+static framework::Tensor Zeros(framework::DDim dims) {
+  framework::Tensor t;
+  float* data = t.mutable_data<float>(dims, platform::CPUPlace());
+  std::memset(data, 0, sizeof(float) * t.numel());
+  return t;
+}
+
+TEST(MatrixBitCode, CompleteTree) {
+  const int64_t num_classes = 6;
+  // 6 + 6 = 0b110: the nodes 2 and 0 from the leaf, taking the bits 0, 1.
+  math::Code code(0, num_classes);
+  ASSERT_EQ(code.length(), 2);
+  EXPECT_EQ(code.index(0), 2);
+  EXPECT_FALSE(code.bit(0));
+  EXPECT_EQ(code.index(1), 0);
+  EXPECT_TRUE(code.bit(1));
+
+  // Every class has a unique path of the nodes in [0, num_classes - 1)
+  // ending at the root.
+  for (int64_t n : {2, 3, 6, 7, 8, 1000}) {
+    int max_code_length = math::MatrixBitCodeFunctor<float>::MaxCodeLength(n);
+    std::set<std::vector<int64_t>> paths;
+    for (int64_t c = 0; c < n; ++c) {
+      math::Code code(c, n);
+      ASSERT_GE(code.length(), 1);
+      ASSERT_LE(code.length(), max_code_length);
+      std::vector<int64_t> path;
+      for (int j = 0; j < code.length(); ++j) {
+        ASSERT_GE(code.index(j), 0);
+        ASSERT_LT(code.index(j), n - 1);
+        path.push_back(code.index(j) * 2 + code.bit(j));
+      }
+      EXPECT_EQ(code.index(code.length() - 1), 0);
+      EXPECT_TRUE(paths.insert(path).second);
+    }
+  }
+}
+
+TEST(MatrixBitCode, CustomTable) {
+  // The paths of two samples in a tree of three non-leaf nodes.
+  framework::Tensor table, code;
+  int64_t* t = table.mutable_data<int64_t>({2, 3}, platform::CPUPlace());
+  int64_t* c = code.mutable_data<int64_t>({2, 3}, platform::CPUPlace());
+  const int64_t table_data[] = {0, 1, -1, 0, 2, 1};
+  const int64_t code_data[] = {1, 0, 0, 0, 1, 1};
+  std::copy(table_data, table_data + 6, t);
+  std::copy(code_data, code_data + 6, c);
+
+  math::MatrixBitCodeFunctor<float> bit_code(table, code);
+  ASSERT_EQ(bit_code.size(), 2);
+  ASSERT_EQ(bit_code.max_code_length(), 3);
+  EXPECT_EQ(bit_code.GetCode(0).length(), 2);
+  EXPECT_EQ(bit_code.GetCode(1).length(), 3);
+  EXPECT_EQ(bit_code.GetCode(1).index(2), 1);
+  EXPECT_TRUE(bit_code.GetCode(1).bit(2));
+  EXPECT_EQ(bit_code.Rows(), (std::vector<int64_t>{0, 1, 2}));
+
+  framework::Tensor tmat = Zeros({2, 3});
+  float* m = tmat.data<float>();
+  for (int i = 0; i < 6; ++i) m[i] = i + 1;
+  framework::Tensor sum = Zeros({2, 1});
+  bit_code.Sum(tmat, &sum, -1.f);
+  EXPECT_EQ(sum.data<float>()[0], -1.f);
+  EXPECT_EQ(sum.data<float>()[1], -11.f);
+  bit_code.Sub(&tmat);
+  const float expected[] = {0, 2, 3, 4, 4, 5};
+  for (int i = 0; i < 6; ++i) EXPECT_EQ(m[i], expected[i]) << "at " << i;
+}
+
+// The weight gradient of the sparse rows equals the rows of the dense one.
+TEST(MatrixBitCode, SparseWeightGrad) {
+  const int64_t num_classes = 1000, batch_size = 37, dim = 45;
+  auto ids = RandomIds(batch_size, num_classes);
+  math::MatrixBitCodeFunctor<float> bit_code(ids, num_classes);
+  int width = bit_code.max_code_length();
+
+  framework::Tensor input = Zeros({batch_size, dim});
+  framework::Tensor tmat = Zeros({batch_size, width});
+  RandomFill(&input, 1);
+  RandomFill(&tmat, 2);
+
+  framework::Tensor dense = Zeros({num_classes - 1, dim});
+  bit_code.MulGradWeight(tmat, &dense, input);
+  framework::SelectedRows sparse;
+  bit_code.MulGradWeight(tmat, &sparse, input);
+
+  auto rows = bit_code.Rows();
+  ASSERT_EQ(sparse.rows().size(), rows.size());
+  ASSERT_EQ(sparse.value().dims()[0], static_cast<int64_t>(rows.size()));
+  const float* d = dense.data<float>();
+  const float* s = sparse.value().data<float>();
+  std::vector<bool> touched(num_classes - 1, false);
+  for (size_t r = 0; r < rows.size(); ++r) {
+    ASSERT_EQ(sparse.rows()[r], rows[r]);
+    touched[rows[r]] = true;
+    for (int64_t k = 0; k < dim; ++k) {
+      ASSERT_EQ(s[r * dim + k], d[rows[r] * dim + k]);
+    }
+  }
+  for (int64_t r = 0; r < num_classes - 1; ++r) {
+    if (touched[r]) continue;
+    for (int64_t k = 0; k < dim; ++k) ASSERT_EQ(d[r * dim + k], 0.f);
+  }
+}
+
+// MulGradError is the transpose of Mul: <Mul(W, x), g> = <x, W^T g>.
+TEST(MatrixBitCode, MulGradError) {
+  const int64_t num_classes = 300, batch_size = 19, dim = 23;
+  auto ids = RandomIds(batch_size, num_classes);
+  math::MatrixBitCodeFunctor<float> bit_code(ids, num_classes);
+  int width = bit_code.max_code_length();
+
+  framework::Tensor weight = Zeros({num_classes - 1, dim});
+  framework::Tensor input = Zeros({batch_size, dim});
+  framework::Tensor grad = Zeros({batch_size, width});
+  RandomFill(&weight, 1);
+  RandomFill(&input, 2);
+  RandomFill(&grad, 3);
+
+  framework::Tensor tmat = Zeros({batch_size, width});
+  bit_code.Mul(&tmat, weight, input);
+  framework::Tensor input_grad = Zeros({batch_size, dim});
+  bit_code.MulGradError(grad, weight, &input_grad);
+
+  double lhs = 0, rhs = 0;
+  for (int64_t i = 0; i < batch_size; ++i) {
+    int length = bit_code.GetCode(i).length();
+    for (int j = 0; j < length; ++j) {
+      lhs += tmat.data<float>()[i * width + j] *
+             grad.data<float>()[i * width + j];
+    }
+    for (int64_t k = 0; k < dim; ++k) {
+      rhs += input.data<float>()[i * dim + k] *
+             input_grad.data<float>()[i * dim + k];
+    }
+  }
+  EXPECT_NEAR(lhs, rhs, 1e-3);
+}
+
+static double TimeIt(const std::function<void()>& func) {
+  const int kRepeat = 3;
+  func();
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kRepeat; ++i) func();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() /
+         kRepeat;
+}
+
+// Logs the time of the forward and backward of the hierarchical sigmoid
+// and the full softmax over vocabularies of 10k to 1M classes. It checks
+// nothing, run it with --gtest_also_run_disabled_tests.
+TEST(MatrixBitCode, DISABLED_BenchmarkAgainstSoftmax) {
+  const int64_t batch_size = 32, dim = 32;
+  platform::CPUDeviceContext ctx;
+  for (int64_t num_classes : {10000, 100000, 1000000}) {
+    framework::Tensor input = Zeros({batch_size, dim});
+    framework::Tensor weight = Zeros({num_classes, dim});
+    RandomFill(&input, 1);
+    RandomFill(&weight, 2);
+    auto ids = RandomIds(batch_size, num_classes);
+
+    math::MatrixBitCodeFunctor<float> bit_code(ids, num_classes);
+    int width = bit_code.max_code_length();
+    framework::Tensor pre_out = Zeros({batch_size, width});
+    framework::Tensor out = Zeros({batch_size, 1});
+    framework::Tensor input_grad = Zeros({batch_size, dim});
+    framework::SelectedRows weight_grad;
+    double hsigmoid = TimeIt([&] {
+      bit_code.Mul(&pre_out, weight, input);
+      bit_code.Sum(pre_out, &out, -1.f);
+      bit_code.Sub(&pre_out);
+      bit_code.MulGradWeight(pre_out, &weight_grad, input);
+      bit_code.MulGradError(pre_out, weight, &input_grad);
+    });
+
+    // logits = input * weight^T, the gradient of the cross entropy is
+    // softmax(logits) - onehot(ids), and the input gradient is
+    // logits_grad * weight. The dense weight gradient is left out.
+    framework::Tensor logits = Zeros({batch_size, num_classes});
+    double softmax = TimeIt([&] {
+      float* l = logits.data<float>();
+      math::gemm<platform::CPUDeviceContext, float>(
+          ctx, CblasNoTrans, CblasTrans, batch_size, num_classes, dim, 1.f,
+          input.data<float>(), weight.data<float>(), 0.f, l);
+      for (int64_t i = 0; i < batch_size; ++i) {
+        float* row = l + i * num_classes;
+        float max = *std::max_element(row, row + num_classes);
+        float sum = 0;
+        for (int64_t j = 0; j < num_classes; ++j) {
+          row[j] = std::exp(row[j] - max);
+          sum += row[j];
+        }
+        for (int64_t j = 0; j < num_classes; ++j) row[j] /= sum;
+        row[ids.data<int64_t>()[i]] -= 1.f;
+      }
+      math::gemm<platform::CPUDeviceContext, float>(
+          ctx, CblasNoTrans, CblasNoTrans, batch_size, dim, num_classes, 1.f,
+          l, weight.data<float>(), 0.f, input_grad.data<float>());
+    });
+    LOG(INFO) << "V = " << num_classes << ": hsigmoid " << hsigmoid
+              << " ms, softmax " << softmax << " ms, speedup "
+              << softmax / hsigmoid;
+  }
+}
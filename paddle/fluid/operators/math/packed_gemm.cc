@@ -0,0 +1,91 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/packed_gemm.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+namespace {
+
+// Packing is only supported by MKLML, the weight is used as is otherwise.
+template <typename T>
+T* PackWeight(const T* weight, int K, int N) {
+  return nullptr;
+}
+
+template <typename T>
+void FreePacked(T* packed) {}
+
+template <typename T>
+void PackedCompute(int M, int N, int K, const T* A, int lda, const T* packed,
+                   T* C, int ldc) {
+  PADDLE_THROW("Packed gemm is only supported for float with MKLML");
+}
+
+#ifdef PADDLE_WITH_MKLML
+float* PackWeight(const float* weight, int K, int N) {
+  float* packed = cblas_sgemm_alloc(CblasBMatrix, 1, N, K);
+  cblas_sgemm_pack(CblasRowMajor, CblasBMatrix, CblasNoTrans, 1, N, K, 1.0,
+                   weight, N, packed);
+  return packed;
+}
+
+void FreePacked(float* packed) { cblas_sgemm_free(packed); }
+
+void PackedCompute(int M, int N, int K, const float* A, int lda,
+                   const float* packed, float* C, int ldc) {
+  cblas_sgemm_compute(CblasRowMajor, CblasNoTrans, CblasPacked, M, N, K, A,
+                      lda, packed, N, 1.0, C, ldc);
+}
+#endif
+
+}  // namespace
+
+template <typename DeviceContext, typename T>
+PackedGemm<DeviceContext, T>::PackedGemm(const DeviceContext& context,
+                                         const T* weight, int K, int N)
+    : context_(context),
+      weight_(weight),
+      packed_(PackWeight(weight, K, N)),
+      K_(K),
+      N_(N) {}
+
+template <typename DeviceContext, typename T>
+PackedGemm<DeviceContext, T>::~PackedGemm() {
+  if (packed_ != nullptr) {
+    FreePacked(packed_);
+  }
+}
+
+template <typename DeviceContext, typename T>
+void PackedGemm<DeviceContext, T>::Compute(int M, const T* A, int lda, T* C,
+                                           int ldc) const {
+  if (M == 0) return;
+  if (packed_ != nullptr) {
+    PackedCompute(M, N_, K_, A, lda, packed_, C, ldc);
+  } else {
+    gemm<DeviceContext, T>(context_, false, false, M, N_, K_,
+                           static_cast<T>(1), A, lda, weight_, N_,
+                           static_cast<T>(1), C, ldc);
+  }
+}
+
+template class PackedGemm<platform::CPUDeviceContext, float>;
+template class PackedGemm<platform::CPUDeviceContext, double>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
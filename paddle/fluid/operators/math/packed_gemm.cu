@@ -0,0 +1,43 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/packed_gemm.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// cuBLAS has no packed gemm, the weight is used as is.
+template <typename DeviceContext, typename T>
+PackedGemm<DeviceContext, T>::PackedGemm(const DeviceContext& context,
+                                         const T* weight, int K, int N)
+    : context_(context), weight_(weight), packed_(nullptr), K_(K), N_(N) {}
+
+template <typename DeviceContext, typename T>
+PackedGemm<DeviceContext, T>::~PackedGemm() {}
+
+template <typename DeviceContext, typename T>
+void PackedGemm<DeviceContext, T>::Compute(int M, const T* A, int lda, T* C,
+                                           int ldc) const {
+  if (M == 0) return;
+  gemm<DeviceContext, T>(context_, false, false, M, N_, K_, static_cast<T>(1),
+                         A, lda, weight_, N_, static_cast<T>(1), C, ldc);
+}
+
+template class PackedGemm<platform::CUDADeviceContext, float>;
+template class PackedGemm<platform::CUDADeviceContext, double>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,52 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/macros.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// A K * N row-major weight multiplied by many small matrices, like the
+// recurrent weight of a RNN which is used once per time step.
+//
+// With MKLML a float weight is packed by cblas_sgemm_pack once, so the
+// time steps skip re-packing it, see also MKLPackedWeight of the legacy
+// gserver. Otherwise it falls back to gemm. The weight should not be
+// changed or freed while PackedGemm is alive.
+template <typename DeviceContext, typename T>
+class PackedGemm {
+ public:
+  PackedGemm(const DeviceContext& context, const T* weight, int K, int N);
+  ~PackedGemm();
+
+  // C = A * weight + C, A is M * K and C is M * N.
+  void Compute(int M, const T* A, int lda, T* C, int ldc) const;
+
+ private:
+  const DeviceContext& context_;
+  const T* weight_;
+  T* packed_;
+  int K_;
+  int N_;
+
+  DISABLE_COPY_AND_ASSIGN(PackedGemm);
+};
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
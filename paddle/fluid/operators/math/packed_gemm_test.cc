@@ -0,0 +1,63 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/packed_gemm.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+template <typename T>
+void TestPackedGemm(int M, int N, int K, int lda, int ldc) {
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceContext context(place);
+
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<T> dist(-1, 1);
+  std::vector<T> weight(K * N), a(M * lda), c(M * ldc);
+  for (auto& v : weight) v = dist(rng);
+  for (auto& v : a) v = dist(rng);
+  for (auto& v : c) v = dist(rng);
+
+  std::vector<T> expected(c);
+  for (int i = 0; i < M; ++i) {
+    for (int j = 0; j < N; ++j) {
+      for (int k = 0; k < K; ++k) {
+        expected[i * ldc + j] += a[i * lda + k] * weight[k * N + j];
+      }
+    }
+  }
+
+  paddle::operators::math::PackedGemm<paddle::platform::CPUDeviceContext, T>
+      packed(context, weight.data(), K, N);
+  // the packed weight is reused by the calls, like the time steps of a RNN
+  std::vector<T> out(c);
+  packed.Compute(M, a.data(), lda, out.data(), ldc);
+  packed.Compute(0, a.data(), lda, out.data(), ldc);
+  for (size_t i = 0; i < out.size(); ++i) {
+    EXPECT_NEAR(out[i], expected[i], 1e-4);
+  }
+  out = c;
+  packed.Compute(M, a.data(), lda, out.data(), ldc);
+  for (size_t i = 0; i < out.size(); ++i) {
+    EXPECT_NEAR(out[i], expected[i], 1e-4);
+  }
+}
+
+TEST(PackedGemm, Float) {
+  TestPackedGemm<float>(5, 16, 8, 8, 16);
+  // the recurrent projection of a GRU writes the first 2/3 of the gates
+  TestPackedGemm<float>(7, 20, 10, 10, 30);
+}
+
+TEST(PackedGemm, Double) { TestPackedGemm<double>(7, 20, 10, 10, 30); }
@@ -236,6 +236,10 @@ template class Pool2dGradFunctor<platform::CPUDeviceContext,
 template class Pool2dGradFunctor<platform::CPUDeviceContext,
                                  paddle::operators::math::AvgPoolGrad<double>,
                                  double>;
+template class Pool2dFunctor<platform::CPUDeviceContext,
+                             paddle::operators::math::MaxPool<int>, int>;
+template class Pool2dFunctor<platform::CPUDeviceContext,
+                             paddle::operators::math::AvgPool<int>, int>;
 
 /*
  * All tensors are in NCDHW format.
@@ -500,6 +504,10 @@ template class Pool3dGradFunctor<platform::CPUDeviceContext,
 template class Pool3dGradFunctor<platform::CPUDeviceContext,
                                  paddle::operators::math::AvgPoolGrad<double>,
                                  double>;
+template class Pool3dFunctor<platform::CPUDeviceContext,
+                             paddle::operators::math::MaxPool<int>, int>;
+template class Pool3dFunctor<platform::CPUDeviceContext,
+                             paddle::operators::math::AvgPool<int>, int>;
 
 /*
  * All tensors are in NCHW format.
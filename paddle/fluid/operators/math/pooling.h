@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #pragma once
+#include <climits>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/tensor.h"
 #include "paddle/fluid/platform/device_context.h"
@@ -44,6 +45,15 @@ class MaxPool {
   DEVICE inline void finalize(T& y, const T& pool_field) {}
 };
 
+// The int max pooling of the INT8 inference, -FLT_MAX overflows int.
+template <>
+class MaxPool<int> {
+ public:
+  DEVICE inline int initial() { return INT_MIN; }
+  DEVICE inline void compute(int& y, const int& x) { y = y > x ? y : x; }
+  DEVICE inline void finalize(int& y, const int& pool_field) {}
+};
+
 template <class T>
 class AvgPool {
  public:
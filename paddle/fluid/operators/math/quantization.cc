@@ -0,0 +1,68 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/quantization.h"
+#include <cstring>
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The rows of C are computed in blocks of kRowBlock, so a row of B is read
+// once for all of them. The innermost loop widens the int8 products to
+// int32 over contiguous columns, which the compiler vectorizes.
+static constexpr int kRowBlock = 4;
+
+void Int8Gemm(int M, int N, int K, const int8_t* A, int lda, const int8_t* B,
+              int ldb, int32_t* C, int ldc) {
+  for (int i = 0; i < M; ++i) {
+    std::memset(C + i * ldc, 0, N * sizeof(int32_t));
+  }
+  int i = 0;
+  for (; i + kRowBlock <= M; i += kRowBlock) {
+    int32_t* c0 = C + i * ldc;
+    int32_t* c1 = c0 + ldc;
+    int32_t* c2 = c1 + ldc;
+    int32_t* c3 = c2 + ldc;
+    for (int k = 0; k < K; ++k) {
+      const int8_t* b = B + k * ldb;
+      int32_t a0 = A[i * lda + k];
+      int32_t a1 = A[(i + 1) * lda + k];
+      int32_t a2 = A[(i + 2) * lda + k];
+      int32_t a3 = A[(i + 3) * lda + k];
+      for (int j = 0; j < N; ++j) {
+        int32_t b_val = b[j];
+        c0[j] += a0 * b_val;
+        c1[j] += a1 * b_val;
+        c2[j] += a2 * b_val;
+        c3[j] += a3 * b_val;
+      }
+    }
+  }
+  for (; i < M; ++i) {
+    int32_t* c = C + i * ldc;
+    for (int k = 0; k < K; ++k) {
+      int32_t a = A[i * lda + k];
+      if (a == 0) continue;
+      const int8_t* b = B + k * ldb;
+      for (int j = 0; j < N; ++j) {
+        c[j] += a * static_cast<int32_t>(b[j]);
+      }
+    }
+  }
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
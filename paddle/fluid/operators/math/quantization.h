@@ -0,0 +1,47 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The symmetric linear quantization of the INT8 inference: a float x is
+// stored as round(x * scale) clipped to [-127, 127], where scale is
+// 127 / max(|x|) of the calibrated range of x.
+constexpr float kInt8MaxValue = 127.0f;
+
+inline int8_t QuantizeToInt8(float x, float scale) {
+  float q = std::round(x * scale);
+  q = std::min(kInt8MaxValue, std::max(-kInt8MaxValue, q));
+  return static_cast<int8_t>(q);
+}
+
+// The scale which maps [-range, range] to [-127, 127].
+inline float Int8Scale(float range) {
+  return range > 0.0f ? kInt8MaxValue / range : 1.0f;
+}
+
+// C = A * B with int32 accumulation, A is M * K and B is K * N, both row
+// major int8.
+void Int8Gemm(int M, int N, int K, const int8_t* A, int lda, const int8_t* B,
+              int ldb, int32_t* C, int ldc);
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
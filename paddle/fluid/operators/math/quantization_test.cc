@@ -0,0 +1,58 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/quantization.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+using paddle::operators::math::Int8Gemm;
+using paddle::operators::math::Int8Scale;
+using paddle::operators::math::QuantizeToInt8;
+
+TEST(Quantization, QuantizeToInt8) {
+  float scale = Int8Scale(2.0f);
+  EXPECT_EQ(QuantizeToInt8(2.0f, scale), 127);
+  EXPECT_EQ(QuantizeToInt8(-2.0f, scale), -127);
+  EXPECT_EQ(QuantizeToInt8(1.0f, scale), 64);
+  EXPECT_EQ(QuantizeToInt8(0.0f, scale), 0);
+  // the values out of the calibrated range are clipped
+  EXPECT_EQ(QuantizeToInt8(10.0f, scale), 127);
+  EXPECT_EQ(QuantizeToInt8(-10.0f, scale), -127);
+  EXPECT_EQ(Int8Scale(0.0f), 1.0f);
+}
+
+TEST(Quantization, Int8Gemm) {
+  // 6 rows to cover both the row blocks and the rest rows
+  const int M = 6, N = 9, K = 13, lda = 15, ldc = 10;
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<int> dist(-127, 127);
+  std::vector<int8_t> a(M * lda), b(K * N);
+  for (auto& v : a) v = static_cast<int8_t>(dist(rng));
+  for (auto& v : b) v = static_cast<int8_t>(dist(rng));
+  std::vector<int32_t> c(M * ldc, -1);
+
+  Int8Gemm(M, N, K, a.data(), lda, b.data(), N, c.data(), ldc);
+  for (int i = 0; i < M; ++i) {
+    for (int j = 0; j < N; ++j) {
+      int32_t expected = 0;
+      for (int k = 0; k < K; ++k) {
+        expected += static_cast<int32_t>(a[i * lda + k]) * b[k * N + j];
+      }
+      EXPECT_EQ(c[i * ldc + j], expected);
+    }
+    // the padding of C is not touched
+    EXPECT_EQ(c[i * ldc + N], -1);
+  }
+}
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include <set>
+#include <unordered_map>
 
 #include "paddle/fluid/operators/math/math_function.h"
 #include "paddle/fluid/operators/math/selected_rows_functor.h"
@@ -189,10 +190,6 @@ template struct SelectedRowsAddToTensor<platform::CPUDeviceContext, int64_t>;
 // add or mul.
 namespace scatter {
 
-size_t FindPos(const std::vector<int64_t>& rows, int64_t value) {
-  return std::find(rows.begin(), rows.end(), value) - rows.begin();
-}
-
 template <typename T>
 struct MergeAdd<platform::CPUDeviceContext, T> {
   framework::SelectedRows operator()(const platform::CPUDeviceContext& context,
@@ -216,8 +213,16 @@ struct MergeAdd<platform::CPUDeviceContext, T> {
     auto* out_data = out.mutable_value()->data<T>();
     auto* input_data = input.value().data<T>();
 
+    // index of the merged rows, searching merge_rows for every input row
+    // is quadratic in the number of rows.
+    std::unordered_map<int64_t, size_t> row_pos;
+    row_pos.reserve(merge_rows.size());
+    for (size_t i = 0; i < merge_rows.size(); i++) {
+      row_pos[merge_rows[i]] = i;
+    }
+
     for (size_t i = 0; i < input_rows.size(); i++) {
-      size_t out_i = FindPos(merge_rows, input_rows[i]);
+      size_t out_i = row_pos[input_rows[i]];
       for (int64_t j = 0; j < input_width; j++) {
         out_data[out_i * input_width + j] += input_data[i * input_width + j];
       }
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/math/sequence2batch.h"
+#include <algorithm>
+#include "paddle/fluid/operators/math/lod_schedule.h"
 
 namespace paddle {
 namespace operators {
@@ -38,15 +40,22 @@ class CopyMatrixRowsFunctor<platform::CPUDeviceContext, T> {
     auto width = dst_dims[1];
     auto* src_data = src.data<T>();
     auto* dst_data = dst.data<T>();
-    for (int i = 0; i < height; ++i) {
-      if (is_src_index) {
-        memcpy(dst_data + i * width, src_data + index[i] * width,
-               width * sizeof(T));
-      } else {
-        memcpy(dst_data + index[i] * width, src_data + i * width,
-               width * sizeof(T));
+    // The indices are a permutation of the rows, so the rows are copied in
+    // parallel.
+    int64_t rows_per_task = std::max<int64_t>(
+        1, kSequenceGrainSize / std::max<int64_t>(1, width));
+    auto copy_rows = [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        if (is_src_index) {
+          memcpy(dst_data + i * width, src_data + index[i] * width,
+                 width * sizeof(T));
+        } else {
+          memcpy(dst_data + index[i] * width, src_data + i * width,
+                 width * sizeof(T));
+        }
       }
-    }
+    };
+    framework::ParallelFor(height, rows_per_task, copy_rows);
   }
 };
 
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/math/sequence_pooling.h"
+#include "paddle/fluid/operators/math/lod_schedule.h"
 #include "paddle/fluid/operators/math/math_function.h"
 
 namespace paddle {
@@ -51,12 +52,13 @@ class MaxSeqPoolFunctor {
 
     int64_t num_seq = out_dims[0];
     int64_t dim = output->numel() / num_seq;
-    for (int64_t i = 0; i < num_seq; ++i) {
+    const size_t* offsets = starts.data();
+    ParallelForSequences(starts, dim, [&](size_t i) {
       for (int64_t k = 0; k < dim; ++k) {
-        out_data[i * dim + k] = in_data[starts[i] * dim + k];
-        max_index[i * dim + k] = starts[i];
+        out_data[i * dim + k] = in_data[offsets[i] * dim + k];
+        max_index[i * dim + k] = offsets[i];
       }
-      for (size_t j = starts[i] + 1; j < starts[i + 1]; ++j) {
+      for (size_t j = offsets[i] + 1; j < offsets[i + 1]; ++j) {
         for (int64_t k = 0; k < dim; ++k) {
           if (in_data[j * dim + k] > out_data[i * dim + k]) {
             out_data[i * dim + k] = in_data[j * dim + k];
@@ -64,7 +66,7 @@ class MaxSeqPoolFunctor {
           }
         }
       }
-    }
+    });
   }
 };
 
@@ -115,14 +117,19 @@ class SequencePoolFunctor<platform::CPUDeviceContext, T> {
       max_pool(context, input, output, index);
       return;
     }
+    PADDLE_ENFORCE(pooltype == "AVERAGE" || pooltype == "SUM" ||
+                       pooltype == "SQRT" || pooltype == "LAST" ||
+                       pooltype == "FIRST",
+                   "unsupported pooling pooltype");
     auto lod = input.lod()[0];
     auto& place = *context.eigen_device();
-    for (int i = 0; i < static_cast<int>(lod.size()) - 1; ++i) {
-      Tensor in_t =
-          input.Slice(static_cast<int>(lod[i]), static_cast<int>(lod[i + 1]));
+    const size_t* offsets = lod.data();
+    int64_t w = input.numel() / input.dims()[0];
+    ParallelForSequences(lod, w, [&](size_t i) {
+      Tensor in_t = input.Slice(static_cast<int>(offsets[i]),
+                                static_cast<int>(offsets[i + 1]));
       Tensor out_t = output->Slice(i, i + 1);
-      int64_t h = static_cast<int64_t>(lod[i + 1] - lod[i]);
-      int64_t w = input.numel() / input.dims()[0];
+      int64_t h = static_cast<int64_t>(offsets[i + 1] - offsets[i]);
       auto in_e = EigenMatrix<T>::From(in_t, framework::make_ddim({h, w}));
       auto out_e = EigenVector<T>::Flatten(out_t);
       if (pooltype == "AVERAGE") {
@@ -139,7 +146,7 @@ class SequencePoolFunctor<platform::CPUDeviceContext, T> {
       } else {
         PADDLE_THROW("unsupported pooling pooltype");
       }
-    }
+    });
   }
 };
 
@@ -162,14 +169,19 @@ class SequencePoolGradFunctor<platform::CPUDeviceContext, T> {
       math::SetConstant<platform::CPUDeviceContext, T> functor;
       functor(context, in_grad, 0);
     }
+    PADDLE_ENFORCE(pooltype == "AVERAGE" || pooltype == "SUM" ||
+                       pooltype == "SQRT" || pooltype == "LAST" ||
+                       pooltype == "FIRST",
+                   "unsupported pooling pooltype");
     auto lod = in_grad->lod()[0];
     auto& place = *context.eigen_device();
-    for (int i = 0; i < static_cast<int>(lod.size()) - 1; ++i) {
-      auto in_g_t = in_grad->Slice(static_cast<int>(lod[i]),
-                                   static_cast<int>(lod[i + 1]));
+    const size_t* offsets = lod.data();
+    int64_t w = in_grad->numel() / in_grad->dims()[0];
+    ParallelForSequences(lod, w, [&](size_t i) {
+      auto in_g_t = in_grad->Slice(static_cast<int>(offsets[i]),
+                                   static_cast<int>(offsets[i + 1]));
       auto out_g_t = out_grad.Slice(i, i + 1);
-      int64_t h = static_cast<int64_t>(lod[i + 1] - lod[i]);
-      int64_t w = in_grad->numel() / in_grad->dims()[0];
+      int64_t h = static_cast<int64_t>(offsets[i + 1] - offsets[i]);
       auto in_g_e = EigenMatrix<T>::From(in_g_t, {h, w});
       auto out_g_e = EigenMatrix<T>::From(out_g_t, {1, w});
       auto out_g_e_v = EigenVector<T>::Flatten(out_g_t);
@@ -189,7 +201,7 @@ class SequencePoolGradFunctor<platform::CPUDeviceContext, T> {
       } else {
         PADDLE_THROW("unsupported pooling pooltype");
       }
-    }
+    });
   }
 };
 
@@ -13,12 +13,23 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/math/softmax.h"
+#include "paddle/fluid/operators/math/cpu_vec.h"
 #include "paddle/fluid/operators/math/softmax_impl.h"
 
 namespace paddle {
 namespace operators {
 namespace math {
 
+template <>
+void SoftmaxFunctor<platform::CPUDeviceContext, float>::operator()(
+    const platform::CPUDeviceContext& context, const framework::Tensor* X,
+    framework::Tensor* Y) {
+  PADDLE_ENFORCE_EQ(X->dims().size(), 2, "X should be a 2-D tensor");
+  int64_t rows = X->dims()[0];
+  int64_t cols = X->dims()[1];
+  VecSoftmax(rows, cols, X->data<float>(), Y->data<float>());
+}
+
 template class SoftmaxFunctor<platform::CPUDeviceContext, float>;
 template class SoftmaxFunctor<platform::CPUDeviceContext, double>;
 template class SoftmaxGradFunctor<platform::CPUDeviceContext, float>;
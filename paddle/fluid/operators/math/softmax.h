@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 #include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/device_context.h"
 
 namespace paddle {
 namespace operators {
@@ -26,6 +27,12 @@ class SoftmaxFunctor {
                   framework::Tensor* Y);
 };
 
+// The float CPU softmax runs the vectorized kernel of cpu_vec.h.
+template <>
+void SoftmaxFunctor<platform::CPUDeviceContext, float>::operator()(
+    const platform::CPUDeviceContext& context, const framework::Tensor* X,
+    framework::Tensor* Y);
+
 template <typename DeviceContext, typename T>
 class SoftmaxGradFunctor {
  public:
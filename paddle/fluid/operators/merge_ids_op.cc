@@ -0,0 +1,93 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/merge_ids_op.h"
+
+namespace paddle {
+namespace operators {
+
+class MergeIdsOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  MergeIdsOpMaker(OpProto *proto, OpAttrChecker *op_checker)
+      : OpProtoAndCheckerMaker(proto, op_checker) {
+    AddInput("Ids", "(LoDTensor) the original input ids, shape{batch_num, 1}")
+        .AsDuplicable();
+    AddInput("Rows",
+             "(LoDTensor) the de-duplicated ids sent to every shard, the "
+             "outputs of split_ids")
+        .AsDuplicable();
+    AddInput("X",
+             "(LoDTensor) the rows fetched from every shard, one row per id "
+             "in Rows")
+        .AsDuplicable();
+    AddOutput("Out", "(LoDTensor) the rows of every input Ids")
+        .AsDuplicable();
+
+    AddComment(R"DOC(
+Merge the rows fetched from the shards back into the order of the original
+ids, it is the inverse of split_ids.
+Example:
+  Input:
+    Ids = [1, 2, 1, 6]
+    Rows(2 shards):
+      rows0 = [2, 6]
+      rows1 = [1]
+    X:
+      x0 = [[0.2], [0.6]]
+      x1 = [[0.1]]
+
+  Out:
+    [[0.1], [0.2], [0.1], [0.6]]
+)DOC");
+  }
+};
+
+class MergeIdsOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext *ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInputs("Ids"), "MergeIdsOp must has input Ids.");
+    PADDLE_ENFORCE(ctx->HasInputs("Rows"), "MergeIdsOp must has input Rows.");
+    PADDLE_ENFORCE(ctx->HasInputs("X"), "MergeIdsOp must has input X.");
+    PADDLE_ENFORCE(ctx->HasOutputs("Out"), "MergeIdsOp must has output Out.");
+
+    for (auto &dims : ctx->GetInputsDim("Ids")) {
+      PADDLE_ENFORCE_EQ(dims.size(), 2);
+      PADDLE_ENFORCE_EQ(dims[1], 1);
+    }
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext &ctx) const override {
+    // the shards which receive no ids have no fetched rows.
+    for (auto *x : ctx.MultiInput<framework::LoDTensor>("X")) {
+      if (x->IsInitialized()) {
+        return framework::OpKernelType(framework::ToDataType(x->type()),
+                                       ctx.GetPlace());
+      }
+    }
+    PADDLE_THROW("MergeIdsOp has no initialized input X");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(merge_ids, ops::MergeIdsOp, ops::MergeIdsOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    merge_ids, ops::MergeIdsOpKernel<paddle::platform::CPUPlace, float>,
+    ops::MergeIdsOpKernel<paddle::platform::CPUPlace, double>);
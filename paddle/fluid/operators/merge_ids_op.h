@@ -0,0 +1,83 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace operators {
+
+template <typename DeviceContext, typename T>
+class MergeIdsOpKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &ctx) const override {
+    auto place = ctx.GetPlace();
+    if (!platform::is_cpu_place(place)) {
+      PADDLE_THROW("MergeIds do not support GPU kernel");
+    }
+
+    auto ids = ctx.MultiInput<framework::LoDTensor>("Ids");
+    auto rows = ctx.MultiInput<framework::LoDTensor>("Rows");
+    auto x = ctx.MultiInput<framework::LoDTensor>("X");
+    auto outs = ctx.MultiOutput<framework::LoDTensor>("Out");
+    PADDLE_ENFORCE_EQ(rows.size(), x.size(),
+                      "the number of Rows and X should be the same");
+    PADDLE_ENFORCE_EQ(ids.size(), outs.size(),
+                      "the number of Ids and Out should be the same");
+
+    // inverse index from id to the fetched row.
+    std::unordered_map<int64_t, const T *> id_to_row;
+    int64_t row_width = -1;
+    for (size_t i = 0; i < rows.size(); ++i) {
+      int64_t num_rows = rows[i]->numel();
+      if (num_rows == 0) continue;
+      PADDLE_ENFORCE_EQ(x[i]->dims()[0], num_rows,
+                        "X[%d] should have one row per id in Rows[%d]", i, i);
+      int64_t width = x[i]->numel() / num_rows;
+      PADDLE_ENFORCE(row_width == -1 || row_width == width,
+                     "rows fetched from all the shards should be of the "
+                     "same width");
+      row_width = width;
+      const int64_t *row_ids = rows[i]->data<int64_t>();
+      const T *x_data = x[i]->data<T>();
+      for (int64_t j = 0; j < num_rows; ++j) {
+        id_to_row[row_ids[j]] = x_data + j * row_width;
+      }
+    }
+
+    for (size_t i = 0; i < ids.size(); ++i) {
+      const int64_t *id_data = ids[i]->data<int64_t>();
+      int64_t num_ids = ids[i]->numel();
+      auto *out = outs[i];
+      out->set_lod(ids[i]->lod());
+      T *out_data = out->mutable_data<T>(
+          framework::make_ddim({num_ids, std::max<int64_t>(row_width, 0)}),
+          place);
+      for (int64_t j = 0; j < num_ids; ++j) {
+        auto it = id_to_row.find(id_data[j]);
+        PADDLE_ENFORCE(it != id_to_row.end(), "id %d is not fetched",
+                       id_data[j]);
+        memcpy(out_data + j * row_width, it->second, row_width * sizeof(T));
+      }
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -49,6 +49,16 @@ class MomentumOp : public framework::OperatorWithKernel {
 
     ctx->SetOutputDim("ParamOut", param_dim);
     ctx->SetOutputDim("VelocityOut", param_dim);
+    if (ctx->HasInput("RowStep")) {
+      ctx->SetOutputDim("RowStepOut", ctx->GetInputDim("RowStep"));
+    }
+  }
+
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext &ctx) const override {
+    // RowStep is int64, the kernel type follows Param.
+    auto data_type = framework::GetDataTypeOfVar(ctx.InputVar("Param"));
+    return framework::OpKernelType(data_type, ctx.device_context());
   }
 };
 
@@ -76,6 +86,13 @@ class MomentumOpMaker : public framework::OpProtoAndCheckerMaker {
     AddOutput("VelocityOut",
               "(Tensor) This output is updated velocity. "
               "It shared memory with Input(Velocity).");
+    AddInput("RowStep",
+             "(Tensor<int64>, optional) The step on which every row was last "
+             "updated by a sparse gradient, of shape [height + 1], the last "
+             "element counts the steps. Only used in the lazy sparse update.")
+        .AsDispensable();
+    AddOutput("RowStepOut", "(Tensor<int64>, optional) Output RowStep")
+        .AsDispensable();
 
     AddAttr<float>("mu", "(float) Momentum coefficient");
     AddAttr<bool>("use_nesterov",
@@ -96,6 +113,11 @@ else:   \\
   param = param - learning\_rate * velocity. \\
 $$
 
+If Grad is SelectedRows, only the rows in it are updated (the lazy mode), and
+the cost of a step is proportional to the number of the unique rows. With
+RowStep, the decay of the moments on the steps a row was skipped is applied
+when the row is updated again.
+
 )DOC");
   }
 };
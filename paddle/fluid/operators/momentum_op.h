@@ -15,6 +15,7 @@ limitations under the License. */
 #pragma once
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/lazy_sparse_update.h"
 
 namespace paddle {
 namespace operators {
@@ -27,7 +28,6 @@ class MomentumOpKernel : public framework::OpKernel<T> {
     auto velocity_out = ctx.Output<framework::Tensor>("VelocityOut");
     auto param = ctx.Input<framework::Tensor>("Param");
     auto velocity = ctx.Input<framework::Tensor>("Velocity");
-    auto grad = ctx.Input<framework::Tensor>("Grad");
     auto learning_rate = ctx.Input<framework::Tensor>("LearningRate");
 
     param_out->mutable_data<T>(ctx.GetPlace());
@@ -36,6 +36,15 @@ class MomentumOpKernel : public framework::OpKernel<T> {
     T mu = static_cast<T>(ctx.Attr<float>("mu"));
     bool use_nesterov = ctx.Attr<bool>("use_nesterov");
 
+    auto* grad_var = ctx.InputVar("Grad");
+    if (grad_var->IsType<framework::SelectedRows>()) {
+      LazyUpdate(ctx, grad_var->Get<framework::SelectedRows>(), *param,
+                 *velocity, learning_rate->data<T>()[0], mu, use_nesterov,
+                 param_out, velocity_out);
+      return;
+    }
+    auto grad = ctx.Input<framework::Tensor>("Grad");
+
     auto p_out = framework::EigenVector<T>::Flatten(*param_out);
     auto v_out = framework::EigenVector<T>::Flatten(*velocity_out);
 
@@ -51,6 +60,57 @@ class MomentumOpKernel : public framework::OpKernel<T> {
       p_out = p - lr[0] * v_out;
     }
   }
+
+ private:
+  // Only the rows of the merged gradient are updated, in parallel. If
+  // RowStep is set, the velocity of a row skipped for k steps is decayed by
+  // mu^k and the parameter is moved by the velocity of those steps when it
+  // is touched again.
+  void LazyUpdate(const framework::ExecutionContext& ctx,
+                  const framework::SelectedRows& grad,
+                  const framework::Tensor& param,
+                  const framework::Tensor& velocity, T lr, T mu,
+                  bool use_nesterov, framework::Tensor* param_out,
+                  framework::Tensor* velocity_out) const {
+    int64_t height = param.dims()[0];
+    // the step is counted even if no row is updated on it.
+    RowStep row_step(GetRowStep(ctx), height);
+    if (grad.rows().size() == 0) return;
+    auto grad_merge = MergeSparseGrad<T>(
+        ctx.template device_context<platform::CPUDeviceContext>(), grad);
+    const int64_t* rows = grad_merge.rows().data();
+    int64_t num_rows = grad_merge.rows().size();
+    int64_t row_numel = grad_merge.value().numel() / num_rows;
+    for (int64_t i = 0; i < num_rows; ++i) {
+      PADDLE_ENFORCE_LT(rows[i], height,
+                        "Input rows index should less than height");
+    }
+
+    const T* g = grad_merge.value().template data<T>();
+    const T* p = param.data<T>();
+    const T* v = velocity.data<T>();
+    T* p_out = param_out->data<T>();
+    T* v_out = velocity_out->data<T>();
+    ParallelForRows(num_rows, row_numel, [&](int64_t i) {
+      int64_t skipped = row_step.Touch(rows[i]);
+      // the velocity is decayed by mu on every skipped step, and the
+      // parameter is moved by -lr * velocity (by lr * mu * velocity with
+      // nesterov) on each of them.
+      T decay = std::pow(mu, static_cast<T>(skipped));
+      T moved = GeometricSum(mu, skipped);
+      if (use_nesterov) moved *= -mu;
+      int64_t offset = rows[i] * row_numel;
+      for (int64_t j = 0; j < row_numel; ++j) {
+        T v_old = v[offset + j];
+        T p_new = p[offset + j] - lr * moved * v_old;
+        T g_val = g[i * row_numel + j];
+        T v_new = decay * v_old * mu + g_val;
+        v_out[offset + j] = v_new;
+        p_out[offset + j] = use_nesterov ? p_new - (g_val - v_new * mu) * lr
+                                         : p_new - lr * v_new;
+      }
+    });
+  }
 };
 
 }  // namespace operators
@@ -14,7 +14,9 @@ limitations under the License. */
 
 #pragma once
 
+#include "paddle/fluid/operators/math/half_weight.h"
 #include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/operators/math/quantization.h"
 
 #include "paddle/fluid/framework/op_registry.h"
 
@@ -46,15 +48,46 @@ class MulKernel : public framework::OpKernel<T> {
     if (z_dim.size() != 2) {
       z->Resize({x_matrix.dims()[0], y_matrix.dims()[1]});
     }
-    math::matmul<DeviceContext, T>(
-        context.template device_context<DeviceContext>(), x_matrix, false,
-        y_matrix, false, static_cast<T>(1), z, static_cast<T>(0));
+    auto& dev_ctx = context.template device_context<DeviceContext>();
+    if (!math::HalfWeightMatMul<DeviceContext, T>::WeightRight(
+            dev_ctx, static_cast<int>(x_matrix.dims()[0]),
+            static_cast<int>(y_matrix.dims()[1]),
+            static_cast<int>(x_matrix.dims()[1]), x_matrix.data<T>(), *y, 0,
+            z->data<T>())) {
+      math::matmul<DeviceContext, T>(dev_ctx, x_matrix, false, y_matrix, false,
+                                     static_cast<T>(1), z, static_cast<T>(0));
+    }
     if (z_dim.size() != 2) {
       z->Resize(z_dim);
     }
   }
 };
 
+// The CPU kernel of the INT8 inference. X and Y are quantized to int8 and
+// Out is their int32 product, which is scaled back to float by the
+// dequantize op.
+class MulInt8Kernel : public framework::OpKernel<int8_t> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    const Tensor* x = context.Input<Tensor>("X");
+    const Tensor* y = context.Input<Tensor>("Y");
+    Tensor* z = context.Output<Tensor>("Out");
+    auto x_dims = framework::flatten_to_2d(
+        x->dims(), context.template Attr<int>("x_num_col_dims"));
+    auto y_dims = framework::flatten_to_2d(
+        y->dims(), context.template Attr<int>("y_num_col_dims"));
+
+    int M = static_cast<int>(x_dims[0]);
+    int K = static_cast<int>(x_dims[1]);
+    int N = static_cast<int>(y_dims[1]);
+    PADDLE_ENFORCE_EQ(K, y_dims[0], "First matrix's width must be equal with "
+                                    "second matrix's height.");
+    int32_t* z_data = z->mutable_data<int32_t>(context.GetPlace());
+    math::Int8Gemm(M, N, K, x->data<int8_t>(), K, y->data<int8_t>(), N, z_data,
+                   N);
+  }
+};
+
 template <typename DeviceContext, typename T>
 class MulGradKernel : public framework::OpKernel<T> {
  public:
@@ -12,8 +12,11 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <algorithm>
+#include <cstring>
 #include <future>  // NOLINT
 #include <ostream>
+#include <unordered_map>
 
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/lod_tensor.h"
@@ -48,6 +51,15 @@ class PrefetchOp : public framework::OperatorBase {
     auto* client_var = scope.FindVar(client_var_name);
     detail::RPCClient* rpc_client = client_var->GetMutable<detail::RPCClient>();
 
+    int cache_size = Attr<int>("cache_size");
+    if (cache_size > 0) {
+      auto* cache = rpc_client->GetRowCache(
+          outs.front(), static_cast<size_t>(cache_size),
+          static_cast<int64_t>(Attr<int>("cache_staleness")));
+      RunWithCache(scope, ctx, rpc_client, cache);
+      return;
+    }
+
     for (size_t i = 0; i < ins.size(); i++) {
       if (NeedSend(scope, ins[i])) {
         VLOG(3) << "sending " << ins[i] << " to " << epmap[i] << " to get "
@@ -60,6 +72,93 @@ class PrefetchOp : public framework::OperatorBase {
     }
     PADDLE_ENFORCE(rpc_client->Wait());
   }
+
+ private:
+  // Only the ids missing in the cache are sent, they are prefetched into a
+  // local scope and the outputs are assembled from the cached rows and the
+  // fetched rows.
+  void RunWithCache(const framework::Scope& scope,
+                    const platform::DeviceContext& ctx,
+                    detail::RPCClient* rpc_client,
+                    detail::PrefetchRowCache* cache) const {
+    auto ins = Inputs("X");
+    auto outs = Outputs("Out");
+    auto epmap = Attr<std::vector<std::string>>("epmap");
+    PADDLE_ENFORCE(platform::is_cpu_place(ctx.GetPlace()),
+                   "prefetch cache only supports CPUPlace");
+
+    cache->NextVersion();
+    framework::Scope& local_scope = scope.NewScope();
+    std::vector<std::vector<int64_t>> misses(ins.size());
+    for (size_t i = 0; i < ins.size(); i++) {
+      if (!NeedSend(scope, ins[i])) {
+        VLOG(3) << "don't send no-initialied variable: " << ins[i];
+        continue;
+      }
+      auto& ids = scope.FindVar(ins[i])->Get<framework::LoDTensor>();
+      const int64_t* ids_data = ids.data<int64_t>();
+      for (int64_t j = 0; j < ids.numel(); ++j) {
+        if (cache->Get(ids_data[j]) == nullptr) {
+          misses[i].push_back(ids_data[j]);
+        }
+      }
+      VLOG(3) << ins[i] << ": " << misses[i].size() << " of " << ids.numel()
+              << " ids missed in the prefetch cache";
+      if (misses[i].empty()) continue;
+
+      auto* miss_ids =
+          local_scope.Var(ins[i])->GetMutable<framework::LoDTensor>();
+      int64_t* miss_data = miss_ids->mutable_data<int64_t>(
+          framework::make_ddim({static_cast<int64_t>(misses[i].size()), 1}),
+          ctx.GetPlace());
+      std::copy(misses[i].begin(), misses[i].end(), miss_data);
+      local_scope.Var(outs[i]);
+      rpc_client->AsyncPrefetchVariable(epmap[i], ctx, local_scope, ins[i],
+                                        outs[i]);
+    }
+    PADDLE_ENFORCE(rpc_client->Wait());
+
+    std::vector<std::unordered_map<int64_t, const float*>> fetched_rows(
+        ins.size());
+    std::vector<int64_t> widths(ins.size(), cache->Width());
+    for (size_t i = 0; i < ins.size(); i++) {
+      if (!NeedSend(scope, ins[i])) continue;
+      auto& ids = scope.FindVar(ins[i])->Get<framework::LoDTensor>();
+      const int64_t* ids_data = ids.data<int64_t>();
+
+      int64_t width = widths[i];
+      if (!misses[i].empty()) {
+        auto& fetched =
+            local_scope.FindVar(outs[i])->Get<framework::LoDTensor>();
+        width = fetched.numel() / static_cast<int64_t>(misses[i].size());
+        widths[i] = width;
+        const float* fetched_data = fetched.data<float>();
+        for (size_t j = 0; j < misses[i].size(); ++j) {
+          fetched_rows[i][misses[i][j]] = fetched_data + j * width;
+        }
+      }
+
+      auto* out = scope.FindVar(outs[i])->GetMutable<framework::LoDTensor>();
+      float* out_data = out->mutable_data<float>(
+          framework::make_ddim({ids.numel(), std::max<int64_t>(width, 0)}),
+          ctx.GetPlace());
+      for (int64_t j = 0; j < ids.numel(); ++j) {
+        auto it = fetched_rows[i].find(ids_data[j]);
+        const float* row =
+            it != fetched_rows[i].end() ? it->second : cache->Get(ids_data[j]);
+        PADDLE_ENFORCE_NOT_NULL(row, "row %d is not prefetched", ids_data[j]);
+        std::memcpy(out_data + j * width, row, width * sizeof(float));
+      }
+    }
+    // fill the cache only after every output is assembled, the rows put may
+    // evict the hits of this batch, including those of the other inputs.
+    for (size_t i = 0; i < ins.size(); i++) {
+      for (auto& fetched_row : fetched_rows[i]) {
+        cache->Put(fetched_row.first, fetched_row.second, widths[i]);
+      }
+    }
+    const_cast<framework::Scope&>(scope).DeleteScope(&local_scope);
+  }
 };
 
 class PrefetchOpMaker : public framework::OpProtoAndCheckerMaker {
@@ -79,11 +178,25 @@ class PrefetchOpMaker : public framework::OpProtoAndCheckerMaker {
         "(string vector, default 127.0.0.1:6164)"
         "Server endpoints in the order of input variables for mapping")
         .SetDefault({"127.0.0.1:6164"});
+    AddAttr<int>("cache_size",
+                 "(int, default 0)"
+                 "The number of rows cached on the trainer, 0 to disable "
+                 "the cache.")
+        .SetDefault(0);
+    AddAttr<int>("cache_staleness",
+                 "(int, default 1)"
+                 "A cached row is fetched again after it has been cached "
+                 "for more than cache_staleness mini-batches.")
+        .SetDefault(1);
     AddComment(R"DOC(
 Prefetch operator
 
 This operator will send Ids variables to listen_and_serve op at
 the parameter server and fetch result back.
+
+If cache_size is positive, the fetched float rows are kept in an LRU cache
+on the trainer and only the ids missing in it, or cached for more than
+cache_staleness mini-batches, are sent.
 )DOC");
   }
 };
@@ -0,0 +1,124 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/quantize_op.h"
+
+namespace paddle {
+namespace operators {
+
+class QuantizeOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("X"),
+                   "Input(X) of QuantizeOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("Out"),
+                   "Output(Out) of QuantizeOp should not be null.");
+    ctx->SetOutputDim("Out", ctx->GetInputDim("X"));
+    ctx->ShareLoD("X", "Out");
+  }
+};
+
+class QuantizeOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  QuantizeOpMaker(OpProto* proto, OpAttrChecker* op_checker)
+      : OpProtoAndCheckerMaker(proto, op_checker) {
+    AddInput("X", "(Tensor) The float input of quantize op.");
+    AddOutput("Out", "(Tensor) The int8 output of quantize op.");
+    AddAttr<float>("scale",
+                   "(float) The scale which maps the calibrated range "
+                   "[-r, r] of X to [-127, 127], that is 127 / r.")
+        .GreaterThan(0.0f);
+    AddComment(R"DOC(
+Quantize Operator.
+
+Quantize the float input to int8 by the symmetric linear quantization of the
+INT8 inference:
+
+$$Out = clip(round(X * scale), -127, 127)$$
+
+)DOC");
+  }
+};
+
+class DequantizeOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("X"),
+                   "Input(X) of DequantizeOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("Out"),
+                   "Output(Out) of DequantizeOp should not be null.");
+    ctx->SetOutputDim("Out", ctx->GetInputDim("X"));
+    ctx->ShareLoD("X", "Out");
+  }
+
+ protected:
+  // Scale is always float, the kernel is decided by the integer X.
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        framework::ToDataType(ctx.Input<framework::Tensor>("X")->type()),
+        ctx.GetPlace());
+  }
+};
+
+class DequantizeOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  DequantizeOpMaker(OpProto* proto, OpAttrChecker* op_checker)
+      : OpProtoAndCheckerMaker(proto, op_checker) {
+    AddInput("X",
+             "(Tensor) The int8 input, or the int32 output of an INT8 "
+             "kernel.");
+    AddInput("Scale",
+             "(Tensor, optional) The float scales of the channels of X, the "
+             "per-channel scales of the quantized weight of the INT8 kernel.")
+        .AsDispensable();
+    AddOutput("Out", "(Tensor) The float output of dequantize op.");
+    AddAttr<float>("scale", "(float) The scale of the quantized input.")
+        .GreaterThan(0.0f);
+    AddAttr<int>("axis",
+                 "(int, default 1) The first dim of the channels of X, X is "
+                 "viewed as [pre, C, post] where C is the size of Scale.")
+        .SetDefault(1);
+    AddComment(R"DOC(
+Dequantize Operator.
+
+Dequantize the int8 or int32 input back to float. The product of an input
+quantized by scale and a weight quantized by Scale[c] per output channel is
+scaled by both of them:
+
+$$Out = X / (scale * Scale[c])$$
+
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(quantize, ops::QuantizeOp, ops::QuantizeOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+REGISTER_OPERATOR(dequantize, ops::DequantizeOp, ops::DequantizeOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    quantize, ops::QuantizeKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::QuantizeKernel<paddle::platform::CPUDeviceContext, double>);
+REGISTER_OP_CPU_KERNEL(
+    dequantize,
+    ops::DequantizeKernel<paddle::platform::CPUDeviceContext, int8_t>,
+    ops::DequantizeKernel<paddle::platform::CPUDeviceContext, int>);
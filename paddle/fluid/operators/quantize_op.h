@@ -0,0 +1,84 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/quantization.h"
+
+namespace paddle {
+namespace operators {
+
+template <typename DeviceContext, typename T>
+class QuantizeKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* x = ctx.Input<framework::Tensor>("X");
+    auto* out = ctx.Output<framework::Tensor>("Out");
+    float scale = ctx.Attr<float>("scale");
+
+    const T* x_data = x->data<T>();
+    int8_t* out_data = out->mutable_data<int8_t>(ctx.GetPlace());
+    for (int64_t i = 0; i < x->numel(); ++i) {
+      out_data[i] = math::QuantizeToInt8(static_cast<float>(x_data[i]), scale);
+    }
+  }
+};
+
+template <typename DeviceContext, typename T>
+class DequantizeKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* x = ctx.Input<framework::Tensor>("X");
+    auto* channel_scale = ctx.Input<framework::Tensor>("Scale");
+    auto* out = ctx.Output<framework::Tensor>("Out");
+    float scale = ctx.Attr<float>("scale");
+    int axis = ctx.Attr<int>("axis");
+
+    const T* x_data = x->data<T>();
+    float* out_data = out->mutable_data<float>(ctx.GetPlace());
+    if (channel_scale == nullptr) {
+      for (int64_t i = 0; i < x->numel(); ++i) {
+        out_data[i] = static_cast<float>(x_data[i]) / scale;
+      }
+      return;
+    }
+
+    // x is viewed as [pre, channels, post], where pre is the product of the
+    // dims before axis.
+    auto dims = x->dims();
+    PADDLE_ENFORCE(axis >= 0 && axis < dims.size(),
+                   "axis should be in [0, %d)", dims.size());
+    int64_t channels = channel_scale->numel();
+    int64_t pre = framework::product(framework::slice_ddim(dims, 0, axis));
+    PADDLE_ENFORCE_EQ(x->numel() % (pre * channels), 0,
+                      "The dims after axis should be divisible by the "
+                      "number of the channel scales");
+    int64_t post = x->numel() / (pre * channels);
+    const float* channel_data = channel_scale->data<float>();
+    for (int64_t i = 0; i < pre; ++i) {
+      for (int64_t c = 0; c < channels; ++c) {
+        float inv_scale = 1.0f / (scale * channel_data[c]);
+        int64_t offset = (i * channels + c) * post;
+        for (int64_t j = 0; j < post; ++j) {
+          out_data[offset + j] =
+              static_cast<float>(x_data[offset + j]) * inv_scale;
+        }
+      }
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
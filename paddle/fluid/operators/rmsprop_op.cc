@@ -58,6 +58,16 @@ class RmspropOp : public framework::OperatorWithKernel {
     ctx->SetOutputDim("ParamOut", param_dim);
     ctx->SetOutputDim("MomentOut", param_dim);
     ctx->SetOutputDim("MeanSquareOut", param_dim);
+    if (ctx->HasInput("RowStep")) {
+      ctx->SetOutputDim("RowStepOut", ctx->GetInputDim("RowStep"));
+    }
+  }
+
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext &ctx) const override {
+    // RowStep is int64, the kernel type follows Param.
+    auto data_type = framework::GetDataTypeOfVar(ctx.InputVar("Param"));
+    return framework::OpKernelType(data_type, ctx.device_context());
   }
 };
 
@@ -83,6 +93,13 @@ class RmspropOpMaker : public framework::OpProtoAndCheckerMaker {
     AddOutput("ParamOut", "(Tensor) Output updated parameter value.");
     AddOutput("MomentOut", "(Tensor) Output updated moment.");
     AddOutput("MeanSquareOut", "(Tensor) Output Mean squared updated value.");
+    AddInput("RowStep",
+             "(Tensor<int64>, optional) The step on which every row was last "
+             "updated by a sparse gradient, of shape [height + 1], the last "
+             "element counts the steps. Only used in the lazy sparse update.")
+        .AsDispensable();
+    AddOutput("RowStepOut", "(Tensor<int64>, optional) Output RowStep")
+        .AsDispensable();
 
     AddAttr<float>("epsilon",
                    "(float, default 1e-10) Constant "
@@ -104,6 +121,11 @@ MomentOut = momentum * Moment +
 ParamOut = Param -  MomentOut
 $$
 
+If Grad is SelectedRows, only the rows in it are updated (the lazy mode), and
+the cost of a step is proportional to the number of the unique rows. With
+RowStep, the decay of the moments on the steps a row was skipped is applied
+when the row is updated again.
+
 The original slides that proposed Rmsprop: Slide 29 of
 http://www.cs.toronto.edu/~tijmen/csc321/slides/lecture_slides_lec6.pdf)
 
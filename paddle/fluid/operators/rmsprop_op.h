@@ -15,6 +15,7 @@ limitations under the License. */
 #pragma once
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/lazy_sparse_update.h"
 
 namespace paddle {
 namespace operators {
@@ -32,8 +33,6 @@ class RmspropOpKernel : public framework::OpKernel<T> {
     auto* moment_out = ctx.Output<Tensor>("MomentOut");
     auto* mean_square_out = ctx.Output<Tensor>("MeanSquareOut");
 
-    auto grad = ctx.Input<Tensor>("Grad");
-
     param_out->mutable_data<T>(ctx.GetPlace());
     moment_out->mutable_data<T>(ctx.GetPlace());
     mean_square_out->mutable_data<T>(ctx.GetPlace());
@@ -42,6 +41,16 @@ class RmspropOpKernel : public framework::OpKernel<T> {
     float rho = ctx.Attr<float>("decay");
     float momentum = ctx.Attr<float>("momentum");
 
+    auto* grad_var = ctx.InputVar("Grad");
+    if (grad_var->IsType<framework::SelectedRows>()) {
+      LazyUpdate(ctx, grad_var->Get<framework::SelectedRows>(),
+                 static_cast<T>(epsilon), static_cast<T>(rho),
+                 static_cast<T>(momentum), param_out, moment_out,
+                 mean_square_out);
+      return;
+    }
+    auto grad = ctx.Input<Tensor>("Grad");
+
     auto p = EigenVector<T>::Flatten(*ctx.Input<Tensor>("Param"));
     auto ms = EigenVector<T>::Flatten(*ctx.Input<Tensor>("MeanSquare"));
     auto lr = EigenVector<T>::Flatten(*ctx.Input<Tensor>("LearningRate"));
@@ -61,6 +70,58 @@ class RmspropOpKernel : public framework::OpKernel<T> {
         lr.broadcast(grad_dsize) * g / (ms_out + epsilon).sqrt();
     p_out.device(place) = p - mom_out;
   }
+
+ private:
+  // Only the rows of the merged gradient are updated, in parallel. If
+  // RowStep is set, the mean square and the moment of a row skipped for k
+  // steps are decayed by decay^k and momentum^k, and the parameter is moved
+  // by the moment of those steps when it is touched again.
+  void LazyUpdate(const framework::ExecutionContext& ctx,
+                  const framework::SelectedRows& grad, T epsilon, T rho,
+                  T momentum, Tensor* param_out, Tensor* moment_out,
+                  Tensor* mean_square_out) const {
+    PADDLE_ENFORCE(platform::is_cpu_place(ctx.GetPlace()),
+                   "sparse rmsprop only supports CPUPlace");
+    auto& param = *ctx.Input<Tensor>("Param");
+    int64_t height = param.dims()[0];
+    // the step is counted even if no row is updated on it.
+    RowStep row_step(GetRowStep(ctx), height);
+    if (grad.rows().size() == 0) return;
+    auto grad_merge = MergeSparseGrad<T>(
+        ctx.template device_context<platform::CPUDeviceContext>(), grad);
+    const int64_t* rows = grad_merge.rows().data();
+    int64_t num_rows = grad_merge.rows().size();
+    int64_t row_numel = grad_merge.value().numel() / num_rows;
+    for (int64_t i = 0; i < num_rows; ++i) {
+      PADDLE_ENFORCE_LT(rows[i], height,
+                        "Input rows index should less than height");
+    }
+
+    const T* g = grad_merge.value().template data<T>();
+    const T* p = param.template data<T>();
+    const T* ms = ctx.Input<Tensor>("MeanSquare")->template data<T>();
+    const T* mom = ctx.Input<Tensor>("Moment")->template data<T>();
+    T lr = ctx.Input<Tensor>("LearningRate")->template data<T>()[0];
+    T* p_out = param_out->template data<T>();
+    T* mom_out = moment_out->template data<T>();
+    T* ms_out = mean_square_out->template data<T>();
+    ParallelForRows(num_rows, row_numel, [&](int64_t i) {
+      int64_t skipped = row_step.Touch(rows[i]);
+      T ms_decay = std::pow(rho, static_cast<T>(skipped));
+      T mom_decay = std::pow(momentum, static_cast<T>(skipped));
+      T moved = GeometricSum(momentum, skipped);
+      int64_t offset = rows[i] * row_numel;
+      for (int64_t j = 0; j < row_numel; ++j) {
+        T g_val = g[i * row_numel + j];
+        T ms_new = rho * ms_decay * ms[offset + j] + (1 - rho) * g_val * g_val;
+        T mom_new = momentum * mom_decay * mom[offset + j] +
+                    lr * g_val / std::sqrt(ms_new + epsilon);
+        ms_out[offset + j] = ms_new;
+        mom_out[offset + j] = mom_new;
+        p_out[offset + j] = p[offset + j] - moved * mom[offset + j] - mom_new;
+      }
+    });
+  }
 };
 
 }  // namespace operators
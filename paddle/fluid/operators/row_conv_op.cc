@@ -13,7 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/row_conv_op.h"
-#include "paddle/fluid/framework/eigen.h"
+#include <algorithm>
+#include <vector>
+#include "paddle/fluid/operators/math/lod_schedule.h"
 
 namespace paddle {
 namespace operators {
@@ -21,10 +23,6 @@ namespace operators {
 using LoDTensor = framework::LoDTensor;
 using framework::Tensor;
 
-template <typename T, int MajorType = Eigen::RowMajor,
-          typename IndexType = Eigen::DenseIndex>
-using EigenMatrix = framework::EigenMatrix<T, MajorType, IndexType>;
-
 class RowConvOp : public framework::OperatorWithKernel {
  public:
   using framework::OperatorWithKernel::OperatorWithKernel;
@@ -135,36 +133,30 @@ class RowConvKernel<platform::CPUDeviceContext, T>
 
     auto batch_indices = x->lod()[0];
     auto input_dim = x->dims()[1];  // 'in' is of size T x N
-    size_t num_sequence = batch_indices.size() - 1;
-
     auto future_context = filter->dims()[0];
-    auto weights = EigenMatrix<T>::From(*filter);
-
-    for (size_t i = 0; i < num_sequence; i++) {
-      int start = static_cast<int>(batch_indices[i]);
-      int end = static_cast<int>(batch_indices[i + 1]);
-      int current_timesteps = end - start;
-      Tensor cur_input_sequence =
-          x->Slice(start, end);  // Current input sequence
-      Tensor cur_output_sequence =
-          out->Slice(start, end);  // Current output sequence
-      auto cip_seq = EigenMatrix<T>::From(cur_input_sequence);
-      auto cot_seq = EigenMatrix<T>::From(cur_output_sequence);
 
-      for (int k = 0; k < current_timesteps;
-           k++) {  // For different time steps in the same sequence
-        for (int w = 0; (w < future_context) && ((k + w) < current_timesteps);
-             w++) {
-          for (int d = 0; d < input_dim; d++) {
-            if (w == 0) {
-              cot_seq(k, d) = weights(w, d) * cip_seq(k + w, d);
-            } else {
-              cot_seq(k, d) += weights(w, d) * cip_seq(k + w, d);
+    const T *in_data = x->data<T>();
+    const T *weights = filter->data<T>();
+    T *out_data = out->data<T>();
+    const size_t *offsets = batch_indices.data();
+    // The sequences are independent, they are run in parallel.
+    math::ParallelForSequences(
+        batch_indices, future_context * input_dim, [&](size_t i) {
+          int end = static_cast<int>(offsets[i + 1]);
+          for (int k = static_cast<int>(offsets[i]); k < end; k++) {
+            T *cur_out = out_data + k * input_dim;
+            for (int d = 0; d < input_dim; d++) {
+              cur_out[d] = weights[d] * in_data[k * input_dim + d];
+            }
+            for (int w = 1; (w < future_context) && (k + w < end); w++) {
+              const T *cur_in = in_data + (k + w) * input_dim;
+              const T *cur_weights = weights + w * input_dim;
+              for (int d = 0; d < input_dim; d++) {
+                cur_out[d] += cur_weights[d] * cur_in[d];
+              }
             }
           }
-        }
-      }
-    }
+        });
   }
 };
 
@@ -181,68 +173,65 @@ class RowConvGradKernel<platform::CPUDeviceContext, T>
 
     auto input_dim = x->dims()[1];  // 'x' is of size T x N
     auto batch_indices = x->lod()[0];
-    size_t num_sequence = batch_indices.size() - 1;
     auto future_context = filter->dims()[0];
+    int64_t filter_numel = future_context * input_dim;
 
-    if (d_filter) {
-      d_filter->mutable_data<T>(context.GetPlace());
-      auto dweights =
-          EigenMatrix<T>::From(*d_filter);  // Gradient of weight matrix
-      dweights.setZero();
-
-      for (size_t i = 0; i < num_sequence; i++) {  // For different sequences
-        int start = static_cast<int>(batch_indices[i]);
-        int end = static_cast<int>(batch_indices[i + 1]);
+    const T *in_data = x->data<T>();
+    const T *d_out_data = d_out->data<T>();
+    const size_t *offsets = batch_indices.data();
 
-        Tensor cur_input = x->Slice(start, end);  // Current input sequence
-        Tensor cur_doutput =
-            d_out->Slice(start, end);  // Current output grad sequence
-
-        auto cur_ip = EigenMatrix<T>::From(cur_input);
-        auto cur_dout = EigenMatrix<T>::From(cur_doutput);
-        int current_timesteps = end - start;
-
-        for (int k = 0; k < current_timesteps;
-             k++) {  // For different time steps in the same sequence
-          for (int w = 0; (w < future_context) && ((k + w) < current_timesteps);
-               w++) {
-            // For dweights (Updating the gradient of weight matrix)
-            for (int d = 0; d < input_dim; d++) {
-              dweights(w, d) += cur_ip(k + w, d) * cur_dout(k, d);
+    if (d_filter) {
+      T *dweights = d_filter->mutable_data<T>(context.GetPlace());
+      // Every chunk of the sequences accumulates its own gradient of the
+      // weight, they are summed up in the order of the chunks, so the
+      // result does not depend on the threads.
+      auto chunks = math::PartitionSequences(batch_indices, filter_numel);
+      std::vector<T> partial(chunks.size() * filter_numel, 0);
+      math::ParallelForChunks(chunks, [&](const math::SequenceChunk &chunk,
+                                          size_t c) {
+        T *cur_dweights = partial.data() + c * filter_numel;
+        for (size_t i = chunk.begin; i < chunk.end; i++) {
+          int end = static_cast<int>(offsets[i + 1]);
+          for (int k = static_cast<int>(offsets[i]); k < end; k++) {
+            const T *cur_dout = d_out_data + k * input_dim;
+            for (int w = 0; (w < future_context) && (k + w < end); w++) {
+              const T *cur_in = in_data + (k + w) * input_dim;
+              T *cur_dw = cur_dweights + w * input_dim;
+              for (int d = 0; d < input_dim; d++) {
+                cur_dw[d] += cur_in[d] * cur_dout[d];
+              }
             }
           }
         }
+      });
+      std::fill(dweights, dweights + filter_numel, static_cast<T>(0));
+      for (size_t c = 0; c < chunks.size(); c++) {
+        const T *cur_dweights = partial.data() + c * filter_numel;
+        for (int64_t j = 0; j < filter_numel; j++) {
+          dweights[j] += cur_dweights[j];
+        }
       }
     }
 
     if (dx) {
-      dx->mutable_data<T>(context.GetPlace());
-      auto weights = EigenMatrix<T>::From(*filter);
-      for (size_t i = 0; i < num_sequence; i++) {  // For different sequences
-        int start = static_cast<int>(batch_indices[i]);
-        int end = static_cast<int>(batch_indices[i + 1]);
-
-        Tensor cur_doutput =
-            d_out->Slice(start, end);  // Current output grad sequence
-        Tensor cur_dinput =
-            dx->Slice(start, end);  // Current input grad sequence
-
-        auto cur_dout = EigenMatrix<T>::From(cur_doutput);
-        auto cur_dip = EigenMatrix<T>::From(cur_dinput);
-        cur_dip.setZero();
-        int current_timesteps = end - start;
-
-        for (int k = 0; k < current_timesteps;
-             k++) {  // For different time steps in the same sequence
-          for (int w = 0; (w < future_context) && ((k + w) < current_timesteps);
-               w++) {
-            // For dinput (Updating the gradient wrt input)
+      T *dx_data = dx->mutable_data<T>(context.GetPlace());
+      const T *weights = filter->data<T>();
+      math::ParallelForSequences(batch_indices, filter_numel, [&](size_t i) {
+        int start = static_cast<int>(offsets[i]);
+        int end = static_cast<int>(offsets[i + 1]);
+        std::fill(dx_data + start * input_dim, dx_data + end * input_dim,
+                  static_cast<T>(0));
+        for (int k = start; k < end; k++) {
+          const T *cur_dout = d_out_data + k * input_dim;
+          for (int w = 0; (w < future_context) && (k + w < end); w++) {
+            T *cur_dx = dx_data + (k + w) * input_dim;
+            const T *cur_weights = weights + w * input_dim;
             for (int d = 0; d < input_dim; d++) {
-              cur_dip(k + w, d) += weights(w, d) * cur_dout(k, d);
+              cur_dx[d] += cur_weights[d] * cur_dout[d];
             }
           }
         }
-      }
+      });
     }
   }
 };
@@ -20,6 +20,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/framework.pb.h"
 #include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/mapped_tensor_file.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/platform/device_context.h"
 
@@ -69,6 +70,7 @@ class SaveCombineOp : public framework::OperatorBase {
                const platform::Place &place) const override {
     auto filename = Attr<std::string>("file_path");
     auto overwrite = Attr<bool>("overwrite");
+    auto aligned = Attr<bool>("aligned");
 
     bool is_present = FileExists(filename);
     if (is_present && !overwrite) {
@@ -89,6 +91,9 @@ class SaveCombineOp : public framework::OperatorBase {
     platform::DeviceContextPool &pool = platform::DeviceContextPool::Instance();
     auto &dev_ctx = *pool.Get(place);
 
+    if (aligned) {
+      framework::WriteMappedTensorHeader(fout, inp_var_names.size());
+    }
     for (size_t i = 0; i < inp_var_names.size(); i++) {
       auto *var = scope.FindVar(inp_var_names[i]);
 
@@ -101,7 +106,11 @@ class SaveCombineOp : public framework::OperatorBase {
 
       auto &tensor = var->Get<framework::LoDTensor>();
       // Serialize tensor
-      framework::SerializeToStream(fout, tensor, dev_ctx);
+      if (aligned) {
+        framework::SerializeToMappedStream(fout, tensor, dev_ctx);
+      } else {
+        framework::SerializeToStream(fout, tensor, dev_ctx);
+      }
     }
     fout.close();
   }
@@ -125,6 +134,11 @@ to a file on disk.
                   "(boolean, default true)"
                   "Overwrite the output file if it exists.")
         .SetDefault(true);
+    AddAttr<bool>("aligned",
+                  "(boolean, default false)"
+                  "Save in the aligned format, whose tensors can be loaded "
+                  "by mapping the file, see load_combine.")
+        .SetDefault(false);
     AddAttr<std::string>(
         "file_path",
         "(string)"
@@ -178,3 +178,44 @@ TEST(SaveLoadTestWithCombineOp, CPU) {
     }
   }
 }
+
+// Save in the aligned format, and load by mapping the file with and without
+// sharing the pages
+TEST(SaveLoadCombineOp, CPUMapped) {
+  paddle::framework::Scope scope;
+  paddle::platform::CPUPlace place;
+
+  std::vector<int> lod1 = {0, 1, 2, 3, 10};
+  paddle::framework::LoD expect_lod1;
+  int* expect1 = CreateForSaveCombineOp(10, 10, lod1, "test_var1", place, scope,
+                                        expect_lod1);
+  std::vector<int> lod2 = {0, 2, 5, 10};
+  paddle::framework::LoD expect_lod2;
+  int* expect2 = CreateForSaveCombineOp(10, 3, lod2, "test_var2", place, scope,
+                                        expect_lod2);
+
+  paddle::framework::AttributeMap attrs;
+  attrs.insert({"file_path", std::string("check_tensor_mapped.ls")});
+  attrs.insert({"aligned", true});
+  auto save_combine_op = paddle::framework::OpRegistry::CreateOp(
+      "save_combine", {{"X", {"test_var1", "test_var2"}}}, {}, attrs);
+  save_combine_op->Run(scope, place);
+
+  for (bool use_mmap : {false, true}) {
+    auto target1 = GeneratePlaceholderBeforeLoad("out_var1", scope);
+    auto target2 = GeneratePlaceholderBeforeLoad("out_var2", scope);
+    attrs["use_mmap"] = use_mmap;
+    auto load_combine_op = paddle::framework::OpRegistry::CreateOp(
+        "load_combine", {}, {{"Out", {"out_var1", "out_var2"}}}, attrs);
+    load_combine_op->Run(scope, place);
+
+    paddle::framework::LoD actual_lod1, actual_lod2;
+    int* actual1 = GetValuesAfterLoadCombineOp(target1, scope, actual_lod1);
+    int* actual2 = GetValuesAfterLoadCombineOp(target2, scope, actual_lod2);
+    CheckValues(expect1, actual1, expect_lod1, actual_lod1, 100);
+    CheckValues(expect2, actual2, expect_lod2, actual_lod2, 30);
+    if (use_mmap) {
+      EXPECT_EQ(reinterpret_cast<uintptr_t>(actual2) % 64, 0UL);
+    }
+  }
+}
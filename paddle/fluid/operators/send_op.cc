@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include <future>
+#include <map>
 #include <ostream>
 
 #include "paddle/fluid/framework/data_type.h"
@@ -54,12 +55,40 @@ class SendOp : public framework::OperatorBase {
     auto* client_var = scope.FindVar(client_var_name);
     detail::RPCClient* rpc_client = client_var->GetMutable<detail::RPCClient>();
 
-    for (size_t i = 0; i < ins.size(); i++) {
-      if (NeedSend(scope, ins[i])) {
-        VLOG(3) << "sending " << ins[i] << " to " << epmap[i];
-        rpc_client->AsyncSendVariable(epmap[i], ctx, scope, ins[i]);
-      } else {
-        VLOG(3) << "don't send no-initialied variable: " << ins[i];
+    auto codec_names = Attr<std::vector<std::string>>("codecs");
+    PADDLE_ENFORCE(codec_names.empty() || codec_names.size() == ins.size(),
+                   "codecs should be empty or one per input");
+    std::vector<detail::CodecConfig> codecs(ins.size());
+    for (size_t i = 0; i < codec_names.size(); i++) {
+      codecs[i] = detail::ParseCodecConfig(codec_names[i]);
+    }
+
+    if (Attr<bool>("use_stream")) {
+      // batch the variables of the same endpoint into one streaming call.
+      std::map<std::string, std::vector<std::string>> ep_vars;
+      std::map<std::string, std::vector<detail::CodecConfig>> ep_codecs;
+      for (size_t i = 0; i < ins.size(); i++) {
+        if (NeedSend(scope, ins[i])) {
+          ep_vars[epmap[i]].push_back(ins[i]);
+          ep_codecs[epmap[i]].push_back(codecs[i]);
+        } else {
+          VLOG(3) << "don't send no-initialied variable: " << ins[i];
+        }
+      }
+      for (auto& it : ep_vars) {
+        VLOG(3) << "streaming " << it.second.size() << " vars to " << it.first;
+        rpc_client->AsyncSendVariables(it.first, ctx, scope, it.second,
+                                       ep_codecs[it.first]);
+      }
+    } else {
+      for (size_t i = 0; i < ins.size(); i++) {
+        if (NeedSend(scope, ins[i])) {
+          VLOG(3) << "sending " << ins[i] << " to " << epmap[i];
+          rpc_client->AsyncSendVariable(epmap[i], ctx, scope, ins[i],
+                                        codecs[i]);
+        } else {
+          VLOG(3) << "don't send no-initialied variable: " << ins[i];
+        }
       }
     }
     PADDLE_ENFORCE(rpc_client->Wait());
@@ -112,6 +141,18 @@ This operator will send tensor to recv_op at the parameter server.
                                       "Server endpoints in the order of input "
                                       "variables for mapping")
         .SetDefault({});
+    AddAttr<bool>("use_stream",
+                  "(bool, default false)"
+                  "Send the variables of each endpoint in one streaming call, "
+                  "large dense tensors are split into slices.")
+        .SetDefault(false);
+    AddAttr<std::vector<std::string>>(
+        "codecs",
+        "(string vector, default empty)"
+        "Gradient compression in the order of input variables, one of "
+        "none, fp16, int8[:block_size] and topk[:ratio]. Only dense FP32 "
+        "tensors are compressed, they are decoded on the pserver.")
+        .SetDefault({});
   }
 };
 
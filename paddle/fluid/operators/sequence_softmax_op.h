@@ -15,6 +15,7 @@ limitations under the License. */
 #pragma once
 
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/lod_schedule.h"
 #include "paddle/fluid/operators/math/softmax.h"
 
 namespace paddle {
@@ -42,9 +43,11 @@ class SequenceSoftmaxKernel : public framework::OpKernel<T> {
                       "SequenceSoftmaxOp should be 1.");
 
     out->mutable_data<T>(ctx.GetPlace());
-    for (int i = 0; i < static_cast<int>(lod[level].size()) - 1; ++i) {
-      int start_pos = static_cast<int>(lod[level][i]);
-      int end_pos = static_cast<int>(lod[level][i + 1]);
+    auto& dev_ctx = ctx.template device_context<DeviceContext>();
+    const size_t* offsets = lod[level].data();
+    math::ForEachSequence<DeviceContext>::Run(lod[level], 1, [&](size_t i) {
+      int start_pos = static_cast<int>(offsets[i]);
+      int end_pos = static_cast<int>(offsets[i + 1]);
       Tensor x_i = x->Slice(start_pos, end_pos);
       Tensor out_i = out->Slice(start_pos, end_pos);
 
@@ -52,9 +55,8 @@ class SequenceSoftmaxKernel : public framework::OpKernel<T> {
       framework::DDim dims_i = framework::make_ddim({1UL, end_pos - start_pos});
       x_i.Resize(dims_i);
       out_i.Resize(dims_i);
-      math::SoftmaxFunctor<DeviceContext, T>()(
-          ctx.template device_context<DeviceContext>(), &x_i, &out_i);
-    }
+      math::SoftmaxFunctor<DeviceContext, T>()(dev_ctx, &x_i, &out_i);
+    });
   }
 };
 
@@ -71,9 +73,11 @@ class SequenceSoftmaxGradKernel : public framework::OpKernel<T> {
     const size_t level = lod.size() - 1;
 
     x_grad->mutable_data<T>(ctx.GetPlace());
-    for (int i = 0; i < static_cast<int>(lod[level].size()) - 1; ++i) {
-      int start_pos = static_cast<int>(lod[level][i]);
-      int end_pos = static_cast<int>(lod[level][i + 1]);
+    auto& dev_ctx = ctx.template device_context<DeviceContext>();
+    const size_t* offsets = lod[level].data();
+    math::ForEachSequence<DeviceContext>::Run(lod[level], 1, [&](size_t i) {
+      int start_pos = static_cast<int>(offsets[i]);
+      int end_pos = static_cast<int>(offsets[i + 1]);
 
       Tensor out_i = out->Slice(start_pos, end_pos);
       Tensor out_grad_i = out_grad->Slice(start_pos, end_pos);
@@ -84,10 +88,9 @@ class SequenceSoftmaxGradKernel : public framework::OpKernel<T> {
       out_i.Resize(dims_i);
       out_grad_i.Resize(dims_i);
       x_grad_i.Resize(dims_i);
-      math::SoftmaxGradFunctor<DeviceContext, T>()(
-          ctx.template device_context<DeviceContext>(), &out_i, &out_grad_i,
-          &x_grad_i);
-    }
+      math::SoftmaxGradFunctor<DeviceContext, T>()(dev_ctx, &out_i,
+                                                   &out_grad_i, &x_grad_i);
+    });
   }
 };
 
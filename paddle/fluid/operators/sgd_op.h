@@ -16,6 +16,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/operators/lazy_sparse_update.h"
 
 namespace paddle {
 namespace operators {
@@ -61,23 +62,31 @@ class SGDOpKernel : public framework::OpKernel<T> {
         auto out_dims = param_out->dims();
         PADDLE_ENFORCE_EQ(grad_height, out_dims[0]);
 
-        auto &grad_value = grad->value();
-        auto &grad_rows = grad->rows();
+        // merge the duplicated rows, so that the rows can be updated in
+        // parallel.
+        auto grad_merge = MergeSparseGrad<T>(
+            ctx.template device_context<platform::CPUDeviceContext>(), *grad);
+        auto &grad_value = grad_merge.value();
+        auto &grad_rows = grad_merge.rows();
 
-        size_t grad_row_numel = grad_value.numel() / grad_rows.size();
+        int64_t grad_row_numel = grad_value.numel() / grad_rows.size();
         PADDLE_ENFORCE_EQ(grad_row_numel, param_out->numel() / grad_height);
-
-        auto *grad_data = grad_value.data<T>();
-        auto *out_data = param_out->data<T>();
-        auto *lr = learning_rate->data<T>();
         for (size_t i = 0; i < grad_rows.size(); i++) {
           PADDLE_ENFORCE(grad_rows[i] < grad_height,
                          "Input rows index should less than height");
+        }
+
+        const int64_t *rows = grad_rows.data();
+        auto *grad_data = grad_value.template data<T>();
+        auto *out_data = param_out->data<T>();
+        T lr = learning_rate->data<T>()[0];
+        ParallelForRows(grad_rows.size(), grad_row_numel, [&](int64_t i) {
+          T *out_row = out_data + rows[i] * grad_row_numel;
+          const T *grad_row = grad_data + i * grad_row_numel;
           for (int64_t j = 0; j < grad_row_numel; j++) {
-            out_data[grad_rows[i] * grad_row_numel + j] -=
-                lr[0] * grad_data[i * grad_row_numel + j];
+            out_row[j] -= lr * grad_row[j];
           }
-        }
+        });
       } else {
         PADDLE_THROW("Unsupported Variable Type of Grad");
       }
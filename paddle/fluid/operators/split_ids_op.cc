@@ -21,20 +21,25 @@ class SplitIdsOpMaker : public framework::OpProtoAndCheckerMaker {
  public:
   SplitIdsOpMaker(OpProto *proto, OpAttrChecker *op_checker)
       : OpProtoAndCheckerMaker(proto, op_checker) {
-    AddInput("Ids", "(LoDTensor) the input ids with shape{batch_num, 1}");
+    AddInput("Ids", "(LoDTensor) the input ids with shape{batch_num, 1}")
+        .AsDuplicable();
     AddOutput("Out", "(LoDTensor) The outputs of the input Ids.")
         .AsDuplicable();
 
     AddComment(R"DOC(
-Split a LoDTensor of Ids into multi LoDTensors, the number is pserver's number
+Split a LoDTensor of Ids into multi LoDTensors, the number is pserver's number.
+The ids of all the inputs are de-duplicated, so that every id is sent to its
+pserver only once per batch, use merge_ids to scatter the fetched rows back.
 Example:
   Input:
-    X = [1,2,3,4,5,6]
+    X = [1,2,3,4,5,6,6]
 
   Out(3 output):
     out0 = [3, 6]
     out1 = [1, 4]
     out2 = [2, 5]
+
+A SelectedRows input is not de-duplicated and only one input is allowed.
 )DOC");
   }
 };
@@ -48,10 +53,15 @@ class SplitIdsOp : public framework::OperatorWithKernel {
     PADDLE_ENFORCE(ctx->HasOutputs("Out"), "SplitIdsOp must has output Out.");
 
     auto ids_var_type = ctx->GetInputsVarType("Ids").front();
-    auto ids_dims = ctx->GetInputDim("Ids");
+    auto ids_dims = ctx->GetInputsDim("Ids");
     if (ids_var_type == framework::proto::VarType::LOD_TENSOR) {
-      PADDLE_ENFORCE_EQ(ids_dims.size(), 2);
-      PADDLE_ENFORCE_EQ(ids_dims[1], 1);
+      for (auto &dims : ids_dims) {
+        PADDLE_ENFORCE_EQ(dims.size(), 2);
+        PADDLE_ENFORCE_EQ(dims[1], 1);
+      }
+    } else {
+      PADDLE_ENFORCE_EQ(ids_dims.size(), 1UL,
+                        "SelectedRows Ids should be only one input");
     }
   }
 };
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 
+#include <unordered_set>
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/math/selected_rows_functor.h"
@@ -30,21 +31,26 @@ class SplitIdsOpKernel : public framework::OpKernel<T> {
       PADDLE_THROW("SplitIds do not support GPU kernel");
     }
 
-    const auto *ids_var = ctx.InputVar("Ids");
+    const auto *ids_var = ctx.MultiInputVar("Ids").front();
     if (ids_var->IsType<framework::LoDTensor>()) {
-      const auto &ids_dims = ctx.Input<framework::LoDTensor>("Ids")->dims();
-      const T *ids = ctx.Input<framework::LoDTensor>("Ids")->data<T>();
+      auto ids_tensors = ctx.MultiInput<framework::LoDTensor>("Ids");
       auto outs = ctx.MultiOutput<framework::LoDTensor>("Out");
       const size_t shard_num = outs.size();
 
       std::vector<std::vector<T>> out_ids;
       out_ids.resize(outs.size());
 
-      // split id by their shard_num.
-      for (int i = 0; i < ids_dims[0]; ++i) {
-        T id = ids[i];
-        size_t shard_id = static_cast<size_t>(id) % shard_num;
-        out_ids[shard_id].push_back(id);
+      // split id by their shard_num, an id appearing in several inputs or
+      // several times in one input is only sent once.
+      std::unordered_set<int64_t> seen;
+      for (auto *ids_tensor : ids_tensors) {
+        const T *ids = ids_tensor->data<T>();
+        for (int64_t i = 0; i < ids_tensor->dims()[0]; ++i) {
+          T id = ids[i];
+          if (!seen.insert(static_cast<int64_t>(id)).second) continue;
+          size_t shard_id = static_cast<size_t>(id) % shard_num;
+          out_ids[shard_id].push_back(id);
+        }
       }
 
       // create tensor for each shard and send to parameter server
@@ -58,7 +64,8 @@ class SplitIdsOpKernel : public framework::OpKernel<T> {
         }
       }
     } else if (ids_var->IsType<framework::SelectedRows>()) {
-      const auto *ids_selected_rows = ctx.Input<framework::SelectedRows>("Ids");
+      const auto *ids_selected_rows =
+          ctx.MultiInput<framework::SelectedRows>("Ids").front();
       auto &ids_dims = ids_selected_rows->value().dims();
       PADDLE_ENFORCE_EQ(ids_dims[0], ids_selected_rows->rows().size(), "");
       const T *ids = ids_selected_rows->value().data<T>();
@@ -0,0 +1,80 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <stdint.h>
+#include <iostream>
+
+#include "paddle/fluid/platform/hostdevice.h"
+
+namespace paddle {
+namespace platform {
+
+// The brain floating point format, the upper 16 bits of a float: 1 sign
+// bit, 8 exponent bits and 7 mantissa bits. It keeps the range of float,
+// so a float weight can be stored in bfloat16 without overflow, and it is
+// widened back to float by a shift.
+struct bfloat16 {
+ public:
+  uint16_t x;
+
+  // The defaulted special member functions keep bfloat16 trivial, like
+  // float16.
+  bfloat16() = default;
+  bfloat16(const bfloat16& o) = default;
+  bfloat16& operator=(const bfloat16& o) = default;
+  bfloat16(bfloat16&& o) = default;
+  bfloat16& operator=(bfloat16&& o) = default;
+  ~bfloat16() = default;
+
+  // Round to the nearest even, NaN stays a quiet NaN.
+  HOSTDEVICE inline explicit bfloat16(float val) {
+    Bits v;
+    v.f = val;
+    if ((v.ui & 0x7fffffffu) > 0x7f800000u) {
+      x = static_cast<uint16_t>((v.ui >> 16) | 0x0040u);
+    } else {
+      x = static_cast<uint16_t>((v.ui + 0x7fffu + ((v.ui >> 16) & 1u)) >> 16);
+    }
+  }
+
+  HOSTDEVICE inline explicit operator float() const {
+    Bits v;
+    v.ui = static_cast<uint32_t>(x) << 16;
+    return v.f;
+  }
+
+ private:
+  union Bits {
+    float f;
+    uint32_t ui;
+  };
+};
+
+HOSTDEVICE inline bool operator==(const bfloat16& a, const bfloat16& b) {
+  return static_cast<float>(a) == static_cast<float>(b);
+}
+
+HOSTDEVICE inline bool operator!=(const bfloat16& a, const bfloat16& b) {
+  return !(a == b);
+}
+
+inline std::ostream& operator<<(std::ostream& os, const bfloat16& a) {
+  os << static_cast<float>(a);
+  return os;
+}
+
+}  // namespace platform
+}  // namespace paddle
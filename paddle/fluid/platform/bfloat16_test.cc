@@ -0,0 +1,56 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/bfloat16.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+
+namespace paddle {
+namespace platform {
+
+TEST(bfloat16, conversion) {
+  EXPECT_EQ(bfloat16(1.0f).x, 0x3f80);
+  EXPECT_EQ(bfloat16(0.5f).x, 0x3f00);
+  EXPECT_EQ(bfloat16(-2.0f).x, 0xc000);
+  EXPECT_EQ(bfloat16(0.0f).x, 0x0000);
+  EXPECT_EQ(bfloat16(-0.0f).x, 0x8000);
+  EXPECT_EQ(bfloat16(std::numeric_limits<float>::infinity()).x, 0x7f80);
+  EXPECT_TRUE(std::isnan(
+      static_cast<float>(bfloat16(std::numeric_limits<float>::quiet_NaN()))));
+
+  EXPECT_EQ(static_cast<float>(bfloat16(1.0f)), 1.0f);
+  EXPECT_EQ(static_cast<float>(bfloat16(-3.0f)), -3.0f);
+  // The range of float is kept.
+  EXPECT_NEAR(static_cast<float>(bfloat16(1e30f)), 1e30f, 1e30f / 256);
+}
+
+TEST(bfloat16, rounding) {
+  // 1 + 2^-8 is halfway between 1 and 1 + 2^-7, rounded to the even 1.
+  EXPECT_EQ(bfloat16(1.00390625f).x, 0x3f80);
+  // 1 + 3 * 2^-8 is halfway to the even 1 + 2^-6.
+  EXPECT_EQ(bfloat16(1.01171875f).x, 0x3f82);
+  // Just above the halfway rounds up.
+  EXPECT_EQ(bfloat16(1.0040f).x, 0x3f81);
+
+  // The relative error of the rounding is at most 2^-8.
+  for (float v = -100.0f; v < 100.0f; v += 0.37f) {
+    float rounded = static_cast<float>(bfloat16(v));
+    EXPECT_LE(std::fabs(rounded - v), std::fabs(v) / 256.0f);
+  }
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -21,6 +21,10 @@ limitations under the License. */
 #include <unistd.h>
 #endif
 
+#if !defined(__arm__) && !defined(__aarch64__)
+#include <cpuid.h>
+#endif
+
 #include "gflags/gflags.h"
 
 DEFINE_double(fraction_of_cpu_memory_to_use, 1,
@@ -84,5 +88,58 @@ size_t CUDAPinnedMaxChunkSize() {
   return CUDAPinnedMaxAllocSize() / 256;
 }
 
+#if !defined(__arm__) && !defined(__aarch64__)
+namespace {
+
+struct CpuIsaFlags {
+  bool sse42 = false;
+  bool avx = false;
+  bool avx2 = false;
+  bool avx512f = false;
+
+  CpuIsaFlags() {
+    unsigned int eax, ebx, ecx, edx;
+    // CPUID: https://en.wikipedia.org/wiki/CPUID
+    __cpuid_count(1, 0, eax, ebx, ecx, edx);
+    sse42 = ecx & (1 << 20);
+    bool fma = ecx & (1 << 12);
+    // The OS should save the AVX registers on context switches as well.
+    bool osxsave = ecx & (1 << 27);
+    unsigned int xcr0 = 0;
+    if (osxsave) {
+      unsigned int xcr0_high;
+      __asm__("xgetbv" : "=a"(xcr0), "=d"(xcr0_high) : "c"(0));
+    }
+    avx = (ecx & (1 << 28)) && (xcr0 & 0x6) == 0x6;
+
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    // The AVX2 kernels use FMA too.
+    avx2 = avx && fma && (ebx & (1 << 5));
+    avx512f = avx2 && (ebx & (1 << 16)) && (xcr0 & 0xe6) == 0xe6;
+  }
+};
+
+}  // namespace
+
+bool MayIUse(const cpu_isa_t cpu_isa) {
+  static const CpuIsaFlags flags;
+  switch (cpu_isa) {
+    case isa_any:
+      return true;
+    case sse42:
+      return flags.sse42;
+    case avx:
+      return flags.avx;
+    case avx2:
+      return flags.avx2;
+    case avx512f:
+      return flags.avx512f;
+  }
+  return false;
+}
+#else
+bool MayIUse(const cpu_isa_t cpu_isa) { return cpu_isa == isa_any; }
+#endif
+
 }  // namespace platform
 }  // namespace paddle
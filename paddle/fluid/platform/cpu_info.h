@@ -37,5 +37,17 @@ size_t CUDAPinnedMinChunkSize();
 //! Get the maximum chunk size for buddy allocator.
 size_t CUDAPinnedMaxChunkSize();
 
+//! The instruction sets of the runtime dispatched CPU kernels.
+typedef enum {
+  isa_any,
+  sse42,
+  avx,
+  avx2,
+  avx512f,
+} cpu_isa_t;
+
+//! Whether the CPU and the OS support the instruction set, by CPUID.
+bool MayIUse(const cpu_isa_t cpu_isa);
+
 }  // namespace platform
 }  // namespace paddle
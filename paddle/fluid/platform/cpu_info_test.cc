@@ -32,3 +32,19 @@ TEST(CpuMemoryUsage, Print) {
                                        use_percent, memory_size)
             << std::endl;
 }
+
+TEST(CpuInfo, MayIUse) {
+  using paddle::platform::MayIUse;
+  EXPECT_TRUE(MayIUse(paddle::platform::isa_any));
+  // The instruction sets are supersets of the former ones.
+  if (MayIUse(paddle::platform::avx512f)) {
+    EXPECT_TRUE(MayIUse(paddle::platform::avx2));
+  }
+  if (MayIUse(paddle::platform::avx2)) {
+    EXPECT_TRUE(MayIUse(paddle::platform::avx));
+  }
+  LOG(INFO) << "sse4.2: " << MayIUse(paddle::platform::sse42)
+            << ", avx: " << MayIUse(paddle::platform::avx)
+            << ", avx2: " << MayIUse(paddle::platform::avx2)
+            << ", avx512f: " << MayIUse(paddle::platform::avx512f);
+}
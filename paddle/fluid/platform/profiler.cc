@@ -271,20 +271,20 @@ struct EventItem {
   double ave_time;
 };
 
-// Print results
+// Print results of the profiling in state
 void PrintProfiler(const std::vector<std::vector<EventItem>>& events_table,
                    const std::string& sorted_domain, const size_t name_width,
-                   const size_t data_width) {
+                   const size_t data_width, ProfilerState state) {
   // Output header information
   std::cout << "\n------------------------->"
             << "     Profiling Report     "
             << "<-------------------------\n\n";
   std::string place;
-  if (g_state == ProfilerState::kCPU) {
+  if (state == ProfilerState::kCPU) {
     place = "CPU";
-  } else if (g_state == ProfilerState::kCUDA) {
+  } else if (state == ProfilerState::kCUDA) {
     place = "CUDA";
-  } else if (g_state == ProfilerState::kAll) {
+  } else if (state == ProfilerState::kAll) {
     place = "All";
   } else {
     PADDLE_THROW("Invalid profiler state");
@@ -314,10 +314,10 @@ void PrintProfiler(const std::vector<std::vector<EventItem>>& events_table,
   std::cout << std::endl;
 }
 
-// Parse the event list and output the profiling report
+// Parse the event list recorded in state and output the profiling report
 void ParseEvents(const std::vector<std::vector<Event>>& events,
-                 EventSortingKey sorted_by = EventSortingKey::kDefault) {
-  if (g_state == ProfilerState::kDisabled) return;
+                 EventSortingKey sorted_by, ProfilerState state) {
+  if (state == ProfilerState::kDisabled) return;
 
   std::string sorted_domain;
   std::function<bool(const EventItem&, const EventItem&)> sorted_func;
@@ -374,8 +374,8 @@ void ParseEvents(const std::vector<std::vector<Event>>& events,
         }
 
         if (rit != pushed_events.rend()) {
-          double event_time = (g_state == ProfilerState::kCUDA ||
-                               g_state == ProfilerState::kAll)
+          double event_time = (state == ProfilerState::kCUDA ||
+                               state == ProfilerState::kAll)
                                   ? rit->CudaElapsedMs(events[i][j])
                                   : rit->CpuElapsedMs(events[i][j]);
 
@@ -430,25 +430,32 @@ void ParseEvents(const std::vector<std::vector<Event>>& events,
   }
 
   // Print report
-  PrintProfiler(events_table, sorted_domain, max_name_width + 4, 12);
+  PrintProfiler(events_table, sorted_domain, max_name_width + 4, 12, state);
 }
 
 void DisableProfiler(EventSortingKey sorted_key,
                      const std::string& profile_path) {
+  ProfilerState state = g_state;
+  DeviceTracer* tracer = GetDeviceTracer();
+  bool gen_profile =
+      state == ProfilerState::kAll && tracer && tracer->IsEnabled();
+  ParseEvents(StopProfiler(), sorted_key, state);
+  if (gen_profile) tracer->GenProfile(profile_path);
+}
+
+std::vector<std::vector<Event>> StopProfiler() {
   PADDLE_ENFORCE(g_state != ProfilerState::kDisabled,
                  "Can't disable profiling, since it's not starting.");
-  // Mark the profiling stop.
   Mark("_stop_profiler_", nullptr);
 
   std::vector<std::vector<Event>> all_events = GetAllEvents();
-  ParseEvents(all_events, sorted_key);
   ResetProfiler();
   DeviceTracer* tracer = GetDeviceTracer();
   if (g_state == ProfilerState::kAll && tracer && tracer->IsEnabled()) {
     tracer->Disable();
-    tracer->GenProfile(profile_path);
   }
   g_state = ProfilerState::kDisabled;
+  return all_events;
 }
 
 }  // namespace platform
@@ -115,5 +115,9 @@ void ResetProfiler();
 void DisableProfiler(EventSortingKey sorted_key,
                      const std::string& profile_path);
 
+// Disable the profiling without printing the report, and return the events
+// of all threads since it was enabled, e.g. to aggregate them elsewhere.
+std::vector<std::vector<Event>> StopProfiler();
+
 }  // namespace platform
 }  // namespace paddle
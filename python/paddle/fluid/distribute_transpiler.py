@@ -143,7 +143,12 @@ class DistributeTranspiler:
                   program=None,
                   pservers="127.0.0.1:6174",
                   trainers=1,
-                  split_method=splitter.round_robin):
+                  split_method=splitter.round_robin,
+                  sum_grads_on_recv=False,
+                  use_stream=False,
+                  codecs=None,
+                  prefetch_cache_size=0,
+                  prefetch_cache_staleness=1):
         """
             Transpile the program to distributed data-parallelism programs.
             The main_program will be transformed to use a remote parameter server
@@ -184,12 +189,35 @@ class DistributeTranspiler:
             :param split_method: A function to determin how to split variables
                 to different servers equally.
             :type split_method: function
+            :param sum_grads_on_recv: sum the dense gradients from the
+                trainers while the pservers receive them, instead of
+                receiving a copy per trainer and summing them with a sum op.
+            :type sum_grads_on_recv: bool
+            :param use_stream: send the gradients of each pserver in one
+                streaming call, large dense gradients are split into slices.
+            :type use_stream: bool
+            :param codecs: gradient compression, one of "none", "fp16",
+                "int8[:block_size]" and "topk[:ratio]", applied to every
+                dense FP32 gradient, or a dict from parameter name to
+                codec. Parameters missing from the dict are sent as is.
+            :type codecs: string|dict
+            :param prefetch_cache_size: the number of rows of the
+                distributed lookup table cached on the trainer, 0 to
+                disable the cache.
+            :type prefetch_cache_size: int
+            :param prefetch_cache_staleness: a cached row is prefetched
+                again after it has been cached for more than this many
+                mini-batches.
+            :type prefetch_cache_staleness: int
         """
         assert (callable(split_method))
         if program is None:
             program = default_main_program()
         self.origin_program = program
         self.trainer_num = trainers
+        self.sum_grads_on_recv = sum_grads_on_recv
+        self.prefetch_cache_size = prefetch_cache_size
+        self.prefetch_cache_staleness = prefetch_cache_staleness
         self.optimize_ops = optimize_ops
         # TODO(typhoonzero): currently trainer_id is fetched from cluster system
         # like Kubernetes, we should port this to use etcd later when developing
@@ -259,9 +287,16 @@ class DistributeTranspiler:
         # op outputs.
         send_inputs = []
         send_outputs = []
+        send_codecs = []
+        grad_to_param = dict([(g.name, p.name) for p, g in params_grads])
         for b in grad_blocks:  # append by order
             varname, block_id, _ = b.split(":")
             send_inputs.append(grad_var_mapping[varname][int(block_id)])
+            if isinstance(codecs, dict):
+                send_codecs.append(
+                    codecs.get(grad_to_param.get(varname), "none"))
+            else:
+                send_codecs.append(codecs or "none")
         for b in param_blocks:
             varname, block_id, _ = b.split(":")
             send_outputs.append(param_var_mapping[varname][int(block_id)])
@@ -289,8 +324,12 @@ class DistributeTranspiler:
             inputs={"X": send_inputs},
             outputs={"Out": send_outputs,
                      "RPCClient": rpc_client_var},
-            attrs={"endpoints": pserver_endpoints,
-                   "epmap": eplist})
+            attrs={
+                "endpoints": pserver_endpoints,
+                "epmap": eplist,
+                "use_stream": use_stream,
+                "codecs": send_codecs
+            })
         # step4: Concat the parameters splits together after recv.
         for varname, splited_var in param_var_mapping.iteritems():
             if len(splited_var) <= 1:
@@ -326,6 +365,8 @@ class DistributeTranspiler:
         """
         # step1
         pserver_program = Program()
+        # dense grads which are summed while received
+        self.recv_sum_grads = []
         # step2: Create vars to receive vars at parameter servers.
         recv_inputs = []
         for v in self.param_grad_ep_mapping[endpoint]["params"]:
@@ -466,7 +507,8 @@ class DistributeTranspiler:
                 "OptimizeBlock": optimize_block,
                 "endpoint": endpoint,
                 "Fanin": self.trainer_num,
-                "PrefetchBlock": prefetch_block
+                "PrefetchBlock": prefetch_block,
+                "sum_grads": self.recv_sum_grads
             })
 
         pserver_program.sync_with_cpp()
@@ -529,76 +571,81 @@ class DistributeTranspiler:
     # transpiler function for dis lookup_table
     def _replace_lookup_table_op_with_prefetch(self, program, rpc_client_var,
                                                eplist):
-        # 1. replace lookup_table_op with split_ids_op -> prefetch_op -> sum_op
+        # 1. replace lookup_table_ops with split_ids_op -> prefetch_op ->
+        # merge_ids_op, the ids of all the lookup_table_ops are batched into
+        # one prefetch and every id is fetched only once.
         self.prefetch_input_vars = None
         self.prefetch_output_vars = None
 
-        continue_search_lookup_table_op = True
-        while continue_search_lookup_table_op:
-            continue_search_lookup_table_op = False
-            all_ops = program.global_block().ops
-            for op in all_ops:
-                if op.type == LOOKUP_TABLE_TYPE:
-                    continue_search_lookup_table_op = True
-
-                    op_index = list(all_ops).index(op)
-                    ids_name = op.input("Ids")
-                    out_name = op.output("Out")
-
-                    if self.prefetch_input_vars is None:
-                        ids_var = program.global_block().vars[ids_name[0]]
-                        self.prefetch_input_vars = self.create_splited_vars(
-                            source_var=ids_var,
-                            block=program.global_block(),
-                            tag="_prefetch_in_")
-                    if self.prefetch_output_vars is None:
-                        out_var = program.global_block().vars[out_name[0]]
-                        self.prefetch_output_vars = self.create_splited_vars(
-                            source_var=out_var,
-                            block=program.global_block(),
-                            tag="_prefetch_out_")
-
-                    # insert split_ids_op
-                    program.global_block().insert_op(
-                        index=op_index,
-                        type="split_ids",
-                        inputs={
-                            'Ids': [
-                                program.global_block().vars[varname]
-                                for varname in ids_name
-                            ]
-                        },
-                        outputs={"Out": self.prefetch_input_vars})
-
-                    # insert prefetch_op
-                    program.global_block().insert_op(
-                        index=op_index + 1,
-                        type="prefetch",
-                        inputs={'X': self.prefetch_input_vars},
-                        outputs={
-                            "Out": self.prefetch_output_vars,
-                            "RPCClient": rpc_client_var
-                        },
-                        attrs={"epmap": eplist})
-
-                    # insert concat_op
-                    program.global_block().insert_op(
-                        index=op_index + 2,
-                        type="concat",
-                        inputs={'X': self.prefetch_output_vars},
-                        outputs={
-                            "Out": [
-                                program.global_block().vars[varname]
-                                for varname in out_name
-                            ]
-                        },
-                        attrs={"axis": 0})
-
-                    # delete lookup_table_op
-                    program.global_block().delete_ops([op])
-                    program.sync_with_cpp()
-                    # break for loop
-                    break
+        block = program.global_block()
+        all_ops = list(block.ops)
+        lookup_table_ops = [
+            op for op in all_ops if op.type == LOOKUP_TABLE_TYPE
+        ]
+        if not lookup_table_ops:
+            return
+
+        ids_name = []
+        out_name = []
+        for op in lookup_table_ops:
+            ids_name.extend(op.input("Ids"))
+            out_name.extend(op.output("Out"))
+
+        # the batched ops are inserted in place of the first lookup_table_op,
+        # so all the ids should have been computed before it.
+        op_index = all_ops.index(lookup_table_ops[0])
+        for op in all_ops[op_index:]:
+            for varname in op.output_arg_names:
+                if varname in ids_name:
+                    raise ValueError(
+                        "ids %s of distributed lookup_table is computed "
+                        "after the first lookup_table op" % varname)
+
+        ids_var = block.vars[ids_name[0]]
+        self.prefetch_input_vars = self.create_splited_vars(
+            source_var=ids_var, block=block, tag="_prefetch_in_")
+        out_var = block.vars[out_name[0]]
+        self.prefetch_output_vars = self.create_splited_vars(
+            source_var=out_var, block=block, tag="_prefetch_out_")
+
+        # insert split_ids_op
+        block.insert_op(
+            index=op_index,
+            type="split_ids",
+            inputs={'Ids': [block.vars[varname] for varname in ids_name]},
+            outputs={"Out": self.prefetch_input_vars})
+
+        # insert prefetch_op
+        block.insert_op(
+            index=op_index + 1,
+            type="prefetch",
+            inputs={'X': self.prefetch_input_vars},
+            outputs={
+                "Out": self.prefetch_output_vars,
+                "RPCClient": rpc_client_var
+            },
+            attrs={
+                "epmap": eplist,
+                "cache_size": self.prefetch_cache_size,
+                "cache_staleness": self.prefetch_cache_staleness
+            })
+
+        # insert merge_ids_op
+        block.insert_op(
+            index=op_index + 2,
+            type="merge_ids",
+            inputs={
+                'Ids': [block.vars[varname] for varname in ids_name],
+                'Rows': self.prefetch_input_vars,
+                'X': self.prefetch_output_vars
+            },
+            outputs={"Out": [block.vars[varname] for varname in out_name]})
+
+        # delete lookup_table_ops, delete_ops removes a contiguous range so
+        # they are deleted one by one.
+        for op in lookup_table_ops:
+            block.delete_ops([op])
+            program.sync_with_cpp()
 
     def _split_table_grad_and_add_send_vars(self, program, rpc_client_var,
                                             pserver_endpoints):
@@ -892,7 +939,17 @@ class DistributeTranspiler:
                     return
                 merged_var = \
                     pserver_block.vars[self._orig_varname(grad_block.name)]
-                if self.trainer_num > 1:
+                if self.trainer_num > 1 and self.sum_grads_on_recv and \
+                    merged_var.type == core.VarDesc.VarType.LOD_TENSOR and \
+                    merged_var.dtype == core.VarDesc.VarType.FP32:
+                    # listen_and_serv sums the grads while receiving them
+                    self.recv_sum_grads.append(merged_var.name)
+                    optimize_block.append_op(
+                        type="scale",
+                        inputs={"X": merged_var},
+                        outputs={"Out": merged_var},
+                        attrs={"scale": 1.0 / float(self.trainer_num)})
+                elif self.trainer_num > 1:
                     vars2merge = []
                     for i in xrange(self.trainer_num):
                         per_trainer_name = "%s.trainer_%d" % \
@@ -72,6 +72,10 @@ def convert_np_dtype_to_dtype_(np_dtype):
         return core.VarDesc.VarType.INT64
     elif dtype == np.bool:
         return core.VarDesc.VarType.BOOL
+    elif dtype == np.uint8:
+        return core.VarDesc.VarType.UINT8
+    elif dtype == np.int8:
+        return core.VarDesc.VarType.INT8
     else:
         raise ValueError("Not supported numpy dtype " + str(dtype))
 
@@ -441,17 +445,23 @@ class Operator(object):
         if outputs is not None:
             given = set()
             need = set()
+            allowed = set()
             for n in outputs:
                 given.add(n)
             for m in proto.outputs:
-                need.add(m.name)
-            if not given == need:
+                allowed.add(m.name)
+                if not m.dispensable:
+                    need.add(m.name)
+            if not (need <= given and given <= allowed):
                 raise ValueError(("Incorrect setting for output(s) of "
                                   "operator \"%s\". Need: [%s] Given: [%s]") %
                                  (type, ", ".join(str(e) for e in need),
                                   ", ".join(str(e) for e in given)))
 
             for out_proto in proto.outputs:
+                if out_proto.name not in outputs:
+                    self.desc.set_output(out_proto.name, [])
+                    continue
                 out_args = outputs[out_proto.name]
                 if not isinstance(out_args, list):
                     out_args = [out_args]
@@ -68,7 +68,8 @@ def save_vars(executor,
               main_program=None,
               vars=None,
               predicate=None,
-              filename=None):
+              filename=None,
+              aligned=False):
     """
     Save variables to directory by executor.
 
@@ -82,6 +83,8 @@ def save_vars(executor,
     will be ignored
     :param filename: The name of a single file that all vars are saved to.
         If it is None, save variables to separate files.
+    :param aligned: Save the single file in the aligned format, which
+        load_vars can map with use_mmap=True instead of reading it.
 
     :return: None
     """
@@ -95,7 +98,8 @@ def save_vars(executor,
             executor,
             dirname=dirname,
             vars=filter(predicate, main_program.list_vars()),
-            filename=filename)
+            filename=filename,
+            aligned=aligned)
     else:
         save_program = Program()
         save_block = save_program.global_block()
@@ -124,7 +128,10 @@ def save_vars(executor,
                 type='save_combine',
                 inputs={'X': save_var_list},
                 outputs={},
-                attrs={'file_path': os.path.join(dirname, filename)})
+                attrs={
+                    'file_path': os.path.join(dirname, filename),
+                    'aligned': aligned
+                })
 
         executor.run(save_program)
 
@@ -142,7 +149,11 @@ def save_params(executor, dirname, main_program=None, filename=None):
         filename=filename)
 
 
-def save_persistables(executor, dirname, main_program=None, filename=None):
+def save_persistables(executor,
+                      dirname,
+                      main_program=None,
+                      filename=None,
+                      aligned=False):
     """
     Save all persistables to directory with executor.
     """
@@ -152,7 +163,8 @@ def save_persistables(executor, dirname, main_program=None, filename=None):
         main_program=main_program,
         vars=None,
         predicate=is_persistable,
-        filename=filename)
+        filename=filename,
+        aligned=aligned)
 
 
 def load_vars(executor,
@@ -160,7 +172,8 @@ def load_vars(executor,
               main_program=None,
               vars=None,
               predicate=None,
-              filename=None):
+              filename=None,
+              use_mmap=False):
     """
     Load variables from directory by executor.
 
@@ -174,6 +187,9 @@ def load_vars(executor,
     predicate will be ignored
     :param filename: The name of the single file that all vars are loaded from.
         If it is None, load variables from separate files.
+    :param use_mmap: If the single file is saved with aligned=True, the
+        variables on CPU share the pages of the mapped file instead of
+        copying them.
 
     :return: None
     """
@@ -187,7 +203,8 @@ def load_vars(executor,
             executor,
             dirname=dirname,
             vars=filter(predicate, main_program.list_vars()),
-            filename=filename)
+            filename=filename,
+            use_mmap=use_mmap)
     else:
         load_prog = Program()
         load_block = load_prog.global_block()
@@ -214,7 +231,10 @@ def load_vars(executor,
                 type='load_combine',
                 inputs={},
                 outputs={"Out": load_var_list},
-                attrs={'file_path': os.path.join(dirname, filename)})
+                attrs={
+                    'file_path': os.path.join(dirname, filename),
+                    'use_mmap': use_mmap
+                })
 
         executor.run(load_prog)
 
@@ -231,7 +251,11 @@ def load_params(executor, dirname, main_program=None, filename=None):
         filename=filename)
 
 
-def load_persistables(executor, dirname, main_program=None, filename=None):
+def load_persistables(executor,
+                      dirname,
+                      main_program=None,
+                      filename=None,
+                      use_mmap=False):
     """
     load all persistables from directory by executor.
     """
@@ -240,7 +264,8 @@ def load_persistables(executor, dirname, main_program=None, filename=None):
         dirname=dirname,
         main_program=main_program,
         predicate=is_persistable,
-        filename=filename)
+        filename=filename,
+        use_mmap=use_mmap)
 
 
 def get_inference_program(target_vars, main_program=None):
@@ -301,7 +326,8 @@ def save_inference_model(dirname,
                          executor,
                          main_program=None,
                          model_filename=None,
-                         params_filename=None):
+                         params_filename=None,
+                         aligned=False):
     """
     Build a model especially for inference,
     and save it to directory by the executor.
@@ -317,6 +343,8 @@ def save_inference_model(dirname,
     :param params_filename: The name of file to save parameters.
         It is used for the case that all parameters are saved in a single binary file.
         If not specified, parameters are considered saved in separate files.
+    :param aligned: Save the single file of the parameters in the aligned
+        format, which load_inference_model can map with use_mmap=True.
 
     :return: None
     """
@@ -359,7 +387,8 @@ def save_inference_model(dirname,
     with open(model_filename, "wb") as f:
         f.write(inference_program.desc.serialize_to_string())
 
-    save_persistables(executor, dirname, inference_program, params_filename)
+    save_persistables(executor, dirname, inference_program, params_filename,
+                      aligned)
 
 
 def get_feed_targets_names(program):
@@ -383,7 +412,8 @@ def get_fetch_targets_names(program):
 def load_inference_model(dirname,
                          executor,
                          model_filename=None,
-                         params_filename=None):
+                         params_filename=None,
+                         use_mmap=False):
     """
     Load inference model from a directory
 
@@ -394,6 +424,9 @@ def load_inference_model(dirname,
     :param params_filename: The name of file to load parameters.
         It is used for the case that all parameters are saved in a single binary file.
         If not specified, parameters are considered saved in separate files.
+    :param use_mmap: If the single file of the parameters is saved with
+        aligned=True, the parameters on CPU share the pages of the mapped
+        file, which are shared by all the processes loading the model.
 
     :return: [program, feed_target_names, fetch_targets]
              program: program especially for inference.
@@ -416,7 +449,7 @@ def load_inference_model(dirname,
         program_desc_str = f.read()
 
     program = Program.parse_from_string(program_desc_str)
-    load_persistables(executor, dirname, program, params_filename)
+    load_persistables(executor, dirname, program, params_filename, use_mmap)
 
     feed_target_names = get_feed_targets_names(program)
     fetch_target_names = get_fetch_targets_names(program)
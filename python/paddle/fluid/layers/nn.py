@@ -65,6 +65,7 @@ __all__ = [
     'transpose',
     'im2sequence',
     'nce',
+    'hsigmoid',
     'beam_search',
     'row_conv',
     'multiplex',
@@ -2896,6 +2897,93 @@ def nce(input,
     return cost / (num_neg_samples + 1)
 
 
+def hsigmoid(input,
+             label,
+             num_classes,
+             param_attr=None,
+             bias_attr=None,
+             path_table=None,
+             path_code=None,
+             is_sparse=False,
+             name=None):
+    """
+    **Hierarchical Sigmoid Layer**
+
+    The hierarchical sigmoid organizes the classes into a binary tree, and
+    the probability of a class is the product of the probabilities of the
+    binary decisions on the path from the root to its leaf. The cost of a
+    sample is O(log(num_classes)) instead of the O(num_classes) of the
+    softmax, which makes it suitable for a large vocabulary.
+
+    By default the tree is the complete binary tree of num_classes leaves.
+    A custom tree, e.g. a Huffman tree built from the class frequencies, is
+    given by path_table and path_code.
+
+    Args:
+        input (Variable): The input tensor of shape [N, D].
+        label (Variable): The labels of shape [N, 1], int64.
+        num_classes (int): The number of classes. The weight has
+            num_classes - 1 rows, one for each non-leaf node of the tree.
+        param_attr (ParamAttr|None): The parameter attribute of the weight.
+        bias_attr (ParamAttr|bool|None): The parameter attribute of the
+            bias, no bias is created if it is False.
+        path_table (Variable|None): The custom tree of shape
+            [N, max_code_length], int64. The j-th column holds the index of
+            the j-th non-leaf node on the path of the label, and the path
+            ends at the first negative index.
+        path_code (Variable|None): The codes of the custom tree of the same
+            shape as path_table, the j-th column is 1 if the path goes to
+            the right child of the j-th node, otherwise 0.
+        is_sparse (bool): Whether the gradient of the weight is a
+            SelectedRows which only holds the rows on the paths.
+        name (str|None): A name for this layer(optional).
+
+    Returns:
+        Variable: The cost of shape [N, 1].
+
+    Examples:
+        .. code-block:: python
+
+            x = fluid.layers.data(name='x', shape=[128], dtype='float32')
+            y = fluid.layers.data(name='y', shape=[1], dtype='int64')
+            cost = fluid.layers.hsigmoid(input=x, label=y, num_classes=10000)
+    """
+    helper = LayerHelper('hsigmoid', **locals())
+    dtype = helper.input_dtype()
+    dim = input.shape[1]
+    if num_classes < 2:
+        raise ValueError("num_classes must be at least 2.")
+    if (path_table is None) != (path_code is None):
+        raise ValueError("path_table and path_code should be set together.")
+
+    weight = helper.create_parameter(
+        attr=helper.param_attr,
+        shape=[num_classes - 1, dim],
+        is_bias=False,
+        dtype=dtype)
+    inputs = {'X': input, 'W': weight, 'Label': label}
+    if helper.bias_attr:
+        inputs['Bias'] = helper.create_parameter(
+            attr=helper.bias_attr,
+            shape=[num_classes - 1, 1],
+            is_bias=True,
+            dtype=dtype)
+    if path_table is not None:
+        inputs['PathTable'] = path_table
+        inputs['PathCode'] = path_code
+
+    out = helper.create_tmp_variable(dtype)
+    pre_out = helper.create_tmp_variable(dtype)
+    helper.append_op(
+        type='hsigmoid',
+        inputs=inputs,
+        outputs={'Out': out,
+                 'PreOut': pre_out},
+        attrs={'num_classes': int(num_classes),
+               'is_sparse': is_sparse})
+    return out
+
+
 def transpose(x, perm, name=None):
     """
     **transpose Layer**
@@ -16,6 +16,7 @@ from collections import defaultdict
 from paddle.fluid.framework import Program
 import framework
 import layers
+import core
 from backward import append_backward
 from framework import program_guard
 import unique_name
@@ -39,7 +40,7 @@ class Optimizer(object):
     but need to use one of it's implementation.
     """
 
-    def __init__(self, learning_rate, regularization=None):
+    def __init__(self, learning_rate, regularization=None, lazy_mode=False):
         if not isinstance(learning_rate, float) and \
                 not isinstance(learning_rate, framework.Variable):
             raise TypeError("learning rate should be float or Variable")
@@ -57,6 +58,11 @@ class Optimizer(object):
         # {accum_name : { paramter_name : accumulator_for_parameter, ...}, ...}
         self._accumulators = defaultdict(lambda: dict())
         self.helper = None
+        # The sparse gradients are always applied lazily, only the rows in
+        # them are updated. In lazy_mode the optimizers with decaying moments
+        # also record the step every row is updated on, so the decay of the
+        # skipped steps is applied when a row is updated again.
+        self._lazy_mode = lazy_mode
 
     def _create_global_learning_rate(self):
         lr = self.global_learning_rate()
@@ -156,6 +162,24 @@ class Optimizer(object):
         self._accumulators[name][param.name] = var
         return var
 
+    def _append_row_step(self, param_and_grad, inputs, outputs):
+        """Utility function to add the RowStep accumulator of a parameter with
+        a sparse gradient to the inputs and outputs of its optimize op
+
+        Args:
+            param_and_grad: the parameter and its gradient
+            inputs: the inputs of the optimize op
+            outputs: the outputs of the optimize op
+        """
+        param, grad = param_and_grad
+        if not self._lazy_mode or \
+                grad.type != core.VarDesc.VarType.SELECTED_ROWS:
+            return
+        row_step = self._add_accumulator(
+            "row_step", param, dtype='int64', shape=[param.shape[0] + 1])
+        inputs["RowStep"] = row_step
+        outputs["RowStepOut"] = row_step
+
     def _get_accumulator(self, name, param):
         """Utility function to fetch an accumulator for a parameter
 
@@ -299,18 +323,21 @@ class MomentumOptimizer(Optimizer):
         velocity_acc = self._get_accumulator(self._velocity_acc_str,
                                              param_and_grad[0])
         # create the momentum optimize op
+        inputs = {
+            "Param": param_and_grad[0],
+            "Grad": param_and_grad[1],
+            "Velocity": velocity_acc,
+            "LearningRate": self._create_param_lr(param_and_grad)
+        }
+        outputs = {
+            "ParamOut": param_and_grad[0],
+            "VelocityOut": velocity_acc
+        }
+        self._append_row_step(param_and_grad, inputs, outputs)
         momentum_op = block.append_op(
             type=self.type,
-            inputs={
-                "Param": param_and_grad[0],
-                "Grad": param_and_grad[1],
-                "Velocity": velocity_acc,
-                "LearningRate": self._create_param_lr(param_and_grad)
-            },
-            outputs={
-                "ParamOut": param_and_grad[0],
-                "VelocityOut": velocity_acc
-            },
+            inputs=inputs,
+            outputs=outputs,
             attrs={"mu": self._momentum,
                    "use_nesterov": self._use_nesterov})
 
@@ -419,22 +446,25 @@ class AdamOptimizer(Optimizer):
         moment2 = self._get_accumulator(self._moment2_acc_str,
                                         param_and_grad[0])
         # create the adam optimize op
+        inputs = {
+            "Param": param_and_grad[0],
+            "Grad": param_and_grad[1],
+            "LearningRate": self._create_param_lr(param_and_grad),
+            "Moment1": moment1,
+            "Moment2": moment2,
+            "Beta1Pow": self._beta1_pow_acc,
+            "Beta2Pow": self._beta2_pow_acc
+        }
+        outputs = {
+            "ParamOut": param_and_grad[0],
+            "Moment1Out": moment1,
+            "Moment2Out": moment2
+        }
+        self._append_row_step(param_and_grad, inputs, outputs)
         adam_op = block.append_op(
             type=self.type,
-            inputs={
-                "Param": param_and_grad[0],
-                "Grad": param_and_grad[1],
-                "LearningRate": self._create_param_lr(param_and_grad),
-                "Moment1": moment1,
-                "Moment2": moment2,
-                "Beta1Pow": self._beta1_pow_acc,
-                "Beta2Pow": self._beta2_pow_acc
-            },
-            outputs={
-                "ParamOut": param_and_grad[0],
-                "Moment1Out": moment1,
-                "Moment2Out": moment2
-            },
+            inputs=inputs,
+            outputs=outputs,
             attrs={
                 "beta1": self._beta1,
                 "beta2": self._beta2,
@@ -510,21 +540,24 @@ class AdamaxOptimizer(Optimizer):
         inf_norm = self._get_accumulator(self._inf_norm_acc_str,
                                          param_and_grad[0])
         # create the adamax optimize op
+        inputs = {
+            "Param": param_and_grad[0],
+            "Grad": param_and_grad[1],
+            "LearningRate": self._create_param_lr(param_and_grad),
+            "Moment": moment,
+            "InfNorm": inf_norm,
+            "Beta1Pow": self._beta1_pow_acc
+        }
+        outputs = {
+            "ParamOut": param_and_grad[0],
+            "MomentOut": moment,
+            "InfNormOut": inf_norm
+        }
+        self._append_row_step(param_and_grad, inputs, outputs)
         adamax_op = block.append_op(
             type=self.type,
-            inputs={
-                "Param": param_and_grad[0],
-                "Grad": param_and_grad[1],
-                "LearningRate": self._create_param_lr(param_and_grad),
-                "Moment": moment,
-                "InfNorm": inf_norm,
-                "Beta1Pow": self._beta1_pow_acc
-            },
-            outputs={
-                "ParamOut": param_and_grad[0],
-                "MomentOut": moment,
-                "InfNormOut": inf_norm
-            },
+            inputs=inputs,
+            outputs=outputs,
             attrs={
                 "beta1": self._beta1,
                 "beta2": self._beta2,
@@ -767,20 +800,23 @@ class RMSPropOptimizer(Optimizer):
                                              param_and_grad[0])
         mean_square_acc = self._get_accumulator(self._mean_square_acc_str,
                                                 param_and_grad[0])
+        inputs = {
+            "Param": param_and_grad[0],
+            "Grad": param_and_grad[1],
+            "Moment": momentum_acc,
+            "MeanSquare": mean_square_acc,
+            "LearningRate": self._create_param_lr(param_and_grad),
+        }
+        outputs = {
+            "ParamOut": param_and_grad[0],
+            "MomentOut": momentum_acc,
+            "MeanSquareOut": mean_square_acc
+        }
+        self._append_row_step(param_and_grad, inputs, outputs)
         rmsprop_op = block.append_op(
             type=self.type,
-            inputs={
-                "Param": param_and_grad[0],
-                "Grad": param_and_grad[1],
-                "Moment": momentum_acc,
-                "MeanSquare": mean_square_acc,
-                "LearningRate": self._create_param_lr(param_and_grad),
-            },
-            outputs={
-                "ParamOut": param_and_grad[0],
-                "MomentOut": momentum_acc,
-                "MeanSquareOut": mean_square_acc
-            },
+            inputs=inputs,
+            outputs=outputs,
             attrs={
                 "epsilon": self._epsilon,
                 "decay": self._rho,
@@ -311,5 +311,100 @@ class TestSparseAdamOp(unittest.TestCase):
             self.check_with_place(place)
 
 
+class TestSparseLazyAdamOp(unittest.TestCase):
+    def setup(self, scope, place):
+        beta1 = 0.9
+        beta2 = 0.999
+        epsilon = 1e-8
+        lr = 0.1
+        height = 10
+        row_numel = 12
+        # the rows 0 and 4 were last updated on the steps 2 and 5, the 6th
+        # step is updating them again, so row 0 catches up 3 steps.
+        self.rows = [0, 4, 0]
+        self.unique_rows = [0, 4]
+        step = np.zeros(height + 1).astype("int64")
+        step[0] = 2
+        step[4] = 5
+        step[height] = 5
+        self.expected_step = step.copy()
+        self.expected_step[[0, 4, height]] = 6
+
+        param = np.random.random((height, row_numel)).astype("float32")
+        moment1 = np.random.random((height, row_numel)).astype("float32")
+        moment2 = np.random.random((height, row_numel)).astype("float32")
+        grad = np.random.random((len(self.rows), row_numel)).astype("float32")
+        self.dense_inputs = {
+            "Param": param,
+            "Moment1": moment1,
+            "Moment2": moment2,
+            "LearningRate": np.array([lr]).astype("float32"),
+            "Beta1Pow": np.array([beta1**6]).astype("float32"),
+            "Beta2Pow": np.array([beta2**6]).astype("float32"),
+            "RowStep": step
+        }
+        self.attrs = {'epsilon': epsilon, 'beta1': beta1, 'beta2': beta2}
+
+        grad_selected_rows = scope.var('Grad').get_selected_rows()
+        grad_selected_rows.set_height(height)
+        grad_selected_rows.set_rows(self.rows)
+        grad_selected_rows.get_tensor().set(grad, place)
+
+        merged = np.zeros((height, row_numel)).astype("float32")
+        for i, row in enumerate(self.rows):
+            merged[row] += grad[i]
+        self.param_out = param.copy()
+        for row in self.unique_rows:
+            inputs = {
+                "Param": param[row],
+                "Moment1": moment1[row],
+                "Moment2": moment2[row],
+                "LearningRate": lr
+            }
+            for t in range(step[row] + 1, 7):
+                inputs["Grad"] = merged[row] if t == 6 else 0
+                inputs["Beta1Pow"] = beta1**t
+                inputs["Beta2Pow"] = beta2**t
+                p, m1, m2 = adam_step(inputs, self.attrs)
+                inputs.update({"Param": p, "Moment1": m1, "Moment2": m2})
+            self.param_out[row] = inputs["Param"]
+
+    def check_with_place(self, place):
+        scope = core.Scope()
+        self.setup(scope, place)
+
+        for key, np_array in self.dense_inputs.iteritems():
+            scope.var(key).get_tensor().set(np_array, place)
+        adam_op = Operator(
+            "adam",
+            Param="Param",
+            Grad="Grad",
+            Moment1="Moment1",
+            Moment2="Moment2",
+            LearningRate="LearningRate",
+            Beta1Pow="Beta1Pow",
+            Beta2Pow="Beta2Pow",
+            RowStep="RowStep",
+            ParamOut="Param",
+            Moment1Out="Moment1",
+            Moment2Out="Moment2",
+            RowStepOut="RowStep",
+            **self.attrs)
+        adam_op.run(scope, place)
+
+        self.assertTrue(
+            np.allclose(
+                np.array(scope.var("Param").get_tensor()),
+                self.param_out,
+                atol=1e-5))
+        self.assertTrue(
+            np.array_equal(
+                np.array(scope.var("RowStep").get_tensor()),
+                self.expected_step))
+
+    def test_sparse_lazy_adam(self):
+        self.check_with_place(core.CPUPlace())
+
+
 if __name__ == "__main__":
     unittest.main()
@@ -0,0 +1,69 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+class TestFusedElementwiseChainOp(OpTest):
+    def setUp(self):
+        self.op_type = "fused_elementwise_chain"
+        x = np.random.uniform(-1, 1, (4, 8, 5, 5)).astype("float32")
+        y0 = np.random.uniform(-1, 1, (8, )).astype("float32")
+        y1 = np.random.uniform(0.5, 1, (4, 8, 5, 5)).astype("float32")
+        self.inputs = {'X': x, 'Y': [('y0', y0), ('y1', y1)]}
+        self.attrs = {
+            'functor_list': ['elementwise_add', 'relu', 'elementwise_div'],
+            'axis_list': [1, -1]
+        }
+        out = np.maximum(x + y0.reshape(1, 8, 1, 1), 0) / y1
+        self.outputs = {'Out': out}
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestFusedElementwiseChainOpRowBroadcast(OpTest):
+    def setUp(self):
+        self.op_type = "fused_elementwise_chain"
+        # more elements than a block of the kernel
+        x = np.random.uniform(-1, 1, (300, 7)).astype("float32")
+        y0 = np.random.uniform(-1, 1, (7, )).astype("float32")
+        y1 = np.random.uniform(-1, 1, (300, 7)).astype("float32")
+        self.inputs = {'X': x, 'Y': [('y0', y0), ('y1', y1)]}
+        self.attrs = {
+            'functor_list':
+            ['sigmoid', 'elementwise_mul', 'elementwise_sub', 'tanh']
+        }
+        out = np.tanh(1. / (1. + np.exp(-x)) * y0 - y1)
+        self.outputs = {'Out': out}
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestFusedElementwiseChainOpActivations(OpTest):
+    def setUp(self):
+        self.op_type = "fused_elementwise_chain"
+        x = np.random.uniform(-1, 1, (10, 12)).astype("float32")
+        self.inputs = {'X': x}
+        self.attrs = {'functor_list': ['relu', 'tanh']}
+        self.outputs = {'Out': np.tanh(np.maximum(x, 0))}
+
+    def test_check_output(self):
+        self.check_output()
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,75 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+def activate(x, activation_type):
+    if activation_type == "relu":
+        return np.maximum(x, 0)
+    if activation_type == "sigmoid":
+        return 1. / (1. + np.exp(-x))
+    if activation_type == "tanh":
+        return np.tanh(x)
+    return x
+
+
+class TestFusedFCOp(OpTest):
+    def setUp(self):
+        self.op_type = "fused_fc"
+        self.activation_type = "relu"
+        self.init_activation()
+        x = np.random.uniform(-1, 1, (16, 32)).astype("float32")
+        w = np.random.uniform(-1, 1, (32, 10)).astype("float32")
+        b = np.random.uniform(-1, 1, (10, )).astype("float32")
+        self.inputs = {'Input': x, 'W': w, 'Bias': b}
+        self.attrs = {'activation_type': self.activation_type}
+        self.outputs = {
+            'Out': activate(np.dot(x, w) + b, self.activation_type)
+        }
+
+    def init_activation(self):
+        pass
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestFusedFCOpSigmoid(TestFusedFCOp):
+    def init_activation(self):
+        self.activation_type = "sigmoid"
+
+
+class TestFusedFCOpTanh(TestFusedFCOp):
+    def init_activation(self):
+        self.activation_type = "tanh"
+
+
+class TestFusedFCOpNoBias(OpTest):
+    def setUp(self):
+        self.op_type = "fused_fc"
+        x = np.random.uniform(-1, 1, (2, 3, 4, 5)).astype("float32")
+        w = np.random.uniform(-1, 1, (20, 6)).astype("float32")
+        self.inputs = {'Input': x, 'W': w}
+        self.attrs = {'in_num_col_dims': 2}
+        out = np.dot(x.reshape(6, 20), w).reshape(2, 3, 6)
+        self.outputs = {'Out': out}
+
+    def test_check_output(self):
+        self.check_output()
+
+
+if __name__ == "__main__":
+    unittest.main()
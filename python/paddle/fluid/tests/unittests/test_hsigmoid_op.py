@@ -0,0 +1,122 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+def complete_tree_path(label, num_classes):
+    c = label + num_classes
+    length = c.bit_length() - 1
+    table = [(c >> (j + 1)) - 1 for j in range(length)]
+    code = [(c >> j) & 1 for j in range(length)]
+    return table, code
+
+
+def hsigmoid(x, w, bias, paths, max_code_length):
+    batch_size = x.shape[0]
+    pre_out = np.zeros((batch_size, max_code_length)).astype(x.dtype)
+    out = np.zeros((batch_size, 1)).astype(x.dtype)
+    for i in range(batch_size):
+        table, code = paths[i]
+        for j, (index, bit) in enumerate(zip(table, code)):
+            pre = np.dot(w[index], x[i])
+            if bias is not None:
+                pre += bias[index]
+            pre = np.clip(pre, -40.0, 40.0)
+            pre_out[i, j] = pre
+            out[i] += np.log(1 + np.exp(pre)) - bit * pre
+    return out, pre_out
+
+
+class TestHSigmoidOp(OpTest):
+    def setUp(self):
+        self.op_type = "hsigmoid"
+        num_classes = 6
+        batch_size = 4
+        dim = 5
+        x = np.random.uniform(-1, 1, (batch_size, dim)).astype('float32')
+        w = np.random.uniform(-1, 1, (num_classes - 1, dim)).astype('float32')
+        bias = np.random.uniform(-1, 1,
+                                 (num_classes - 1, 1)).astype('float32')
+        label = np.array([0, 1, 4, 5]).astype('int64').reshape(batch_size, 1)
+        paths = [complete_tree_path(l, num_classes) for l in label[:, 0]]
+        max_code_length = (num_classes - 1).bit_length()
+        out, pre_out = hsigmoid(x, w, bias, paths, max_code_length)
+
+        self.attrs = {'num_classes': num_classes}
+        self.inputs = {'X': x, 'W': w, 'Bias': bias, 'Label': label}
+        self.outputs = {'Out': out, 'PreOut': pre_out}
+
+    def test_check_output(self):
+        self.check_output()
+
+    def test_check_grad(self):
+        self.check_grad(['X', 'W', 'Bias'], 'Out', no_grad_set=set(['Label']))
+
+
+class TestHSigmoidOpCustomTree(OpTest):
+    def setUp(self):
+        self.op_type = "hsigmoid"
+        # A tree of 6 classes and 5 non-leaf nodes:
+        #   node 0: (node 1, node 2), node 1: (class 0, node 3),
+        #   node 3: (class 1, class 2), node 2: (node 4, class 3),
+        #   node 4: (class 4, class 5).
+        tree = {
+            0: ([0, 1], [0, 0]),
+            1: ([0, 1, 3], [0, 1, 0]),
+            2: ([0, 1, 3], [0, 1, 1]),
+            3: ([0, 2], [1, 1]),
+            4: ([0, 2, 4], [1, 0, 0]),
+            5: ([0, 2, 4], [1, 0, 1]),
+        }
+        num_classes = 6
+        batch_size = 5
+        dim = 3
+        max_code_length = 3
+        x = np.random.uniform(-1, 1, (batch_size, dim)).astype('float32')
+        w = np.random.uniform(-1, 1, (num_classes - 1, dim)).astype('float32')
+        label = np.array([0, 2, 3, 4, 5]).astype('int64').reshape(batch_size,
+                                                                  1)
+        paths = [tree[l] for l in label[:, 0]]
+        path_table = -np.ones((batch_size, max_code_length)).astype('int64')
+        path_code = np.zeros((batch_size, max_code_length)).astype('int64')
+        for i, (table, code) in enumerate(paths):
+            path_table[i, :len(table)] = table
+            path_code[i, :len(code)] = code
+        out, pre_out = hsigmoid(x, w, None, paths, max_code_length)
+
+        self.attrs = {'num_classes': num_classes}
+        self.inputs = {
+            'X': x,
+            'W': w,
+            'Label': label,
+            'PathTable': path_table,
+            'PathCode': path_code
+        }
+        self.outputs = {'Out': out, 'PreOut': pre_out}
+
+    def test_check_output(self):
+        self.check_output()
+
+    def test_check_grad(self):
+        self.check_grad(
+            ['X', 'W'],
+            'Out',
+            no_grad_set=set(['Label', 'PathTable', 'PathCode']))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -82,6 +82,31 @@ class TestBook(unittest.TestCase):
         self.assertEqual(str(fetch_vars[0]), str(avg_cost))
         self.assertEqual(expected, actual)
 
+        # the parameters in a single aligned file, mapped by the loading
+        MAPPED_MODEL_DIR = "./tmp/inference_model_mapped"
+        save_inference_model(
+            MAPPED_MODEL_DIR, ["x", "y"], [avg_cost],
+            exe,
+            program,
+            params_filename="__params__",
+            aligned=True)
+
+        reload(executor)  # reload to build a new scope
+        exe = executor.Executor(place)
+
+        [infer_prog, feed_var_names, fetch_vars] = load_inference_model(
+            MAPPED_MODEL_DIR,
+            exe,
+            params_filename="__params__",
+            use_mmap=True)
+
+        outs = exe.run(
+            infer_prog,
+            feed={feed_var_names[0]: tensor_x,
+                  feed_var_names[1]: tensor_y},
+            fetch_list=fetch_vars)
+        self.assertEqual(expected, outs[0])
+
 
 if __name__ == '__main__':
     unittest.main()
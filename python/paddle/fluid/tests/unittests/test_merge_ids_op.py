@@ -0,0 +1,42 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+class TestMergeIdsOp(OpTest):
+    def setUp(self):
+        self.op_type = "merge_ids"
+        ids0 = np.array([[0], [2], [5], [2]]).astype('int64')
+        ids1 = np.array([[5], [3], [0]]).astype('int64')
+        rows0 = np.array([[0], [2]]).astype('int64')
+        rows1 = np.array([[5], [3]]).astype('int64')
+        x0 = np.random.random((2, 4)).astype('float32')
+        x1 = np.random.random((2, 4)).astype('float32')
+        out0 = np.array([x0[0], x0[1], x1[0], x0[1]]).astype('float32')
+        out1 = np.array([x1[0], x1[1], x0[0]]).astype('float32')
+        self.inputs = {
+            'Ids': [('ids0', ids0), ('ids1', ids1)],
+            'Rows': [('rows0', rows0), ('rows1', rows1)],
+            'X': [('x0', x0), ('x1', x1)]
+        }
+        self.outputs = {'Out': [('out0', out0), ('out1', out1)]}
+
+    def test_check_output(self):
+        self.check_output()
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -15,6 +15,8 @@
 import unittest
 import numpy as np
 from op_test import OpTest
+from paddle.fluid import core
+from paddle.fluid.op import Operator
 
 
 class TestMomentumOp1(OpTest):
@@ -86,5 +88,102 @@ class TestMomentumOp2(OpTest):
         self.check_output()
 
 
+def momentum_step(param, grad, velocity, lr, mu, use_nesterov):
+    velocity_out = mu * velocity + grad
+    if use_nesterov:
+        param_out = param - (grad - velocity_out * mu) * lr
+    else:
+        param_out = param - lr * velocity_out
+    return param_out, velocity_out
+
+
+class TestSparseLazyMomentumOp(unittest.TestCase):
+    def setup(self, scope, place):
+        height = 10
+        row_numel = 12
+        mu = 0.9
+        lr = 0.1
+        # the rows 0 and 4 were last updated on the steps 2 and 5, the 6th
+        # step is updating them again, so row 0 catches up 3 steps.
+        self.rows = [0, 4, 0]
+        self.unique_rows = [0, 4]
+        step = np.zeros(height + 1).astype("int64")
+        step[0] = 2
+        step[4] = 5
+        step[height] = 5
+        self.expected_step = step.copy()
+        self.expected_step[[0, 4, height]] = 6
+
+        param = np.random.random((height, row_numel)).astype("float32")
+        velocity = np.random.random((height, row_numel)).astype("float32")
+        grad = np.random.random((len(self.rows), row_numel)).astype("float32")
+        self.dense_inputs = {
+            "Param": param,
+            "Velocity": velocity,
+            "LearningRate": np.array([lr]).astype("float32"),
+            "RowStep": step
+        }
+
+        grad_selected_rows = scope.var('Grad').get_selected_rows()
+        grad_selected_rows.set_height(height)
+        grad_selected_rows.set_rows(self.rows)
+        grad_selected_rows.get_tensor().set(grad, place)
+
+        merged = np.zeros((height, row_numel)).astype("float32")
+        for i, row in enumerate(self.rows):
+            merged[row] += grad[i]
+        self.param_out = param.copy()
+        self.velocity_out = velocity.copy()
+        for row in self.unique_rows:
+            p, v = param[row], velocity[row]
+            for _ in range(5 - step[row]):
+                p, v = momentum_step(p, 0, v, lr, mu, self.use_nesterov)
+            p, v = momentum_step(p, merged[row], v, lr, mu, self.use_nesterov)
+            self.param_out[row], self.velocity_out[row] = p, v
+        self.attrs = {'mu': mu, 'use_nesterov': self.use_nesterov}
+
+    def check_with_place(self, place):
+        scope = core.Scope()
+        self.setup(scope, place)
+
+        for key, np_array in self.dense_inputs.iteritems():
+            scope.var(key).get_tensor().set(np_array, place)
+        momentum_op = Operator(
+            "momentum",
+            Param="Param",
+            Grad="Grad",
+            Velocity="Velocity",
+            LearningRate="LearningRate",
+            RowStep="RowStep",
+            ParamOut="Param",
+            VelocityOut="Velocity",
+            RowStepOut="RowStep",
+            **self.attrs)
+        momentum_op.run(scope, place)
+
+        self.assertTrue(
+            np.allclose(
+                np.array(scope.var("Param").get_tensor()),
+                self.param_out,
+                atol=1e-5))
+        self.assertTrue(
+            np.allclose(
+                np.array(scope.var("Velocity").get_tensor()),
+                self.velocity_out,
+                atol=1e-5))
+        self.assertTrue(
+            np.array_equal(
+                np.array(scope.var("RowStep").get_tensor()),
+                self.expected_step))
+
+    def test_sparse_momentum(self):
+        self.use_nesterov = False
+        self.check_with_place(core.CPUPlace())
+
+    def test_sparse_nesterov_momentum(self):
+        self.use_nesterov = True
+        self.check_with_place(core.CPUPlace())
+
+
 if __name__ == "__main__":
     unittest.main()
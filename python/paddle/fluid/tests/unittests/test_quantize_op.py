@@ -0,0 +1,92 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+class TestQuantizeOp(OpTest):
+    def setUp(self):
+        self.op_type = "quantize"
+        x = np.random.uniform(-1.5, 1.5, (4, 5)).astype("float32")
+        # Multiply in float32 like the kernel.
+        scale = np.float32(127. / 1.2)
+        self.inputs = {'X': x}
+        self.attrs = {'scale': float(scale)}
+        # The values out of the calibrated range are clipped.
+        self.outputs = {
+            'Out': np.clip(np.round(x * scale), -127, 127).astype("int8")
+        }
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestDequantizeOp(OpTest):
+    def setUp(self):
+        self.op_type = "dequantize"
+        x = np.random.randint(-127, 128, (4, 5)).astype("int8")
+        scale = 50.
+        self.inputs = {'X': x}
+        self.attrs = {'scale': scale}
+        self.outputs = {'Out': (x / scale).astype("float32")}
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestDequantizeOpScale(OpTest):
+    """The int32 output of an INT8 kernel, whose channels from axis have
+    their own scales in Scale.
+    """
+
+    def setUp(self):
+        self.op_type = "dequantize"
+        self.init_axis()
+        x = np.random.randint(-100000, 100000, (2, 3, 4, 5)).astype("int32")
+        channels = x.shape[self.axis]
+        channel_scale = np.random.uniform(10, 100,
+                                          (channels, )).astype("float32")
+        scale = 30.
+        shape = [1] * x.ndim
+        shape[self.axis] = channels
+        self.inputs = {'X': x, 'Scale': channel_scale}
+        self.attrs = {'scale': scale, 'axis': self.axis}
+        self.outputs = {
+            'Out': (x / (scale * channel_scale.reshape(shape))).astype(
+                "float32")
+        }
+
+    def init_axis(self):
+        self.axis = 1
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestDequantizeOpScaleAxis2(TestDequantizeOpScale):
+    def init_axis(self):
+        self.axis = 2
+
+
+class TestDequantizeOpScaleLastAxis(TestDequantizeOpScale):
+    """The output of a mul whose x_num_col_dims is 3."""
+
+    def init_axis(self):
+        self.axis = 3
+
+
+if __name__ == '__main__':
+    unittest.main()
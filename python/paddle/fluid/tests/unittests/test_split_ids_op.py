@@ -23,13 +23,27 @@ class TestSplitIdsOp(OpTest):
         ids = np.array([[0], [2], [2], [3], [5], [5], [6]]).astype('int64')
         out0 = np.array([[0], [3], [6]]).astype('int64')
         out1 = np.array([[]]).astype('int64')
-        out2 = np.array([[2], [2], [5], [5]]).astype('int64')
-        self.inputs = {'Ids': ids}
+        out2 = np.array([[2], [5]]).astype('int64')
+        self.inputs = {'Ids': [('ids0', ids)]}
         self.outputs = {'Out': [('out0', out0), ('out1', out1), ('out2', out2)]}
 
     def test_check_output(self):
         self.check_output()
 
 
+class TestSplitIdsOpMultiInput(OpTest):
+    def setUp(self):
+        self.op_type = "split_ids"
+        ids0 = np.array([[0], [2], [5], [2]]).astype('int64')
+        ids1 = np.array([[5], [3], [0], [7]]).astype('int64')
+        out0 = np.array([[0], [2]]).astype('int64')
+        out1 = np.array([[5], [3], [7]]).astype('int64')
+        self.inputs = {'Ids': [('ids0', ids0), ('ids1', ids1)]}
+        self.outputs = {'Out': [('out0', out0), ('out1', out1)]}
+
+    def test_check_output(self):
+        self.check_output()
+
+
 if __name__ == '__main__':
     unittest.main()
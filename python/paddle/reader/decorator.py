@@ -14,7 +14,8 @@
 
 __all__ = [
     'map_readers', 'buffered', 'compose', 'chain', 'shuffle',
-    'ComposeNotAligned', 'firstn', 'xmap_readers', 'PipeReader'
+    'ComposeNotAligned', 'firstn', 'xmap_readers', 'PipeReader',
+    'bucket_by_length'
 ]
 
 from threading import Thread
@@ -83,6 +84,58 @@ def shuffle(reader, buf_size):
     return data_reader
 
 
+def bucket_by_length(reader, batch_size, buf_size, key=None):
+    """
+    Creates a batched reader whose mini-batches hold the samples of similar
+    lengths.
+
+    Output from the original reader is buffered into a buffer of buf_size
+    samples, which is sorted by the lengths of the samples and cut into
+    mini-batches of batch_size samples, then the mini-batches are shuffled.
+    The sequences of a mini-batch are then of about the same length, so
+    the sequence operators spend little time on the skew of the lengths.
+
+    :param reader: the data reader to read from.
+    :type reader: callable
+    :param batch_size: size of each mini-batch.
+    :type batch_size: int
+    :param buf_size: the number of the samples sorted together, the larger
+        it is the closer the lengths of a mini-batch are.
+    :type buf_size: int
+    :param key: the function returning the length of a sample, the length
+        of the first field of the sample by default.
+    :type key: callable
+    :return: the batched reader.
+    :rtype: callable
+    """
+
+    if key is None:
+        key = lambda sample: len(sample[0])
+
+    def bucket(buf):
+        buf.sort(key=key)
+        batches = [
+            buf[i:i + batch_size] for i in xrange(0, len(buf), batch_size)
+        ]
+        random.shuffle(batches)
+        return batches
+
+    def data_reader():
+        buf = []
+        for e in reader():
+            buf.append(e)
+            if len(buf) >= buf_size:
+                for b in bucket(buf):
+                    yield b
+                buf = []
+
+        if len(buf) > 0:
+            for b in bucket(buf):
+                yield b
+
+    return data_reader
+
+
 def chain(*readers):
     """
     Creates a data reader whose output is the outputs of input data
@@ -122,6 +122,22 @@ class TestShuffle(unittest.TestCase):
             self.assertEqual(total, 10)
 
 
+class TestBucketByLength(unittest.TestCase):
+    def test_bucket_by_length(self):
+        def reader():
+            for length in [5, 1, 4, 2, 3, 6, 8, 7, 9]:
+                yield (range(length), length)
+
+        batches = list(
+            paddle.reader.bucket_by_length(
+                reader, batch_size=2, buf_size=4)())
+        # The buffers of 4, 4 and 1 samples make 2, 2 and 1 batches.
+        self.assertEqual(len(batches), 5)
+        lengths = sorted(
+            [tuple(sorted(s[1] for s in batch)) for batch in batches])
+        self.assertEqual(lengths, [(1, 2), (3, 6), (4, 5), (7, 8), (9, )])
+
+
 class TestXmap(unittest.TestCase):
     def test_xmap(self):
         def mapper(x):